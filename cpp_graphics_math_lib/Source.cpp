@@ -2,6 +2,20 @@
 #include <tests/tests_matrix.h>
 #include <tests/tests_plane_3d.h>
 #include <tests/tests_frustum.h>
+#include <tests/tests_matrix3x4.h>
+#include <tests/tests_quat.h>
+#include <tests/tests_trs.h>
+#include <tests/tests_vec3_soa.h>
+#include <tests/tests_vec4.h>
+#include <tests/tests_bvh.h>
+#include <tests/tests_dynamic_aabb_tree.h>
+#include <tests/tests_loose_octree.h>
+#include <tests/tests_terrain_quadtree.h>
+#include <tests/tests_spatial_hash_grid.h>
+#include <tests/tests_sweep_and_prune.h>
+#include <tests/tests_ray.h>
+#include <tests/tests_ray_packet.h>
+#include <tests/tests_triangle.h>
 #include <stdlib.h>
 
 int main()
@@ -12,6 +26,20 @@ int main()
     TestMatrix();
     TestPlane3d();
     TestFrustum();
+    TestMatrix3x4();
+    TestQuat();
+    TestTRS();
+    TestVec3SoA();
+    TestVec4();
+    TestBvh();
+    TestDynamicAabbTree();
+    TestLooseOctree();
+    TestTerrainQuadtree();
+    TestSpatialHashGrid();
+    TestSweepAndPrune();
+    TestRay();
+    TestRayPacket();
+    TestTriangle();
 
     CloseLogger();
 
@@ -0,0 +1,927 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: bvh.h
+    Desc:     bounding volume hierarchy (BVH) over an array of Rect3d primitives
+
+              - build: top-down, a split of each node is chosen using
+                the surface area heuristic (SAH) evaluated over a fixed
+                number of bins along each axis;
+              - nodes are stored in a flat array (64-byte aligned) and refer
+                to each other by indices; children of a node are always
+                stored next to each other and start on a cache line,
+                so both children are fetched by a single memory access;
+              - queries (frustum, rect, point, ray, ray packet) write indices of
+                primitives into a caller's buffer and allocate nothing
+
+    Created:  17.10.2026 by DimaSkup
+\**********************************************************************************/
+#pragma once
+
+#include <geometry/frustum.h>
+#include <geometry/rect_3d.h>
+#include <geometry/rect_3d_functions.h>
+#include <geometry/intersection_tests.h>
+#include <geometry/ray_packet.h>
+#include <math/vec3.h>
+#include <math/simd.h>
+#include <assert.h>
+#include <float.h>
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <memory>
+
+
+//==================================================================================
+// BVH node
+//==================================================================================
+struct alignas(32) BvhNode
+{
+    Rect3d   bounds;
+
+    // inner node: index of the left child (the right child is leftOrFirst+1);
+    // leaf:       index of the first primitive in Bvh::primIndices
+    uint32_t leftOrFirst = 0;
+
+    // number of primitives in a leaf (0 for inner nodes)
+    uint32_t count = 0;
+
+    inline bool IsLeaf() const { return count > 0; }
+};
+
+static_assert(sizeof(BvhNode) == 32, "two BVH nodes must fit into one cache line");
+
+
+//==================================================================================
+// BVH
+//==================================================================================
+class Bvh
+{
+public:
+    static constexpr int      NUM_BINS      = 16;
+    static constexpr int      MAX_DEPTH     = 64;      // it is also the size of a traversal stack
+    static constexpr uint32_t MAX_LEAF_SIZE = 4;       // default max number of primitives in a leaf
+    static constexpr size_t   NODES_ALIGN   = 64;      // cache line
+
+    //-----------------------------------------------------
+    // public data
+    //-----------------------------------------------------
+
+    // nodes[0] is the root, nodes[1] is unused so pairs of children
+    // always start at even indices (on a cache line boundary);
+    // children are always stored after their parent (depth-first order)
+    BvhNode*  nodes       = nullptr;
+    uint32_t  numNodes    = 0;
+    uint32_t  maxNodes    = 0;
+
+    // leaves refer to ranges of primIndices; primBounds are bounds of
+    // primitives in the same order (so leaves read them sequentially)
+    uint32_t* primIndices = nullptr;
+    Rect3d*   primBounds  = nullptr;
+    uint32_t  numPrims    = 0;
+
+    // SAH cost of the tree right after the build and the current one
+    // (after refits); see ComputeSahCost()
+    float     buildSahCost = 0;
+    float     sahCost      = 0;
+
+    //-----------------------------------------------------
+    // constructors, destructor
+    //-----------------------------------------------------
+    Bvh() {}
+    ~Bvh() { Release(); }
+
+    Bvh(const Bvh&) = delete;
+    Bvh& operator = (const Bvh&) = delete;
+
+    //-----------------------------------------------------
+    // build
+    //-----------------------------------------------------
+    void Build(const Rect3d* prims, const uint32_t numPrims, const uint32_t maxLeafSize = MAX_LEAF_SIZE);
+    void Allocate(const uint32_t numPrims);
+    void Release();
+
+    inline bool IsEmpty() const { return numNodes == 0; }
+
+    //-----------------------------------------------------
+    // refit (for moving primitives)
+    //-----------------------------------------------------
+    void  Refit(const Rect3d* newBounds, const bool updateSahCost = false);
+    float ComputeSahCost() const;
+
+    inline bool IsDegraded(const float maxCostRatio = 1.5f) const
+    {
+        return sahCost > buildSahCost * maxCostRatio;
+    }
+
+    //-----------------------------------------------------
+    // queries: all of them return the number of found primitives,
+    // only the first maxCount of them are written into outIndices
+    //-----------------------------------------------------
+    uint32_t QueryFrustum(const Frustum& frustum, uint32_t* outIndices, const uint32_t maxCount) const;
+    uint32_t QueryRect   (const Rect3d& rect,     uint32_t* outIndices, const uint32_t maxCount) const;
+    uint32_t QueryPoint  (const Vec3& point,      uint32_t* outIndices, const uint32_t maxCount) const;
+
+    uint32_t QueryRay(
+        const Vec3& origin,
+        const Vec3& dir,
+        const float tMax,
+        uint32_t* outIndices,
+        const uint32_t maxCount) const;
+
+    template <int N>
+    uint32_t QueryRayPacket(
+        const RayPacket<N>& packet,
+        const uint32_t activeMask,
+        uint32_t* outIndices,
+        uint32_t* outMasks,
+        const uint32_t maxCount) const;
+};
+
+
+//==================================================================================
+// BUILD HELPERS
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:   an "inverted" rect: union of it with anything gives that thing
+//---------------------------------------------------------
+inline Rect3d BvhEmptyRect()
+{
+    return Rect3d(FLT_MAX, -FLT_MAX, FLT_MAX, -FLT_MAX, FLT_MAX, -FLT_MAX);
+}
+
+//---------------------------------------------------------
+// Desc:   a split candidate chosen by the SAH
+//---------------------------------------------------------
+struct BvhSplit
+{
+    int   axis = -1;        // -1 if there is no valid split
+    int   bin  = 0;         // primitives from bins [0, bin] go to the left child
+    float cost = FLT_MAX;   // sum of (surface area * count) of both children
+};
+
+//---------------------------------------------------------
+// Desc:   a bin of the SAH builder
+//---------------------------------------------------------
+struct BvhBin
+{
+    Rect3d   bounds = BvhEmptyRect();
+    uint32_t count  = 0;
+};
+
+//---------------------------------------------------------
+// Desc:   bins of a node along all three axes
+//---------------------------------------------------------
+struct BvhBins
+{
+    BvhBin bins[3][Bvh::NUM_BINS];
+
+    // merge bins which were filled over another range of primitives
+    inline void Merge(const BvhBins& other)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            for (int i = 0; i < Bvh::NUM_BINS; ++i)
+            {
+                bins[axis][i].bounds.Union(other.bins[axis][i].bounds);
+                bins[axis][i].count += other.bins[axis][i].count;
+            }
+        }
+    }
+};
+
+//---------------------------------------------------------
+// Desc:   mapping of primitive centroids into bins of a node
+//---------------------------------------------------------
+struct BvhBinMapping
+{
+    float minC[3];
+    float scale[3];         // 0 if centroids of the node are flat along the axis
+
+    inline void Init(const Rect3d& centroidBounds)
+    {
+        const float mins[3]  = { centroidBounds.x0, centroidBounds.y0, centroidBounds.z0 };
+        const float sizes[3] = { centroidBounds.SizeX(), centroidBounds.SizeY(), centroidBounds.SizeZ() };
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            minC[axis]  = mins[axis];
+            scale[axis] = (sizes[axis] > 0.0f) ? (Bvh::NUM_BINS / sizes[axis]) : 0.0f;
+        }
+    }
+
+    inline int GetBin(const Vec3& centroid, const int axis) const
+    {
+        const int bin = (int)((centroid.xyz[axis] - minC[axis]) * scale[axis]);
+        return (bin < Bvh::NUM_BINS - 1) ? bin : Bvh::NUM_BINS - 1;
+    }
+};
+
+//---------------------------------------------------------
+// Desc:   compute bounds of primitives and bounds of their centroids
+// Args:   - prims:     bounds of all the primitives (by original index)
+//         - centroids: centroids of all the primitives (by original index)
+//         - indices:   a range of primitive indices
+//---------------------------------------------------------
+inline void BvhComputeBounds(
+    const Rect3d* prims,
+    const Vec3* centroids,
+    const uint32_t* indices,
+    const uint32_t count,
+    Rect3d& outBounds,
+    Rect3d& outCentroidBounds)
+{
+    outBounds         = BvhEmptyRect();
+    outCentroidBounds = BvhEmptyRect();
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        outBounds.Union(prims[indices[i]]);
+        outCentroidBounds.Union(centroids[indices[i]]);
+    }
+}
+
+//---------------------------------------------------------
+// Desc:   put a range of primitives into bins along all the axes
+//---------------------------------------------------------
+inline void BvhFillBins(
+    const Rect3d* prims,
+    const Vec3* centroids,
+    const uint32_t* indices,
+    const uint32_t count,
+    const BvhBinMapping& mapping,
+    BvhBins& outBins)
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const uint32_t idx = indices[i];
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            if (mapping.scale[axis] == 0.0f)
+                continue;
+
+            BvhBin& bin = outBins.bins[axis][mapping.GetBin(centroids[idx], axis)];
+            bin.bounds.Union(prims[idx]);
+            bin.count++;
+        }
+    }
+}
+
+//---------------------------------------------------------
+// Desc:   find the cheapest split plane between bins by the SAH
+//---------------------------------------------------------
+inline BvhSplit BvhFindBestSplit(const BvhBins& bins, const BvhBinMapping& mapping)
+{
+    constexpr int NUM_PLANES = Bvh::NUM_BINS - 1;
+    BvhSplit best;
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        if (mapping.scale[axis] == 0.0f)
+            continue;
+
+        const BvhBin* axisBins = bins.bins[axis];
+
+        float    leftArea[NUM_PLANES];
+        uint32_t leftCount[NUM_PLANES];
+        Rect3d   bounds = BvhEmptyRect();
+        uint32_t count  = 0;
+
+        // sweep from the left: areas/counts of everything to the left of each plane
+        for (int i = 0; i < NUM_PLANES; ++i)
+        {
+            bounds.Union(axisBins[i].bounds);
+            count += axisBins[i].count;
+
+            leftCount[i] = count;
+            leftArea[i]  = (count > 0) ? bounds.SurfaceArea() : 0.0f;
+        }
+
+        // sweep from the right and evaluate the cost of each plane
+        bounds = BvhEmptyRect();
+        count  = 0;
+
+        for (int i = NUM_PLANES - 1; i >= 0; --i)
+        {
+            bounds.Union(axisBins[i + 1].bounds);
+            count += axisBins[i + 1].count;
+
+            if (count == 0 || leftCount[i] == 0)
+                continue;
+
+            const float cost = leftArea[i] * leftCount[i] + bounds.SurfaceArea() * count;
+
+            if (cost < best.cost)
+            {
+                best.axis = axis;
+                best.bin  = i;
+                best.cost = cost;
+            }
+        }
+    }
+
+    return best;
+}
+
+//---------------------------------------------------------
+// Desc:   partition a range of primitive indices by the split; the partition
+//         is stable (it keeps the order of indices in both parts), so the
+//         parallel build which partitions by chunks gives the same result
+// Args:   - scratch: a buffer of at least count elements
+// Ret:    number of primitives which go to the left child
+//---------------------------------------------------------
+inline uint32_t BvhPartition(
+    const Vec3* centroids,
+    uint32_t* indices,
+    const uint32_t count,
+    const BvhBinMapping& mapping,
+    const BvhSplit& split,
+    uint32_t* scratch)
+{
+    uint32_t numLeft  = 0;
+    uint32_t numRight = 0;
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const uint32_t idx = indices[i];
+
+        if (mapping.GetBin(centroids[idx], split.axis) <= split.bin)
+            indices[numLeft++] = idx;
+        else
+            scratch[numRight++] = idx;
+    }
+
+    memcpy(indices + numLeft, scratch, numRight * sizeof(uint32_t));
+    return numLeft;
+}
+
+//---------------------------------------------------------
+// Desc:   common data of a (single-threaded) build
+//---------------------------------------------------------
+struct BvhBuilder
+{
+    Bvh*          bvh;
+    const Rect3d* prims;
+    const Vec3*   centroids;
+    uint32_t*     scratch;          // a buffer of numPrims indices for partitioning
+    uint32_t      maxLeafSize;
+
+    //---------------------------------------------------------
+    // Desc:   split a node which covers primitives [first, first+count)
+    //         and recursively build its subtree
+    //---------------------------------------------------------
+    void Subdivide(const uint32_t nodeIdx, const uint32_t first, const uint32_t count, const int depth)
+    {
+        BvhNode& node     = bvh->nodes[nodeIdx];
+        uint32_t* indices = bvh->primIndices + first;
+
+        Rect3d centroidBounds;
+        BvhComputeBounds(prims, centroids, indices, count, node.bounds, centroidBounds);
+
+        node.leftOrFirst = first;
+        node.count       = count;
+
+        // the traversal stack is limited by MAX_DEPTH
+        if (count <= maxLeafSize || depth >= Bvh::MAX_DEPTH - 1)
+            return;
+
+        BvhBinMapping mapping;
+        mapping.Init(centroidBounds);
+
+        BvhBins bins;
+        BvhFillBins(prims, centroids, indices, count, mapping, bins);
+
+        const BvhSplit split    = BvhFindBestSplit(bins, mapping);
+        uint32_t       numLeft  = count / 2;
+
+        // if all the centroids are in the same point we just split the range in half
+        if (split.axis >= 0)
+            numLeft = BvhPartition(centroids, indices, count, mapping, split, scratch + first);
+
+        const uint32_t leftIdx = bvh->numNodes;
+        bvh->numNodes += 2;
+        assert(bvh->numNodes <= bvh->maxNodes);
+
+        node.leftOrFirst = leftIdx;
+        node.count       = 0;
+
+        Subdivide(leftIdx,     first,           numLeft,         depth + 1);
+        Subdivide(leftIdx + 1, first + numLeft, count - numLeft, depth + 1);
+    }
+};
+
+
+//==================================================================================
+// BUILD
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:   allocate memory for a BVH over numPrims primitives
+//         (a tree with N leaves has 2N-1 nodes + 1 unused node);
+//         the current memory is reused if it is enough (per-frame rebuilds)
+//---------------------------------------------------------
+inline void Bvh::Allocate(const uint32_t numPrimitives)
+{
+    if ((numPrimitives > 0) && (2 * numPrimitives <= maxNodes))
+    {
+        numPrims = numPrimitives;
+        numNodes = 0;
+        std::fill_n(nodes, 2 * numPrimitives, BvhNode());
+        return;
+    }
+
+    Release();
+
+    if (numPrimitives == 0)
+        return;
+
+    maxNodes    = 2 * numPrimitives;
+    nodes       = (BvhNode*)AlignedAlloc(maxNodes * sizeof(BvhNode), NODES_ALIGN);
+    primIndices = new uint32_t[numPrimitives];
+    primBounds  = new Rect3d[numPrimitives];
+    numPrims    = numPrimitives;
+
+    assert(nodes != nullptr && "can't allocate memory for BVH nodes");
+    std::uninitialized_fill_n(nodes, maxNodes, BvhNode());
+}
+
+//---------------------------------------------------------
+
+inline void Bvh::Release()
+{
+    if (nodes)
+        AlignedFree(nodes);
+
+    delete[] primIndices;
+    delete[] primBounds;
+
+    nodes       = nullptr;
+    primIndices = nullptr;
+    primBounds  = nullptr;
+    numNodes    = 0;
+    maxNodes    = 0;
+    numPrims    = 0;
+    buildSahCost = 0;
+    sahCost      = 0;
+}
+
+//---------------------------------------------------------
+// Desc:   build the BVH using binned SAH
+// Args:   - prims:       bounds of primitives; indices of this array are
+//                        returned by the queries
+//         - numPrims:    number of primitives
+//         - maxLeafSize: a node with fewer primitives isn't split
+//---------------------------------------------------------
+inline void Bvh::Build(const Rect3d* prims, const uint32_t numPrimitives, const uint32_t maxLeafSize)
+{
+    assert((prims != nullptr) || (numPrimitives == 0));
+    assert(maxLeafSize > 0);
+
+    Allocate(numPrimitives);
+
+    if (numPrimitives == 0)
+        return;
+
+    Vec3*     centroids = new Vec3[numPrimitives];
+    uint32_t* scratch   = new uint32_t[numPrimitives];
+
+    for (uint32_t i = 0; i < numPrimitives; ++i)
+    {
+        centroids[i]   = prims[i].MidPoint();
+        primIndices[i] = i;
+    }
+
+    BvhBuilder builder;
+    builder.bvh         = this;
+    builder.prims       = prims;
+    builder.centroids   = centroids;
+    builder.scratch     = scratch;
+    builder.maxLeafSize = maxLeafSize;
+
+    numNodes = 2;
+    builder.Subdivide(0, 0, numPrimitives, 0);
+
+    // store bounds of primitives in the order of leaves
+    for (uint32_t i = 0; i < numPrimitives; ++i)
+        primBounds[i] = prims[primIndices[i]];
+
+    buildSahCost = ComputeSahCost();
+    sahCost      = buildSahCost;
+
+    delete[] centroids;
+    delete[] scratch;
+}
+
+//---------------------------------------------------------
+// Desc:   copy a subtree from another array of nodes into the BVH;
+//         children pairs are allocated in depth-first order (the same
+//         order as the single-threaded build allocates them)
+// Args:   - srcNodes: nodes of any layout (but with Bvh children pairs)
+//         - srcIdx:   the root of the subtree in srcNodes
+//         - bvh:      the destination (numNodes is the next free pair)
+//         - dstIdx:   the root of the subtree in bvh
+//---------------------------------------------------------
+inline void BvhCompactNodes(const BvhNode* srcNodes, const uint32_t srcIdx, Bvh& bvh, const uint32_t dstIdx)
+{
+    const BvhNode& src = srcNodes[srcIdx];
+    BvhNode&       dst = bvh.nodes[dstIdx];
+
+    dst = src;
+
+    if (src.IsLeaf())
+        return;
+
+    const uint32_t leftIdx = bvh.numNodes;
+    bvh.numNodes    += 2;
+    dst.leftOrFirst  = leftIdx;
+
+    BvhCompactNodes(srcNodes, src.leftOrFirst,     bvh, leftIdx);
+    BvhCompactNodes(srcNodes, src.leftOrFirst + 1, bvh, leftIdx + 1);
+}
+
+
+//==================================================================================
+// REFIT
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:   SAH cost of a node: the probability to visit it (its area relative
+//         to the root one) multiplied by the cost of its processing
+//         (1 for an inner node, number of primitives for a leaf)
+//---------------------------------------------------------
+inline float BvhNodeSahCost(const BvhNode& node)
+{
+    return node.bounds.SurfaceArea() * (node.IsLeaf() ? (float)node.count : 1.0f);
+}
+
+//---------------------------------------------------------
+// Desc:   SAH cost of the whole tree (relative to the area of the root)
+//---------------------------------------------------------
+inline float Bvh::ComputeSahCost() const
+{
+    if (IsEmpty())
+        return 0.0f;
+
+    float cost = 0.0f;
+
+    for (uint32_t i = 2; i < numNodes; ++i)
+        cost += BvhNodeSahCost(nodes[i]);
+
+    const float rootArea = nodes[0].bounds.SurfaceArea();
+    cost += BvhNodeSahCost(nodes[0]);
+
+    return (rootArea > 0.0f) ? cost / rootArea : 0.0f;
+}
+
+//---------------------------------------------------------
+// Desc:   update bounds of all the nodes after primitives are moved
+//         (the topology is kept); since children are always stored after
+//         their parent, it is a single backward pass over the nodes
+// Args:   - newBounds:     new bounds of primitives (by original indices,
+//                          the same array layout as passed to the build)
+//         - updateSahCost: compute the SAH cost of the refitted tree during
+//                          the pass (use IsDegraded() to check if it's time
+//                          to rebuild the tree)
+//---------------------------------------------------------
+inline void Bvh::Refit(const Rect3d* newBounds, const bool updateSahCost)
+{
+    assert((newBounds != nullptr) || IsEmpty());
+
+    if (IsEmpty())
+        return;
+
+    for (uint32_t i = 0; i < numPrims; ++i)
+        primBounds[i] = newBounds[primIndices[i]];
+
+    float cost = 0.0f;
+
+    for (uint32_t i = numNodes - 1; i > 1; --i)
+    {
+        BvhNode& node = nodes[i];
+
+        if (node.IsLeaf())
+        {
+            node.bounds = primBounds[node.leftOrFirst];
+
+            for (uint32_t j = node.leftOrFirst + 1; j < node.leftOrFirst + node.count; ++j)
+                node.bounds.Union(primBounds[j]);
+        }
+        else
+        {
+            node.bounds = nodes[node.leftOrFirst].bounds;
+            node.bounds.Union(nodes[node.leftOrFirst + 1].bounds);
+        }
+
+        if (updateSahCost)
+            cost += BvhNodeSahCost(node);
+    }
+
+    // the root
+    BvhNode& root = nodes[0];
+
+    if (root.IsLeaf())
+    {
+        root.bounds = primBounds[0];
+
+        for (uint32_t j = 1; j < root.count; ++j)
+            root.bounds.Union(primBounds[j]);
+    }
+    else
+    {
+        root.bounds = nodes[root.leftOrFirst].bounds;
+        root.bounds.Union(nodes[root.leftOrFirst + 1].bounds);
+    }
+
+    if (updateSahCost)
+    {
+        const float rootArea = root.bounds.SurfaceArea();
+        cost += BvhNodeSahCost(root);
+
+        sahCost = (rootArea > 0.0f) ? cost / rootArea : 0.0f;
+    }
+}
+
+
+//==================================================================================
+// QUERIES
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:   a common traversal for queries which test nodes and
+//         primitives by the same volume
+//         (TTest must have: bool operator()(const Rect3d&) const)
+//---------------------------------------------------------
+template <class TTest>
+inline uint32_t BvhQuery(const Bvh& bvh, const TTest& test, uint32_t* outIndices, const uint32_t maxCount)
+{
+    assert((outIndices != nullptr) || (maxCount == 0));
+
+    if (bvh.IsEmpty())
+        return 0;
+
+    uint32_t stack[Bvh::MAX_DEPTH];
+    int      sp      = 0;
+    uint32_t nodeIdx = 0;
+    uint32_t found   = 0;
+
+    for (;;)
+    {
+        const BvhNode& node = bvh.nodes[nodeIdx];
+
+        if (test(node.bounds))
+        {
+            if (!node.IsLeaf())
+            {
+                // go into the left child, visit the right one later
+                assert(sp < Bvh::MAX_DEPTH);
+                stack[sp++] = node.leftOrFirst + 1;
+                nodeIdx     = node.leftOrFirst;
+                continue;
+            }
+
+            for (uint32_t i = node.leftOrFirst; i < node.leftOrFirst + node.count; ++i)
+            {
+                if (!test(bvh.primBounds[i]))
+                    continue;
+
+                if (found < maxCount)
+                    outIndices[found] = bvh.primIndices[i];
+                ++found;
+            }
+        }
+
+        if (sp == 0)
+            break;
+
+        nodeIdx = stack[--sp];
+    }
+
+    return found;
+}
+
+//---------------------------------------------------------
+// Desc:   volume tests for BvhQuery
+//---------------------------------------------------------
+struct BvhTestRect
+{
+    Rect3d rect;
+    inline bool operator()(const Rect3d& bounds) const { return OverlapRect3d(bounds, rect); }
+};
+
+struct BvhTestPoint
+{
+    Vec3 point;
+    inline bool operator()(const Rect3d& bounds) const { return bounds.PointInRect(point); }
+};
+
+struct BvhTestRay
+{
+    Ray ray;
+
+    // the same NaN-safe slab test as QueryRayPacket() uses: an axis-parallel
+    // ray which starts on a face of the bounds touches them
+    inline bool operator()(const Rect3d& bounds) const
+    {
+        float tNear;
+        return RayIntersectRect3d(ray, bounds, tNear);
+    }
+};
+
+//---------------------------------------------------------
+// Desc:   find primitives which bounds overlap the input rect
+//---------------------------------------------------------
+inline uint32_t Bvh::QueryRect(const Rect3d& rect, uint32_t* outIndices, const uint32_t maxCount) const
+{
+    BvhTestRect test;
+    test.rect = rect;
+
+    return BvhQuery(*this, test, outIndices, maxCount);
+}
+
+//---------------------------------------------------------
+// Desc:   find primitives which bounds contain the input point
+//---------------------------------------------------------
+inline uint32_t Bvh::QueryPoint(const Vec3& point, uint32_t* outIndices, const uint32_t maxCount) const
+{
+    BvhTestPoint test;
+    test.point = point;
+
+    return BvhQuery(*this, test, outIndices, maxCount);
+}
+
+//---------------------------------------------------------
+// Desc:   find primitives which bounds are hit by the ray
+// Args:   - origin: ray origin
+//         - dir:    ray direction (not necessarily normalized)
+//         - tMax:   max distance along the ray in units of the direction length
+//---------------------------------------------------------
+inline uint32_t Bvh::QueryRay(
+    const Vec3& origin,
+    const Vec3& dir,
+    const float tMax,
+    uint32_t* outIndices,
+    const uint32_t maxCount) const
+{
+    BvhTestRay test;
+    test.ray = Ray(origin, dir, 0.0f, tMax);
+
+    return BvhQuery(*this, test, outIndices, maxCount);
+}
+
+//---------------------------------------------------------
+// Desc:   find primitives which bounds are hit by rays of the packet;
+//         each node is tested only by rays which hit its parent,
+//         so divergent rays are dropped as early as possible
+// Args:   - packet:     4 or 8 rays
+//         - activeMask: rays of the packet to trace
+//         - outIndices: indices of found primitives
+//         - outMasks:   rays which hit each found primitive (may be nullptr)
+//         - maxCount:   size of the output buffers
+//---------------------------------------------------------
+template <int N>
+inline uint32_t Bvh::QueryRayPacket(
+    const RayPacket<N>& packet,
+    const uint32_t activeMask,
+    uint32_t* outIndices,
+    uint32_t* outMasks,
+    const uint32_t maxCount) const
+{
+    assert((outIndices != nullptr) || (maxCount == 0));
+
+    if (IsEmpty() || activeMask == 0)
+        return 0;
+
+    struct StackItem
+    {
+        uint32_t nodeIdx;
+        uint32_t raysMask;
+    };
+
+    alignas(32) float tNear[N];
+    StackItem         stack[MAX_DEPTH];
+    int               sp    = 0;
+    uint32_t          found = 0;
+
+    stack[sp].nodeIdx  = 0;
+    stack[sp].raysMask = activeMask;
+    ++sp;
+
+    while (sp > 0)
+    {
+        --sp;
+        const BvhNode& node     = nodes[stack[sp].nodeIdx];
+        const uint32_t raysMask = RayPacketIntersectRect3d(packet, node.bounds, stack[sp].raysMask, tNear);
+
+        if (raysMask == 0)
+            continue;
+
+        if (!node.IsLeaf())
+        {
+            // the left child is visited first
+            assert(sp + 2 <= MAX_DEPTH);
+            stack[sp].nodeIdx    = node.leftOrFirst + 1;
+            stack[sp].raysMask   = raysMask;
+            stack[sp+1].nodeIdx  = node.leftOrFirst;
+            stack[sp+1].raysMask = raysMask;
+            sp += 2;
+            continue;
+        }
+
+        for (uint32_t i = node.leftOrFirst; i < node.leftOrFirst + node.count; ++i)
+        {
+            const uint32_t primMask = RayPacketIntersectRect3d(packet, primBounds[i], raysMask, tNear);
+
+            if (primMask == 0)
+                continue;
+
+            if (found < maxCount)
+            {
+                outIndices[found] = primIndices[i];
+
+                if (outMasks)
+                    outMasks[found] = primMask;
+            }
+            ++found;
+        }
+    }
+
+    return found;
+}
+
+//---------------------------------------------------------
+// Desc:   find primitives which bounds are (at least partially) inside
+//         the frustum; plane masks are passed from parents to children,
+//         so subtrees completely inside the frustum are not tested at all
+//---------------------------------------------------------
+inline uint32_t Bvh::QueryFrustum(const Frustum& frustum, uint32_t* outIndices, const uint32_t maxCount) const
+{
+    assert((outIndices != nullptr) || (maxCount == 0));
+
+    if (IsEmpty())
+        return 0;
+
+    struct StackItem
+    {
+        uint32_t nodeIdx;
+        uint32_t planesMask;
+    };
+
+    StackItem stack[MAX_DEPTH];
+    int       sp              = 0;
+    uint32_t  nodeIdx         = 0;
+    uint32_t  planesMask      = Frustum::ALL_PLANES_MASK;
+    int       lastRejectPlane = -1;
+    uint32_t  found           = 0;
+
+    for (;;)
+    {
+        const BvhNode& node = nodes[nodeIdx];
+        uint32_t childMask  = 0;
+
+        if (frustum.ClassifyRect(node.bounds, planesMask, childMask, lastRejectPlane) != Frustum::CULL_OUTSIDE)
+        {
+            if (!node.IsLeaf())
+            {
+                assert(sp < MAX_DEPTH);
+                stack[sp].nodeIdx    = node.leftOrFirst + 1;
+                stack[sp].planesMask = childMask;
+                ++sp;
+
+                nodeIdx    = node.leftOrFirst;
+                planesMask = childMask;
+                continue;
+            }
+
+            for (uint32_t i = node.leftOrFirst; i < node.leftOrFirst + node.count; ++i)
+            {
+                uint32_t primMask = 0;
+
+                if (frustum.ClassifyRect(primBounds[i], childMask, primMask, lastRejectPlane) == Frustum::CULL_OUTSIDE)
+                    continue;
+
+                if (found < maxCount)
+                    outIndices[found] = primIndices[i];
+                ++found;
+            }
+        }
+
+        if (sp == 0)
+            break;
+
+        --sp;
+        nodeIdx    = stack[sp].nodeIdx;
+        planesMask = stack[sp].planesMask;
+    }
+
+    return found;
+}
@@ -0,0 +1,356 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: bvh_linear_build.h
+    Desc:     linear BVH (LBVH) build for fully dynamic sets of primitives
+              which are rebuilt every frame (particles, debris, etc.)
+
+              1. centroids (Rect3d::MidPoint) are encoded into 30-bit
+                 Morton codes relative to bounds of all the centroids;
+              2. primitives are sorted by the codes (parallel radix sort);
+              3. the hierarchy is emitted as in "Maximizing Parallelism in
+                 the Construction of BVHs, Octrees, and k-d Trees" (Karras):
+                 each inner node is computed independently from the sorted
+                 codes, duplicate codes are resolved by indices;
+              4. bounds are computed bottom-up: the second thread which
+                 arrives at a node computes its bounds and goes up
+
+              Each leaf has a single primitive. The tree quality is lower
+              than with the SAH build, but the build is much faster.
+
+              Children of the inner node i are emitted as a pair at [2 + 2*i]
+              of temp nodes; then the nodes are compacted into the Bvh in
+              depth-first order (so Bvh::Refit works on the result)
+
+    Created:  17.10.2026 by DimaSkup
+\**********************************************************************************/
+#pragma once
+
+#include <geometry/bvh.h>
+#include <math/morton.h>
+#include <threading/task_pool.h>
+#include <threading/parallel_radix_sort.h>
+#include <atomic>
+#include <vector>
+
+
+//---------------------------------------------------------
+// Desc:   a builder which keeps its temp buffers between builds,
+//         so per-frame rebuilds of the same size allocate nothing
+//---------------------------------------------------------
+class BvhLinearBuilder
+{
+public:
+    static constexpr uint32_t GRAIN_SIZE = 1 << 13;
+
+    //-----------------------------------------------------
+    // public data
+    //-----------------------------------------------------
+    std::vector<uint32_t> codes;             // sorted Morton codes
+    std::vector<uint32_t> tmpCodes;
+    std::vector<uint32_t> tmpIndices;
+    std::vector<uint32_t> parents;           // inner node index of a parent of each node slot
+    std::vector<uint32_t> leafSlots;         // node slot of each leaf
+    std::vector<uint32_t> innerSlots;        // node slot of each inner node
+    std::vector<BvhNode>  nodes;             // emitted nodes (before compaction)
+
+    std::atomic<uint32_t>* visits     = nullptr;   // per inner node: how many children are done
+    uint32_t               maxVisits  = 0;
+
+    //-----------------------------------------------------
+    // constructors, destructor
+    //-----------------------------------------------------
+    BvhLinearBuilder() {}
+    ~BvhLinearBuilder() { delete[] visits; }
+
+    BvhLinearBuilder(const BvhLinearBuilder&) = delete;
+    BvhLinearBuilder& operator = (const BvhLinearBuilder&) = delete;
+
+    //-----------------------------------------------------
+    // methods
+    //-----------------------------------------------------
+    void Build(TaskPool& pool, const Rect3d* prims, const uint32_t numPrims, Bvh& outBvh);
+
+    //-----------------------------------------------------
+    // internal
+    //-----------------------------------------------------
+    void ComputeCodes(TaskPool& pool, const Rect3d* prims, const uint32_t numPrims, Bvh& bvh);
+    void EmitInnerNode(const uint32_t idx, const uint32_t numPrims);
+    void ComputeBounds(const uint32_t leafIdx, Bvh& bvh);
+    int  Delta(const int i, const int j, const int numPrims) const;
+};
+
+
+//==================================================================================
+// INLINE METHODS
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:   length of the common prefix of codes i and j (-1 if j is out of range);
+//         equal codes are made unique by appending the indices
+//---------------------------------------------------------
+inline int BvhLinearBuilder::Delta(const int i, const int j, const int numPrims) const
+{
+    if (j < 0 || j >= numPrims)
+        return -1;
+
+    const uint32_t ci = codes[i];
+    const uint32_t cj = codes[j];
+
+    if (ci == cj)
+        return 32 + CountLeadingZeros32((uint32_t)i ^ (uint32_t)j);
+
+    return CountLeadingZeros32(ci ^ cj);
+}
+
+//---------------------------------------------------------
+// Desc:   compute Morton codes of centroids and sort primitives by them
+//---------------------------------------------------------
+inline void BvhLinearBuilder::ComputeCodes(TaskPool& pool, const Rect3d* prims, const uint32_t numPrims, Bvh& bvh)
+{
+    // bounds of centroids
+    const uint32_t      numChunks = (numPrims + GRAIN_SIZE - 1) / GRAIN_SIZE;
+    std::vector<Rect3d> chunkBounds(numChunks);
+
+    pool.ParallelFor(numPrims, GRAIN_SIZE, [&](const uint32_t begin, const uint32_t end)
+    {
+        Rect3d bounds = BvhEmptyRect();
+
+        for (uint32_t i = begin; i < end; ++i)
+            bounds.Union(prims[i].MidPoint());
+
+        chunkBounds[begin / GRAIN_SIZE] = bounds;
+    });
+
+    Rect3d centroidBounds = BvhEmptyRect();
+
+    for (const Rect3d& bounds : chunkBounds)
+        centroidBounds.Union(bounds);
+
+    const Vec3 minP  = centroidBounds.MinPoint();
+    const Vec3 size  = centroidBounds.Size();
+    const Vec3 scale((size.x > 0) ? 1024.0f / size.x : 0.0f,
+                     (size.y > 0) ? 1024.0f / size.y : 0.0f,
+                     (size.z > 0) ? 1024.0f / size.z : 0.0f);
+
+    // codes
+    pool.ParallelFor(numPrims, GRAIN_SIZE, [&](const uint32_t begin, const uint32_t end)
+    {
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            codes[i]           = MortonEncodePoint(prims[i].MidPoint(), minP, scale);
+            bvh.primIndices[i] = i;
+        }
+    });
+
+    ParallelRadixSort(pool, codes.data(), bvh.primIndices, tmpCodes.data(), tmpIndices.data(), numPrims, 30);
+}
+
+//---------------------------------------------------------
+// Desc:   find the range of primitives covered by the inner node idx
+//         and its split position, and write its pair of children
+//---------------------------------------------------------
+inline void BvhLinearBuilder::EmitInnerNode(const uint32_t idx, const uint32_t numPrims)
+{
+    const int i = (int)idx;
+    const int n = (int)numPrims;
+
+    // direction of the range (+1 or -1)
+    const int d        = (Delta(i, i + 1, n) - Delta(i, i - 1, n) >= 0) ? 1 : -1;
+    const int deltaMin = Delta(i, i - d, n);
+
+    // upper bound of the range length
+    int lMax = 2;
+    while (Delta(i, i + lMax * d, n) > deltaMin)
+        lMax *= 2;
+
+    // exact length by binary search
+    int l = 0;
+    for (int t = lMax / 2; t >= 1; t /= 2)
+    {
+        if (Delta(i, i + (l + t) * d, n) > deltaMin)
+            l += t;
+    }
+
+    const int j         = i + l * d;
+    const int deltaNode = Delta(i, j, n);
+
+    // split position by binary search
+    int s = 0;
+    int t = l;
+
+    do
+    {
+        t = (t + 1) >> 1;
+
+        if (Delta(i, i + (s + t) * d, n) > deltaNode)
+            s += t;
+    }
+    while (t > 1);
+
+    const int      gamma    = i + s * d + ((d < 0) ? -1 : 0);
+    const int      rangeMin = (i < j) ? i : j;
+    const int      rangeMax = (i < j) ? j : i;
+    const uint32_t base     = 2 + 2 * idx;
+
+    BvhNode& left  = nodes[base];
+    BvhNode& right = nodes[base + 1];
+
+    if (rangeMin == gamma)
+    {
+        left.leftOrFirst = gamma;
+        left.count       = 1;
+        leafSlots[gamma] = base;
+    }
+    else
+    {
+        left.leftOrFirst  = 2 + 2 * gamma;
+        left.count        = 0;
+        innerSlots[gamma] = base;
+    }
+
+    if (rangeMax == gamma + 1)
+    {
+        right.leftOrFirst    = gamma + 1;
+        right.count          = 1;
+        leafSlots[gamma + 1] = base + 1;
+    }
+    else
+    {
+        right.leftOrFirst     = 2 + 2 * (gamma + 1);
+        right.count           = 0;
+        innerSlots[gamma + 1] = base + 1;
+    }
+
+    parents[base]     = idx;
+    parents[base + 1] = idx;
+}
+
+//---------------------------------------------------------
+// Desc:   set bounds of a leaf and go up while this thread is
+//         the second one which arrives at a parent node
+//---------------------------------------------------------
+inline void BvhLinearBuilder::ComputeBounds(const uint32_t leafIdx, Bvh& bvh)
+{
+    uint32_t slot = leafSlots[leafIdx];
+    nodes[slot].bounds = bvh.primBounds[leafIdx];
+
+    for (;;)
+    {
+        const uint32_t parent = parents[slot];
+
+        // the first child to arrive stops; acq_rel makes its bounds visible to the second one
+        if (visits[parent].fetch_add(1, std::memory_order_acq_rel) == 0)
+            return;
+
+        BvhNode& node = nodes[innerSlots[parent]];
+
+        node.bounds = nodes[2 + 2 * parent].bounds;
+        node.bounds.Union(nodes[3 + 2 * parent].bounds);
+
+        if (parent == 0)
+            return;
+
+        slot = innerSlots[parent];
+    }
+}
+
+//---------------------------------------------------------
+// Desc:   build the LBVH
+// Args:   - pool:     a pool to execute tasks
+//         - prims:    bounds of primitives
+//         - numPrims: number of primitives
+//         - outBvh:   the result (its memory is reused if it is enough)
+//---------------------------------------------------------
+inline void BvhLinearBuilder::Build(TaskPool& pool, const Rect3d* prims, const uint32_t numPrims, Bvh& outBvh)
+{
+    assert((prims != nullptr) || (numPrims == 0));
+
+    outBvh.Allocate(numPrims);
+
+    if (numPrims == 0)
+        return;
+
+    if (codes.size() < numPrims)
+    {
+        codes.resize(numPrims);
+        tmpCodes.resize(numPrims);
+        tmpIndices.resize(numPrims);
+        parents.resize(2 * numPrims);
+        leafSlots.resize(numPrims);
+        innerSlots.resize(numPrims);
+        nodes.resize(2 * numPrims);
+    }
+
+    if (maxVisits < numPrims)
+    {
+        delete[] visits;
+        visits    = new std::atomic<uint32_t>[numPrims];
+        maxVisits = numPrims;
+    }
+
+    ComputeCodes(pool, prims, numPrims, outBvh);
+
+    pool.ParallelFor(numPrims, GRAIN_SIZE, [&](const uint32_t begin, const uint32_t end)
+    {
+        for (uint32_t i = begin; i < end; ++i)
+            outBvh.primBounds[i] = prims[outBvh.primIndices[i]];
+    });
+
+    // a single primitive: the root is a leaf
+    if (numPrims == 1)
+    {
+        outBvh.nodes[0].bounds      = outBvh.primBounds[0];
+        outBvh.nodes[0].leftOrFirst = 0;
+        outBvh.nodes[0].count       = 1;
+        outBvh.numNodes             = 2;
+        outBvh.buildSahCost         = outBvh.ComputeSahCost();
+        outBvh.sahCost              = outBvh.buildSahCost;
+        return;
+    }
+
+    // the root
+    nodes[0].leftOrFirst = 2;
+    nodes[0].count       = 0;
+    innerSlots[0]        = 0;
+
+    const uint32_t numInner = numPrims - 1;
+
+    pool.ParallelFor(numInner, GRAIN_SIZE, [&](const uint32_t begin, const uint32_t end)
+    {
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            EmitInnerNode(i, numPrims);
+            visits[i].store(0, std::memory_order_relaxed);
+        }
+    });
+
+    pool.ParallelFor(numPrims, GRAIN_SIZE, [&](const uint32_t begin, const uint32_t end)
+    {
+        for (uint32_t i = begin; i < end; ++i)
+            ComputeBounds(i, outBvh);
+    });
+
+    // children pairs go after their parents
+    outBvh.numNodes = 2;
+    BvhCompactNodes(nodes.data(), 0, outBvh, 0);
+
+    outBvh.buildSahCost = outBvh.ComputeSahCost();
+    outBvh.sahCost      = outBvh.buildSahCost;
+}
+
+//---------------------------------------------------------
+// Desc:   build the LBVH with a temp builder (see BvhLinearBuilder::Build)
+//---------------------------------------------------------
+inline void BvhBuildLinear(TaskPool& pool, const Rect3d* prims, const uint32_t numPrims, Bvh& outBvh)
+{
+    BvhLinearBuilder builder;
+    builder.Build(pool, prims, numPrims, outBvh);
+}
@@ -0,0 +1,299 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: bvh_parallel_build.h
+    Desc:     parallel binned SAH build of Bvh on a work-stealing task pool
+
+              - big nodes (near the root) are split using parallel binning
+                and parallel (stable) partitioning of primitives;
+              - subtrees are built as separate tasks;
+              - each subtree owns a fixed range of nodes (a subtree over N
+                primitives needs at most 2*(N-1) nodes under its root), so
+                tasks don't share any counter; at the end the nodes are
+                compacted in the same order as the single-threaded build
+                allocates them
+
+              The result doesn't depend on the number of threads and is
+              exactly the same as the result of Bvh::Build()
+
+    Created:  17.10.2026 by DimaSkup
+\**********************************************************************************/
+#pragma once
+
+#include <geometry/bvh.h>
+#include <threading/task_pool.h>
+#include <vector>
+
+
+//---------------------------------------------------------
+// Desc:   data of a parallel build
+//---------------------------------------------------------
+struct BvhParallelBuilder
+{
+    // nodes with at least so many primitives are split by parallel binning/partitioning
+    static constexpr uint32_t PARALLEL_SPLIT_SIZE = 1 << 16;
+
+    // subtrees with at least so many primitives are built by separate tasks
+    static constexpr uint32_t SUBTREE_TASK_SIZE   = 1 << 11;
+
+    // number of primitives processed by one task of a parallel loop
+    static constexpr uint32_t GRAIN_SIZE          = 1 << 14;
+
+    TaskPool*     pool;
+    Bvh*          bvh;
+    BvhNode*      nodes;            // sparse nodes (by subtree ranges)
+    const Rect3d* prims;
+    const Vec3*   centroids;
+    uint32_t*     scratch;
+    uint32_t      maxLeafSize;
+
+    //---------------------------------------------------------
+    // Desc:   BvhComputeBounds() by chunks in parallel
+    //---------------------------------------------------------
+    void ComputeBounds(const uint32_t* indices, const uint32_t count, Rect3d& outBounds, Rect3d& outCentroidBounds)
+    {
+        if (count < PARALLEL_SPLIT_SIZE)
+        {
+            BvhComputeBounds(prims, centroids, indices, count, outBounds, outCentroidBounds);
+            return;
+        }
+
+        const uint32_t      numChunks = (count + GRAIN_SIZE - 1) / GRAIN_SIZE;
+        std::vector<Rect3d> bounds(numChunks);
+        std::vector<Rect3d> centroidBounds(numChunks);
+
+        pool->ParallelFor(count, GRAIN_SIZE, [&](const uint32_t begin, const uint32_t end)
+        {
+            const uint32_t chunk = begin / GRAIN_SIZE;
+            BvhComputeBounds(prims, centroids, indices + begin, end - begin, bounds[chunk], centroidBounds[chunk]);
+        });
+
+        // min/max are exact, so the result doesn't depend on the chunks
+        outBounds         = BvhEmptyRect();
+        outCentroidBounds = BvhEmptyRect();
+
+        for (uint32_t i = 0; i < numChunks; ++i)
+        {
+            outBounds.Union(bounds[i]);
+            outCentroidBounds.Union(centroidBounds[i]);
+        }
+    }
+
+    //---------------------------------------------------------
+    // Desc:   BvhFillBins() by chunks in parallel
+    //---------------------------------------------------------
+    void FillBins(const uint32_t* indices, const uint32_t count, const BvhBinMapping& mapping, BvhBins& outBins)
+    {
+        if (count < PARALLEL_SPLIT_SIZE)
+        {
+            BvhFillBins(prims, centroids, indices, count, mapping, outBins);
+            return;
+        }
+
+        const uint32_t       numChunks = (count + GRAIN_SIZE - 1) / GRAIN_SIZE;
+        std::vector<BvhBins> bins(numChunks);
+
+        pool->ParallelFor(count, GRAIN_SIZE, [&](const uint32_t begin, const uint32_t end)
+        {
+            BvhFillBins(prims, centroids, indices + begin, end - begin, mapping, bins[begin / GRAIN_SIZE]);
+        });
+
+        for (const BvhBins& chunkBins : bins)
+            outBins.Merge(chunkBins);
+    }
+
+    //---------------------------------------------------------
+    // Desc:   BvhPartition() in parallel: count left primitives of each chunk,
+    //         then each chunk scatters its indices into the scratch buffer
+    //         by the prefix sums (the same order as the serial partition)
+    //---------------------------------------------------------
+    uint32_t Partition(
+        uint32_t* indices,
+        uint32_t* scratchRange,
+        const uint32_t count,
+        const BvhBinMapping& mapping,
+        const BvhSplit& split)
+    {
+        if (count < PARALLEL_SPLIT_SIZE)
+            return BvhPartition(centroids, indices, count, mapping, split, scratchRange);
+
+        const uint32_t        numChunks = (count + GRAIN_SIZE - 1) / GRAIN_SIZE;
+        std::vector<uint32_t> leftOffsets(numChunks + 1, 0);
+
+        pool->ParallelFor(count, GRAIN_SIZE, [&](const uint32_t begin, const uint32_t end)
+        {
+            uint32_t numLeft = 0;
+
+            for (uint32_t i = begin; i < end; ++i)
+                numLeft += (mapping.GetBin(centroids[indices[i]], split.axis) <= split.bin);
+
+            leftOffsets[begin / GRAIN_SIZE + 1] = numLeft;
+        });
+
+        for (uint32_t i = 0; i < numChunks; ++i)
+            leftOffsets[i + 1] += leftOffsets[i];
+
+        const uint32_t totalLeft = leftOffsets[numChunks];
+
+        pool->ParallelFor(count, GRAIN_SIZE, [&](const uint32_t begin, const uint32_t end)
+        {
+            uint32_t left  = leftOffsets[begin / GRAIN_SIZE];
+            uint32_t right = totalLeft + (begin - left);
+
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                const uint32_t idx = indices[i];
+
+                if (mapping.GetBin(centroids[idx], split.axis) <= split.bin)
+                    scratchRange[left++] = idx;
+                else
+                    scratchRange[right++] = idx;
+            }
+        });
+
+        pool->ParallelFor(count, GRAIN_SIZE, [&](const uint32_t begin, const uint32_t end)
+        {
+            memcpy(indices + begin, scratchRange + begin, (end - begin) * sizeof(uint32_t));
+        });
+
+        return totalLeft;
+    }
+
+    //---------------------------------------------------------
+    // Desc:   the same as BvhBuilder::Subdivide but children of the node
+    //         are placed at nodeBase, and their subtrees use ranges after it
+    //---------------------------------------------------------
+    void Subdivide(
+        const uint32_t nodeIdx,
+        const uint32_t first,
+        const uint32_t count,
+        const int depth,
+        const uint32_t nodeBase)
+    {
+        BvhNode&  node    = nodes[nodeIdx];
+        uint32_t* indices = bvh->primIndices + first;
+
+        Rect3d centroidBounds;
+        ComputeBounds(indices, count, node.bounds, centroidBounds);
+
+        node.leftOrFirst = first;
+        node.count       = count;
+
+        if (count <= maxLeafSize || depth >= Bvh::MAX_DEPTH - 1)
+            return;
+
+        BvhBinMapping mapping;
+        mapping.Init(centroidBounds);
+
+        BvhBins bins;
+        FillBins(indices, count, mapping, bins);
+
+        const BvhSplit split   = BvhFindBestSplit(bins, mapping);
+        uint32_t       numLeft = count / 2;
+
+        if (split.axis >= 0)
+            numLeft = Partition(indices, scratch + first, count, mapping, split);
+
+        node.leftOrFirst = nodeBase;
+        node.count       = 0;
+
+        const uint32_t numRight  = count - numLeft;
+        const uint32_t leftBase  = nodeBase + 2;
+        const uint32_t rightBase = leftBase + 2 * (numLeft - 1);
+
+        if (count < SUBTREE_TASK_SIZE)
+        {
+            Subdivide(nodeBase,     first,           numLeft,  depth + 1, leftBase);
+            Subdivide(nodeBase + 1, first + numLeft, numRight, depth + 1, rightBase);
+            return;
+        }
+
+        // the left subtree may be stolen by another thread, the right one is built here
+        TaskCounter counter;
+
+        pool->Submit(counter, [this, nodeBase, first, numLeft, depth, leftBase]()
+        {
+            Subdivide(nodeBase, first, numLeft, depth + 1, leftBase);
+        });
+
+        Subdivide(nodeBase + 1, first + numLeft, numRight, depth + 1, rightBase);
+
+        pool->Wait(counter);
+    }
+};
+
+//---------------------------------------------------------
+// Desc:   build the BVH using binned SAH on multiple threads
+// Args:   - pool:        a pool to execute tasks
+//         - prims:       bounds of primitives
+//         - numPrims:    number of primitives
+//         - outBvh:      the result (the same as outBvh.Build() gives)
+//         - maxLeafSize: a node with fewer primitives isn't split
+//---------------------------------------------------------
+inline void BvhBuildParallel(
+    TaskPool& pool,
+    const Rect3d* prims,
+    const uint32_t numPrims,
+    Bvh& outBvh,
+    const uint32_t maxLeafSize = Bvh::MAX_LEAF_SIZE)
+{
+    assert((prims != nullptr) || (numPrims == 0));
+    assert(maxLeafSize > 0);
+
+    constexpr uint32_t grainSize = BvhParallelBuilder::GRAIN_SIZE;
+
+    outBvh.Allocate(numPrims);
+
+    if (numPrims == 0)
+        return;
+
+    Vec3*     centroids = new Vec3[numPrims];
+    uint32_t* scratch   = new uint32_t[numPrims];
+    BvhNode*  nodes     = (BvhNode*)AlignedAlloc(outBvh.maxNodes * sizeof(BvhNode), Bvh::NODES_ALIGN);
+
+    assert(nodes != nullptr && "can't allocate memory for BVH nodes");
+
+    pool.ParallelFor(numPrims, grainSize, [&](const uint32_t begin, const uint32_t end)
+    {
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            centroids[i]          = prims[i].MidPoint();
+            outBvh.primIndices[i] = i;
+        }
+    });
+
+    BvhParallelBuilder builder;
+    builder.pool        = &pool;
+    builder.bvh         = &outBvh;
+    builder.nodes       = nodes;
+    builder.prims       = prims;
+    builder.centroids   = centroids;
+    builder.scratch     = scratch;
+    builder.maxLeafSize = maxLeafSize;
+
+    // root is at 0, 1 is unused, subtree of the root uses [2, 2*numPrims)
+    builder.Subdivide(0, 0, numPrims, 0, 2);
+
+    outBvh.numNodes = 2;
+    BvhCompactNodes(nodes, 0, outBvh, 0);
+
+    pool.ParallelFor(numPrims, grainSize, [&](const uint32_t begin, const uint32_t end)
+    {
+        for (uint32_t i = begin; i < end; ++i)
+            outBvh.primBounds[i] = prims[outBvh.primIndices[i]];
+    });
+
+    outBvh.buildSahCost = outBvh.ComputeSahCost();
+    outBvh.sahCost      = outBvh.buildSahCost;
+
+    AlignedFree(nodes);
+    delete[] centroids;
+    delete[] scratch;
+}
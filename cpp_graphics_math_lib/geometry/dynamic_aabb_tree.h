@@ -0,0 +1,690 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: dynamic_aabb_tree.h
+    Desc:     dynamic AABB tree (as in Box2D / Bullet) for objects which are
+              created, moved and destroyed all the time (broadphase)
+
+              - each object is a leaf referred by an integer proxy id;
+              - leaves store "fat" bounds: real bounds expanded by a margin
+                and extended along the displacement, so small motions don't
+                change the tree at all;
+              - a new leaf goes down to the sibling which gives the smallest
+                increase of the surface area, then ancestors are rebalanced
+                by rotations (the height of subtrees differs by at most 1);
+              - nodes live in a pool with a free list: the pool only grows
+                (x2) when it is full, so the steady state allocates nothing
+
+    Created:  17.10.2026 by DimaSkup
+\**********************************************************************************/
+#pragma once
+
+#include <geometry/frustum.h>
+#include <geometry/rect_3d.h>
+#include <geometry/rect_3d_functions.h>
+#include <geometry/intersection_tests.h>
+#include <math/vec3.h>
+#include <assert.h>
+#include <stdint.h>
+
+
+//==================================================================================
+// dynamic AABB tree node
+//==================================================================================
+struct DynamicAabbNode
+{
+    Rect3d   bounds;                 // fat bounds for leaves
+
+    // parent of a node in the tree; the next node in the free list for free nodes
+    int32_t  parentOrNext = -1;
+
+    int32_t  child1       = -1;      // -1 for leaves
+    int32_t  child2       = -1;
+    int32_t  height       = -1;      // 0 for leaves, -1 for free nodes
+    uint32_t userData     = 0;       // leaves only
+
+    inline bool IsLeaf() const { return child1 == -1; }
+};
+
+
+//==================================================================================
+// dynamic AABB tree
+//==================================================================================
+class DynamicAabbTree
+{
+public:
+    static constexpr int32_t NULL_NODE               = -1;
+    static constexpr int     MAX_DEPTH               = 64;     // it is also the size of a traversal stack
+    static constexpr int32_t INIT_CAPACITY           = 16;
+    static constexpr float   DEFAULT_MARGIN          = 0.1f;
+    static constexpr float   DISPLACEMENT_MULTIPLIER = 4.0f;   // how far ahead of the motion fat bounds are extended
+
+    //-----------------------------------------------------
+    // public data
+    //-----------------------------------------------------
+    DynamicAabbNode* nodes      = nullptr;
+    int32_t          numNodes   = 0;           // number of used nodes (leaves + inner)
+    int32_t          maxNodes   = 0;           // capacity of the pool
+    int32_t          freeList   = NULL_NODE;
+    int32_t          root       = NULL_NODE;
+    int32_t          numProxies = 0;
+    float            margin     = DEFAULT_MARGIN;
+
+    //-----------------------------------------------------
+    // constructors, destructor
+    //-----------------------------------------------------
+    explicit DynamicAabbTree(const float fatMargin = DEFAULT_MARGIN, const int32_t capacity = INIT_CAPACITY);
+    ~DynamicAabbTree() { delete[] nodes; }
+
+    DynamicAabbTree(const DynamicAabbTree&) = delete;
+    DynamicAabbTree& operator = (const DynamicAabbTree&) = delete;
+
+    //-----------------------------------------------------
+    // proxies
+    //-----------------------------------------------------
+    int32_t Insert(const Rect3d& bounds, const uint32_t userData = 0);
+    void    Remove(const int32_t proxyId);
+    bool    Move  (const int32_t proxyId, const Rect3d& bounds, const Vec3& displacement = Vec3(0, 0, 0));
+
+    void    Clear();
+    void    Reserve(const int32_t capacity);
+
+    inline const Rect3d& GetFatBounds(const int32_t proxyId) const
+    {
+        assert(proxyId >= 0 && proxyId < maxNodes && nodes[proxyId].IsLeaf());
+        return nodes[proxyId].bounds;
+    }
+
+    inline uint32_t GetUserData(const int32_t proxyId) const
+    {
+        assert(proxyId >= 0 && proxyId < maxNodes && nodes[proxyId].IsLeaf());
+        return nodes[proxyId].userData;
+    }
+
+    inline int32_t GetHeight() const { return (root == NULL_NODE) ? 0 : nodes[root].height; }
+    inline bool    IsEmpty()   const { return root == NULL_NODE; }
+
+    //-----------------------------------------------------
+    // queries: all of them return the number of found proxies (by fat bounds),
+    // only the first maxCount of them are written into outProxies
+    //-----------------------------------------------------
+    int32_t QueryRect   (const Rect3d& rect,     int32_t* outProxies, const int32_t maxCount) const;
+    int32_t QueryFrustum(const Frustum& frustum, int32_t* outProxies, const int32_t maxCount) const;
+
+    //-----------------------------------------------------
+    // internal
+    //-----------------------------------------------------
+    int32_t AllocateNode();
+    void    FreeNode(const int32_t nodeIdx);
+    void    InsertLeaf(const int32_t leaf);
+    void    RemoveLeaf(const int32_t leaf);
+    void    FixUpwards(int32_t nodeIdx);
+    int32_t Balance(const int32_t nodeIdx);
+    Rect3d  ComputeFatBounds(const Rect3d& bounds, const Vec3& displacement) const;
+};
+
+
+//==================================================================================
+// INLINE METHODS: pool of nodes
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:   create an empty tree
+// Args:   - fatMargin: bounds of leaves are expanded by this value
+//         - capacity:  initial number of nodes in the pool
+//                      (a tree of N proxies uses 2*N-1 nodes)
+//---------------------------------------------------------
+inline DynamicAabbTree::DynamicAabbTree(const float fatMargin, const int32_t capacity)
+{
+    assert(fatMargin >= 0.0f);
+
+    margin = fatMargin;
+    Reserve((capacity > 0) ? capacity : INIT_CAPACITY);
+}
+
+//---------------------------------------------------------
+// Desc:   grow the pool of nodes (if necessary) so it can hold the given
+//         number of nodes; new nodes are linked into the free list
+//---------------------------------------------------------
+inline void DynamicAabbTree::Reserve(const int32_t capacity)
+{
+    if (capacity <= maxNodes)
+        return;
+
+    DynamicAabbNode* newNodes = new DynamicAabbNode[capacity];
+
+    for (int32_t i = 0; i < maxNodes; ++i)
+        newNodes[i] = nodes[i];
+
+    delete[] nodes;
+
+    // new nodes go in front of the free list
+    for (int32_t i = maxNodes; i < capacity - 1; ++i)
+    {
+        newNodes[i].parentOrNext = i + 1;
+        newNodes[i].height       = -1;
+    }
+
+    newNodes[capacity - 1].parentOrNext = freeList;
+    newNodes[capacity - 1].height       = -1;
+
+    freeList = maxNodes;
+    nodes    = newNodes;
+    maxNodes = capacity;
+}
+
+//---------------------------------------------------------
+// Desc:   remove all the proxies (the memory is kept)
+//---------------------------------------------------------
+inline void DynamicAabbTree::Clear()
+{
+    for (int32_t i = 0; i < maxNodes; ++i)
+    {
+        nodes[i].parentOrNext = (i + 1 < maxNodes) ? i + 1 : NULL_NODE;
+        nodes[i].child1       = NULL_NODE;
+        nodes[i].child2       = NULL_NODE;
+        nodes[i].height       = -1;
+    }
+
+    freeList   = (maxNodes > 0) ? 0 : NULL_NODE;
+    root       = NULL_NODE;
+    numNodes   = 0;
+    numProxies = 0;
+}
+
+//---------------------------------------------------------
+// Desc:   take a node from the free list (the pool grows x2 if it is empty)
+// Ret:    index of the node (pointers to nodes are invalidated by a growth)
+//---------------------------------------------------------
+inline int32_t DynamicAabbTree::AllocateNode()
+{
+    if (freeList == NULL_NODE)
+        Reserve((maxNodes > 0) ? maxNodes * 2 : INIT_CAPACITY);
+
+    const int32_t    nodeIdx = freeList;
+    DynamicAabbNode& node    = nodes[nodeIdx];
+
+    freeList          = node.parentOrNext;
+    node.parentOrNext = NULL_NODE;
+    node.child1       = NULL_NODE;
+    node.child2       = NULL_NODE;
+    node.height       = 0;
+    node.userData     = 0;
+    ++numNodes;
+
+    return nodeIdx;
+}
+
+//---------------------------------------------------------
+// Desc:   return a node into the free list
+//---------------------------------------------------------
+inline void DynamicAabbTree::FreeNode(const int32_t nodeIdx)
+{
+    assert(nodeIdx >= 0 && nodeIdx < maxNodes);
+    assert(numNodes > 0);
+
+    nodes[nodeIdx].parentOrNext = freeList;
+    nodes[nodeIdx].child1       = NULL_NODE;
+    nodes[nodeIdx].child2       = NULL_NODE;
+    nodes[nodeIdx].height       = -1;
+
+    freeList = nodeIdx;
+    --numNodes;
+}
+
+
+//==================================================================================
+// INLINE METHODS: proxies
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:   expand bounds by the margin and extend them along the displacement
+//---------------------------------------------------------
+inline Rect3d DynamicAabbTree::ComputeFatBounds(const Rect3d& bounds, const Vec3& displacement) const
+{
+    Rect3d fat = bounds;
+    fat.Expand(margin);
+
+    const float dx = displacement.x * DISPLACEMENT_MULTIPLIER;
+    const float dy = displacement.y * DISPLACEMENT_MULTIPLIER;
+    const float dz = displacement.z * DISPLACEMENT_MULTIPLIER;
+
+    if (dx < 0) fat.x0 += dx; else fat.x1 += dx;
+    if (dy < 0) fat.y0 += dy; else fat.y1 += dy;
+    if (dz < 0) fat.z0 += dz; else fat.z1 += dz;
+
+    return fat;
+}
+
+//---------------------------------------------------------
+// Desc:   add a new object into the tree
+// Args:   - bounds:   real bounds of the object
+//         - userData: any value to store along with the proxy
+// Ret:    proxy id (it is stable until the proxy is removed)
+//---------------------------------------------------------
+inline int32_t DynamicAabbTree::Insert(const Rect3d& bounds, const uint32_t userData)
+{
+    const int32_t proxyId = AllocateNode();
+
+    nodes[proxyId].bounds   = ComputeFatBounds(bounds, Vec3(0, 0, 0));
+    nodes[proxyId].userData = userData;
+    nodes[proxyId].height   = 0;
+
+    InsertLeaf(proxyId);
+    ++numProxies;
+
+    return proxyId;
+}
+
+//---------------------------------------------------------
+// Desc:   remove the object from the tree (the proxy id becomes invalid)
+//---------------------------------------------------------
+inline void DynamicAabbTree::Remove(const int32_t proxyId)
+{
+    assert(proxyId >= 0 && proxyId < maxNodes && nodes[proxyId].IsLeaf() && nodes[proxyId].height == 0);
+
+    RemoveLeaf(proxyId);
+    FreeNode(proxyId);
+    --numProxies;
+}
+
+//---------------------------------------------------------
+// Desc:   update bounds of a moved object; the leaf is reinserted only if
+//         the new bounds go out of its fat bounds (or if the fat bounds
+//         became too big, e.g. after a fast motion is stopped)
+// Args:   - proxyId:      the proxy to move
+//         - bounds:       new real bounds of the object
+//         - displacement: expected motion of the object for the next update
+// Ret:    true if the leaf is reinserted (its fat bounds changed)
+//---------------------------------------------------------
+inline bool DynamicAabbTree::Move(const int32_t proxyId, const Rect3d& bounds, const Vec3& displacement)
+{
+    assert(proxyId >= 0 && proxyId < maxNodes && nodes[proxyId].IsLeaf() && nodes[proxyId].height == 0);
+
+    const Rect3d  fatBounds  = ComputeFatBounds(bounds, displacement);
+    const Rect3d& treeBounds = nodes[proxyId].bounds;
+
+    if (ContainsRect3d(treeBounds, bounds))
+    {
+        Rect3d hugeBounds = fatBounds;
+        hugeBounds.Expand(4.0f * margin);
+
+        if (ContainsRect3d(hugeBounds, treeBounds))
+            return false;
+    }
+
+    RemoveLeaf(proxyId);
+    nodes[proxyId].bounds = fatBounds;
+    InsertLeaf(proxyId);
+
+    return true;
+}
+
+
+//==================================================================================
+// INLINE METHODS: tree structure
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:   surface area of the union of two rects
+//---------------------------------------------------------
+inline float DynamicAabbUnionArea(const Rect3d& a, const Rect3d& b)
+{
+    Rect3d tmp = a;
+    tmp.Union(b);
+    return tmp.SurfaceArea();
+}
+
+//---------------------------------------------------------
+// Desc:   put the leaf into the tree: go down choosing a child with the
+//         smaller cost (increase of the area of all ancestors included)
+//         until creating a new parent for the leaf is cheaper
+//---------------------------------------------------------
+inline void DynamicAabbTree::InsertLeaf(const int32_t leaf)
+{
+    if (root == NULL_NODE)
+    {
+        root = leaf;
+        nodes[leaf].parentOrNext = NULL_NODE;
+        return;
+    }
+
+    // find the best sibling
+    const Rect3d leafBounds = nodes[leaf].bounds;
+    int32_t      idx        = root;
+
+    while (!nodes[idx].IsLeaf())
+    {
+        const DynamicAabbNode& node   = nodes[idx];
+        const int32_t          child1 = node.child1;
+        const int32_t          child2 = node.child2;
+
+        const float area         = node.bounds.SurfaceArea();
+        const float combinedArea = DynamicAabbUnionArea(node.bounds, leafBounds);
+
+        // cost of creating a new parent for this node and the leaf
+        const float cost = 2.0f * combinedArea;
+
+        // minimum cost of pushing the leaf further down the tree
+        const float inheritanceCost = 2.0f * (combinedArea - area);
+
+        float cost1 = DynamicAabbUnionArea(nodes[child1].bounds, leafBounds) + inheritanceCost;
+        float cost2 = DynamicAabbUnionArea(nodes[child2].bounds, leafBounds) + inheritanceCost;
+
+        if (!nodes[child1].IsLeaf())
+            cost1 -= nodes[child1].bounds.SurfaceArea();
+
+        if (!nodes[child2].IsLeaf())
+            cost2 -= nodes[child2].bounds.SurfaceArea();
+
+        if (cost < cost1 && cost < cost2)
+            break;
+
+        idx = (cost1 < cost2) ? child1 : child2;
+    }
+
+    const int32_t sibling   = idx;
+    const int32_t oldParent = nodes[sibling].parentOrNext;
+    const int32_t newParent = AllocateNode();
+
+    // create a new parent for the sibling and the leaf
+    DynamicAabbNode& parent = nodes[newParent];
+    parent.parentOrNext = oldParent;
+    parent.bounds       = leafBounds;
+    parent.bounds.Union(nodes[sibling].bounds);
+    parent.height       = nodes[sibling].height + 1;
+    parent.child1       = sibling;
+    parent.child2       = leaf;
+
+    nodes[sibling].parentOrNext = newParent;
+    nodes[leaf].parentOrNext    = newParent;
+
+    if (oldParent == NULL_NODE)
+        root = newParent;
+    else if (nodes[oldParent].child1 == sibling)
+        nodes[oldParent].child1 = newParent;
+    else
+        nodes[oldParent].child2 = newParent;
+
+    FixUpwards(nodes[leaf].parentOrNext);
+}
+
+//---------------------------------------------------------
+// Desc:   take the leaf out of the tree: its sibling replaces its parent
+//         (the leaf node itself isn't freed)
+//---------------------------------------------------------
+inline void DynamicAabbTree::RemoveLeaf(const int32_t leaf)
+{
+    if (leaf == root)
+    {
+        root = NULL_NODE;
+        return;
+    }
+
+    const int32_t parent      = nodes[leaf].parentOrNext;
+    const int32_t grandParent = nodes[parent].parentOrNext;
+    const int32_t sibling     = (nodes[parent].child1 == leaf) ? nodes[parent].child2 : nodes[parent].child1;
+
+    nodes[sibling].parentOrNext = grandParent;
+    FreeNode(parent);
+
+    if (grandParent == NULL_NODE)
+    {
+        root = sibling;
+        return;
+    }
+
+    if (nodes[grandParent].child1 == parent)
+        nodes[grandParent].child1 = sibling;
+    else
+        nodes[grandParent].child2 = sibling;
+
+    FixUpwards(grandParent);
+}
+
+//---------------------------------------------------------
+// Desc:   rebalance and refit all the nodes from the input one up to the root
+//---------------------------------------------------------
+inline void DynamicAabbTree::FixUpwards(int32_t nodeIdx)
+{
+    while (nodeIdx != NULL_NODE)
+    {
+        nodeIdx = Balance(nodeIdx);
+
+        DynamicAabbNode&       node   = nodes[nodeIdx];
+        const DynamicAabbNode& child1 = nodes[node.child1];
+        const DynamicAabbNode& child2 = nodes[node.child2];
+
+        node.height = 1 + ((child1.height > child2.height) ? child1.height : child2.height);
+        node.bounds = child1.bounds;
+        node.bounds.Union(child2.bounds);
+
+        nodeIdx = node.parentOrNext;
+    }
+}
+
+//---------------------------------------------------------
+// Desc:   if heights of children of node A differ by more than 1, rotate
+//         the higher child up (it takes the place of A, and A takes the
+//         place of the lower grandchild), written as node(child1, child2):
+//
+//             A(B, C(F, G))   =>   C(A(B, G), F)     (if F is higher than G)
+//
+// Ret:    index of the node which is now at the place of A
+//---------------------------------------------------------
+inline int32_t DynamicAabbTree::Balance(const int32_t iA)
+{
+    assert(iA != NULL_NODE);
+
+    DynamicAabbNode& A = nodes[iA];
+
+    if (A.IsLeaf() || A.height < 2)
+        return iA;
+
+    const int32_t    iB = A.child1;
+    const int32_t    iC = A.child2;
+    DynamicAabbNode& B  = nodes[iB];
+    DynamicAabbNode& C  = nodes[iC];
+
+    const int32_t balance = C.height - B.height;
+
+    // rotate C up
+    if (balance > 1)
+    {
+        const int32_t    iF = C.child1;
+        const int32_t    iG = C.child2;
+        DynamicAabbNode& F  = nodes[iF];
+        DynamicAabbNode& G  = nodes[iG];
+
+        // swap A and C
+        C.child1       = iA;
+        C.parentOrNext = A.parentOrNext;
+        A.parentOrNext = iC;
+
+        if (C.parentOrNext == NULL_NODE)
+            root = iC;
+        else if (nodes[C.parentOrNext].child1 == iA)
+            nodes[C.parentOrNext].child1 = iC;
+        else
+            nodes[C.parentOrNext].child2 = iC;
+
+        // the higher grandchild stays under C, the lower one goes under A
+        const bool       fIsHigher = (F.height > G.height);
+        const int32_t    iHigh     = (fIsHigher) ? iF : iG;
+        const int32_t    iLow      = (fIsHigher) ? iG : iF;
+        DynamicAabbNode& high      = nodes[iHigh];
+        DynamicAabbNode& low       = nodes[iLow];
+
+        C.child2         = iHigh;
+        A.child2         = iLow;
+        low.parentOrNext = iA;
+
+        A.bounds = B.bounds;
+        A.bounds.Union(low.bounds);
+        C.bounds = A.bounds;
+        C.bounds.Union(high.bounds);
+
+        A.height = 1 + ((B.height > low.height) ? B.height : low.height);
+        C.height = 1 + ((A.height > high.height) ? A.height : high.height);
+
+        return iC;
+    }
+
+    // rotate B up
+    if (balance < -1)
+    {
+        const int32_t    iD = B.child1;
+        const int32_t    iE = B.child2;
+        DynamicAabbNode& D  = nodes[iD];
+        DynamicAabbNode& E  = nodes[iE];
+
+        // swap A and B
+        B.child1       = iA;
+        B.parentOrNext = A.parentOrNext;
+        A.parentOrNext = iB;
+
+        if (B.parentOrNext == NULL_NODE)
+            root = iB;
+        else if (nodes[B.parentOrNext].child1 == iA)
+            nodes[B.parentOrNext].child1 = iB;
+        else
+            nodes[B.parentOrNext].child2 = iB;
+
+        // the higher grandchild stays under B, the lower one goes under A
+        const bool       dIsHigher = (D.height > E.height);
+        const int32_t    iHigh     = (dIsHigher) ? iD : iE;
+        const int32_t    iLow      = (dIsHigher) ? iE : iD;
+        DynamicAabbNode& high      = nodes[iHigh];
+        DynamicAabbNode& low       = nodes[iLow];
+
+        B.child2         = iHigh;
+        A.child1         = iLow;
+        low.parentOrNext = iA;
+
+        A.bounds = C.bounds;
+        A.bounds.Union(low.bounds);
+        B.bounds = A.bounds;
+        B.bounds.Union(high.bounds);
+
+        A.height = 1 + ((C.height > low.height) ? C.height : low.height);
+        B.height = 1 + ((A.height > high.height) ? A.height : high.height);
+
+        return iB;
+    }
+
+    return iA;
+}
+
+
+//==================================================================================
+// INLINE METHODS: queries
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:   find proxies which fat bounds overlap the input rect
+//---------------------------------------------------------
+inline int32_t DynamicAabbTree::QueryRect(const Rect3d& rect, int32_t* outProxies, const int32_t maxCount) const
+{
+    assert((outProxies != nullptr) || (maxCount == 0));
+
+    if (root == NULL_NODE)
+        return 0;
+
+    int32_t stack[MAX_DEPTH];
+    int     sp      = 0;
+    int32_t nodeIdx = root;
+    int32_t found   = 0;
+
+    for (;;)
+    {
+        const DynamicAabbNode& node = nodes[nodeIdx];
+
+        if (OverlapRect3d(node.bounds, rect))
+        {
+            if (!node.IsLeaf())
+            {
+                assert(sp < MAX_DEPTH);
+                stack[sp++] = node.child2;
+                nodeIdx     = node.child1;
+                continue;
+            }
+
+            if (found < maxCount)
+                outProxies[found] = nodeIdx;
+            ++found;
+        }
+
+        if (sp == 0)
+            break;
+
+        nodeIdx = stack[--sp];
+    }
+
+    return found;
+}
+
+//---------------------------------------------------------
+// Desc:   find proxies which fat bounds are (at least partially) inside
+//         the frustum; plane masks are passed from parents to children
+//---------------------------------------------------------
+inline int32_t DynamicAabbTree::QueryFrustum(const Frustum& frustum, int32_t* outProxies, const int32_t maxCount) const
+{
+    assert((outProxies != nullptr) || (maxCount == 0));
+
+    if (root == NULL_NODE)
+        return 0;
+
+    struct StackItem
+    {
+        int32_t  nodeIdx;
+        uint32_t planesMask;
+    };
+
+    StackItem stack[MAX_DEPTH];
+    int       sp              = 0;
+    int32_t   nodeIdx         = root;
+    uint32_t  planesMask      = Frustum::ALL_PLANES_MASK;
+    int       lastRejectPlane = -1;
+    int32_t   found           = 0;
+
+    for (;;)
+    {
+        const DynamicAabbNode& node = nodes[nodeIdx];
+        uint32_t childMask = 0;
+
+        if (frustum.ClassifyRect(node.bounds, planesMask, childMask, lastRejectPlane) != Frustum::CULL_OUTSIDE)
+        {
+            if (!node.IsLeaf())
+            {
+                assert(sp < MAX_DEPTH);
+                stack[sp].nodeIdx    = node.child2;
+                stack[sp].planesMask = childMask;
+                ++sp;
+
+                nodeIdx    = node.child1;
+                planesMask = childMask;
+                continue;
+            }
+
+            if (found < maxCount)
+                outProxies[found] = nodeIdx;
+            ++found;
+        }
+
+        if (sp == 0)
+            break;
+
+        nodeIdx    = stack[sp - 1].nodeIdx;
+        planesMask = stack[sp - 1].planesMask;
+        --sp;
+    }
+
+    return found;
+}
@@ -32,6 +32,11 @@
 #include <geometry/rect_3d.h>
 #include <geometry/sphere.h>
 #include <geometry/intersection_tests.h>
+#include <math/simd.h>
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
 
 class Frustum
 {
@@ -44,6 +49,30 @@ public:
     };
 
 
+    // result of batch culling of volumes
+    enum eCullResult
+    {
+        CULL_OUTSIDE = 0,
+        CULL_INTERSECT,
+        CULL_INSIDE
+    };
+
+    // planes indices (the order of planes in the SoA form and in plane masks)
+    enum ePlaneIndices
+    {
+        PLANE_IDX_LEFT = 0,
+        PLANE_IDX_RIGHT,
+        PLANE_IDX_TOP,
+        PLANE_IDX_BOTTOM,
+        PLANE_IDX_NEAR,
+        PLANE_IDX_FAR,
+        NUM_PLANES
+    };
+
+    // a mask with a bit for each plane: a volume must be tested against all of them
+    static constexpr uint32_t ALL_PLANES_MASK = (1 << NUM_PLANES) - 1;
+
+
 #if 0
     ///////////////////////////////////////////////////////////
 
@@ -96,6 +125,40 @@ public:
     bool TestPoint(const Vec3& point) const;
     bool TestRect(const Rect3d& rect) const;
     bool TestSphere(const Sphere& sphere) const;
+
+    //-----------------------------------------------------
+    // batch culling
+    //-----------------------------------------------------
+    void GetPlanesSoA(float outPlanes[4][6]) const;
+
+    void CullSpheres(const Sphere* spheres, const size_t n, uint64_t* visibleBits) const;
+
+    void CullSpheres(
+        const float* centersX,
+        const float* centersY,
+        const float* centersZ,
+        const float* radii,
+        const size_t n,
+        uint64_t* visibleBits) const;
+
+    void CullRects(const Rect3d* rects, const size_t n, uint8_t* result) const;
+
+    //-----------------------------------------------------
+    // hierarchical culling (with plane masks and plane coherency)
+    //-----------------------------------------------------
+    const Plane3d& GetPlane(const int index) const;
+
+    int ClassifyRect(
+        const Rect3d& rect,
+        const uint32_t inPlanesMask,
+        uint32_t& outPlanesMask,
+        int& lastRejectPlane) const;
+
+    int ClassifySphere(
+        const Sphere& sphere,
+        const uint32_t inPlanesMask,
+        uint32_t& outPlanesMask,
+        int& lastRejectPlane) const;
 };
 
 
@@ -306,13 +369,14 @@ inline void Frustum::CreateFromProjMatrix(
 //---------------------------------------------------------
 // Desc:   transform the current frustum with input matrix and 
 //         store the result into outFrustum
+// NOTE:   the input matrix must be affine (world/view transformation)
 //---------------------------------------------------------
 inline void Frustum::Transform(Frustum& outFrustum, const Matrix& mat) const
 {
     // compute an inverse transpose matrix for proper
     // transformation of the plane's normal vector
     Matrix invMT;
-    MatrixInverse(invMT, nullptr, mat);
+    MatrixInverseAffine(invMT, nullptr, mat);
     MatrixTranspose(invMT);
 
     outFrustum = *this;
@@ -344,11 +408,11 @@ inline bool Frustum::TestPoint(const Vec3& p) const
 //---------------------------------------------------------
 inline bool Frustum::TestRect(const Rect3d& rect) const
 {
-    return  (PlaneClassify(rect, leftPlane)     != PLANE_BACK) ||
-            (PlaneClassify(rect, rightPlane)    != PLANE_BACK) ||
-            (PlaneClassify(rect, topPlane)      != PLANE_BACK) ||
-            (PlaneClassify(rect, bottomPlane)   != PLANE_BACK) ||
-            (PlaneClassify(rect, nearPlane)     != PLANE_BACK) ||
+    return  (PlaneClassify(rect, leftPlane)     != PLANE_BACK) &&
+            (PlaneClassify(rect, rightPlane)    != PLANE_BACK) &&
+            (PlaneClassify(rect, topPlane)      != PLANE_BACK) &&
+            (PlaneClassify(rect, bottomPlane)   != PLANE_BACK) &&
+            (PlaneClassify(rect, nearPlane)     != PLANE_BACK) &&
             (PlaneClassify(rect, farPlane)      != PLANE_BACK);
 }
 
@@ -385,6 +449,821 @@ inline bool Frustum::TestSphere(const Sphere& sphere) const
 #endif
 }
 
+
+//==================================================================================
+// BATCH CULLING
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:   get the planes in SoA form (transposed), so they can be
+//         broadcasted into SIMD registers plane by plane
+// Args:   - outPlanes: [0] - normal.x, [1] - normal.y, [2] - normal.z, [3] - distance
+//                      of left, right, top, bottom, near, far planes
+//---------------------------------------------------------
+inline void Frustum::GetPlanesSoA(float outPlanes[4][6]) const
+{
+    for (int i = 0; i < NUM_PLANES; ++i)
+    {
+        const Plane3d& plane = GetPlane(i);
+
+        outPlanes[0][i] = plane.normal.x;
+        outPlanes[1][i] = plane.normal.y;
+        outPlanes[2][i] = plane.normal.z;
+        outPlanes[3][i] = plane.distance;
+    }
+}
+
+//---------------------------------------------------------
+// Desc:   frustum planes prepared for SIMD culling kernels; build it once
+//         per frame (or when the camera moves) and reuse for all the batches:
+//         - planes are stored in SoA form padded up to 8 lanes, so one plane
+//           can be broadcasted into a register, or all 6 planes can be
+//           processed at once against a single volume;
+//         - padding planes are zeros: any volume is in front of them;
+//         - sign masks of normal components (all ones if n > 0) select
+//           the positive/negative vertex of a box without branches;
+//         - absolute normals give a projected radius of a box extents
+//---------------------------------------------------------
+struct alignas(32) PackedFrustum
+{
+    static constexpr int NUM_LANES = 8;
+
+    //-----------------------------------------------------
+    // public data
+    //-----------------------------------------------------
+    float    nx[NUM_LANES];
+    float    ny[NUM_LANES];
+    float    nz[NUM_LANES];
+    float    d[NUM_LANES];
+
+    float    absNx[NUM_LANES];
+    float    absNy[NUM_LANES];
+    float    absNz[NUM_LANES];
+
+    uint32_t signX[NUM_LANES];
+    uint32_t signY[NUM_LANES];
+    uint32_t signZ[NUM_LANES];
+
+    //-----------------------------------------------------
+    // creators
+    //-----------------------------------------------------
+    PackedFrustum();
+    explicit PackedFrustum(const Frustum& frustum);
+
+    void Build(const Frustum& frustum);
+    void CreateFromProjMatrix(const Matrix& proj, const bool normalizePlanes = false);
+
+    //-----------------------------------------------------
+    // test operations (all the planes at once)
+    //-----------------------------------------------------
+    bool TestSphere(const Sphere& sphere) const;
+    int  ClassifyRect(const Rect3d& rect) const;
+
+    //-----------------------------------------------------
+    // batch culling
+    //-----------------------------------------------------
+    void CullSpheres(const Sphere* spheres, const size_t n, uint64_t* visibleBits) const;
+
+    void CullSpheres(
+        const float* centersX,
+        const float* centersY,
+        const float* centersZ,
+        const float* radii,
+        const size_t n,
+        uint64_t* visibleBits) const;
+
+    void CullRects(const Rect3d* rects, const size_t n, uint8_t* result) const;
+};
+
+static_assert(Frustum::NUM_PLANES <= PackedFrustum::NUM_LANES, "frustum planes must fit into 8 lanes");
+
+//---------------------------------------------------------
+// Desc:   default constructor: all the planes are zeros (nothing is culled)
+//---------------------------------------------------------
+inline PackedFrustum::PackedFrustum()
+{
+    memset(this, 0, sizeof(PackedFrustum));
+}
+
+//---------------------------------------------------------
+
+inline PackedFrustum::PackedFrustum(const Frustum& frustum)
+{
+    Build(frustum);
+}
+
+//---------------------------------------------------------
+// Desc:   pack planes of the input frustum
+//---------------------------------------------------------
+inline void PackedFrustum::Build(const Frustum& frustum)
+{
+    for (int i = 0; i < Frustum::NUM_PLANES; ++i)
+    {
+        const Plane3d& plane = frustum.GetPlane(i);
+
+        nx[i]    = plane.normal.x;
+        ny[i]    = plane.normal.y;
+        nz[i]    = plane.normal.z;
+        d[i]     = plane.distance;
+
+        absNx[i] = fabsf(plane.normal.x);
+        absNy[i] = fabsf(plane.normal.y);
+        absNz[i] = fabsf(plane.normal.z);
+
+        signX[i] = (plane.normal.x > 0.0f) ? 0xFFFFFFFF : 0;
+        signY[i] = (plane.normal.y > 0.0f) ? 0xFFFFFFFF : 0;
+        signZ[i] = (plane.normal.z > 0.0f) ? 0xFFFFFFFF : 0;
+    }
+
+    // padding lanes
+    for (int i = Frustum::NUM_PLANES; i < NUM_LANES; ++i)
+    {
+        nx[i]    = ny[i]    = nz[i]    = d[i] = 0.0f;
+        absNx[i] = absNy[i] = absNz[i] = 0.0f;
+        signX[i] = signY[i] = signZ[i] = 0;
+    }
+}
+
+//---------------------------------------------------------
+// Desc:   extract planes from the input projection (or view-projection)
+//         matrix and pack them
+//---------------------------------------------------------
+inline void PackedFrustum::CreateFromProjMatrix(const Matrix& proj, const bool normalizePlanes)
+{
+    Frustum frustum;
+    frustum.CreateFromProjMatrix(proj, normalizePlanes);
+    Build(frustum);
+}
+
+//---------------------------------------------------------
+// Desc:   test a sphere against all the planes at once
+//         (the same test as Frustum::TestSphere)
+//---------------------------------------------------------
+inline bool PackedFrustum::TestSphere(const Sphere& sphere) const
+{
+#if defined(MATH_SIMD_AVX2)
+
+    const __m256 x    = _mm256_set1_ps(sphere.center.x);
+    const __m256 y    = _mm256_set1_ps(sphere.center.y);
+    const __m256 z    = _mm256_set1_ps(sphere.center.z);
+    const __m256 negR = _mm256_set1_ps(-sphere.radius);
+
+    const __m256 dist = SimdMulAdd(z, _mm256_load_ps(nz),
+                        SimdMulAdd(y, _mm256_load_ps(ny),
+                        SimdMulAdd(x, _mm256_load_ps(nx), _mm256_load_ps(d))));
+
+    return SimdMoveMask(SimdCmpGe(dist, negR)) == 0xFF;
+
+#elif defined(MATH_SIMD_SSE2)
+
+    const __m128 x    = _mm_set1_ps(sphere.center.x);
+    const __m128 y    = _mm_set1_ps(sphere.center.y);
+    const __m128 z    = _mm_set1_ps(sphere.center.z);
+    const __m128 negR = _mm_set1_ps(-sphere.radius);
+
+    const __m128 dist0 = SimdMulAdd(z, _mm_load_ps(nz),
+                         SimdMulAdd(y, _mm_load_ps(ny),
+                         SimdMulAdd(x, _mm_load_ps(nx), _mm_load_ps(d))));
+
+    const __m128 dist1 = SimdMulAdd(z, _mm_load_ps(nz + 4),
+                         SimdMulAdd(y, _mm_load_ps(ny + 4),
+                         SimdMulAdd(x, _mm_load_ps(nx + 4), _mm_load_ps(d + 4))));
+
+    const __m128 inside = SimdAnd(SimdCmpGe(dist0, negR), SimdCmpGe(dist1, negR));
+    return SimdMoveMask(inside) == 0xF;
+
+#else
+
+    for (int p = 0; p < Frustum::NUM_PLANES; ++p)
+    {
+        const float dist = nx[p]*sphere.center.x + ny[p]*sphere.center.y + nz[p]*sphere.center.z + d[p];
+
+        if (dist < -sphere.radius)
+            return false;
+    }
+    return true;
+
+#endif
+}
+
+//---------------------------------------------------------
+// Desc:   classify a box against all the planes at once: the box is
+//         represented by its center and extents, the projected radius
+//         of extents onto a plane normal is |n| dot extents
+// Ret:    CULL_OUTSIDE, CULL_INTERSECT or CULL_INSIDE
+//---------------------------------------------------------
+inline int PackedFrustum::ClassifyRect(const Rect3d& rect) const
+{
+    const float cx = (rect.x0 + rect.x1) * 0.5f;
+    const float cy = (rect.y0 + rect.y1) * 0.5f;
+    const float cz = (rect.z0 + rect.z1) * 0.5f;
+    const float ex = (rect.x1 - rect.x0) * 0.5f;
+    const float ey = (rect.y1 - rect.y0) * 0.5f;
+    const float ez = (rect.z1 - rect.z0) * 0.5f;
+
+#if defined(MATH_SIMD_AVX2)
+
+    const __m256 dist = SimdMulAdd(_mm256_set1_ps(cz), _mm256_load_ps(nz),
+                        SimdMulAdd(_mm256_set1_ps(cy), _mm256_load_ps(ny),
+                        SimdMulAdd(_mm256_set1_ps(cx), _mm256_load_ps(nx), _mm256_load_ps(d))));
+
+    const __m256 radius = SimdMulAdd(_mm256_set1_ps(ez), _mm256_load_ps(absNz),
+                          SimdMulAdd(_mm256_set1_ps(ey), _mm256_load_ps(absNy),
+                          SimdMul(_mm256_set1_ps(ex), _mm256_load_ps(absNx))));
+
+    const __m256 zero      = _mm256_setzero_ps();
+    const int    outside   = SimdMoveMask(SimdCmpLt(SimdAdd(dist, radius), zero));
+    const int    intersect = SimdMoveMask(SimdCmpLt(SimdSub(dist, radius), zero));
+
+#elif defined(MATH_SIMD_SSE2)
+
+    int outside   = 0;
+    int intersect = 0;
+
+    for (int i = 0; i < NUM_LANES; i += 4)
+    {
+        const __m128 dist = SimdMulAdd(_mm_set1_ps(cz), _mm_load_ps(nz + i),
+                            SimdMulAdd(_mm_set1_ps(cy), _mm_load_ps(ny + i),
+                            SimdMulAdd(_mm_set1_ps(cx), _mm_load_ps(nx + i), _mm_load_ps(d + i))));
+
+        const __m128 radius = SimdMulAdd(_mm_set1_ps(ez), _mm_load_ps(absNz + i),
+                              SimdMulAdd(_mm_set1_ps(ey), _mm_load_ps(absNy + i),
+                              SimdMul(_mm_set1_ps(ex), _mm_load_ps(absNx + i))));
+
+        const __m128 zero = _mm_setzero_ps();
+        outside   |= SimdMoveMask(SimdCmpLt(SimdAdd(dist, radius), zero));
+        intersect |= SimdMoveMask(SimdCmpLt(SimdSub(dist, radius), zero));
+    }
+
+#else
+
+    int outside   = 0;
+    int intersect = 0;
+
+    for (int p = 0; p < Frustum::NUM_PLANES; ++p)
+    {
+        const float dist   = nx[p]*cx + ny[p]*cy + nz[p]*cz + d[p];
+        const float radius = absNx[p]*ex + absNy[p]*ey + absNz[p]*ez;
+
+        outside   |= (dist + radius < 0.0f);
+        intersect |= (dist - radius < 0.0f);
+    }
+
+#endif
+
+    if (outside)
+        return Frustum::CULL_OUTSIDE;
+
+    return (intersect) ? Frustum::CULL_INTERSECT : Frustum::CULL_INSIDE;
+}
+
+//---------------------------------------------------------
+// Desc:   sources of spheres for the common culling implementation:
+//         load 8, 4 or 1 sphere(s) starting from index i in SoA form
+//---------------------------------------------------------
+struct FrustumSpheresAoS
+{
+    // Sphere is 16 bytes: (radius, center.x, center.y, center.z)
+    const Sphere* spheres;
+
+#if defined(MATH_SIMD_SSE2)
+    inline void Load(const size_t i, __m128& x, __m128& y, __m128& z, __m128& r) const
+    {
+        r = _mm_loadu_ps(&spheres[i+0].radius);
+        x = _mm_loadu_ps(&spheres[i+1].radius);
+        y = _mm_loadu_ps(&spheres[i+2].radius);
+        z = _mm_loadu_ps(&spheres[i+3].radius);
+
+        _MM_TRANSPOSE4_PS(r, x, y, z);
+    }
+#endif
+
+#if defined(MATH_SIMD_AVX2)
+    inline void Load(const size_t i, __m256& x, __m256& y, __m256& z, __m256& r) const
+    {
+        __m128 xl, yl, zl, rl;
+        __m128 xh, yh, zh, rh;
+
+        Load(i,     xl, yl, zl, rl);
+        Load(i + 4, xh, yh, zh, rh);
+
+        x = _mm256_insertf128_ps(_mm256_castps128_ps256(xl), xh, 1);
+        y = _mm256_insertf128_ps(_mm256_castps128_ps256(yl), yh, 1);
+        z = _mm256_insertf128_ps(_mm256_castps128_ps256(zl), zh, 1);
+        r = _mm256_insertf128_ps(_mm256_castps128_ps256(rl), rh, 1);
+    }
+#endif
+
+    inline void Load(const size_t i, float& x, float& y, float& z, float& r) const
+    {
+        x = spheres[i].center.x;
+        y = spheres[i].center.y;
+        z = spheres[i].center.z;
+        r = spheres[i].radius;
+    }
+};
+
+static_assert(sizeof(Sphere) == 4*sizeof(float), "Sphere must be (radius, center) without padding");
+
+//---------------------------------------------------------
+
+struct FrustumSpheresSoA
+{
+    const float* x;
+    const float* y;
+    const float* z;
+    const float* r;
+
+#if defined(MATH_SIMD_SSE2)
+    inline void Load(const size_t i, __m128& outX, __m128& outY, __m128& outZ, __m128& outR) const
+    {
+        outX = _mm_loadu_ps(x + i);
+        outY = _mm_loadu_ps(y + i);
+        outZ = _mm_loadu_ps(z + i);
+        outR = _mm_loadu_ps(r + i);
+    }
+#endif
+
+#if defined(MATH_SIMD_AVX2)
+    inline void Load(const size_t i, __m256& outX, __m256& outY, __m256& outZ, __m256& outR) const
+    {
+        outX = _mm256_loadu_ps(x + i);
+        outY = _mm256_loadu_ps(y + i);
+        outZ = _mm256_loadu_ps(z + i);
+        outR = _mm256_loadu_ps(r + i);
+    }
+#endif
+
+    inline void Load(const size_t i, float& outX, float& outY, float& outZ, float& outR) const
+    {
+        outX = x[i];
+        outY = y[i];
+        outZ = z[i];
+        outR = r[i];
+    }
+};
+
+#if defined(MATH_SIMD_SSE2)
+//---------------------------------------------------------
+// Desc:   SIMD helper: test 4 (or 8) spheres in SoA form against 6 planes
+//         without branches (the same test as Frustum::TestSphere)
+// Ret:    a lane is all ones if the sphere is visible
+//---------------------------------------------------------
+template <class T>
+inline T FrustumSpheresVisibleSimd(const PackedFrustum& pf, const T x, const T y, const T z, const T r)
+{
+    T zero;
+    SimdSet1(0.0f, zero);
+
+    const T negR    = SimdSub(zero, r);
+    T       visible = SimdCmpGe(zero, zero);     // all ones
+
+    for (int p = 0; p < Frustum::NUM_PLANES; ++p)
+    {
+        T nx, ny, nz, d;
+        SimdSet1(pf.nx[p], nx);
+        SimdSet1(pf.ny[p], ny);
+        SimdSet1(pf.nz[p], nz);
+        SimdSet1(pf.d[p],  d);
+
+        const T dist   = SimdMulAdd(z, nz, SimdMulAdd(y, ny, SimdMulAdd(x, nx, d)));
+        const T inside = SimdCmpGe(dist, negR);
+
+        visible = SimdAnd(visible, inside);
+    }
+
+    return visible;
+}
+#endif
+
+//---------------------------------------------------------
+// Desc:   a common implementation of PackedFrustum::CullSpheres for AoS/SoA input;
+//         spheres are processed by groups of 64 (one output word), inside of
+//         a group by 8 (AVX2) or 4 (SSE) spheres per iteration
+//---------------------------------------------------------
+template <class TSource>
+inline void FrustumCullSpheres(
+    const PackedFrustum& pf,
+    const TSource& src,
+    const size_t n,
+    uint64_t* visibleBits)
+{
+    for (size_t base = 0; base < n; base += 64)
+    {
+        const size_t count = (n - base < 64) ? (n - base) : 64;
+        uint64_t     word  = 0;
+        size_t       j     = 0;
+
+#if defined(MATH_SIMD_AVX2)
+        for (; j + 8 <= count; j += 8)
+        {
+            __m256 x, y, z, r;
+            src.Load(base + j, x, y, z, r);
+
+            const int mask = SimdMoveMask(FrustumSpheresVisibleSimd(pf, x, y, z, r));
+            word |= (uint64_t)mask << j;
+        }
+#endif
+
+#if defined(MATH_SIMD_SSE2)
+        for (; j + 4 <= count; j += 4)
+        {
+            __m128 x, y, z, r;
+            src.Load(base + j, x, y, z, r);
+
+            const int mask = SimdMoveMask(FrustumSpheresVisibleSimd(pf, x, y, z, r));
+            word |= (uint64_t)mask << j;
+        }
+#endif
+
+        // the tail (or everything if there is no SIMD)
+        for (; j < count; ++j)
+        {
+            float x, y, z, r;
+            src.Load(base + j, x, y, z, r);
+
+            uint64_t visible = 1;
+
+            for (int p = 0; p < Frustum::NUM_PLANES; ++p)
+            {
+                const float dist = pf.nx[p]*x + pf.ny[p]*y + pf.nz[p]*z + pf.d[p];
+                visible &= (uint64_t)(dist >= -r);
+            }
+
+            word |= visible << j;
+        }
+
+        visibleBits[base / 64] = word;
+    }
+}
+
+//---------------------------------------------------------
+// Desc:   test an array of spheres against the frustum (like TestSphere)
+// Args:   - spheres:     input array of n spheres
+//         - n:           number of spheres
+//         - visibleBits: output bitmask of (n+63)/64 words: bit (i%64) of
+//                        word (i/64) is set if sphere i is visible;
+//                        unused bits of the last word are cleared
+//---------------------------------------------------------
+inline void PackedFrustum::CullSpheres(const Sphere* spheres, const size_t n, uint64_t* visibleBits) const
+{
+    assert((spheres != nullptr && visibleBits != nullptr) || (n == 0));
+
+    FrustumSpheresAoS src;
+    src.spheres = spheres;
+
+    FrustumCullSpheres(*this, src, n, visibleBits);
+}
+
+//---------------------------------------------------------
+// Desc:   the same as above but spheres are stored in SoA form
+// Args:   - centersX/Y/Z: arrays of sphere centers coords
+//         - radii:        array of sphere radii
+//---------------------------------------------------------
+inline void PackedFrustum::CullSpheres(
+    const float* centersX,
+    const float* centersY,
+    const float* centersZ,
+    const float* radii,
+    const size_t n,
+    uint64_t* visibleBits) const
+{
+    assert((centersX && centersY && centersZ && radii && visibleBits) || (n == 0));
+
+    FrustumSpheresSoA src;
+    src.x = centersX;
+    src.y = centersY;
+    src.z = centersZ;
+    src.r = radii;
+
+    FrustumCullSpheres(*this, src, n, visibleBits);
+}
+
+//---------------------------------------------------------
+// Desc:   classify a box in the same way as the SIMD kernel does
+//---------------------------------------------------------
+inline int FrustumClassifyRect(const PackedFrustum& pf, const Rect3d& rect)
+{
+    int outside   = 0;
+    int intersect = 0;
+
+    for (int p = 0; p < Frustum::NUM_PLANES; ++p)
+    {
+        // positive vertex (the furthest along the normal) and the negative one
+        const float px = pf.signX[p] ? rect.x1 : rect.x0;
+        const float py = pf.signY[p] ? rect.y1 : rect.y0;
+        const float pz = pf.signZ[p] ? rect.z1 : rect.z0;
+        const float nx = pf.signX[p] ? rect.x0 : rect.x1;
+        const float ny = pf.signY[p] ? rect.y0 : rect.y1;
+        const float nz = pf.signZ[p] ? rect.z0 : rect.z1;
+
+        const float dMax = pf.nx[p]*px + pf.ny[p]*py + pf.nz[p]*pz + pf.d[p];
+        const float dMin = pf.nx[p]*nx + pf.ny[p]*ny + pf.nz[p]*nz + pf.d[p];
+
+        outside   |= (dMax < 0.0f);
+        intersect |= (dMin < 0.0f);
+    }
+
+    // outside -> 0; intersect -> 1; inside -> 2
+    return (1 - outside) * (2 - intersect);
+}
+
+static_assert(sizeof(Rect3d) == 6*sizeof(float), "Rect3d must be (x0, x1, y0, y1, z0, z1) without padding");
+
+#if defined(MATH_SIMD_SSE2)
+//---------------------------------------------------------
+// Desc:   SIMD helper: load 4 Rect3d and transpose them into SoA registers
+//---------------------------------------------------------
+inline void LoadRect3dx4Simd(
+    const Rect3d* rects,
+    __m128& x0, __m128& x1,
+    __m128& y0, __m128& y1,
+    __m128& z0, __m128& z1)
+{
+    // each rect is (x0, x1, y0, y1, z0, z1)
+    x0 = _mm_loadu_ps(&rects[0].x0);
+    x1 = _mm_loadu_ps(&rects[1].x0);
+    y0 = _mm_loadu_ps(&rects[2].x0);
+    y1 = _mm_loadu_ps(&rects[3].x0);
+
+    _MM_TRANSPOSE4_PS(x0, x1, y0, y1);
+
+    // (z0, z1) pairs of rects 0,1 and 2,3
+    const __m128 z01 = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), (const __m64*)&rects[0].z0), (const __m64*)&rects[1].z0);
+    const __m128 z23 = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), (const __m64*)&rects[2].z0), (const __m64*)&rects[3].z0);
+
+    z0 = _mm_shuffle_ps(z01, z23, _MM_SHUFFLE(2,0,2,0));
+    z1 = _mm_shuffle_ps(z01, z23, _MM_SHUFFLE(3,1,3,1));
+}
+
+//---------------------------------------------------------
+// Desc:   SIMD helper: classify 4 (or 8) boxes in SoA form against 6 planes
+// Args:   - outOutside:   lane is all ones if the box is completely outside
+//         - outIntersect: lane is all ones if the box crosses any plane
+//---------------------------------------------------------
+template <class T>
+inline void FrustumRectsClassifySimd(
+    const PackedFrustum& pf,
+    const T x0, const T x1,
+    const T y0, const T y1,
+    const T z0, const T z1,
+    T& outOutside,
+    T& outIntersect)
+{
+    T zero;
+    SimdSet1(0.0f, zero);
+
+    T outside   = zero;
+    T intersect = zero;
+
+    for (int p = 0; p < Frustum::NUM_PLANES; ++p)
+    {
+        T sx, sy, sz;
+        SimdSet1Bits(pf.signX[p], sx);
+        SimdSet1Bits(pf.signY[p], sy);
+        SimdSet1Bits(pf.signZ[p], sz);
+
+        T nx, ny, nz, d;
+        SimdSet1(pf.nx[p], nx);
+        SimdSet1(pf.ny[p], ny);
+        SimdSet1(pf.nz[p], nz);
+        SimdSet1(pf.d[p],  d);
+
+        // positive and negative vertices
+        const T dMax = SimdMulAdd(SimdSelect(sz, z1, z0), nz,
+                       SimdMulAdd(SimdSelect(sy, y1, y0), ny,
+                       SimdMulAdd(SimdSelect(sx, x1, x0), nx, d)));
+
+        const T dMin = SimdMulAdd(SimdSelect(sz, z0, z1), nz,
+                       SimdMulAdd(SimdSelect(sy, y0, y1), ny,
+                       SimdMulAdd(SimdSelect(sx, x0, x1), nx, d)));
+
+        outside   = SimdOr(outside,   SimdCmpLt(dMax, zero));
+        intersect = SimdOr(intersect, SimdCmpLt(dMin, zero));
+    }
+
+    outOutside   = outside;
+    outIntersect = intersect;
+}
+#endif
+
+//---------------------------------------------------------
+// Desc:   convert lane masks of the SIMD kernel into per-box results
+//---------------------------------------------------------
+inline void FrustumStoreCullResults(const int outsideBits, const int intersectBits, const int count, uint8_t* result)
+{
+    for (int k = 0; k < count; ++k)
+    {
+        const int outside   = (outsideBits   >> k) & 1;
+        const int intersect = (intersectBits >> k) & 1;
+
+        result[k] = (uint8_t)((1 - outside) * (2 - intersect));
+    }
+}
+
+//---------------------------------------------------------
+// Desc:   classify an array of boxes against the frustum
+// Args:   - rects:  input array of n boxes
+//         - n:      number of boxes
+//         - result: output array of n values of eCullResult
+//                   (CULL_OUTSIDE, CULL_INTERSECT, CULL_INSIDE)
+//---------------------------------------------------------
+inline void PackedFrustum::CullRects(const Rect3d* rects, const size_t n, uint8_t* result) const
+{
+    assert((rects != nullptr && result != nullptr) || (n == 0));
+
+    size_t i = 0;
+
+#if defined(MATH_SIMD_AVX2)
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128 lo[6];
+        __m128 hi[6];
+        __m256 v[6];
+
+        LoadRect3dx4Simd(rects + i,     lo[0], lo[1], lo[2], lo[3], lo[4], lo[5]);
+        LoadRect3dx4Simd(rects + i + 4, hi[0], hi[1], hi[2], hi[3], hi[4], hi[5]);
+
+        for (int k = 0; k < 6; ++k)
+            v[k] = _mm256_insertf128_ps(_mm256_castps128_ps256(lo[k]), hi[k], 1);
+
+        __m256 outside, intersect;
+        FrustumRectsClassifySimd(*this, v[0], v[1], v[2], v[3], v[4], v[5], outside, intersect);
+
+        FrustumStoreCullResults(SimdMoveMask(outside), SimdMoveMask(intersect), 8, result + i);
+    }
+
+#endif
+
+#if defined(MATH_SIMD_SSE2)
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 x0, x1, y0, y1, z0, z1;
+        LoadRect3dx4Simd(rects + i, x0, x1, y0, y1, z0, z1);
+
+        __m128 outside, intersect;
+        FrustumRectsClassifySimd(*this, x0, x1, y0, y1, z0, z1, outside, intersect);
+
+        FrustumStoreCullResults(SimdMoveMask(outside), SimdMoveMask(intersect), 4, result + i);
+    }
+
+#endif
+
+    // the tail (or everything if there is no SIMD)
+    for (; i < n; ++i)
+        result[i] = (uint8_t)FrustumClassifyRect(*this, rects[i]);
+}
+
+
+//---------------------------------------------------------
+// Desc:   batch culling with planes of this frustum; if the same frustum
+//         is used for several batches, build a PackedFrustum once and
+//         call its methods directly
+//---------------------------------------------------------
+inline void Frustum::CullSpheres(const Sphere* spheres, const size_t n, uint64_t* visibleBits) const
+{
+    PackedFrustum(*this).CullSpheres(spheres, n, visibleBits);
+}
+
+//---------------------------------------------------------
+
+inline void Frustum::CullSpheres(
+    const float* centersX,
+    const float* centersY,
+    const float* centersZ,
+    const float* radii,
+    const size_t n,
+    uint64_t* visibleBits) const
+{
+    PackedFrustum(*this).CullSpheres(centersX, centersY, centersZ, radii, n, visibleBits);
+}
+
+//---------------------------------------------------------
+
+inline void Frustum::CullRects(const Rect3d* rects, const size_t n, uint8_t* result) const
+{
+    PackedFrustum(*this).CullRects(rects, n, result);
+}
+
+
+//==================================================================================
+// HIERARCHICAL CULLING
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:   get a plane by its index (see ePlaneIndices)
+//---------------------------------------------------------
+inline const Plane3d& Frustum::GetPlane(const int index) const
+{
+    assert(index >= 0 && index < NUM_PLANES);
+
+    static Plane3d Frustum::* const planes[NUM_PLANES] =
+    {
+        &Frustum::leftPlane,
+        &Frustum::rightPlane,
+        &Frustum::topPlane,
+        &Frustum::bottomPlane,
+        &Frustum::nearPlane,
+        &Frustum::farPlane
+    };
+
+    return this->*planes[index];
+}
+
+//---------------------------------------------------------
+// Desc:   a common implementation of ClassifyRect/ClassifySphere:
+//         - only planes from the input mask are tested;
+//         - the plane which rejected the volume last time is tested first;
+//         - the output mask has only planes which intersect the volume,
+//           so children of the volume don't need to test the others
+//---------------------------------------------------------
+template <class TVolume>
+inline int FrustumClassifyHierarchical(
+    const Frustum& frustum,
+    const TVolume& volume,
+    const uint32_t inPlanesMask,
+    uint32_t& outPlanesMask,
+    int& lastRejectPlane)
+{
+    outPlanesMask = 0;
+
+    // the parent is completely inside the frustum
+    if (inPlanesMask == 0)
+        return Frustum::CULL_INSIDE;
+
+    uint32_t mask = inPlanesMask;
+
+    // plane coherency: most likely the same plane rejects the volume again
+    if ((lastRejectPlane >= 0) && (lastRejectPlane < Frustum::NUM_PLANES) &&
+        (mask & (1 << lastRejectPlane)))
+    {
+        const int type = PlaneClassify(volume, frustum.GetPlane(lastRejectPlane));
+
+        if (type == PLANE_BACK)
+            return Frustum::CULL_OUTSIDE;
+
+        if (type == PLANE_INTERSECT)
+            outPlanesMask |= (1 << lastRejectPlane);
+
+        mask &= ~(1 << lastRejectPlane);
+    }
+
+    for (int p = 0; p < Frustum::NUM_PLANES; ++p)
+    {
+        if (!(mask & (1 << p)))
+            continue;
+
+        const int type = PlaneClassify(volume, frustum.GetPlane(p));
+
+        if (type == PLANE_BACK)
+        {
+            lastRejectPlane = p;
+            outPlanesMask   = 0;
+            return Frustum::CULL_OUTSIDE;
+        }
+
+        if (type == PLANE_INTERSECT)
+            outPlanesMask |= (1 << p);
+    }
+
+    return (outPlanesMask) ? Frustum::CULL_INTERSECT : Frustum::CULL_INSIDE;
+}
+
+//---------------------------------------------------------
+// Desc:   classify a box which is a node of some bounding hierarchy
+// Args:   - rect:            the bounding box of the node
+//         - inPlanesMask:    planes to test (outPlanesMask of the parent node,
+//                            or ALL_PLANES_MASK for the root node)
+//         - outPlanesMask:   planes which intersect the box (pass it to children)
+//         - lastRejectPlane: per-node cache: index of the plane which rejected
+//                            the node last time (-1 if none); it is updated
+//                            when the node is rejected
+// Ret:    CULL_OUTSIDE, CULL_INTERSECT or CULL_INSIDE
+//---------------------------------------------------------
+inline int Frustum::ClassifyRect(
+    const Rect3d& rect,
+    const uint32_t inPlanesMask,
+    uint32_t& outPlanesMask,
+    int& lastRejectPlane) const
+{
+    return FrustumClassifyHierarchical(*this, rect, inPlanesMask, outPlanesMask, lastRejectPlane);
+}
+
+//---------------------------------------------------------
+// Desc:   the same as ClassifyRect but for a bounding sphere
+//---------------------------------------------------------
+inline int Frustum::ClassifySphere(
+    const Sphere& sphere,
+    const uint32_t inPlanesMask,
+    uint32_t& outPlanesMask,
+    int& lastRejectPlane) const
+{
+    return FrustumClassifyHierarchical(*this, sphere, inPlanesMask, outPlanesMask, lastRejectPlane);
+}
+
+
 #if 0
 
 
@@ -54,6 +54,26 @@ inline bool IntersectRect3d(const Rect3d& a, const Rect3d& b, Rect3d& result)
             result.z0 <= result.z1);
 }
 
+//---------------------------------------------------------
+// Desc:   test if two input 3d rectangles overlap (touching counts as overlap)
+//---------------------------------------------------------
+inline bool OverlapRect3d(const Rect3d& a, const Rect3d& b)
+{
+    return (a.x0 <= b.x1 && b.x0 <= a.x1 &&
+            a.y0 <= b.y1 && b.y0 <= a.y1 &&
+            a.z0 <= b.z1 && b.z0 <= a.z1);
+}
+
+//---------------------------------------------------------
+// Desc:   test if the inner 3d rectangle is completely inside of the outer one
+//---------------------------------------------------------
+inline bool ContainsRect3d(const Rect3d& outer, const Rect3d& inner)
+{
+    return (outer.x0 <= inner.x0 && inner.x1 <= outer.x1 &&
+            outer.y0 <= inner.y0 && inner.y1 <= outer.y1 &&
+            outer.z0 <= inner.z0 && inner.z1 <= outer.z1);
+}
+
 //---------------------------------------------------------
 // Desc:   define intersection type btw input 3d rectangle and plane
 //         (rect can be completely in front, behind or be intersected by the plane)
@@ -103,17 +123,18 @@ inline int PlaneClassify(const Rect3d& rect, const Plane3d& plane)
     const float dMin = plane.SignedDistance(minPoint);
     const float dMax = plane.SignedDistance(maxPoint);
 
-    // the rect intersects the plane if one dist is positive and the other is negative
-    if (dMin * dMax < 0.0f)
+    // the rect is behind the plane if even the furthest point along the normal is behind;
+    // in front if even the nearest point is in front; otherwise it is intersected
+    if (dMax < 0.0f)
     {
-        return PLANE_INTERSECT;
+        return PLANE_BACK;
     }
-    else if (dMin)
+    else if (dMin < 0.0f)
     {
-        return PLANE_FRONT;
+        return PLANE_INTERSECT;
     }
 
-    return PLANE_BACK;
+    return PLANE_FRONT;
 }
 
 //---------------------------------------------------------
@@ -126,7 +147,7 @@ inline int PlaneClassify(const Sphere& sphere, const Plane3d& plane)
     if (fabs(d) < sphere.radius)
         return PLANE_INTERSECT;
 
-    else if (d)
+    else if (d > 0.0f)
         return PLANE_FRONT;
 
     return PLANE_BACK;
@@ -0,0 +1,475 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: loose_octree.h
+    Desc:     loose octree over a big set of static Rect3d objects
+
+              - a cell of the level L is the world box divided by 2^L along
+                each axis; its "loose" bounds are the cell expanded by a half
+                of its size on each side, so an object fits into the loose
+                cell which contains its center if the object isn't bigger
+                than the cell itself;
+              - so the level of an object is selected in O(1) by its size:
+                floor(log2(worldSize / objectSize)), no descending is needed;
+              - objects are sorted by (Morton code of the cell at the deepest
+                level, level), so objects of any subtree form a contiguous
+                range, and a node stores its objects as a sub-range of it;
+                a subtree completely inside of a query volume is written out
+                without visiting its nodes;
+              - nodes are stored in one array, children of a node are stored
+                next to each other; only non-empty subtrees have nodes
+
+    Created:  17.10.2026 by DimaSkup
+\**********************************************************************************/
+#pragma once
+
+#include <geometry/frustum.h>
+#include <geometry/rect_3d.h>
+#include <geometry/rect_3d_functions.h>
+#include <geometry/intersection_tests.h>
+#include <math/vec3.h>
+#include <math/morton.h>
+#include <assert.h>
+#include <float.h>
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+
+
+//==================================================================================
+// loose octree node
+//==================================================================================
+struct LooseOctreeNode
+{
+    // tight bounds of all the objects of the subtree
+    // (they are always inside of the loose bounds of the cell)
+    Rect3d   bounds;
+
+    // objects of the subtree: [first, first + numTotal) of LooseOctree::objIndices;
+    // the first numOwn of them belong to this node itself
+    uint32_t first       = 0;
+    uint32_t numOwn      = 0;
+    uint32_t numTotal    = 0;
+
+    // children: [firstChild, firstChild + numChildren) of LooseOctree::nodes
+    uint32_t firstChild  = 0;
+    uint32_t numChildren = 0;
+};
+
+//---------------------------------------------------------
+// Desc:   sort key of an object: (Morton code of the cell at the deepest
+//         level << 4) | level of the object
+//---------------------------------------------------------
+struct LooseOctreeKey
+{
+    uint64_t key;
+    uint32_t index;
+
+    inline bool operator < (const LooseOctreeKey& other) const { return key < other.key; }
+};
+
+
+//==================================================================================
+// loose octree
+//==================================================================================
+class LooseOctree
+{
+public:
+    static constexpr int MAX_DEPTH     = 10;                  // cells are encoded by 30-bit Morton codes
+    static constexpr int DEFAULT_DEPTH = 8;
+    static constexpr int STACK_SIZE    = 8 * MAX_DEPTH + 1;   // max size of a traversal stack
+
+    //-----------------------------------------------------
+    // public data
+    //-----------------------------------------------------
+    std::vector<LooseOctreeNode> nodes;          // nodes[0] is the root
+    std::vector<uint32_t>        objIndices;     // indices of objects in the tree order
+    std::vector<Rect3d>          objBounds;      // bounds of objects in the same order
+    std::vector<LooseOctreeKey>  keys;           // temp buffer of the build
+
+    Rect3d worldBounds;
+    Vec3   worldSize;
+    int    maxDepth = DEFAULT_DEPTH;
+
+    //-----------------------------------------------------
+    // build
+    //-----------------------------------------------------
+    void Build(const Rect3d* objects, const uint32_t numObjects, const int maxTreeDepth = DEFAULT_DEPTH);
+    void Clear();
+
+    inline bool IsEmpty() const { return nodes.empty(); }
+
+    int    GetLevel(const Rect3d& bounds) const;
+    void   GetCell(const Vec3& point, const int level, uint32_t& cx, uint32_t& cy, uint32_t& cz) const;
+    Rect3d GetLooseCellBounds(const int level, const uint32_t cx, const uint32_t cy, const uint32_t cz) const;
+
+    //-----------------------------------------------------
+    // queries: all of them return the number of found objects,
+    // only the first maxCount of them are written into outIndices
+    //-----------------------------------------------------
+    uint32_t QueryFrustum(const Frustum& frustum, uint32_t* outIndices, const uint32_t maxCount) const;
+    uint32_t QueryRect   (const Rect3d& rect,     uint32_t* outIndices, const uint32_t maxCount) const;
+
+    //-----------------------------------------------------
+    // internal
+    //-----------------------------------------------------
+    void BuildNode(const uint32_t nodeIdx, const int level, const uint32_t begin, const uint32_t end);
+    void WriteRange(const uint32_t first, const uint32_t count, uint32_t* outIndices, const uint32_t maxCount, uint32_t& found) const;
+};
+
+
+//==================================================================================
+// INLINE METHODS: cells
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:   the deepest level which cells are not smaller than the object
+//         along each axis (so the object fits into a loose cell of the level)
+//---------------------------------------------------------
+inline int LooseOctree::GetLevel(const Rect3d& bounds) const
+{
+    const Vec3 size  = bounds.Size();
+    float      ratio = FLT_MAX;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        if (size.xyz[i] > 0.0f)
+            ratio = Min(ratio, worldSize.xyz[i] / size.xyz[i]);
+    }
+
+    if (ratio >= (float)(1u << maxDepth))
+        return maxDepth;
+
+    // floor(log2(ratio))
+    return (ratio >= 1.0f) ? 31 - CountLeadingZeros32((uint32_t)ratio) : 0;
+}
+
+//---------------------------------------------------------
+// Desc:   coords of a cell of the level which contains the point
+//---------------------------------------------------------
+inline void LooseOctree::GetCell(
+    const Vec3& point,
+    const int level,
+    uint32_t& cx,
+    uint32_t& cy,
+    uint32_t& cz) const
+{
+    assert(level >= 0 && level <= maxDepth);
+
+    const float    numCells = (float)(1u << level);
+    const uint32_t maxCell  = (1u << level) - 1;
+    const Vec3     minP     = worldBounds.MinPoint();
+    uint32_t       cell[3];
+
+    for (int i = 0; i < 3; ++i)
+    {
+        const float c = (worldSize.xyz[i] > 0.0f) ? (point.xyz[i] - minP.xyz[i]) * numCells / worldSize.xyz[i] : 0.0f;
+        cell[i] = (c <= 0.0f) ? 0 : ((uint32_t)c > maxCell) ? maxCell : (uint32_t)c;
+    }
+
+    cx = cell[0];
+    cy = cell[1];
+    cz = cell[2];
+}
+
+//---------------------------------------------------------
+// Desc:   bounds of the cell expanded by a half of the cell size on each side
+//---------------------------------------------------------
+inline Rect3d LooseOctree::GetLooseCellBounds(
+    const int level,
+    const uint32_t cx,
+    const uint32_t cy,
+    const uint32_t cz) const
+{
+    const float sx = worldSize.x / (float)(1u << level);
+    const float sy = worldSize.y / (float)(1u << level);
+    const float sz = worldSize.z / (float)(1u << level);
+
+    Rect3d cell(worldBounds.x0 + sx * cx, worldBounds.x0 + sx * (cx + 1),
+                worldBounds.y0 + sy * cy, worldBounds.y0 + sy * (cy + 1),
+                worldBounds.z0 + sz * cz, worldBounds.z0 + sz * (cz + 1));
+
+    cell.Expand(Vec3(0.5f * sx, 0.5f * sy, 0.5f * sz));
+    return cell;
+}
+
+
+//==================================================================================
+// INLINE METHODS: build
+//==================================================================================
+
+//---------------------------------------------------------
+
+inline void LooseOctree::Clear()
+{
+    nodes.clear();
+    objIndices.clear();
+    objBounds.clear();
+}
+
+//---------------------------------------------------------
+// Desc:   build the tree over the objects (memory of a previous build is reused)
+// Args:   - objects:      bounds of objects
+//         - numObjects:   number of objects
+//         - maxTreeDepth: the deepest level (up to MAX_DEPTH)
+//---------------------------------------------------------
+inline void LooseOctree::Build(const Rect3d* objects, const uint32_t numObjects, const int maxTreeDepth)
+{
+    assert((objects != nullptr) || (numObjects == 0));
+    assert(maxTreeDepth >= 0 && maxTreeDepth <= MAX_DEPTH);
+
+    Clear();
+
+    if (numObjects == 0)
+        return;
+
+    maxDepth    = maxTreeDepth;
+    worldBounds = objects[0];
+
+    for (uint32_t i = 1; i < numObjects; ++i)
+        worldBounds.Union(objects[i]);
+
+    worldSize = worldBounds.Size();
+
+    // select a level and a cell of each object
+    keys.resize(numObjects);
+
+    for (uint32_t i = 0; i < numObjects; ++i)
+    {
+        const int level = GetLevel(objects[i]);
+        uint32_t  cx, cy, cz;
+
+        GetCell(objects[i].MidPoint(), level, cx, cy, cz);
+
+        const uint64_t code = (uint64_t)MortonEncode3d(cx, cy, cz) << (3 * (maxDepth - level));
+
+        keys[i].key   = (code << 4) | (uint64_t)level;
+        keys[i].index = i;
+    }
+
+    std::sort(keys.begin(), keys.end());
+
+    objIndices.resize(numObjects);
+    objBounds.resize(numObjects);
+
+    for (uint32_t i = 0; i < numObjects; ++i)
+    {
+        objIndices[i] = keys[i].index;
+        objBounds[i]  = objects[keys[i].index];
+    }
+
+    nodes.resize(1);
+    BuildNode(0, 0, 0, numObjects);
+}
+
+//---------------------------------------------------------
+// Desc:   set up the node over a range of sorted objects and create its children
+//---------------------------------------------------------
+inline void LooseOctree::BuildNode(const uint32_t nodeIdx, const int level, const uint32_t begin, const uint32_t end)
+{
+    // objects of this level go first
+    uint32_t numOwn = 0;
+
+    while ((begin + numOwn < end) && ((int)(keys[begin + numOwn].key & 0xF) == level))
+        ++numOwn;
+
+    // the rest of the range is split into children by the next 3 bits of the codes
+    uint32_t childBegin[8];
+    uint32_t childEnd[8];
+    uint32_t numChildren = 0;
+
+    if (begin + numOwn < end)
+    {
+        assert(level < maxDepth);
+        const int shift = 4 + 3 * (maxDepth - level - 1);
+
+        for (uint32_t i = begin + numOwn; i < end; ++i)
+        {
+            const uint32_t digit = (uint32_t)(keys[i].key >> shift) & 7;
+
+            if ((numChildren == 0) || (((uint32_t)(keys[childBegin[numChildren - 1]].key >> shift) & 7) != digit))
+            {
+                childBegin[numChildren] = i;
+                ++numChildren;
+            }
+
+            childEnd[numChildren - 1] = i + 1;
+        }
+    }
+
+    const uint32_t firstChild = (uint32_t)nodes.size();
+    nodes.resize(firstChild + numChildren);
+
+    Rect3d bounds = (numOwn > 0) ? objBounds[begin] : Rect3d();
+
+    for (uint32_t i = begin + 1; i < begin + numOwn; ++i)
+        bounds.Union(objBounds[i]);
+
+    for (uint32_t c = 0; c < numChildren; ++c)
+    {
+        BuildNode(firstChild + c, level + 1, childBegin[c], childEnd[c]);
+
+        if ((numOwn == 0) && (c == 0))
+            bounds = nodes[firstChild].bounds;
+        else
+            bounds.Union(nodes[firstChild + c].bounds);
+    }
+
+    LooseOctreeNode& node = nodes[nodeIdx];
+    node.bounds      = bounds;
+    node.first       = begin;
+    node.numOwn      = numOwn;
+    node.numTotal    = end - begin;
+    node.firstChild  = firstChild;
+    node.numChildren = numChildren;
+}
+
+
+//==================================================================================
+// INLINE METHODS: queries
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:   write indices of a range of objects (a whole subtree) into
+//         the output buffer; the ones which don't fit are only counted
+//---------------------------------------------------------
+inline void LooseOctree::WriteRange(
+    const uint32_t first,
+    const uint32_t count,
+    uint32_t* outIndices,
+    const uint32_t maxCount,
+    uint32_t& found) const
+{
+    const uint32_t numWrite = (found < maxCount) ? Min(count, maxCount - found) : 0;
+
+    for (uint32_t i = 0; i < numWrite; ++i)
+        outIndices[found + i] = objIndices[first + i];
+
+    found += count;
+}
+
+//---------------------------------------------------------
+// Desc:   find objects which bounds overlap the input rect
+//---------------------------------------------------------
+inline uint32_t LooseOctree::QueryRect(const Rect3d& rect, uint32_t* outIndices, const uint32_t maxCount) const
+{
+    assert((outIndices != nullptr) || (maxCount == 0));
+
+    if (IsEmpty())
+        return 0;
+
+    uint32_t stack[STACK_SIZE];
+    int      sp    = 0;
+    uint32_t found = 0;
+
+    stack[sp++] = 0;
+
+    while (sp > 0)
+    {
+        const LooseOctreeNode& node = nodes[stack[--sp]];
+        Rect3d                 tmp;
+
+        if (!IntersectRect3d(node.bounds, rect, tmp))
+            continue;
+
+        // the whole subtree is inside of the rect
+        if (tmp == node.bounds)
+        {
+            WriteRange(node.first, node.numTotal, outIndices, maxCount, found);
+            continue;
+        }
+
+        for (uint32_t i = node.first; i < node.first + node.numOwn; ++i)
+        {
+            if (!IntersectRect3d(objBounds[i], rect, tmp))
+                continue;
+
+            if (found < maxCount)
+                outIndices[found] = objIndices[i];
+            ++found;
+        }
+
+        for (uint32_t c = 0; c < node.numChildren; ++c)
+        {
+            assert(sp < STACK_SIZE);
+            stack[sp++] = node.firstChild + c;
+        }
+    }
+
+    return found;
+}
+
+//---------------------------------------------------------
+// Desc:   find objects which bounds are (at least partially) inside the
+//         frustum; plane masks are passed from parents to children, and
+//         subtrees completely inside of the frustum are written out at once
+//---------------------------------------------------------
+inline uint32_t LooseOctree::QueryFrustum(const Frustum& frustum, uint32_t* outIndices, const uint32_t maxCount) const
+{
+    assert((outIndices != nullptr) || (maxCount == 0));
+
+    if (IsEmpty())
+        return 0;
+
+    struct StackItem
+    {
+        uint32_t nodeIdx;
+        uint32_t planesMask;
+    };
+
+    StackItem stack[STACK_SIZE];
+    int       sp              = 0;
+    int       lastRejectPlane = -1;
+    uint32_t  found           = 0;
+
+    stack[sp].nodeIdx    = 0;
+    stack[sp].planesMask = Frustum::ALL_PLANES_MASK;
+    ++sp;
+
+    while (sp > 0)
+    {
+        --sp;
+        const LooseOctreeNode& node = nodes[stack[sp].nodeIdx];
+        uint32_t childMask = 0;
+
+        const int type = frustum.ClassifyRect(node.bounds, stack[sp].planesMask, childMask, lastRejectPlane);
+
+        if (type == Frustum::CULL_OUTSIDE)
+            continue;
+
+        if (type == Frustum::CULL_INSIDE)
+        {
+            WriteRange(node.first, node.numTotal, outIndices, maxCount, found);
+            continue;
+        }
+
+        for (uint32_t i = node.first; i < node.first + node.numOwn; ++i)
+        {
+            uint32_t objMask = 0;
+
+            if (frustum.ClassifyRect(objBounds[i], childMask, objMask, lastRejectPlane) == Frustum::CULL_OUTSIDE)
+                continue;
+
+            if (found < maxCount)
+                outIndices[found] = objIndices[i];
+            ++found;
+        }
+
+        for (uint32_t c = 0; c < node.numChildren; ++c)
+        {
+            assert(sp < STACK_SIZE);
+            stack[sp].nodeIdx    = node.firstChild + c;
+            stack[sp].planesMask = childMask;
+            ++sp;
+        }
+    }
+
+    return found;
+}
@@ -56,7 +56,7 @@ public:
     Plane3d(const float nx, const float ny, const float nz, const float dist);
     Plane3d(const Plane3d& src);
     Plane3d(const Vec4& normalAndDist);
-    Plane3d(const Vec3& p0, const Vec3& p1, const Vec3& p2);
+    Plane3d(const Vec3& p0, const Vec3& p1, const Vec3& p2);  // normal = (p1-p0) x (p2-p0)
     Plane3d(const Vec3& normal, const float distance);
     Plane3d(const Vec3& point, const Vec3& normal);
     ~Plane3d();
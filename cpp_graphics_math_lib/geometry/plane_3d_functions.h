@@ -195,7 +195,10 @@ inline Vec3 Plane3d::ProjectPointToPlane(const Vec3& point) const
 }
 
 //---------------------------------------------------------
-// Desc:   setup a plane with given a clockwise ordering of 3D points
+// Desc:   setup a plane with given a clockwise ordering of 3D points:
+//         the normal is (p1 - p0) x (p2 - p0), so in the left-handed system
+//         the points are clockwise when looked at from the side the normal
+//         points to (the same as Triangle::GetNormal())
 //---------------------------------------------------------
 inline void Plane3d::Set(const Vec3& p0, const Vec3& p1, const Vec3& p2)
 {
@@ -0,0 +1,397 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: ray.h
+    Desc:     a ray (origin, direction, its reciprocal and the [tMin, tMax]
+              interval) and branchless slab tests against Rect3d:
+              - a single ray vs a single rect;
+              - a single ray vs 8 rects in SoA form (Rect3dx8);
+              - 8 rays vs a single rect;
+              and single ray tests against Sphere and Plane3d
+
+              Axis-parallel rays: a zero component of the direction gives
+              an infinite reciprocal, so the slab distances are +-inf, or NaN
+              if the origin lies exactly on the slab plane (0 * inf). NaNs are
+              replaced by -inf/+inf for the entry/exit distance, so such a slab
+              doesn't limit the ray at all (touching counts as a hit)
+
+              NOTE: the NaN handling relies on IEEE comparisons, so don't
+              build it with /fp:fast or -ffast-math
+
+    Created:  17.10.2026 by DimaSkup
+\**********************************************************************************/
+#pragma once
+
+#include <geometry/rect_3d.h>
+#include <geometry/sphere.h>
+#include <geometry/plane_3d.h>
+#include <math/vec3.h>
+#include <math/vec_functions.h>
+#include <math/math_helpers.h>
+#include <math/simd.h>
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+
+
+//==================================================================================
+// ray
+//==================================================================================
+class Ray
+{
+public:
+
+    //-----------------------------------------------------
+    // public data
+    //-----------------------------------------------------
+    Vec3  origin = { 0,0,0 };
+    Vec3  dir    = { 0,0,1 };     // not necessarily normalized
+    Vec3  invDir = { INFINITY, INFINITY, 1 };
+    float tMin   = 0.0f;          // the interval along the ray in units of the direction length
+    float tMax   = FLT_MAX;
+
+    //-----------------------------------------------------
+    // constructors, destructor
+    //-----------------------------------------------------
+    Ray() {};
+    Ray(const Vec3& _origin, const Vec3& _dir, const float _tMin = 0.0f, const float _tMax = FLT_MAX);
+
+    //-----------------------------------------------------
+    // methods
+    //-----------------------------------------------------
+    void SetDirection(const Vec3& _dir);
+
+    inline Vec3 GetPoint(const float t) const { return origin + dir * t; }
+};
+
+
+//==================================================================================
+// 8 rects in SoA form (e.g. children of a wide BVH node)
+//==================================================================================
+struct alignas(32) Rect3dx8
+{
+    float x0[8]{ 0 };
+    float x1[8]{ 0 };
+    float y0[8]{ 0 };
+    float y1[8]{ 0 };
+    float z0[8]{ 0 };
+    float z1[8]{ 0 };
+
+    inline Rect3d Get(const int lane) const
+    {
+        assert(lane >= 0 && lane < 8);
+        return Rect3d(x0[lane], x1[lane], y0[lane], y1[lane], z0[lane], z1[lane]);
+    }
+
+    inline void Set(const int lane, const Rect3d& rect)
+    {
+        assert(lane >= 0 && lane < 8);
+        x0[lane] = rect.x0;  x1[lane] = rect.x1;
+        y0[lane] = rect.y0;  y1[lane] = rect.y1;
+        z0[lane] = rect.z0;  z1[lane] = rect.z1;
+    }
+};
+
+
+//==================================================================================
+// INLINE FUNCTIONS
+//==================================================================================
+
+//---------------------------------------------------------
+
+inline Ray::Ray(const Vec3& _origin, const Vec3& _dir, const float _tMin, const float _tMax) :
+    origin(_origin),
+    tMin(_tMin),
+    tMax(_tMax)
+{
+    SetDirection(_dir);
+}
+
+//---------------------------------------------------------
+// Desc:   set the direction and its reciprocal (a zero component gives +-inf)
+//---------------------------------------------------------
+inline void Ray::SetDirection(const Vec3& _dir)
+{
+    dir    = _dir;
+    invDir = Vec3(1.0f / _dir.x, 1.0f / _dir.y, 1.0f / _dir.z);
+}
+
+//---------------------------------------------------------
+// Desc:   clip the [tEnter, tExit] interval by one slab (scalar version);
+//         Max(NaN, -inf) == -inf and Min(NaN, inf) == inf, otherwise these
+//         calls don't change the value
+//---------------------------------------------------------
+inline void RayClipBySlab(
+    const float origin,
+    const float invDir,
+    const float slab0,
+    const float slab1,
+    float& tEnter,
+    float& tExit)
+{
+    const float t0 = (slab0 - origin) * invDir;
+    const float t1 = (slab1 - origin) * invDir;
+
+    tEnter = Max(tEnter, Min(Max(t0, -INFINITY), Max(t1, -INFINITY)));
+    tExit  = Min(tExit,  Max(Min(t0,  INFINITY), Min(t1,  INFINITY)));
+}
+
+//---------------------------------------------------------
+// Desc:   slab test of the ray against a 3d rectangle
+// Args:   - ray:   the ray to test
+//         - rect:  the rectangle to test
+//         - tNear: output entry distance (tMin if the ray starts inside)
+// Ret:    true if the ray hits the rect within [ray.tMin, ray.tMax]
+//---------------------------------------------------------
+inline bool RayIntersectRect3d(const Ray& ray, const Rect3d& rect, float& tNear)
+{
+    float tEnter = ray.tMin;
+    float tExit  = ray.tMax;
+
+    RayClipBySlab(ray.origin.x, ray.invDir.x, rect.x0, rect.x1, tEnter, tExit);
+    RayClipBySlab(ray.origin.y, ray.invDir.y, rect.y0, rect.y1, tEnter, tExit);
+    RayClipBySlab(ray.origin.z, ray.invDir.z, rect.z0, rect.z1, tEnter, tExit);
+
+    tNear = tEnter;
+    return tEnter <= tExit;
+}
+
+//---------------------------------------------------------
+// Desc:   intersection of the ray with a sphere
+// Args:   - t: output distance of the nearest intersection within
+//              [ray.tMin, ray.tMax] (the exit one if the ray starts inside)
+// Ret:    true if there is an intersection within [ray.tMin, ray.tMax]
+//---------------------------------------------------------
+inline bool RayIntersectSphere(const Ray& ray, const Sphere& sphere, float& t)
+{
+    // |m + t*d|^2 = r^2  =>  a*t^2 + 2*b*t + c = 0
+    const Vec3  m    = ray.origin - sphere.center;
+    const float a    = Vec3Dot(ray.dir, ray.dir);
+    const float b    = Vec3Dot(m, ray.dir);
+    const float c    = Vec3Dot(m, m) - sphere.radius * sphere.radius;
+    const float disc = b*b - a*c;
+
+    if (disc < 0.0f)
+        return false;
+
+    const float sq = sqrtf(disc);
+    const float t0 = (-b - sq) / a;
+    const float t1 = (-b + sq) / a;
+
+    t = (t0 >= ray.tMin) ? t0 : t1;
+    return (t >= ray.tMin) && (t <= ray.tMax);
+}
+
+//---------------------------------------------------------
+// Desc:   intersection of the ray with a plane (from any side);
+//         a ray parallel to the plane doesn't hit it (even if it lies in it)
+// Args:   - t: output distance of the intersection
+// Ret:    true if there is an intersection within [ray.tMin, ray.tMax]
+//---------------------------------------------------------
+inline bool RayIntersectPlane3d(const Ray& ray, const Plane3d& plane, float& t)
+{
+    const float dist  = Vec3Dot(plane.normal, ray.origin) + plane.distance;
+    const float denom = Vec3Dot(plane.normal, ray.dir);
+
+    // +-inf or NaN for parallel rays, so the range test fails
+    t = -dist / denom;
+    return (t >= ray.tMin) && (t <= ray.tMax);
+}
+
+
+#if defined(MATH_SIMD_SSE2)
+
+//---------------------------------------------------------
+// Desc:   SIMD version of RayClipBySlab() (T is __m128 or __m256);
+//         min/max instructions return the 2nd operand if any of them is NaN
+//---------------------------------------------------------
+template <class T>
+inline void RayClipBySlabSimd(
+    const T origin,
+    const T invDir,
+    const T slab0,
+    const T slab1,
+    T& tEnter,
+    T& tExit)
+{
+    T negInf, posInf;
+    SimdSet1(-INFINITY, negInf);
+    SimdSet1( INFINITY, posInf);
+
+    const T t0 = SimdMul(SimdSub(slab0, origin), invDir);
+    const T t1 = SimdMul(SimdSub(slab1, origin), invDir);
+
+    tEnter = SimdMax(tEnter, SimdMin(SimdMax(t0, negInf), SimdMax(t1, negInf)));
+    tExit  = SimdMin(tExit,  SimdMax(SimdMin(t0, posInf), SimdMin(t1, posInf)));
+}
+
+//---------------------------------------------------------
+// Desc:   slab test of 4 or 8 lanes (rays and rects in SoA form)
+// Ret:    all-ones lanes for hits
+//---------------------------------------------------------
+template <class T>
+inline T RayIntersectRect3dSimd(
+    const T ox, const T oy, const T oz,
+    const T ix, const T iy, const T iz,
+    const T tMin, const T tMax,
+    const T x0, const T x1,
+    const T y0, const T y1,
+    const T z0, const T z1,
+    T& outTNear)
+{
+    T tEnter = tMin;
+    T tExit  = tMax;
+
+    RayClipBySlabSimd(ox, ix, x0, x1, tEnter, tExit);
+    RayClipBySlabSimd(oy, iy, y0, y1, tEnter, tExit);
+    RayClipBySlabSimd(oz, iz, z0, z1, tEnter, tExit);
+
+    outTNear = tEnter;
+    return SimdCmpLe(tEnter, tExit);
+}
+
+#endif // MATH_SIMD_SSE2
+
+//---------------------------------------------------------
+// Desc:   slab test of a single ray against 8 rects at once
+// Args:   - ray:      the ray to test
+//         - rects:    8 rects in SoA form (mask out results of unused lanes)
+//         - outTNear: (8 floats) entry distances, valid for hit lanes only
+// Ret:    bit mask of hit rects (bit i is set if the ray hits rect i)
+//---------------------------------------------------------
+inline int RayIntersectRect3dx8(const Ray& ray, const Rect3dx8& rects, float* outTNear)
+{
+    assert(outTNear != nullptr);
+
+#if defined(MATH_SIMD_AVX2)
+    __m256 tNear;
+    const __m256 hit = RayIntersectRect3dSimd(
+        _mm256_set1_ps(ray.origin.x), _mm256_set1_ps(ray.origin.y), _mm256_set1_ps(ray.origin.z),
+        _mm256_set1_ps(ray.invDir.x), _mm256_set1_ps(ray.invDir.y), _mm256_set1_ps(ray.invDir.z),
+        _mm256_set1_ps(ray.tMin),     _mm256_set1_ps(ray.tMax),
+        _mm256_load_ps(rects.x0),     _mm256_load_ps(rects.x1),
+        _mm256_load_ps(rects.y0),     _mm256_load_ps(rects.y1),
+        _mm256_load_ps(rects.z0),     _mm256_load_ps(rects.z1),
+        tNear);
+
+    _mm256_storeu_ps(outTNear, tNear);
+    return SimdMoveMask(hit);
+
+#elif defined(MATH_SIMD_SSE2)
+    int mask = 0;
+
+    for (int i = 0; i < 8; i += 4)
+    {
+        __m128 tNear;
+        const __m128 hit = RayIntersectRect3dSimd(
+            _mm_set1_ps(ray.origin.x), _mm_set1_ps(ray.origin.y), _mm_set1_ps(ray.origin.z),
+            _mm_set1_ps(ray.invDir.x), _mm_set1_ps(ray.invDir.y), _mm_set1_ps(ray.invDir.z),
+            _mm_set1_ps(ray.tMin),     _mm_set1_ps(ray.tMax),
+            _mm_load_ps(rects.x0 + i), _mm_load_ps(rects.x1 + i),
+            _mm_load_ps(rects.y0 + i), _mm_load_ps(rects.y1 + i),
+            _mm_load_ps(rects.z0 + i), _mm_load_ps(rects.z1 + i),
+            tNear);
+
+        _mm_storeu_ps(outTNear + i, tNear);
+        mask |= SimdMoveMask(hit) << i;
+    }
+
+    return mask;
+
+#else
+    int mask = 0;
+
+    for (int i = 0; i < 8; ++i)
+    {
+        if (RayIntersectRect3d(ray, rects.Get(i), outTNear[i]))
+            mask |= (1 << i);
+    }
+
+    return mask;
+#endif
+}
+
+//---------------------------------------------------------
+// Desc:   slab test of 8 rays against a single rect at once
+// Args:   - rays:     8 rays
+//         - rect:     the rect to test
+//         - outTNear: (8 floats) entry distances, valid for hit lanes only
+// Ret:    bit mask of rays which hit the rect
+//---------------------------------------------------------
+inline int Rayx8IntersectRect3d(const Ray* rays, const Rect3d& rect, float* outTNear)
+{
+    assert(rays != nullptr && outTNear != nullptr);
+
+#if defined(MATH_SIMD_SSE2)
+    // rays into SoA form
+    alignas(32) float ox[8], oy[8], oz[8];
+    alignas(32) float ix[8], iy[8], iz[8];
+    alignas(32) float tMin[8], tMax[8];
+
+    for (int i = 0; i < 8; ++i)
+    {
+        ox[i]   = rays[i].origin.x;
+        oy[i]   = rays[i].origin.y;
+        oz[i]   = rays[i].origin.z;
+        ix[i]   = rays[i].invDir.x;
+        iy[i]   = rays[i].invDir.y;
+        iz[i]   = rays[i].invDir.z;
+        tMin[i] = rays[i].tMin;
+        tMax[i] = rays[i].tMax;
+    }
+#endif
+
+#if defined(MATH_SIMD_AVX2)
+    __m256 tNear;
+    const __m256 hit = RayIntersectRect3dSimd(
+        _mm256_load_ps(ox),         _mm256_load_ps(oy),         _mm256_load_ps(oz),
+        _mm256_load_ps(ix),         _mm256_load_ps(iy),         _mm256_load_ps(iz),
+        _mm256_load_ps(tMin),       _mm256_load_ps(tMax),
+        _mm256_set1_ps(rect.x0),    _mm256_set1_ps(rect.x1),
+        _mm256_set1_ps(rect.y0),    _mm256_set1_ps(rect.y1),
+        _mm256_set1_ps(rect.z0),    _mm256_set1_ps(rect.z1),
+        tNear);
+
+    _mm256_storeu_ps(outTNear, tNear);
+    return SimdMoveMask(hit);
+
+#elif defined(MATH_SIMD_SSE2)
+    int mask = 0;
+
+    for (int i = 0; i < 8; i += 4)
+    {
+        __m128 tNear;
+        const __m128 hit = RayIntersectRect3dSimd(
+            _mm_load_ps(ox + i),     _mm_load_ps(oy + i),     _mm_load_ps(oz + i),
+            _mm_load_ps(ix + i),     _mm_load_ps(iy + i),     _mm_load_ps(iz + i),
+            _mm_load_ps(tMin + i),   _mm_load_ps(tMax + i),
+            _mm_set1_ps(rect.x0),    _mm_set1_ps(rect.x1),
+            _mm_set1_ps(rect.y0),    _mm_set1_ps(rect.y1),
+            _mm_set1_ps(rect.z0),    _mm_set1_ps(rect.z1),
+            tNear);
+
+        _mm_storeu_ps(outTNear + i, tNear);
+        mask |= SimdMoveMask(hit) << i;
+    }
+
+    return mask;
+
+#else
+    int mask = 0;
+
+    for (int i = 0; i < 8; ++i)
+    {
+        if (RayIntersectRect3d(rays[i], rect, outTNear[i]))
+            mask |= (1 << i);
+    }
+
+    return mask;
+#endif
+}
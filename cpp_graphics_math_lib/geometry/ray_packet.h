@@ -0,0 +1,400 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: ray_packet.h
+    Desc:     packets of 4 or 8 coherent rays (a shared origin and close
+              directions, e.g. a lightmap texel or a visibility check)
+              in SoA form, and their tests against Rect3d, Sphere and Plane3d
+
+              - each test takes a mask of active lanes (bit i - ray i) and
+                returns the mask of active rays which hit the volume, so
+                during a traversal of a hierarchy the mask of a node is
+                the mask of its parent AND the hit mask of its bounds;
+              - rays which missed a node are dropped from its subtree,
+                the whole subtree is skipped when the mask becomes 0;
+              - inside of a test blocks of 4 (8 with AVX2) lanes without
+                active rays are skipped
+
+    Created:  17.10.2026 by DimaSkup
+\**********************************************************************************/
+#pragma once
+
+#include <geometry/ray.h>
+#include <geometry/rect_3d.h>
+#include <geometry/sphere.h>
+#include <geometry/plane_3d.h>
+#include <math/simd.h>
+#include <assert.h>
+#include <stdint.h>
+
+
+//==================================================================================
+// ray packet
+//==================================================================================
+template <int N>
+struct alignas(32) RayPacket
+{
+    static_assert(N == 4 || N == 8, "a ray packet has 4 or 8 lanes");
+
+    static constexpr int      NUM_LANES = N;
+    static constexpr uint32_t ALL_LANES = (1u << N) - 1;
+
+    //-----------------------------------------------------
+    // public data
+    //-----------------------------------------------------
+    float ox[N]{ 0 };           // origins
+    float oy[N]{ 0 };
+    float oz[N]{ 0 };
+    float dx[N]{ 0 };           // directions
+    float dy[N]{ 0 };
+    float dz[N]{ 0 };
+    float ix[N]{ 0 };           // reciprocals of directions
+    float iy[N]{ 0 };
+    float iz[N]{ 0 };
+    float tMin[N]{ 0 };
+    float tMax[N]{ 0 };
+
+    //-----------------------------------------------------
+    // methods
+    //-----------------------------------------------------
+    void     Set(const int lane, const Ray& ray);
+    Ray      Get(const int lane) const;
+    uint32_t SetRays(const Ray* rays, const int numRays);
+    void     ShrinkTMax(const uint32_t hitMask, const float* t);
+};
+
+typedef RayPacket<4> RayPacket4;
+typedef RayPacket<8> RayPacket8;
+
+
+//==================================================================================
+// INLINE FUNCTIONS
+//==================================================================================
+
+//---------------------------------------------------------
+
+template <int N>
+inline void RayPacket<N>::Set(const int lane, const Ray& ray)
+{
+    assert(lane >= 0 && lane < N);
+
+    ox[lane]   = ray.origin.x;
+    oy[lane]   = ray.origin.y;
+    oz[lane]   = ray.origin.z;
+    dx[lane]   = ray.dir.x;
+    dy[lane]   = ray.dir.y;
+    dz[lane]   = ray.dir.z;
+    ix[lane]   = ray.invDir.x;
+    iy[lane]   = ray.invDir.y;
+    iz[lane]   = ray.invDir.z;
+    tMin[lane] = ray.tMin;
+    tMax[lane] = ray.tMax;
+}
+
+//---------------------------------------------------------
+
+template <int N>
+inline Ray RayPacket<N>::Get(const int lane) const
+{
+    assert(lane >= 0 && lane < N);
+
+    Ray ray;
+    ray.origin = Vec3(ox[lane], oy[lane], oz[lane]);
+    ray.dir    = Vec3(dx[lane], dy[lane], dz[lane]);
+    ray.invDir = Vec3(ix[lane], iy[lane], iz[lane]);
+    ray.tMin   = tMin[lane];
+    ray.tMax   = tMax[lane];
+
+    return ray;
+}
+
+//---------------------------------------------------------
+// Desc:   fill the packet with up to N rays; unused lanes get an empty
+//         interval (tMin > tMax), so they never hit anything
+// Ret:    the mask of active lanes
+//---------------------------------------------------------
+template <int N>
+inline uint32_t RayPacket<N>::SetRays(const Ray* rays, const int numRays)
+{
+    assert(rays != nullptr);
+    assert(numRays > 0 && numRays <= N);
+
+    for (int i = 0; i < numRays; ++i)
+        Set(i, rays[i]);
+
+    for (int i = numRays; i < N; ++i)
+    {
+        Set(i, rays[0]);
+        tMin[i] = 1.0f;
+        tMax[i] = 0.0f;
+    }
+
+    return (1u << numRays) - 1;
+}
+
+//---------------------------------------------------------
+// Desc:   closest hit search: limit rays of the hit mask by the found distances
+//         (the following tests only accept closer intersections)
+//---------------------------------------------------------
+template <int N>
+inline void RayPacket<N>::ShrinkTMax(const uint32_t hitMask, const float* t)
+{
+    assert(t != nullptr);
+
+    for (int i = 0; i < N; ++i)
+    {
+        if (hitMask & (1u << i))
+            tMax[i] = t[i];
+    }
+}
+
+
+#if defined(MATH_SIMD_SSE2)
+
+//---------------------------------------------------------
+// Desc:   a register type for a packet: a packet of 8 is processed
+//         at once with AVX2, or by two halves with SSE
+//---------------------------------------------------------
+template <int N>
+struct RayPacketSimd
+{
+    typedef __m128 Type;
+    static constexpr int WIDTH = 4;
+};
+
+#if defined(MATH_SIMD_AVX2)
+template <>
+struct RayPacketSimd<8>
+{
+    typedef __m256 Type;
+    static constexpr int WIDTH = 8;
+};
+#endif
+
+//---------------------------------------------------------
+// Desc:   SIMD intersection of rays with a sphere (see RayIntersectSphere())
+// Ret:    all-ones lanes for hits
+//---------------------------------------------------------
+template <class T>
+inline T RayIntersectSphereSimd(
+    const T ox, const T oy, const T oz,
+    const T dx, const T dy, const T dz,
+    const T tMin, const T tMax,
+    const Sphere& sphere,
+    T& outT)
+{
+    T cx, cy, cz, r, zero;
+    SimdSet1(sphere.center.x, cx);
+    SimdSet1(sphere.center.y, cy);
+    SimdSet1(sphere.center.z, cz);
+    SimdSet1(sphere.radius,   r);
+    SimdSet1(0.0f,            zero);
+
+    const T mx = SimdSub(ox, cx);
+    const T my = SimdSub(oy, cy);
+    const T mz = SimdSub(oz, cz);
+
+    const T a    = SimdMulAdd(dz, dz, SimdMulAdd(dy, dy, SimdMul(dx, dx)));
+    const T b    = SimdMulAdd(mz, dz, SimdMulAdd(my, dy, SimdMul(mx, dx)));
+    const T c    = SimdSub(SimdMulAdd(mz, mz, SimdMulAdd(my, my, SimdMul(mx, mx))), SimdMul(r, r));
+    const T disc = SimdSub(SimdMul(b, b), SimdMul(a, c));
+
+    // the sqrt of a clamped value, misses are rejected by the mask
+    const T sq   = SimdSqrt(SimdMax(disc, zero));
+    const T negB = SimdSub(zero, b);
+    const T t0   = SimdDiv(SimdSub(negB, sq), a);
+    const T t1   = SimdDiv(SimdAdd(negB, sq), a);
+    const T t    = SimdSelect(SimdCmpGe(t0, tMin), t0, t1);
+
+    outT = t;
+    return SimdAnd(SimdCmpGe(disc, zero), SimdAnd(SimdCmpGe(t, tMin), SimdCmpLe(t, tMax)));
+}
+
+//---------------------------------------------------------
+// Desc:   SIMD intersection of rays with a plane (see RayIntersectPlane3d())
+// Ret:    all-ones lanes for hits
+//---------------------------------------------------------
+template <class T>
+inline T RayIntersectPlane3dSimd(
+    const T ox, const T oy, const T oz,
+    const T dx, const T dy, const T dz,
+    const T tMin, const T tMax,
+    const Plane3d& plane,
+    T& outT)
+{
+    T nx, ny, nz, d, zero;
+    SimdSet1(plane.normal.x, nx);
+    SimdSet1(plane.normal.y, ny);
+    SimdSet1(plane.normal.z, nz);
+    SimdSet1(plane.distance, d);
+    SimdSet1(0.0f,           zero);
+
+    const T dist  = SimdMulAdd(nz, oz, SimdMulAdd(ny, oy, SimdMulAdd(nx, ox, d)));
+    const T denom = SimdMulAdd(nz, dz, SimdMulAdd(ny, dy, SimdMul(nx, dx)));
+
+    // +-inf or NaN for parallel rays, so the range test fails
+    const T t = SimdSub(zero, SimdDiv(dist, denom));
+
+    outT = t;
+    return SimdAnd(SimdCmpGe(t, tMin), SimdCmpLe(t, tMax));
+}
+
+#endif // MATH_SIMD_SSE2
+
+//---------------------------------------------------------
+// Desc:   slab test of the packet against a 3d rectangle
+// Args:   - packet:     rays to test
+//         - rect:       the rectangle to test
+//         - activeMask: lanes to test
+//         - outTNear:   (N floats) entry distances, valid for hit lanes only
+// Ret:    the mask of active rays which hit the rect
+//---------------------------------------------------------
+template <int N>
+inline uint32_t RayPacketIntersectRect3d(
+    const RayPacket<N>& packet,
+    const Rect3d& rect,
+    const uint32_t activeMask,
+    float* outTNear)
+{
+    assert(outTNear != nullptr);
+    uint32_t mask = 0;
+
+#if defined(MATH_SIMD_SSE2)
+    typedef typename RayPacketSimd<N>::Type T;
+    constexpr int W = RayPacketSimd<N>::WIDTH;
+
+    T x0, x1, y0, y1, z0, z1;
+    SimdSet1(rect.x0, x0);  SimdSet1(rect.x1, x1);
+    SimdSet1(rect.y0, y0);  SimdSet1(rect.y1, y1);
+    SimdSet1(rect.z0, z0);  SimdSet1(rect.z1, z1);
+
+    for (int i = 0; i < N; i += W)
+    {
+        // no active rays in this block
+        if (((activeMask >> i) & ((1u << W) - 1)) == 0)
+            continue;
+
+        T ox, oy, oz, ix, iy, iz, tMin, tMax, tNear;
+        SimdLoad(packet.ox + i, ox);  SimdLoad(packet.ix + i, ix);
+        SimdLoad(packet.oy + i, oy);  SimdLoad(packet.iy + i, iy);
+        SimdLoad(packet.oz + i, oz);  SimdLoad(packet.iz + i, iz);
+        SimdLoad(packet.tMin + i, tMin);
+        SimdLoad(packet.tMax + i, tMax);
+
+        const T hit = RayIntersectRect3dSimd(ox, oy, oz, ix, iy, iz, tMin, tMax, x0, x1, y0, y1, z0, z1, tNear);
+
+        SimdStoreu(outTNear + i, tNear);
+        mask |= (uint32_t)SimdMoveMask(hit) << i;
+    }
+#else
+    for (int i = 0; i < N; ++i)
+    {
+        if ((activeMask & (1u << i)) && RayIntersectRect3d(packet.Get(i), rect, outTNear[i]))
+            mask |= (1u << i);
+    }
+#endif
+
+    return mask & activeMask;
+}
+
+//---------------------------------------------------------
+// Desc:   intersection of the packet with a sphere
+// Args:   - outT: (N floats) distances of the nearest intersections
+//                 within [tMin, tMax], valid for hit lanes only
+// Ret:    the mask of active rays which hit the sphere
+//---------------------------------------------------------
+template <int N>
+inline uint32_t RayPacketIntersectSphere(
+    const RayPacket<N>& packet,
+    const Sphere& sphere,
+    const uint32_t activeMask,
+    float* outT)
+{
+    assert(outT != nullptr);
+    uint32_t mask = 0;
+
+#if defined(MATH_SIMD_SSE2)
+    typedef typename RayPacketSimd<N>::Type T;
+    constexpr int W = RayPacketSimd<N>::WIDTH;
+
+    for (int i = 0; i < N; i += W)
+    {
+        if (((activeMask >> i) & ((1u << W) - 1)) == 0)
+            continue;
+
+        T ox, oy, oz, dx, dy, dz, tMin, tMax, t;
+        SimdLoad(packet.ox + i, ox);  SimdLoad(packet.dx + i, dx);
+        SimdLoad(packet.oy + i, oy);  SimdLoad(packet.dy + i, dy);
+        SimdLoad(packet.oz + i, oz);  SimdLoad(packet.dz + i, dz);
+        SimdLoad(packet.tMin + i, tMin);
+        SimdLoad(packet.tMax + i, tMax);
+
+        const T hit = RayIntersectSphereSimd(ox, oy, oz, dx, dy, dz, tMin, tMax, sphere, t);
+
+        SimdStoreu(outT + i, t);
+        mask |= (uint32_t)SimdMoveMask(hit) << i;
+    }
+#else
+    for (int i = 0; i < N; ++i)
+    {
+        if ((activeMask & (1u << i)) && RayIntersectSphere(packet.Get(i), sphere, outT[i]))
+            mask |= (1u << i);
+    }
+#endif
+
+    return mask & activeMask;
+}
+
+//---------------------------------------------------------
+// Desc:   intersection of the packet with a plane (from any side)
+// Args:   - outT: (N floats) distances of intersections, valid for hit lanes only
+// Ret:    the mask of active rays which hit the plane within [tMin, tMax]
+//---------------------------------------------------------
+template <int N>
+inline uint32_t RayPacketIntersectPlane3d(
+    const RayPacket<N>& packet,
+    const Plane3d& plane,
+    const uint32_t activeMask,
+    float* outT)
+{
+    assert(outT != nullptr);
+    uint32_t mask = 0;
+
+#if defined(MATH_SIMD_SSE2)
+    typedef typename RayPacketSimd<N>::Type T;
+    constexpr int W = RayPacketSimd<N>::WIDTH;
+
+    for (int i = 0; i < N; i += W)
+    {
+        if (((activeMask >> i) & ((1u << W) - 1)) == 0)
+            continue;
+
+        T ox, oy, oz, dx, dy, dz, tMin, tMax, t;
+        SimdLoad(packet.ox + i, ox);  SimdLoad(packet.dx + i, dx);
+        SimdLoad(packet.oy + i, oy);  SimdLoad(packet.dy + i, dy);
+        SimdLoad(packet.oz + i, oz);  SimdLoad(packet.dz + i, dz);
+        SimdLoad(packet.tMin + i, tMin);
+        SimdLoad(packet.tMax + i, tMax);
+
+        const T hit = RayIntersectPlane3dSimd(ox, oy, oz, dx, dy, dz, tMin, tMax, plane, t);
+
+        SimdStoreu(outT + i, t);
+        mask |= (uint32_t)SimdMoveMask(hit) << i;
+    }
+#else
+    for (int i = 0; i < N; ++i)
+    {
+        if ((activeMask & (1u << i)) && RayIntersectPlane3d(packet.Get(i), plane, outT[i]))
+            mask |= (1u << i);
+    }
+#endif
+
+    return mask & activeMask;
+}
@@ -121,6 +121,7 @@ public:
     Vec3 MaxPoint() const;
 
     float Volume() const;
+    float SurfaceArea() const;
 
     void Expand(const float n);
     void Expand(const Vec3& size);
@@ -129,6 +130,9 @@ public:
     void ExpandY(const float n);
     void ExpandZ(const float n);
 
+    void Union(const Rect3d& rect);
+    void Union(const Vec3& point);
+
     bool PointInRect(const Vec3& point) const;
 
     //Sphere CreateBoundingSphere() const;
@@ -566,6 +566,17 @@ inline float Rect3d::Volume() const
 
 //---------------------------------------------------------
 
+inline float Rect3d::SurfaceArea() const
+{
+    const float sx = SizeX();
+    const float sy = SizeY();
+    const float sz = SizeZ();
+
+    return 2.0f * (sx*sy + sy*sz + sz*sx);
+}
+
+//---------------------------------------------------------
+
 inline void Rect3d::Expand(const float n)
 {
     ExpandX(n);
@@ -597,6 +608,34 @@ inline void Rect3d::ExpandZ(const float n)
     z1 += n;
 }
 
+//---------------------------------------------------------
+// Desc:   grow the rectangle so it also contains the input one
+//---------------------------------------------------------
+inline void Rect3d::Union(const Rect3d& rect)
+{
+    x0 = (rect.x0 < x0) ? rect.x0 : x0;
+    y0 = (rect.y0 < y0) ? rect.y0 : y0;
+    z0 = (rect.z0 < z0) ? rect.z0 : z0;
+
+    x1 = (rect.x1 > x1) ? rect.x1 : x1;
+    y1 = (rect.y1 > y1) ? rect.y1 : y1;
+    z1 = (rect.z1 > z1) ? rect.z1 : z1;
+}
+
+//---------------------------------------------------------
+// Desc:   grow the rectangle so it also contains the input point
+//---------------------------------------------------------
+inline void Rect3d::Union(const Vec3& p)
+{
+    x0 = (p.x < x0) ? p.x : x0;
+    y0 = (p.y < y0) ? p.y : y0;
+    z0 = (p.z < z0) ? p.z : z0;
+
+    x1 = (p.x > x1) ? p.x : x1;
+    y1 = (p.y > y1) ? p.y : y1;
+    z1 = (p.z > z1) ? p.z : z1;
+}
+
 //---------------------------------------------------------
 
 inline void Rect3d::Expand(const Vec3& size)
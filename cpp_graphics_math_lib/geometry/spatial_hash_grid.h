@@ -0,0 +1,347 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: spatial_hash_grid.h
+    Desc:     uniform grid over points or spheres for neighbour queries
+              (crowds, particles); it is rebuilt from scratch each frame
+
+              - space is divided into cubic cells, each cell is hashed into
+                a table of a power of 2 size (an infinite grid is supported);
+              - the build is a counting sort by the hash: the 1st pass counts
+                items per bucket, a prefix sum gives each bucket its start,
+                the 2nd pass scatters items; nothing is allocated per cell;
+              - items are stored in the bucket order (positions, radii and
+                original indices in separate arrays), so a bucket is read as
+                one contiguous range: [cellStart[h], cellStart[h] + cellCount[h]);
+              - a sphere goes into the cell of its center, queries extend
+                the searched cells by the max radius of items
+
+              The best cell size is about the typical query radius
+
+    Created:  17.10.2026 by DimaSkup
+\**********************************************************************************/
+#pragma once
+
+#include <geometry/sphere.h>
+#include <math/vec3.h>
+#include <math/vec_functions.h>
+#include <math/math_helpers.h>
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <vector>
+
+
+//==================================================================================
+// spatial hash grid
+//==================================================================================
+class SpatialHashGrid
+{
+public:
+    static constexpr uint32_t MIN_TABLE_SIZE = 16;
+
+    //-----------------------------------------------------
+    // public data
+    //-----------------------------------------------------
+    float cellSize    = 1.0f;
+    float invCellSize = 1.0f;
+    float maxRadius   = 0.0f;       // max radius of items
+
+    // buckets of the hash table
+    std::vector<uint32_t> cellStart;
+    std::vector<uint32_t> cellCount;
+    uint32_t              tableMask = 0;
+
+    // items in the bucket order
+    std::vector<Vec3>     positions;
+    std::vector<float>    radii;
+    std::vector<uint32_t> indices;      // original indices
+    std::vector<uint64_t> cellKeys;     // packed cell coords (to skip other cells of a bucket)
+
+    std::vector<uint32_t> itemHashes;   // temp buffer of the build
+
+    //-----------------------------------------------------
+    // constructors, destructor
+    //-----------------------------------------------------
+    explicit SpatialHashGrid(const float gridCellSize = 1.0f);
+
+    //-----------------------------------------------------
+    // build
+    //-----------------------------------------------------
+    void Build(const Vec3* points, const uint32_t numPoints);
+    void Build(const Sphere* spheres, const uint32_t numSpheres);
+    void SetCellSize(const float gridCellSize);
+
+    inline uint32_t GetNumItems() const { return (uint32_t)indices.size(); }
+
+    //-----------------------------------------------------
+    // queries: all of them return the number of found items,
+    // only the first maxCount of them are written into outIndices
+    //-----------------------------------------------------
+    uint32_t QueryRadius(
+        const Vec3& point,
+        const float radius,
+        uint32_t* outIndices,
+        const uint32_t maxCount) const;
+
+    uint32_t QueryRadiusBatch(
+        const Vec3* points,
+        const uint32_t numPoints,
+        const float radius,
+        uint32_t* outIndices,
+        const uint32_t maxCount,
+        uint32_t* outStarts,
+        uint32_t* outCounts) const;
+
+    //-----------------------------------------------------
+    // internal
+    //-----------------------------------------------------
+    int32_t  GetCellCoord(const float x) const { return (int32_t)floorf(x * invCellSize); }
+    uint32_t Hash(const int32_t x, const int32_t y, const int32_t z) const;
+    uint64_t PackCell(const int32_t x, const int32_t y, const int32_t z) const;
+};
+
+
+//==================================================================================
+// INLINE METHODS
+//==================================================================================
+
+//---------------------------------------------------------
+
+inline SpatialHashGrid::SpatialHashGrid(const float gridCellSize)
+{
+    SetCellSize(gridCellSize);
+}
+
+//---------------------------------------------------------
+// Desc:   set the cell size (the grid must be rebuilt after it)
+//---------------------------------------------------------
+inline void SpatialHashGrid::SetCellSize(const float gridCellSize)
+{
+    assert(gridCellSize > 0.0f);
+
+    cellSize    = gridCellSize;
+    invCellSize = 1.0f / gridCellSize;
+}
+
+//---------------------------------------------------------
+// Desc:   hash of a cell (Teschner et al. "Optimized Spatial Hashing
+//         for Collision Detection of Deformable Objects")
+//---------------------------------------------------------
+inline uint32_t SpatialHashGrid::Hash(const int32_t x, const int32_t y, const int32_t z) const
+{
+    const uint32_t h = ((uint32_t)x * 73856093u) ^ ((uint32_t)y * 19349663u) ^ ((uint32_t)z * 83492791u);
+    return h & tableMask;
+}
+
+//---------------------------------------------------------
+// Desc:   cell coords packed into 21 bits each
+//---------------------------------------------------------
+inline uint64_t SpatialHashGrid::PackCell(const int32_t x, const int32_t y, const int32_t z) const
+{
+    constexpr uint64_t mask = (1u << 21) - 1;
+    return (((uint64_t)x & mask) << 42) | (((uint64_t)y & mask) << 21) | ((uint64_t)z & mask);
+}
+
+//---------------------------------------------------------
+// Desc:   center and radius of items of different types
+//---------------------------------------------------------
+inline const Vec3& SpatialHashCenter(const Vec3& point)    { return point; }
+inline const Vec3& SpatialHashCenter(const Sphere& sphere) { return sphere.center; }
+inline float       SpatialHashRadius(const Vec3&)          { return 0.0f; }
+inline float       SpatialHashRadius(const Sphere& sphere) { return sphere.radius; }
+
+//---------------------------------------------------------
+// Desc:   counting sort of items by hashes of their cells
+//         (TItem is Vec3 or Sphere)
+//---------------------------------------------------------
+template <class TItem>
+inline void SpatialHashGridBuild(SpatialHashGrid& grid, const TItem* items, const uint32_t numItems)
+{
+    assert((items != nullptr) || (numItems == 0));
+
+    // the table is at least 2x bigger than the number of items
+    uint32_t tableSize = SpatialHashGrid::MIN_TABLE_SIZE;
+
+    while (tableSize < 2 * numItems)
+        tableSize *= 2;
+
+    grid.tableMask = tableSize - 1;
+
+    grid.cellStart.assign(tableSize, 0);
+    grid.cellCount.assign(tableSize, 0);
+    grid.itemHashes.resize(numItems);
+    grid.positions.resize(numItems);
+    grid.radii.resize(numItems);
+    grid.indices.resize(numItems);
+    grid.cellKeys.resize(numItems);
+
+    // 1st pass: count items of each bucket
+    grid.maxRadius = 0.0f;
+
+    for (uint32_t i = 0; i < numItems; ++i)
+    {
+        const Vec3&    p = SpatialHashCenter(items[i]);
+        const uint32_t h = grid.Hash(grid.GetCellCoord(p.x), grid.GetCellCoord(p.y), grid.GetCellCoord(p.z));
+
+        grid.itemHashes[i] = h;
+        grid.cellCount[h]++;
+        grid.maxRadius = Max(grid.maxRadius, SpatialHashRadius(items[i]));
+    }
+
+    // ends of buckets (the 2nd pass moves them back to starts)
+    uint32_t sum = 0;
+
+    for (uint32_t h = 0; h < tableSize; ++h)
+    {
+        sum += grid.cellCount[h];
+        grid.cellStart[h] = sum;
+    }
+
+    // 2nd pass: scatter in the reverse order, so items of a bucket keep the input order
+    for (uint32_t i = numItems; i-- > 0; )
+    {
+        const uint32_t dst = --grid.cellStart[grid.itemHashes[i]];
+        const Vec3&    p   = SpatialHashCenter(items[i]);
+
+        grid.positions[dst] = p;
+        grid.radii[dst]     = SpatialHashRadius(items[i]);
+        grid.indices[dst]   = i;
+        grid.cellKeys[dst]  = grid.PackCell(grid.GetCellCoord(p.x), grid.GetCellCoord(p.y), grid.GetCellCoord(p.z));
+    }
+}
+
+//---------------------------------------------------------
+// Desc:   build the grid over points / spheres (memory of a previous
+//         build is reused)
+//---------------------------------------------------------
+inline void SpatialHashGrid::Build(const Vec3* points, const uint32_t numPoints)
+{
+    SpatialHashGridBuild(*this, points, numPoints);
+}
+
+inline void SpatialHashGrid::Build(const Sphere* spheres, const uint32_t numSpheres)
+{
+    SpatialHashGridBuild(*this, spheres, numSpheres);
+}
+
+//---------------------------------------------------------
+// Desc:   find items (points or spheres) which intersect the sphere
+//         around the point (dist <= radius + radius of the item)
+//---------------------------------------------------------
+inline uint32_t SpatialHashGrid::QueryRadius(
+    const Vec3& point,
+    const float radius,
+    uint32_t* outIndices,
+    const uint32_t maxCount) const
+{
+    assert((outIndices != nullptr) || (maxCount == 0));
+    assert(radius >= 0.0f);
+
+    if (indices.empty())
+        return 0;
+
+    const float   reach = radius + maxRadius;
+    const int32_t x0    = GetCellCoord(point.x - reach);
+    const int32_t y0    = GetCellCoord(point.y - reach);
+    const int32_t z0    = GetCellCoord(point.z - reach);
+    const int32_t x1    = GetCellCoord(point.x + reach);
+    const int32_t y1    = GetCellCoord(point.y + reach);
+    const int32_t z1    = GetCellCoord(point.z + reach);
+    uint32_t      found = 0;
+
+    auto testItem = [&](const uint32_t i)
+    {
+        const Vec3  d       = positions[i] - point;
+        const float maxDist = radius + radii[i];
+
+        if (Vec3Dot(d, d) > maxDist * maxDist)
+            return;
+
+        if (found < maxCount)
+            outIndices[found] = indices[i];
+        ++found;
+    };
+
+    // the range covers more cells than the table has buckets: a linear scan is cheaper
+    const uint64_t numCells = (uint64_t)(x1 - x0 + 1) * (uint64_t)(y1 - y0 + 1) * (uint64_t)(z1 - z0 + 1);
+
+    if (numCells > cellStart.size())
+    {
+        for (uint32_t i = 0; i < (uint32_t)indices.size(); ++i)
+            testItem(i);
+
+        return found;
+    }
+
+    for (int32_t z = z0; z <= z1; ++z)
+    {
+        for (int32_t y = y0; y <= y1; ++y)
+        {
+            for (int32_t x = x0; x <= x1; ++x)
+            {
+                const uint32_t h     = Hash(x, y, z);
+                const uint32_t first = cellStart[h];
+                const uint32_t last  = first + cellCount[h];
+                const uint64_t key   = PackCell(x, y, z);
+
+                for (uint32_t i = first; i < last; ++i)
+                {
+                    // skip items of another cell with the same hash (it is visited separately)
+                    if (cellKeys[i] == key)
+                        testItem(i);
+                }
+            }
+        }
+    }
+
+    return found;
+}
+
+//---------------------------------------------------------
+// Desc:   QueryRadius() for a lot of points with the same radius; results of
+//         all the queries go one after another into the same buffer
+//         (points in a spatial order, e.g. the grid's own positions,
+//         make the queries much more cache friendly)
+// Args:   - points:     query points
+//         - numPoints:  number of queries
+//         - radius:     query radius
+//         - outIndices: results of all the queries
+//         - maxCount:   size of outIndices
+//         - outStarts:  (numPoints) where results of each query start in outIndices
+//         - outCounts:  (numPoints) number of items found by each query
+//                       (the written ones may be fewer if outIndices is full)
+// Ret:    total number of found items
+//---------------------------------------------------------
+inline uint32_t SpatialHashGrid::QueryRadiusBatch(
+    const Vec3* points,
+    const uint32_t numPoints,
+    const float radius,
+    uint32_t* outIndices,
+    const uint32_t maxCount,
+    uint32_t* outStarts,
+    uint32_t* outCounts) const
+{
+    assert((points != nullptr) || (numPoints == 0));
+    assert((outStarts != nullptr && outCounts != nullptr) || (numPoints == 0));
+
+    uint32_t total = 0;
+
+    for (uint32_t i = 0; i < numPoints; ++i)
+    {
+        const uint32_t start = Min(total, maxCount);
+
+        outStarts[i] = start;
+        outCounts[i] = QueryRadius(points[i], radius, outIndices + start, maxCount - start);
+        total       += outCounts[i];
+    }
+
+    return total;
+}
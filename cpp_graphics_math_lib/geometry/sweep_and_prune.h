@@ -0,0 +1,360 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: sweep_and_prune.h
+    Desc:     sweep-and-prune broadphase over Rect3d: finds all the pairs of
+              overlapping boxes without testing each box against each other
+
+              - min/max endpoints of boxes are kept sorted along 1 axis (x)
+                or along all the 3 axes;
+              - objects move a bit between frames, so the arrays are almost
+                sorted: they are re-sorted by an insertion sort which is
+                close to O(n) in this case;
+              - a sweep over the endpoints keeps a list of "active" boxes
+                (the min is passed, the max isn't): a new box overlaps the
+                active ones along the sweep axis, so only the other axes
+                are tested (by SIMD, right from the Rect3d layout);
+              - with 3 sorted axes each frame is swept along the axis with
+                the biggest spread of boxes (the fewest false candidates)
+
+              Found pairs go into a buffer which is reused from frame to frame
+
+    Created:  17.10.2026 by DimaSkup
+\**********************************************************************************/
+#pragma once
+
+#include <geometry/rect_3d.h>
+#include <geometry/intersection_tests.h>
+#include <math/simd.h>
+#include <assert.h>
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+
+
+//==================================================================================
+// endpoint of a box along some axis
+//==================================================================================
+struct SapEndpoint
+{
+    float    value = 0;
+    uint32_t data  = 0;      // (object index << 1) | isMax
+
+    inline uint32_t GetObject() const { return data >> 1; }
+    inline uint32_t IsMax()     const { return data & 1; }
+
+    // at equal values mins go first, so touching boxes overlap
+    inline bool operator < (const SapEndpoint& rhs) const
+    {
+        return (value < rhs.value) || (value == rhs.value && IsMax() < rhs.IsMax());
+    }
+};
+
+//---------------------------------------------------------
+
+struct SapPair
+{
+    uint32_t a = 0;          // a < b
+    uint32_t b = 0;
+};
+
+
+//==================================================================================
+// sweep-and-prune broadphase
+//==================================================================================
+class SweepAndPrune
+{
+public:
+
+    //-----------------------------------------------------
+    // public data
+    //-----------------------------------------------------
+    std::vector<Rect3d>      bounds;              // copy of the input boxes
+    std::vector<SapEndpoint> endpoints[3];        // 2 endpoints per object for each sorted axis
+    std::vector<SapPair>     pairs;               // result of the last FindPairs()
+
+    int      numSortedAxes = 1;                   // 1 (only x) or 3
+    int      sweepAxis     = 0;                   // the axis of the last sweep
+    uint32_t numSwaps      = 0;                   // swaps of the last insertion sort (for stats)
+
+    // the sweep state
+    std::vector<uint32_t> active;                 // active objects
+    std::vector<uint32_t> activePos;              // position of each object in the active list
+
+    //-----------------------------------------------------
+    // constructors, destructor
+    //-----------------------------------------------------
+    explicit SweepAndPrune(const int sortedAxes = 1);
+
+    //-----------------------------------------------------
+    // methods
+    //-----------------------------------------------------
+    void     Update(const Rect3d* newBounds, const uint32_t numObjects);
+    uint32_t FindPairs();
+    void     Clear();
+
+    inline uint32_t GetNumObjects() const { return (uint32_t)bounds.size(); }
+
+    //-----------------------------------------------------
+    // internal
+    //-----------------------------------------------------
+    void Rebuild();
+    void ChooseSweepAxis();
+};
+
+
+//==================================================================================
+// INLINE FUNCTIONS
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:   min (isMax == 0) or max (isMax == 1) of the rect along the axis;
+//         reads Rect3d as the array (x0, x1, y0, y1, z0, z1)
+//---------------------------------------------------------
+inline float SapGetEndpoint(const Rect3d& rect, const int axis, const uint32_t isMax)
+{
+    return (&rect.x0)[2 * axis + isMax];
+}
+
+//---------------------------------------------------------
+// Desc:   overlap test of two boxes (touching counts as overlap);
+//         the SIMD version loads (x0, x1, y0, y1) and (z0, z1) of each box
+//         as is and compares a with the swapped b: (b.x1, b.x0, b.y1, b.y0):
+//         even lanes must be <=, odd lanes must be >=
+//---------------------------------------------------------
+inline bool SapOverlap(const Rect3d& a, const Rect3d& b)
+{
+#if defined(MATH_SIMD_SSE2)
+    const __m128 zero = _mm_setzero_ps();
+
+    const __m128 a01 = _mm_loadu_ps(&a.x0);
+    const __m128 b01 = _mm_loadu_ps(&b.x0);
+    const __m128 a2  = _mm_loadl_pi(zero, (const __m64*)&a.z0);
+    const __m128 b2  = _mm_loadl_pi(zero, (const __m64*)&b.z0);
+
+    const __m128 bSwap01 = _mm_shuffle_ps(b01, b01, _MM_SHUFFLE(2, 3, 0, 1));
+    const __m128 bSwap2  = _mm_shuffle_ps(b2,  b2,  _MM_SHUFFLE(2, 3, 0, 1));
+
+    const int mask01 = (SimdMoveMask(SimdCmpLe(a01, bSwap01)) & 0x5) | (SimdMoveMask(SimdCmpGe(a01, bSwap01)) & 0xA);
+    const int mask2  = (SimdMoveMask(SimdCmpLe(a2,  bSwap2))  & 0x1) | (SimdMoveMask(SimdCmpGe(a2,  bSwap2))  & 0x2);
+
+    return (mask01 == 0xF) && (mask2 == 0x3);
+#else
+    return OverlapRect3d(a, b);
+#endif
+}
+
+//---------------------------------------------------------
+// Desc:   sort endpoints by insertion; the cost is O(n + number of swaps),
+//         so it is almost linear for the arrays from the previous frame
+// Ret:    number of swaps
+//---------------------------------------------------------
+inline uint32_t SapInsertionSort(SapEndpoint* endpoints, const uint32_t count)
+{
+    uint32_t numSwaps = 0;
+
+    for (uint32_t i = 1; i < count; ++i)
+    {
+        const SapEndpoint key = endpoints[i];
+        uint32_t          j   = i;
+
+        while (j > 0 && key < endpoints[j - 1])
+        {
+            endpoints[j] = endpoints[j - 1];
+            --j;
+        }
+
+        numSwaps += (i - j);
+        endpoints[j] = key;
+    }
+
+    return numSwaps;
+}
+
+//---------------------------------------------------------
+
+inline SweepAndPrune::SweepAndPrune(const int sortedAxes)
+{
+    assert(sortedAxes == 1 || sortedAxes == 3);
+    numSortedAxes = sortedAxes;
+}
+
+//---------------------------------------------------------
+
+inline void SweepAndPrune::Clear()
+{
+    bounds.clear();
+    pairs.clear();
+    active.clear();
+    activePos.clear();
+
+    for (int axis = 0; axis < 3; ++axis)
+        endpoints[axis].clear();
+
+    sweepAxis = 0;
+    numSwaps  = 0;
+}
+
+//---------------------------------------------------------
+// Desc:   set new bounds of objects (once per frame); if the number of objects
+//         is the same, the sorted arrays of the previous frame are updated and
+//         re-sorted by insertion, otherwise they are built from scratch
+// Args:   - newBounds:  bounds of objects, an object is referred by its index
+//         - numObjects: number of objects
+//---------------------------------------------------------
+inline void SweepAndPrune::Update(const Rect3d* newBounds, const uint32_t numObjects)
+{
+    assert((newBounds != nullptr) || (numObjects == 0));
+
+    const bool isSameCount = (numObjects == GetNumObjects());
+
+    bounds.assign(newBounds, newBounds + numObjects);
+
+    if (!isSameCount)
+    {
+        Rebuild();
+        ChooseSweepAxis();
+        return;
+    }
+
+    numSwaps = 0;
+
+    for (int axis = 0; axis < numSortedAxes; ++axis)
+    {
+        std::vector<SapEndpoint>& axisEndpoints = endpoints[axis];
+
+        // refresh values and keep the old order
+        for (SapEndpoint& endpoint : axisEndpoints)
+            endpoint.value = SapGetEndpoint(bounds[endpoint.GetObject()], axis, endpoint.IsMax());
+
+        numSwaps += SapInsertionSort(axisEndpoints.data(), (uint32_t)axisEndpoints.size());
+    }
+
+    ChooseSweepAxis();
+}
+
+//---------------------------------------------------------
+// Desc:   build sorted endpoint arrays from scratch
+//---------------------------------------------------------
+inline void SweepAndPrune::Rebuild()
+{
+    const uint32_t numObjects = GetNumObjects();
+
+    for (int axis = 0; axis < 3; ++axis)
+        endpoints[axis].clear();
+
+    for (int axis = 0; axis < numSortedAxes; ++axis)
+    {
+        std::vector<SapEndpoint>& axisEndpoints = endpoints[axis];
+        axisEndpoints.resize(2 * numObjects);
+
+        for (uint32_t i = 0; i < 2 * numObjects; ++i)
+        {
+            axisEndpoints[i].data  = i;
+            axisEndpoints[i].value = SapGetEndpoint(bounds[i >> 1], axis, i & 1);
+        }
+
+        std::sort(axisEndpoints.begin(), axisEndpoints.end());
+    }
+
+    activePos.resize(numObjects);
+    numSwaps = 0;
+}
+
+//---------------------------------------------------------
+// Desc:   with 3 sorted axes choose the axis with the biggest variance
+//         of box centers (boxes overlap along it less often)
+//---------------------------------------------------------
+inline void SweepAndPrune::ChooseSweepAxis()
+{
+    sweepAxis = 0;
+
+    if (numSortedAxes == 1 || bounds.empty())
+        return;
+
+    float sum[3]    = { 0, 0, 0 };
+    float sqrSum[3] = { 0, 0, 0 };
+
+    for (const Rect3d& rect : bounds)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            const float c = SapGetEndpoint(rect, axis, 0) + SapGetEndpoint(rect, axis, 1);
+
+            sum[axis]    += c;
+            sqrSum[axis] += c * c;
+        }
+    }
+
+    // n * variance (of doubled centers) is enough for the comparison
+    const float invNum  = 1.0f / (float)bounds.size();
+    float       bestVar = -1.0f;
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const float var = sqrSum[axis] - sum[axis] * sum[axis] * invNum;
+
+        if (var > bestVar)
+        {
+            bestVar   = var;
+            sweepAxis = axis;
+        }
+    }
+}
+
+//---------------------------------------------------------
+// Desc:   sweep along the sorted endpoints and find all the pairs of
+//         overlapping boxes
+// Ret:    number of found pairs (they are in the pairs array)
+//---------------------------------------------------------
+inline uint32_t SweepAndPrune::FindPairs()
+{
+    const std::vector<SapEndpoint>& axisEndpoints = endpoints[sweepAxis];
+
+    // keep the capacity of the previous frame
+    pairs.clear();
+    active.clear();
+
+    for (const SapEndpoint& endpoint : axisEndpoints)
+    {
+        const uint32_t obj = endpoint.GetObject();
+
+        if (endpoint.IsMax())
+        {
+            // remove the object from the active list (swap with the last one)
+            const uint32_t pos  = activePos[obj];
+            const uint32_t last = active.back();
+
+            active[pos]     = last;
+            activePos[last] = pos;
+            active.pop_back();
+            continue;
+        }
+
+        // a new box overlaps all the active ones along the sweep axis
+        const Rect3d& rect = bounds[obj];
+
+        for (const uint32_t other : active)
+        {
+            if (!SapOverlap(rect, bounds[other]))
+                continue;
+
+            SapPair pair;
+            pair.a = (obj < other) ? obj : other;
+            pair.b = (obj < other) ? other : obj;
+            pairs.push_back(pair);
+        }
+
+        activePos[obj] = (uint32_t)active.size();
+        active.push_back(obj);
+    }
+
+    return (uint32_t)pairs.size();
+}
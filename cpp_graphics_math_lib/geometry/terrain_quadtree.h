@@ -0,0 +1,361 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: terrain_quadtree.h
+    Desc:     chunked LOD quadtree over a square heightfield
+
+              - each node is a chunk of (chunkSize x chunkSize) quads; a node
+                of the level L takes each 2^(maxLevel-L)-th sample, so the
+                root is the coarsest chunk and leaves are full resolution;
+              - a node carries its Rect3d bounds (min/max heights of its
+                area) and its geometric error: max vertical distance between
+                the full-resolution heights and the chunk surface (it is
+                never smaller than errors of children);
+              - per frame one traversal both culls nodes by the frustum and
+                selects LOD: a visible node is drawn if its error projected
+                on the screen is small enough, otherwise its children are
+                visited
+
+              Cracks between chunks of different levels are not handled here
+              (use skirts or stitching in the renderer)
+
+    Created:  17.10.2026 by DimaSkup
+\**********************************************************************************/
+#pragma once
+
+#include <geometry/frustum.h>
+#include <geometry/rect_3d.h>
+#include <geometry/rect_3d_functions.h>
+#include <math/matrix.h>
+#include <math/math_helpers.h>
+#include <math/vec3.h>
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <vector>
+
+
+//==================================================================================
+// terrain quadtree node
+//==================================================================================
+struct TerrainQuadtreeNode
+{
+    Rect3d   bounds;                  // x/z: the chunk area, y: min/max heights in it
+    float    geometricError = 0;      // in world units
+
+    // 4 children are stored together: [firstChild, firstChild + 4) (0 for leaves)
+    uint32_t firstChild     = 0;
+
+    // the first sample of the chunk and the level (step btw samples is 2^(maxLevel-level))
+    uint32_t sampleX        = 0;
+    uint32_t sampleZ        = 0;
+    uint32_t level          = 0;
+
+    inline bool IsLeaf() const { return firstChild == 0; }
+};
+
+
+//==================================================================================
+// terrain quadtree
+//==================================================================================
+class TerrainQuadtree
+{
+public:
+    static constexpr uint32_t MAX_LEVELS = 16;
+    static constexpr int      STACK_SIZE = 3 * MAX_LEVELS + 4;    // max size of a traversal stack
+
+    //-----------------------------------------------------
+    // public data
+    //-----------------------------------------------------
+    std::vector<TerrainQuadtreeNode> nodes;    // nodes[0] is the root
+
+    uint32_t numSamples = 0;                   // per side of the heightfield
+    uint32_t chunkSize  = 0;                   // quads per side of a chunk
+    uint32_t numLevels  = 0;
+    Vec3     origin;                           // world position of the sample (0, 0)
+    float    spacing    = 1;                   // distance btw neighbour samples
+
+    //-----------------------------------------------------
+    // methods
+    //-----------------------------------------------------
+    void Build(
+        const float* heights,
+        const uint32_t samplesPerSide,
+        const uint32_t quadsPerChunk,
+        const Vec3& terrainOrigin,
+        const float sampleSpacing);
+
+    void Clear();
+
+    inline bool IsEmpty() const { return nodes.empty(); }
+
+    uint32_t SelectLod(
+        const Frustum& frustum,
+        const Vec3& cameraPos,
+        const float sseFactor,
+        const float maxScreenError,
+        uint32_t* outNodes,
+        const uint32_t maxCount) const;
+
+    //-----------------------------------------------------
+    // internal
+    //-----------------------------------------------------
+    void BuildNode(
+        const uint32_t nodeIdx,
+        const float* heights,
+        const uint32_t sampleX,
+        const uint32_t sampleZ,
+        const uint32_t level);
+};
+
+
+//==================================================================================
+// INLINE FUNCTIONS
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:   factor to convert an error in world units at the distance 1
+//         into pixels: viewportHeight / (2 * tan(fov/2))
+// Args:   - proj:           projection matrix (see MatrixProjectionLH)
+//         - viewportHeight: in pixels
+//---------------------------------------------------------
+inline float TerrainSseFactor(const Matrix& proj, const float viewportHeight)
+{
+    // m11 = 1 / tan(fov/2)
+    return 0.5f * viewportHeight * proj.m11;
+}
+
+//---------------------------------------------------------
+// Desc:   squared distance from a point to the closest point of a rect
+//         (0 if the point is inside)
+//---------------------------------------------------------
+inline float TerrainSqrDistToRect(const Vec3& p, const Rect3d& rect)
+{
+    const float dx = Max(Max(rect.x0 - p.x, 0.0f), p.x - rect.x1);
+    const float dy = Max(Max(rect.y0 - p.y, 0.0f), p.y - rect.y1);
+    const float dz = Max(Max(rect.z0 - p.z, 0.0f), p.z - rect.z1);
+
+    return dx*dx + dy*dy + dz*dz;
+}
+
+//---------------------------------------------------------
+// Desc:   build the tree over the heightfield
+// Args:   - heights:        samplesPerSide^2 heights in world units
+//                           (row by row along z: heights[z * samplesPerSide + x])
+//         - samplesPerSide: must be quadsPerChunk * 2^n + 1
+//         - quadsPerChunk:  quads per side of a chunk
+//         - terrainOrigin:  world position of the sample (0, 0) at the height 0
+//         - sampleSpacing:  distance btw neighbour samples
+//---------------------------------------------------------
+inline void TerrainQuadtree::Build(
+    const float* heights,
+    const uint32_t samplesPerSide,
+    const uint32_t quadsPerChunk,
+    const Vec3& terrainOrigin,
+    const float sampleSpacing)
+{
+    assert(heights != nullptr);
+    assert(quadsPerChunk > 0 && sampleSpacing > 0.0f);
+
+    Clear();
+
+    numSamples = samplesPerSide;
+    chunkSize  = quadsPerChunk;
+    origin     = terrainOrigin;
+    spacing    = sampleSpacing;
+
+    // number of levels: the root covers the whole heightfield
+    const uint32_t numChunks = (numSamples - 1) / chunkSize;
+    numLevels = 1;
+
+    while ((1u << (numLevels - 1)) < numChunks)
+        ++numLevels;
+
+    assert((numSamples - 1) == (chunkSize << (numLevels - 1)) && "numSamples must be chunkSize * 2^n + 1");
+    assert(numLevels <= MAX_LEVELS);
+
+    // 4^0 + 4^1 + ... nodes
+    size_t numNodes = 0;
+    for (uint32_t i = 0; i < numLevels; ++i)
+        numNodes += (size_t)1 << (2 * i);
+
+    nodes.reserve(numNodes);
+    nodes.resize(1);
+
+    BuildNode(0, heights, 0, 0, 0);
+}
+
+//---------------------------------------------------------
+
+inline void TerrainQuadtree::Clear()
+{
+    nodes.clear();
+    numSamples = 0;
+    numLevels  = 0;
+}
+
+//---------------------------------------------------------
+// Desc:   compute bounds and the error of the node and build its subtree
+//---------------------------------------------------------
+inline void TerrainQuadtree::BuildNode(
+    const uint32_t nodeIdx,
+    const float* heights,
+    const uint32_t sampleX,
+    const uint32_t sampleZ,
+    const uint32_t level)
+{
+    const uint32_t step   = 1u << (numLevels - 1 - level);
+    const uint32_t extent = chunkSize * step;             // in samples
+
+    float minH   = heights[sampleZ * numSamples + sampleX];
+    float maxH   = minH;
+    float errMax = 0.0f;
+
+    // compare each sample with the bilinear surface of the chunk grid
+    for (uint32_t z = sampleZ; z <= sampleZ + extent; ++z)
+    {
+        const uint32_t z0 = sampleZ + Min((z - sampleZ) / step, chunkSize - 1) * step;
+        const float    tz = (float)(z - z0) / (float)step;
+
+        for (uint32_t x = sampleX; x <= sampleX + extent; ++x)
+        {
+            const float h = heights[z * numSamples + x];
+
+            minH = Min(minH, h);
+            maxH = Max(maxH, h);
+
+            if (step == 1)
+                continue;
+
+            const uint32_t x0 = sampleX + Min((x - sampleX) / step, chunkSize - 1) * step;
+            const float    tx = (float)(x - x0) / (float)step;
+
+            const float h00 = heights[z0 * numSamples + x0];
+            const float h10 = heights[z0 * numSamples + x0 + step];
+            const float h01 = heights[(z0 + step) * numSamples + x0];
+            const float h11 = heights[(z0 + step) * numSamples + x0 + step];
+
+            const float hz0    = h00 + (h10 - h00) * tx;
+            const float hz1    = h01 + (h11 - h01) * tx;
+            const float approx = hz0 + (hz1 - hz0) * tz;
+
+            errMax = Max(errMax, fabsf(h - approx));
+        }
+    }
+
+    uint32_t firstChild = 0;
+
+    if (level + 1 < numLevels)
+    {
+        firstChild = (uint32_t)nodes.size();
+        nodes.resize(firstChild + 4);
+
+        const uint32_t half = extent / 2;
+
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            BuildNode(firstChild + c, heights, sampleX + (c & 1) * half, sampleZ + (c >> 1) * half, level + 1);
+
+            // the error of a parent is never smaller than errors of its children,
+            // so the selected LOD doesn't jump back and forth along the tree
+            errMax = Max(errMax, nodes[firstChild + c].geometricError);
+        }
+    }
+
+    TerrainQuadtreeNode& node = nodes[nodeIdx];
+
+    node.bounds = Rect3d(
+        origin.x + spacing * sampleX,  origin.x + spacing * (sampleX + extent),
+        origin.y + minH,               origin.y + maxH,
+        origin.z + spacing * sampleZ,  origin.z + spacing * (sampleZ + extent));
+
+    node.geometricError = errMax;
+    node.firstChild     = firstChild;
+    node.sampleX        = sampleX;
+    node.sampleZ        = sampleZ;
+    node.level          = level;
+}
+
+//---------------------------------------------------------
+// Desc:   select chunks to render: a single traversal culls nodes by the
+//         frustum (with plane masks) and stops at nodes which projected
+//         error is small enough (error * sseFactor / distance <= maxScreenError)
+// Args:   - frustum:        the view frustum in world space
+//         - cameraPos:      the camera position in world space
+//         - sseFactor:      see TerrainSseFactor()
+//         - maxScreenError: allowed error in pixels
+//         - outNodes:       indices of selected nodes
+//         - maxCount:       size of the output buffer
+// Ret:    the number of selected nodes (only the first maxCount are written)
+//---------------------------------------------------------
+inline uint32_t TerrainQuadtree::SelectLod(
+    const Frustum& frustum,
+    const Vec3& cameraPos,
+    const float sseFactor,
+    const float maxScreenError,
+    uint32_t* outNodes,
+    const uint32_t maxCount) const
+{
+    assert((outNodes != nullptr) || (maxCount == 0));
+    assert(sseFactor > 0.0f && maxScreenError >= 0.0f);
+
+    if (IsEmpty())
+        return 0;
+
+    struct StackItem
+    {
+        uint32_t nodeIdx;
+        uint32_t planesMask;
+    };
+
+    StackItem stack[STACK_SIZE];
+    int       sp              = 0;
+    int       lastRejectPlane = -1;
+    uint32_t  found           = 0;
+
+    stack[sp].nodeIdx    = 0;
+    stack[sp].planesMask = Frustum::ALL_PLANES_MASK;
+    ++sp;
+
+    while (sp > 0)
+    {
+        --sp;
+        const uint32_t             nodeIdx   = stack[sp].nodeIdx;
+        const TerrainQuadtreeNode& node      = nodes[nodeIdx];
+        uint32_t                   childMask = 0;
+
+        if (frustum.ClassifyRect(node.bounds, stack[sp].planesMask, childMask, lastRejectPlane) == Frustum::CULL_OUTSIDE)
+            continue;
+
+        // error * sseFactor / dist <= maxScreenError (compared squared, without a division)
+        const float screenError = node.geometricError * sseFactor;
+        const float allowed     = maxScreenError * maxScreenError * TerrainSqrDistToRect(cameraPos, node.bounds);
+        const bool  isDetailed  = (screenError * screenError <= allowed);
+
+        if (isDetailed || node.IsLeaf())
+        {
+            if (found < maxCount)
+                outNodes[found] = nodeIdx;
+            ++found;
+            continue;
+        }
+
+        // push children in reverse, so they are visited in order
+        for (int c = 3; c >= 0; --c)
+        {
+            assert(sp < STACK_SIZE);
+            stack[sp].nodeIdx    = node.firstChild + c;
+            stack[sp].planesMask = childMask;
+            ++sp;
+        }
+    }
+
+    return found;
+}
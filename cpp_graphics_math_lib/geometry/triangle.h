@@ -0,0 +1,479 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: triangle.h
+    Desc:     a triangle, a block of 8 triangles in SoA form and
+              ray-triangle intersections:
+
+              - Moller-Trumbore (fast): for a single triangle and for
+                8 triangles at once (the nearest hit of the block);
+              - watertight (Woop, Benthin, Wald "Watertight Ray/Triangle
+                Intersection", 2013): a ray never slips between triangles
+                which share an edge or a vertex (edge functions are
+                computed in double precision); slower, for bakes
+
+              Both tests are two-sided. Barycentrics (u, v) of a hit give
+              the point (1 - u - v) * v0 + u * v1 + v * v2
+
+              NOTE: a block stores edges instead of vertices, so it is only
+              used by Moller-Trumbore: the watertight test needs the same
+              vertices for neighbour triangles (v0 + e1 may differ from v1)
+
+    Created:  17.10.2026 by DimaSkup
+\**********************************************************************************/
+#pragma once
+
+#include <geometry/ray.h>
+#include <geometry/rect_3d.h>
+#include <math/vec3.h>
+#include <math/vec_functions.h>
+#include <math/math_helpers.h>
+#include <math/simd.h>
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+
+
+//==================================================================================
+// triangle
+//==================================================================================
+class Triangle
+{
+public:
+
+    //-----------------------------------------------------
+    // public data
+    //-----------------------------------------------------
+    Vec3 v0 = { 0,0,0 };
+    Vec3 v1 = { 0,0,0 };
+    Vec3 v2 = { 0,0,0 };
+
+    //-----------------------------------------------------
+    // constructors, destructor
+    //-----------------------------------------------------
+    Triangle() {};
+    Triangle(const Vec3& _v0, const Vec3& _v1, const Vec3& _v2) : v0(_v0), v1(_v1), v2(_v2) {}
+
+    //-----------------------------------------------------
+    // methods
+    //-----------------------------------------------------
+
+    // (v1 - v0) x (v2 - v0): in the left-handed system the vertices are
+    // clockwise when looked at from the side the normal points to (the same
+    // as for Plane3d(v0, v1, v2)); not normalized, its length is 2 * area
+    inline Vec3 GetNormal() const { return Vec3Cross(v1 - v0, v2 - v0); }
+
+    inline Vec3 GetPoint(const float u, const float v) const
+    {
+        return v0 * (1.0f - u - v) + v1 * u + v2 * v;
+    }
+
+    Rect3d GetBounds() const;
+};
+
+
+//==================================================================================
+// 8 triangles in SoA form: the first vertex and two edges
+// (unused lanes are left zero: degenerate triangles are never hit)
+//==================================================================================
+struct alignas(32) Trianglex8
+{
+    float v0x[8]{ 0 };
+    float v0y[8]{ 0 };
+    float v0z[8]{ 0 };
+    float e1x[8]{ 0 };          // v1 - v0
+    float e1y[8]{ 0 };
+    float e1z[8]{ 0 };
+    float e2x[8]{ 0 };          // v2 - v0
+    float e2y[8]{ 0 };
+    float e2z[8]{ 0 };
+
+    void     Set(const int lane, const Triangle& tri);
+    Triangle Get(const int lane) const;
+    void     SetTriangles(const Triangle* tris, const int numTris);
+};
+
+
+//==================================================================================
+// result of a ray-triangle test
+//==================================================================================
+struct TriangleHit
+{
+    float t     = FLT_MAX;
+    float u     = 0.0f;         // barycentrics of v1 and v2
+    float v     = 0.0f;
+    int   index = -1;           // the hit triangle (-1 if there is no hit)
+};
+
+
+//==================================================================================
+// INLINE FUNCTIONS
+//==================================================================================
+
+//---------------------------------------------------------
+
+inline Rect3d Triangle::GetBounds() const
+{
+    return Rect3d(
+        Min(Min(v0.x, v1.x), v2.x), Max(Max(v0.x, v1.x), v2.x),
+        Min(Min(v0.y, v1.y), v2.y), Max(Max(v0.y, v1.y), v2.y),
+        Min(Min(v0.z, v1.z), v2.z), Max(Max(v0.z, v1.z), v2.z));
+}
+
+//---------------------------------------------------------
+
+inline void Trianglex8::Set(const int lane, const Triangle& tri)
+{
+    assert(lane >= 0 && lane < 8);
+
+    const Vec3 e1 = tri.v1 - tri.v0;
+    const Vec3 e2 = tri.v2 - tri.v0;
+
+    v0x[lane] = tri.v0.x;  v0y[lane] = tri.v0.y;  v0z[lane] = tri.v0.z;
+    e1x[lane] = e1.x;      e1y[lane] = e1.y;      e1z[lane] = e1.z;
+    e2x[lane] = e2.x;      e2y[lane] = e2.y;      e2z[lane] = e2.z;
+}
+
+//---------------------------------------------------------
+
+inline Triangle Trianglex8::Get(const int lane) const
+{
+    assert(lane >= 0 && lane < 8);
+
+    const Vec3 v0(v0x[lane], v0y[lane], v0z[lane]);
+    return Triangle(v0,
+                    v0 + Vec3(e1x[lane], e1y[lane], e1z[lane]),
+                    v0 + Vec3(e2x[lane], e2y[lane], e2z[lane]));
+}
+
+//---------------------------------------------------------
+// Desc:   fill the block with up to 8 triangles, the rest lanes are degenerate
+//---------------------------------------------------------
+inline void Trianglex8::SetTriangles(const Triangle* tris, const int numTris)
+{
+    assert(tris != nullptr);
+    assert(numTris >= 0 && numTris <= 8);
+
+    for (int i = 0; i < numTris; ++i)
+        Set(i, tris[i]);
+
+    for (int i = numTris; i < 8; ++i)
+        Set(i, Triangle());
+}
+
+//---------------------------------------------------------
+// Desc:   Moller-Trumbore test by the first vertex and edges of a triangle;
+//         a ray parallel to the triangle (det == 0) gives NaN/inf, so it fails
+//         the range tests
+// Ret:    true if the ray hits the triangle within [ray.tMin, ray.tMax]
+//---------------------------------------------------------
+inline bool RayIntersectTriangle(
+    const Ray& ray,
+    const Vec3& v0,
+    const Vec3& e1,
+    const Vec3& e2,
+    float& t,
+    float& u,
+    float& v)
+{
+    const Vec3  p      = Vec3Cross(ray.dir, e2);
+    const float invDet = 1.0f / Vec3Dot(e1, p);
+
+    const Vec3 s = ray.origin - v0;
+    u = Vec3Dot(s, p) * invDet;
+
+    if (!(u >= 0.0f && u <= 1.0f))
+        return false;
+
+    const Vec3 q = Vec3Cross(s, e1);
+    v = Vec3Dot(ray.dir, q) * invDet;
+
+    if (!(v >= 0.0f && u + v <= 1.0f))
+        return false;
+
+    t = Vec3Dot(e2, q) * invDet;
+    return (t >= ray.tMin) && (t <= ray.tMax);
+}
+
+//---------------------------------------------------------
+// Desc:   Moller-Trumbore ray-triangle test
+// Args:   - t:    output distance along the ray
+//         - u, v: output barycentrics of v1 and v2
+//---------------------------------------------------------
+inline bool RayIntersectTriangle(const Ray& ray, const Triangle& tri, float& t, float& u, float& v)
+{
+    return RayIntersectTriangle(ray, tri.v0, tri.v1 - tri.v0, tri.v2 - tri.v0, t, u, v);
+}
+
+//---------------------------------------------------------
+// Desc:   watertight ray-triangle test: vertices are moved into the space
+//         of the ray (the ray goes along +z from the origin), so the test
+//         becomes a 2d test of the origin against edges of the projected
+//         triangle; a shared edge gives the same edge function for both
+//         triangles, so a ray through it always hits one of them
+// Args:   - t:    output distance along the ray
+//         - u, v: output barycentrics of v1 and v2
+//---------------------------------------------------------
+inline bool RayIntersectTriangleWatertight(const Ray& ray, const Triangle& tri, float& t, float& u, float& v)
+{
+    const float* dir = &ray.dir.x;
+
+    // kz - the axis where the direction is the biggest, the winding is kept
+    const float ax = fabsf(ray.dir.x);
+    const float ay = fabsf(ray.dir.y);
+    const float az = fabsf(ray.dir.z);
+
+    const int kz = (ax > ay) ? ((ax > az) ? 0 : 2) : ((ay > az) ? 1 : 2);
+    int       kx = (kz + 1) % 3;
+    int       ky = (kx + 1) % 3;
+
+    if (dir[kz] < 0.0f)
+    {
+        const int tmp = kx;
+        kx = ky;
+        ky = tmp;
+    }
+
+    // shear constants
+    const float sx = dir[kx] / dir[kz];
+    const float sy = dir[ky] / dir[kz];
+    const float sz = 1.0f / dir[kz];
+
+    // vertices relative to the origin
+    const Vec3   a  = tri.v0 - ray.origin;
+    const Vec3   b  = tri.v1 - ray.origin;
+    const Vec3   c  = tri.v2 - ray.origin;
+    const float* pa = &a.x;
+    const float* pb = &b.x;
+    const float* pc = &c.x;
+
+    // shear and scale of vertices
+    const float axs = pa[kx] - sx * pa[kz];
+    const float ays = pa[ky] - sy * pa[kz];
+    const float bxs = pb[kx] - sx * pb[kz];
+    const float bys = pb[ky] - sy * pb[kz];
+    const float cxs = pc[kx] - sx * pc[kz];
+    const float cys = pc[ky] - sy * pc[kz];
+
+    // scaled barycentrics (edge functions): always in double precision,
+    // a product of floats is exact there, so a shared edge gives exactly
+    // the negated value for the neighbour triangle even if the compiler
+    // fuses multiply-adds (a fused float product would be rounded differently)
+    const float U = (float)((double)cxs * (double)bys - (double)cys * (double)bxs);
+    const float V = (float)((double)axs * (double)cys - (double)ays * (double)cxs);
+    const float W = (float)((double)bxs * (double)ays - (double)bys * (double)axs);
+
+    // the origin must be on the same side of all the edges (two-sided)
+    if ((U < 0.0f || V < 0.0f || W < 0.0f) && (U > 0.0f || V > 0.0f || W > 0.0f))
+        return false;
+
+    const float det = U + V + W;
+
+    if (det == 0.0f)
+        return false;
+
+    // distance along the ray
+    const float T      = sz * (U * pa[kz] + V * pb[kz] + W * pc[kz]);
+    const float invDet = 1.0f / det;
+
+    t = T * invDet;
+    u = V * invDet;
+    v = W * invDet;
+
+    return (t >= ray.tMin) && (t <= ray.tMax);
+}
+
+
+#if defined(MATH_SIMD_SSE2)
+
+//---------------------------------------------------------
+// Desc:   Vec3Cross() and Vec3Dot() for vectors in SoA registers
+//---------------------------------------------------------
+template <class T>
+inline void Vec3CrossSimd(
+    const T ax, const T ay, const T az,
+    const T bx, const T by, const T bz,
+    T& outX, T& outY, T& outZ)
+{
+    outX = SimdSub(SimdMul(ay, bz), SimdMul(az, by));
+    outY = SimdSub(SimdMul(az, bx), SimdMul(ax, bz));
+    outZ = SimdSub(SimdMul(ax, by), SimdMul(ay, bx));
+}
+
+template <class T>
+inline T Vec3DotSimd(
+    const T ax, const T ay, const T az,
+    const T bx, const T by, const T bz)
+{
+    return SimdMulAdd(az, bz, SimdMulAdd(ay, by, SimdMul(ax, bx)));
+}
+
+//---------------------------------------------------------
+// Desc:   Moller-Trumbore test of a ray against 4 or 8 triangles
+//         of the block starting from the lane i
+// Ret:    all-ones lanes for hits
+//---------------------------------------------------------
+template <class T>
+inline T RayIntersectTrianglesSimd(
+    const Ray& ray,
+    const Trianglex8& tris,
+    const int i,
+    T& outT,
+    T& outU,
+    T& outV)
+{
+    T dx, dy, dz, ox, oy, oz, tMin, tMax, zero, one;
+    SimdSet1(ray.dir.x,    dx);
+    SimdSet1(ray.dir.y,    dy);
+    SimdSet1(ray.dir.z,    dz);
+    SimdSet1(ray.origin.x, ox);
+    SimdSet1(ray.origin.y, oy);
+    SimdSet1(ray.origin.z, oz);
+    SimdSet1(ray.tMin,     tMin);
+    SimdSet1(ray.tMax,     tMax);
+    SimdSet1(0.0f,         zero);
+    SimdSet1(1.0f,         one);
+
+    T v0x, v0y, v0z, e1x, e1y, e1z, e2x, e2y, e2z;
+    SimdLoad(tris.v0x + i, v0x);  SimdLoad(tris.v0y + i, v0y);  SimdLoad(tris.v0z + i, v0z);
+    SimdLoad(tris.e1x + i, e1x);  SimdLoad(tris.e1y + i, e1y);  SimdLoad(tris.e1z + i, e1z);
+    SimdLoad(tris.e2x + i, e2x);  SimdLoad(tris.e2y + i, e2y);  SimdLoad(tris.e2z + i, e2z);
+
+    T px, py, pz;
+    Vec3CrossSimd(dx, dy, dz, e2x, e2y, e2z, px, py, pz);
+
+    const T invDet = SimdDiv(one, Vec3DotSimd(e1x, e1y, e1z, px, py, pz));
+
+    const T sx = SimdSub(ox, v0x);
+    const T sy = SimdSub(oy, v0y);
+    const T sz = SimdSub(oz, v0z);
+    const T u  = SimdMul(Vec3DotSimd(sx, sy, sz, px, py, pz), invDet);
+
+    T qx, qy, qz;
+    Vec3CrossSimd(sx, sy, sz, e1x, e1y, e1z, qx, qy, qz);
+
+    const T v = SimdMul(Vec3DotSimd(dx, dy, dz, qx, qy, qz), invDet);
+    const T t = SimdMul(Vec3DotSimd(e2x, e2y, e2z, qx, qy, qz), invDet);
+
+    // NaN lanes (degenerate or parallel) fail all the comparisons
+    T hit = SimdAnd(SimdCmpGe(u, zero), SimdCmpLe(u, one));
+    hit   = SimdAnd(hit, SimdAnd(SimdCmpGe(v, zero), SimdCmpLe(SimdAdd(u, v), one)));
+    hit   = SimdAnd(hit, SimdAnd(SimdCmpGe(t, tMin), SimdCmpLe(t, tMax)));
+
+    outT = t;
+    outU = u;
+    outV = v;
+
+    return hit;
+}
+
+#endif // MATH_SIMD_SSE2
+
+//---------------------------------------------------------
+// Desc:   Moller-Trumbore test of a ray against 8 triangles at once;
+//         to find the nearest hit over several blocks set ray.tMax to
+//         the distance of the hit after each block
+// Args:   - ray:    the ray to test
+//         - tris:   8 triangles in SoA form
+//         - outHit: the nearest hit (only written if there is a hit)
+// Ret:    index of the nearest hit triangle in the block (-1 if none)
+//---------------------------------------------------------
+inline int RayIntersectTrianglex8(const Ray& ray, const Trianglex8& tris, TriangleHit& outHit)
+{
+    alignas(32) float t[8];
+    alignas(32) float u[8];
+    alignas(32) float v[8];
+    int               mask = 0;
+
+#if defined(MATH_SIMD_AVX2)
+    __m256 t8, u8, v8;
+    mask = SimdMoveMask(RayIntersectTrianglesSimd(ray, tris, 0, t8, u8, v8));
+
+    SimdStore(t, t8);
+    SimdStore(u, u8);
+    SimdStore(v, v8);
+
+#elif defined(MATH_SIMD_SSE2)
+    for (int i = 0; i < 8; i += 4)
+    {
+        __m128 t4, u4, v4;
+        mask |= SimdMoveMask(RayIntersectTrianglesSimd(ray, tris, i, t4, u4, v4)) << i;
+
+        SimdStore(t + i, t4);
+        SimdStore(u + i, u4);
+        SimdStore(v + i, v4);
+    }
+
+#else
+    for (int i = 0; i < 8; ++i)
+    {
+        const Vec3 v0(tris.v0x[i], tris.v0y[i], tris.v0z[i]);
+        const Vec3 e1(tris.e1x[i], tris.e1y[i], tris.e1z[i]);
+        const Vec3 e2(tris.e2x[i], tris.e2y[i], tris.e2z[i]);
+
+        if (RayIntersectTriangle(ray, v0, e1, e2, t[i], u[i], v[i]))
+            mask |= (1 << i);
+    }
+#endif
+
+    if (mask == 0)
+        return -1;
+
+    // the nearest of hits
+    int nearest = -1;
+
+    for (int i = 0; i < 8; ++i)
+    {
+        if ((mask & (1 << i)) && (nearest < 0 || t[i] < t[nearest]))
+            nearest = i;
+    }
+
+    outHit.t     = t[nearest];
+    outHit.u     = u[nearest];
+    outHit.v     = v[nearest];
+    outHit.index = nearest;
+
+    return nearest;
+}
+
+//---------------------------------------------------------
+// Desc:   the nearest watertight hit of a ray over an array of triangles
+// Ret:    index of the nearest hit triangle (-1 if none)
+//---------------------------------------------------------
+inline int RayIntersectTrianglesWatertight(
+    const Ray& ray,
+    const Triangle* tris,
+    const int numTris,
+    TriangleHit& outHit)
+{
+    assert((tris != nullptr) || (numTris == 0));
+
+    Ray nearestRay = ray;
+    int nearest    = -1;
+
+    for (int i = 0; i < numTris; ++i)
+    {
+        float t, u, v;
+
+        if (!RayIntersectTriangleWatertight(nearestRay, tris[i], t, u, v))
+            continue;
+
+        // the following triangles must be closer
+        nearestRay.tMax = t;
+        nearest         = i;
+
+        outHit.t     = t;
+        outHit.u     = u;
+        outHit.v     = v;
+        outHit.index = i;
+    }
+
+    return nearest;
+}
@@ -1,6 +1,7 @@
 #include "dx_math_helpers.h"
 #include <cmath>
 #include <DirectXMath.h>
+#include <math/quat.h>
 
 using namespace DirectX;
 
@@ -34,22 +35,6 @@ float MathHelper::AngleFromXY(const float x, const float y)
 
 ///////////////////////////////////////////////////////////
 
-struct Quaternion 
-{
-	Quaternion(const DirectX::XMVECTOR& quat)
-	{
-		// real part 
-		w = quat.m128_f32[3];   
-
-		// imaginary part
-		x = quat.m128_f32[0];   
-		y = quat.m128_f32[1];
-		z = quat.m128_f32[2];
-	}
-
-	float w, x, y, z;
-};
-
 struct EulerAngles {
 	float roll  = 0.0f;
 	float pitch = 0.0f;
@@ -63,26 +48,14 @@ DirectX::XMFLOAT3 MathHelper::QuatToRollPitchYaw(const DirectX::XMVECTOR quat)
 {
 	// this implementation assumes normalized quaternion
 	// converts to Euler angles in 3-2-1 sequence
+	// (the conversion itself is implemented by the native Quat type)
 
-	Quaternion q(quat);
-
-	// x-axis rotation; (forward-backward axis)
-	float sinr_cosp = 2 * (q.w * q.x + q.y * q.z);
-	float cosr_cosp = 1 - 2 * (q.x * q.x + q.y * q.y);
-	float roll      = std::atan2(sinr_cosp, cosr_cosp);
-
-	// y-axis rotation; (left-right axis)
-	float temp  = 2 * (q.w * q.y - q.x * q.z);
-	float sinp  = std::sqrtf(1 + temp);
-	float cosp  = std::sqrtf(1 - temp);
-	float pitch = 2 * std::atan2(sinp, cosp) - XM_PIDIV2;
+	XMFLOAT4 q;
+	XMStoreFloat4(&q, quat);
 
-	// z-axis rotation; (up-down axis)
-	float siny_cosp = 2 * (q.w * q.z + q.x * q.y);
-	float cosy_cosp = 1 - 2 * (q.y * q.y + q.z * q.z);
-	float yaw       = std::atan2(siny_cosp, cosy_cosp);
+	const Vec3 angles = ::QuatToRollPitchYaw(Quat(q.x, q.y, q.z, q.w));
 
-	return { roll, pitch, yaw };
+	return { angles.x, angles.y, angles.z };
 }
 
 ///////////////////////////////////////////////////////////
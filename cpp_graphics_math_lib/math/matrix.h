@@ -18,10 +18,19 @@
 #include <math/vec3.h>
 #include <math/math_constants.h>
 #include <math/math_helpers.h>
+#include <math/simd.h>
 #include <assert.h>
 #include <memory.h>
 #include <math.h>
 #include <stdio.h>
+#include <stddef.h>
+
+
+// for batches of matrices which output is bigger than this we use non-temporal
+// stores (the result bypasses the cache; about a half of a typical L2 cache)
+#ifndef MATRIX_BATCH_STREAM_BYTES
+#define MATRIX_BATCH_STREAM_BYTES (256 * 1024)
+#endif
 
 
 //==================================================================================
@@ -47,7 +56,7 @@ struct Matrix4x4
 //==================================================================================
 // Class:   Matrix
 //==================================================================================
-__declspec(align(16)) class Matrix
+class alignas(16) Matrix
 {
 public:
     Matrix();
@@ -82,10 +91,9 @@ public:
             float m30, m31, m32, m33;
         };
 
-        struct
-        {
-            Vec4 r[4];
-        };
+        // (not wrapped into an anonymous struct: a member with constructors
+        //  isn't allowed there by the standard, only MSVC accepts it)
+        Vec4 r[4];
     };
 };
 
@@ -254,7 +262,8 @@ inline void MatrixTranspose(const Matrix& src, Matrix& dst)
 }
 
 //---------------------------------------------------------
-// Desc:   calc and return a determinant of the matrix
+// Desc:   calc and return a determinant of the upper 3x3 part of the matrix
+//         (it is equal to the full determinant for affine matrices)
 //---------------------------------------------------------
 inline float MatrixDeterminant(const Matrix& mat)
 { 
@@ -264,10 +273,31 @@ inline float MatrixDeterminant(const Matrix& mat)
 }
 
 //---------------------------------------------------------
-// Desc:   compute the inverse of the input matrix mat and store the result in invMat
-// Ret:    0 if the matrix is invertible
+// Desc:   calc and return a determinant of the full 4x4 matrix
+//         (expansion by 2x2 minors of the two lower rows)
 //---------------------------------------------------------
-inline int MatrixInverse(Matrix& invMat, float* determinant, const Matrix& mat)
+inline float MatrixDeterminant4x4(const Matrix& m)
+{
+    const float s0 = m.m20*m.m31 - m.m21*m.m30;
+    const float s1 = m.m20*m.m32 - m.m22*m.m30;
+    const float s2 = m.m20*m.m33 - m.m23*m.m30;
+    const float s3 = m.m21*m.m32 - m.m22*m.m31;
+    const float s4 = m.m21*m.m33 - m.m23*m.m31;
+    const float s5 = m.m22*m.m33 - m.m23*m.m32;
+
+    return m.m00 * (m.m11*s5 - m.m12*s4 + m.m13*s3) -
+           m.m01 * (m.m10*s5 - m.m12*s2 + m.m13*s1) +
+           m.m02 * (m.m10*s4 - m.m11*s2 + m.m13*s0) -
+           m.m03 * (m.m10*s3 - m.m11*s1 + m.m12*s0);
+}
+
+//---------------------------------------------------------
+// Desc:   compute the inverse of an AFFINE input matrix mat (its last column
+//         must be 0,0,0,1) and store the result in invMat;
+//         it is cheaper than the general MatrixInverse()
+// Ret:    1 if the matrix is invertible, 0 otherwise
+//---------------------------------------------------------
+inline int MatrixInverseAffine(Matrix& invMat, float* determinant, const Matrix& mat)
 {
     // compute the determinant to see if there is an inverse
     float det = MatrixDeterminant(mat);
@@ -308,9 +338,219 @@ inline int MatrixInverse(Matrix& invMat, float* determinant, const Matrix& mat)
     return 1;
 }
 
+//---------------------------------------------------------
+// Desc:   compute the inverse of a matrix which consists only of rotation
+//         and translation (the upper 3x3 part is orthonormal):
+//
+//             | R  0 |^-1     | R^T      0 |
+//             | t  1 |     =  | -t*R^T   1 |
+//
+//         no determinant and no divisions at all
+// NOTE:   invMat must not be the same object as mat
+//---------------------------------------------------------
+inline void MatrixInverseOrthonormal(Matrix& invMat, const Matrix& mat)
+{
+    assert(&invMat != &mat);
+
+    invMat.m00 = mat.m00;  invMat.m01 = mat.m10;  invMat.m02 = mat.m20;  invMat.m03 = 0;
+    invMat.m10 = mat.m01;  invMat.m11 = mat.m11;  invMat.m12 = mat.m21;  invMat.m13 = 0;
+    invMat.m20 = mat.m02;  invMat.m21 = mat.m12;  invMat.m22 = mat.m22;  invMat.m23 = 0;
+
+    invMat.m30 = -(mat.m30 * mat.m00 + mat.m31 * mat.m01 + mat.m32 * mat.m02);
+    invMat.m31 = -(mat.m30 * mat.m10 + mat.m31 * mat.m11 + mat.m32 * mat.m12);
+    invMat.m32 = -(mat.m30 * mat.m20 + mat.m31 * mat.m21 + mat.m32 * mat.m22);
+    invMat.m33 = 1.0f;
+}
+
+//---------------------------------------------------------
+// Desc:   compute the inverse of a general 4x4 matrix by Cramer's rule
+//         (plain scalar version; it is used when there is no SIMD support
+//          and as a reference for testing of the SIMD version)
+// Ret:    1 if the matrix is invertible, 0 otherwise
+//---------------------------------------------------------
+inline int MatrixInverseScalar(Matrix& invMat, float* determinant, const Matrix& mat)
+{
+    const float* m = mat.mat;
+    float inv[16];
+
+    // 2x2 minors of the two upper and the two lower rows
+    const float a0 = m[0]*m[5]  - m[1]*m[4];
+    const float a1 = m[0]*m[6]  - m[2]*m[4];
+    const float a2 = m[0]*m[7]  - m[3]*m[4];
+    const float a3 = m[1]*m[6]  - m[2]*m[5];
+    const float a4 = m[1]*m[7]  - m[3]*m[5];
+    const float a5 = m[2]*m[7]  - m[3]*m[6];
+
+    const float b0 = m[8]*m[13]  - m[9]*m[12];
+    const float b1 = m[8]*m[14]  - m[10]*m[12];
+    const float b2 = m[8]*m[15]  - m[11]*m[12];
+    const float b3 = m[9]*m[14]  - m[10]*m[13];
+    const float b4 = m[9]*m[15]  - m[11]*m[13];
+    const float b5 = m[10]*m[15] - m[11]*m[14];
+
+    const float det = a0*b5 - a1*b4 + a2*b3 + a3*b2 - a4*b1 + a5*b0;
+
+    if (determinant != nullptr)
+        *determinant = det;
+
+    if (fabs(det) < EPSILON_E5)
+    {
+        return 0;
+    }
+
+    // transposed matrix of cofactors (adjugate)
+    inv[0]  = + m[5]*b5  - m[6]*b4  + m[7]*b3;
+    inv[1]  = - m[1]*b5  + m[2]*b4  - m[3]*b3;
+    inv[2]  = + m[13]*a5 - m[14]*a4 + m[15]*a3;
+    inv[3]  = - m[9]*a5  + m[10]*a4 - m[11]*a3;
+
+    inv[4]  = - m[4]*b5  + m[6]*b2  - m[7]*b1;
+    inv[5]  = + m[0]*b5  - m[2]*b2  + m[3]*b1;
+    inv[6]  = - m[12]*a5 + m[14]*a2 - m[15]*a1;
+    inv[7]  = + m[8]*a5  - m[10]*a2 + m[11]*a1;
+
+    inv[8]  = + m[4]*b4  - m[5]*b2  + m[7]*b0;
+    inv[9]  = - m[0]*b4  + m[1]*b2  - m[3]*b0;
+    inv[10] = + m[12]*a4 - m[13]*a2 + m[15]*a0;
+    inv[11] = - m[8]*a4  + m[9]*a2  - m[11]*a0;
+
+    inv[12] = - m[4]*b3  + m[5]*b1  - m[6]*b0;
+    inv[13] = + m[0]*b3  - m[1]*b1  + m[2]*b0;
+    inv[14] = - m[12]*a3 + m[13]*a1 - m[14]*a0;
+    inv[15] = + m[8]*a3  - m[9]*a1  + m[10]*a0;
+
+    const float detInv = 1.0f / det;
+
+    for (int i = 0; i < 16; ++i)
+        invMat.mat[i] = inv[i] * detInv;
+
+    return 1;
+}
+
+//---------------------------------------------------------
+// Desc:   compute the inverse of a general 4x4 matrix (projection matrices
+//         included) and store the result in invMat;
+//         for affine or rotation+translation matrices prefer the cheaper
+//         MatrixInverseAffine() and MatrixInverseOrthonormal()
+//
+//         the SIMD version is Cramer's rule from the Intel's paper
+//         "Streaming SIMD Extensions - Inverse of 4x4 Matrix" (AP-928):
+//         the matrix is transposed while loading and all the 2x2 products
+//         are computed for 4 cofactors at once with shuffles
+//
+// Args:   - invMat:      output inverse matrix (can be the same object as mat)
+//         - determinant: optional output determinant of the matrix
+//         - mat:         input matrix
+// Ret:    1 if the matrix is invertible, 0 otherwise (invMat isn't changed)
+//---------------------------------------------------------
+inline int MatrixInverse(Matrix& invMat, float* determinant, const Matrix& mat)
+{
+#if defined(MATH_SIMD_SSE2)
+
+    const float* src = mat.mat;
+    __m128 minor0, minor1, minor2, minor3;
+    __m128 row0, row1, row2, row3;
+    __m128 det, tmp;
+
+    // load and transpose (rows 1 and 3 have their halves swapped)
+    tmp  = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), (const __m64*)(src)),     (const __m64*)(src + 4));
+    row1 = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), (const __m64*)(src + 8)), (const __m64*)(src + 12));
+    row0 = _mm_shuffle_ps(tmp, row1, 0x88);
+    row1 = _mm_shuffle_ps(row1, tmp, 0xDD);
+
+    tmp  = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), (const __m64*)(src + 2)),  (const __m64*)(src + 6));
+    row3 = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), (const __m64*)(src + 10)), (const __m64*)(src + 14));
+    row2 = _mm_shuffle_ps(tmp, row3, 0x88);
+    row3 = _mm_shuffle_ps(row3, tmp, 0xDD);
+
+    // cofactors
+    tmp    = _mm_mul_ps(row2, row3);
+    tmp    = _mm_shuffle_ps(tmp, tmp, 0xB1);
+    minor0 = _mm_mul_ps(row1, tmp);
+    minor1 = _mm_mul_ps(row0, tmp);
+    tmp    = _mm_shuffle_ps(tmp, tmp, 0x4E);
+    minor0 = _mm_sub_ps(_mm_mul_ps(row1, tmp), minor0);
+    minor1 = _mm_sub_ps(_mm_mul_ps(row0, tmp), minor1);
+    minor1 = _mm_shuffle_ps(minor1, minor1, 0x4E);
+
+    tmp    = _mm_mul_ps(row1, row2);
+    tmp    = _mm_shuffle_ps(tmp, tmp, 0xB1);
+    minor0 = _mm_add_ps(_mm_mul_ps(row3, tmp), minor0);
+    minor3 = _mm_mul_ps(row0, tmp);
+    tmp    = _mm_shuffle_ps(tmp, tmp, 0x4E);
+    minor0 = _mm_sub_ps(minor0, _mm_mul_ps(row3, tmp));
+    minor3 = _mm_sub_ps(_mm_mul_ps(row0, tmp), minor3);
+    minor3 = _mm_shuffle_ps(minor3, minor3, 0x4E);
+
+    tmp    = _mm_mul_ps(_mm_shuffle_ps(row1, row1, 0x4E), row3);
+    tmp    = _mm_shuffle_ps(tmp, tmp, 0xB1);
+    row2   = _mm_shuffle_ps(row2, row2, 0x4E);
+    minor0 = _mm_add_ps(_mm_mul_ps(row2, tmp), minor0);
+    minor2 = _mm_mul_ps(row0, tmp);
+    tmp    = _mm_shuffle_ps(tmp, tmp, 0x4E);
+    minor0 = _mm_sub_ps(minor0, _mm_mul_ps(row2, tmp));
+    minor2 = _mm_sub_ps(_mm_mul_ps(row0, tmp), minor2);
+    minor2 = _mm_shuffle_ps(minor2, minor2, 0x4E);
+
+    tmp    = _mm_mul_ps(row0, row1);
+    tmp    = _mm_shuffle_ps(tmp, tmp, 0xB1);
+    minor2 = _mm_add_ps(_mm_mul_ps(row3, tmp), minor2);
+    minor3 = _mm_sub_ps(_mm_mul_ps(row2, tmp), minor3);
+    tmp    = _mm_shuffle_ps(tmp, tmp, 0x4E);
+    minor2 = _mm_sub_ps(_mm_mul_ps(row3, tmp), minor2);
+    minor3 = _mm_sub_ps(minor3, _mm_mul_ps(row2, tmp));
+
+    tmp    = _mm_mul_ps(row0, row3);
+    tmp    = _mm_shuffle_ps(tmp, tmp, 0xB1);
+    minor1 = _mm_sub_ps(minor1, _mm_mul_ps(row2, tmp));
+    minor2 = _mm_add_ps(_mm_mul_ps(row1, tmp), minor2);
+    tmp    = _mm_shuffle_ps(tmp, tmp, 0x4E);
+    minor1 = _mm_add_ps(_mm_mul_ps(row2, tmp), minor1);
+    minor2 = _mm_sub_ps(minor2, _mm_mul_ps(row1, tmp));
+
+    tmp    = _mm_mul_ps(row0, row2);
+    tmp    = _mm_shuffle_ps(tmp, tmp, 0xB1);
+    minor1 = _mm_add_ps(_mm_mul_ps(row3, tmp), minor1);
+    minor3 = _mm_sub_ps(minor3, _mm_mul_ps(row1, tmp));
+    tmp    = _mm_shuffle_ps(tmp, tmp, 0x4E);
+    minor1 = _mm_sub_ps(minor1, _mm_mul_ps(row3, tmp));
+    minor3 = _mm_add_ps(_mm_mul_ps(row1, tmp), minor3);
+
+    // determinant: dot product of the 1st row with its cofactors
+    det = _mm_mul_ps(row0, minor0);
+    det = _mm_add_ps(_mm_shuffle_ps(det, det, 0x4E), det);
+    det = _mm_add_ss(_mm_shuffle_ps(det, det, 0xB1), det);
+
+    const float d = _mm_cvtss_f32(det);
+
+    if (determinant != nullptr)
+        *determinant = d;
+
+    if (fabs(d) < EPSILON_E5)
+    {
+        return 0;
+    }
+
+    // use a real division (not _mm_rcp_ss) to keep the precision of the scalar version
+    det = _mm_set1_ps(1.0f / d);
+
+    _mm_store_ps(invMat.m[0], _mm_mul_ps(det, minor0));
+    _mm_store_ps(invMat.m[1], _mm_mul_ps(det, minor1));
+    _mm_store_ps(invMat.m[2], _mm_mul_ps(det, minor2));
+    _mm_store_ps(invMat.m[3], _mm_mul_ps(det, minor3));
+
+    return 1;
+
+#else
+
+    return MatrixInverseScalar(invMat, determinant, mat);
+
+#endif
+}
+
 //---------------------------------------------------------
 // Desc:   compute the inverse of the input matrix mat and return the inverse matrix
-// Ret:    if the input matrix is invertible we set det to zero
+// Ret:    if the input matrix isn't invertible we return a zero matrix
 //---------------------------------------------------------
 inline Matrix MatrixInverse(float* det, const Matrix& mat)
 {
@@ -321,8 +561,11 @@ inline Matrix MatrixInverse(float* det, const Matrix& mat)
 
 //---------------------------------------------------------
 // Desc:   multiply two matrices together and return the result in outMat
+//         (plain scalar version; it is used when there is no SIMD support
+//          and as a reference for testing of the SIMD version)
+// NOTE:   outMat must not be the same object as ma or mb
 //---------------------------------------------------------
-inline void MatrixMul(const Matrix& ma, const Matrix& mb, Matrix& outMat)
+inline void MatrixMulScalar(const Matrix& ma, const Matrix& mb, Matrix& outMat)
 {
     for (int i = 0; i < 4; i++)
     {
@@ -348,6 +591,259 @@ inline void MatrixMul(const Matrix& ma, const Matrix& mb, Matrix& outMat)
     }
 }
 
+#if defined(MATH_SIMD_SSE2)
+//---------------------------------------------------------
+// Desc:   SIMD helper: multiply one matrix row (a) by a matrix which
+//         rows are already loaded into registers b0..b3
+//---------------------------------------------------------
+inline __m128 MatrixMulRowSimd(
+    const __m128 a,
+    const __m128 b0,
+    const __m128 b1,
+    const __m128 b2,
+    const __m128 b3)
+{
+    __m128 r = _mm_mul_ps(SIMD_SPLAT(a, 0), b0);
+    r = SimdMulAdd(SIMD_SPLAT(a, 1), b1, r);
+    r = SimdMulAdd(SIMD_SPLAT(a, 2), b2, r);
+    r = SimdMulAdd(SIMD_SPLAT(a, 3), b3, r);
+    return r;
+}
+#endif
+
+#if defined(MATH_SIMD_AVX2)
+//---------------------------------------------------------
+// Desc:   AVX2 helper: multiply two matrix rows (packed into a) by a matrix
+//         which rows are duplicated into both 128-bit halves of b0..b3;
+//         _mm256_shuffle_ps works within each 128-bit half so it broadcasts
+//         an element of the 1st row into the low half and of the 2nd into the high
+//---------------------------------------------------------
+inline __m256 MatrixMulRow2Simd(
+    const __m256 a,
+    const __m256 b0,
+    const __m256 b1,
+    const __m256 b2,
+    const __m256 b3)
+{
+    __m256 r = _mm256_mul_ps(_mm256_shuffle_ps(a, a, 0x00), b0);
+    r = SimdMulAdd(_mm256_shuffle_ps(a, a, 0x55), b1, r);
+    r = SimdMulAdd(_mm256_shuffle_ps(a, a, 0xAA), b2, r);
+    r = SimdMulAdd(_mm256_shuffle_ps(a, a, 0xFF), b3, r);
+    return r;
+}
+#endif
+
+//---------------------------------------------------------
+// Desc:   multiply two matrices together and return the result in outMat;
+//         each row of the result is a linear combination of the rows of mb:
+//
+//            out.r[i] = ma[i][0]*mb.r[0] + ma[i][1]*mb.r[1] +
+//                       ma[i][2]*mb.r[2] + ma[i][3]*mb.r[3]
+//
+//         so we keep all the rows of mb in registers and process one row of ma
+//         per 128-bit register (or two rows per 256-bit register with AVX2)
+//
+// NOTE:   outMat CAN be the same object as ma or mb
+//         (all the rows of mb are loaded before anything is written)
+//---------------------------------------------------------
+inline void MatrixMul(const Matrix& ma, const Matrix& mb, Matrix& outMat)
+{
+#if defined(MATH_SIMD_AVX2)
+
+    // each row of mb is duplicated into both 128-bit halves
+    const __m256 b0 = _mm256_broadcast_ps((const __m128*)mb.m[0]);
+    const __m256 b1 = _mm256_broadcast_ps((const __m128*)mb.m[1]);
+    const __m256 b2 = _mm256_broadcast_ps((const __m128*)mb.m[2]);
+    const __m256 b3 = _mm256_broadcast_ps((const __m128*)mb.m[3]);
+
+    // rows 0,1 and 2,3 of ma (a matrix is only 16-byte aligned so use unaligned loads)
+    const __m256 a01 = _mm256_loadu_ps(ma.m[0]);
+    const __m256 a23 = _mm256_loadu_ps(ma.m[2]);
+
+    _mm256_storeu_ps(outMat.m[0], MatrixMulRow2Simd(a01, b0, b1, b2, b3));
+    _mm256_storeu_ps(outMat.m[2], MatrixMulRow2Simd(a23, b0, b1, b2, b3));
+
+#elif defined(MATH_SIMD_SSE2)
+
+    const __m128 b0 = _mm_load_ps(mb.m[0]);
+    const __m128 b1 = _mm_load_ps(mb.m[1]);
+    const __m128 b2 = _mm_load_ps(mb.m[2]);
+    const __m128 b3 = _mm_load_ps(mb.m[3]);
+
+    // load all the rows of ma before storing so ma can be the output as well
+    const __m128 a0 = _mm_load_ps(ma.m[0]);
+    const __m128 a1 = _mm_load_ps(ma.m[1]);
+    const __m128 a2 = _mm_load_ps(ma.m[2]);
+    const __m128 a3 = _mm_load_ps(ma.m[3]);
+
+    _mm_store_ps(outMat.m[0], MatrixMulRowSimd(a0, b0, b1, b2, b3));
+    _mm_store_ps(outMat.m[1], MatrixMulRowSimd(a1, b0, b1, b2, b3));
+    _mm_store_ps(outMat.m[2], MatrixMulRowSimd(a2, b0, b1, b2, b3));
+    _mm_store_ps(outMat.m[3], MatrixMulRowSimd(a3, b0, b1, b2, b3));
+
+#else
+
+    if (&outMat == &ma || &outMat == &mb)
+    {
+        Matrix tmp;
+        MatrixMulScalar(ma, mb, tmp);
+        MatrixCopy(tmp, outMat);
+    }
+    else
+    {
+        MatrixMulScalar(ma, mb, outMat);
+    }
+
+#endif
+}
+
+//---------------------------------------------------------
+// Desc:   multiply each matrix of the input array by the same matrix b:
+//         out[i] = a[i] * b
+//         (for instance: local matrices by a parent or view-projection matrix)
+//
+//         b is kept in registers for the whole loop; for big outputs we use
+//         non-temporal stores so the result doesn't evict useful data from cache
+//
+// Args:   - a:   array of n input matrices
+//         - b:   right-hand matrix for each multiplication
+//         - out: array of n output matrices (can be the same array as a)
+//         - n:   number of matrices
+//---------------------------------------------------------
+inline void MatrixMulBatch(const Matrix* a, const Matrix& b, Matrix* out, const size_t n)
+{
+    assert(a != nullptr);
+    assert(out != nullptr);
+
+#if defined(MATH_SIMD_AVX2)
+
+    const __m256 b0 = _mm256_broadcast_ps((const __m128*)b.m[0]);
+    const __m256 b1 = _mm256_broadcast_ps((const __m128*)b.m[1]);
+    const __m256 b2 = _mm256_broadcast_ps((const __m128*)b.m[2]);
+    const __m256 b3 = _mm256_broadcast_ps((const __m128*)b.m[3]);
+
+    if (n * sizeof(Matrix) >= MATRIX_BATCH_STREAM_BYTES)
+    {
+        // non-temporal stores need only 16-byte alignment per 128-bit half
+        for (size_t i = 0; i < n; ++i)
+        {
+            const __m256 r01 = MatrixMulRow2Simd(_mm256_loadu_ps(a[i].m[0]), b0, b1, b2, b3);
+            const __m256 r23 = MatrixMulRow2Simd(_mm256_loadu_ps(a[i].m[2]), b0, b1, b2, b3);
+
+            _mm_stream_ps(out[i].m[0], _mm256_castps256_ps128(r01));
+            _mm_stream_ps(out[i].m[1], _mm256_extractf128_ps(r01, 1));
+            _mm_stream_ps(out[i].m[2], _mm256_castps256_ps128(r23));
+            _mm_stream_ps(out[i].m[3], _mm256_extractf128_ps(r23, 1));
+        }
+        _mm_sfence();
+    }
+    else
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            const __m256 a01 = _mm256_loadu_ps(a[i].m[0]);
+            const __m256 a23 = _mm256_loadu_ps(a[i].m[2]);
+
+            _mm256_storeu_ps(out[i].m[0], MatrixMulRow2Simd(a01, b0, b1, b2, b3));
+            _mm256_storeu_ps(out[i].m[2], MatrixMulRow2Simd(a23, b0, b1, b2, b3));
+        }
+    }
+
+#elif defined(MATH_SIMD_SSE2)
+
+    const __m128 b0 = _mm_load_ps(b.m[0]);
+    const __m128 b1 = _mm_load_ps(b.m[1]);
+    const __m128 b2 = _mm_load_ps(b.m[2]);
+    const __m128 b3 = _mm_load_ps(b.m[3]);
+
+    if (n * sizeof(Matrix) >= MATRIX_BATCH_STREAM_BYTES)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            for (int row = 0; row < 4; ++row)
+            {
+                const __m128 r = MatrixMulRowSimd(_mm_load_ps(a[i].m[row]), b0, b1, b2, b3);
+                _mm_stream_ps(out[i].m[row], r);
+            }
+        }
+        _mm_sfence();
+    }
+    else
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            for (int row = 0; row < 4; ++row)
+            {
+                const __m128 r = MatrixMulRowSimd(_mm_load_ps(a[i].m[row]), b0, b1, b2, b3);
+                _mm_store_ps(out[i].m[row], r);
+            }
+        }
+    }
+
+#else
+
+    for (size_t i = 0; i < n; ++i)
+        MatrixMul(a[i], b, out[i]);
+
+#endif
+}
+
+//---------------------------------------------------------
+// Desc:   pairwise multiplication of two arrays of matrices:
+//         out[i] = a[i] * b[i]
+// Args:   - a, b: arrays of n input matrices
+//         - out:  array of n output matrices (can be the same array as a or b)
+//         - n:    number of matrices
+//---------------------------------------------------------
+inline void MatrixMulBatch(const Matrix* a, const Matrix* b, Matrix* out, const size_t n)
+{
+    assert(a != nullptr);
+    assert(b != nullptr);
+    assert(out != nullptr);
+
+#if defined(MATH_SIMD_SSE2)
+
+    const bool useStream = (n * sizeof(Matrix) >= MATRIX_BATCH_STREAM_BYTES);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        const __m128 b0 = _mm_load_ps(b[i].m[0]);
+        const __m128 b1 = _mm_load_ps(b[i].m[1]);
+        const __m128 b2 = _mm_load_ps(b[i].m[2]);
+        const __m128 b3 = _mm_load_ps(b[i].m[3]);
+
+        const __m128 r0 = MatrixMulRowSimd(_mm_load_ps(a[i].m[0]), b0, b1, b2, b3);
+        const __m128 r1 = MatrixMulRowSimd(_mm_load_ps(a[i].m[1]), b0, b1, b2, b3);
+        const __m128 r2 = MatrixMulRowSimd(_mm_load_ps(a[i].m[2]), b0, b1, b2, b3);
+        const __m128 r3 = MatrixMulRowSimd(_mm_load_ps(a[i].m[3]), b0, b1, b2, b3);
+
+        if (useStream)
+        {
+            _mm_stream_ps(out[i].m[0], r0);
+            _mm_stream_ps(out[i].m[1], r1);
+            _mm_stream_ps(out[i].m[2], r2);
+            _mm_stream_ps(out[i].m[3], r3);
+        }
+        else
+        {
+            _mm_store_ps(out[i].m[0], r0);
+            _mm_store_ps(out[i].m[1], r1);
+            _mm_store_ps(out[i].m[2], r2);
+            _mm_store_ps(out[i].m[3], r3);
+        }
+    }
+
+    if (useStream)
+        _mm_sfence();
+
+#else
+
+    for (size_t i = 0; i < n; ++i)
+        MatrixMul(a[i], b[i], out[i]);
+
+#endif
+}
+
 //---------------------------------------------------------
 // Desc:   multiply a Vec3 by 4x4 matrix and return the result in outVec;
 // 
@@ -380,14 +876,273 @@ inline void MatrixMulVec3(const Vec3& vec, const Matrix& mat, Vec3& outVec)
 //---------------------------------------------------------
 inline void MatrixMulVec4(const Vec4& vec, const Matrix& mat, Vec4& outVec)
 {
+#if defined(MATH_SIMD_SSE2)
+
+    // the vector is processed as a single matrix row (vec and outVec can be the same)
+    outVec.xmm = MatrixMulRowSimd(vec.xmm, mat.r[0].xmm, mat.r[1].xmm, mat.r[2].xmm, mat.r[3].xmm);
+
+#else
+
+    const Vec4 v = vec;
+
     // multiply vec by matrix
     for (int col = 0; col < 4; col++)
     {
         outVec.xyzw[col] = 0.0f;
-        outVec.xyzw[col] += (vec.xyzw[0] * mat.m[0][col]);
-        outVec.xyzw[col] += (vec.xyzw[1] * mat.m[1][col]);
-        outVec.xyzw[col] += (vec.xyzw[2] * mat.m[2][col]);
-        outVec.xyzw[col] += (vec.xyzw[3] * mat.m[3][col]);
+        outVec.xyzw[col] += (v.xyzw[0] * mat.m[0][col]);
+        outVec.xyzw[col] += (v.xyzw[1] * mat.m[1][col]);
+        outVec.xyzw[col] += (v.xyzw[2] * mat.m[2][col]);
+        outVec.xyzw[col] += (v.xyzw[3] * mat.m[3][col]);
+    }
+
+#endif
+}
+
+//==================================================================================
+// stream transformations (arrays of vectors by one matrix)
+//==================================================================================
+
+#if defined(MATH_SIMD_SSE2)
+//---------------------------------------------------------
+// Desc:   SIMD helper: transform 4 (or 8) vectors in SoA form by the upper 3x3
+//         part of the matrix (elements of which are broadcasted into m[][])
+//         and add the translation t (zeros for normals)
+//---------------------------------------------------------
+template <class T>
+inline void MatrixTransformSoASimd(
+    const T x, const T y, const T z,
+    const T m[3][3],
+    const T tx, const T ty, const T tz,
+    T& ox, T& oy, T& oz)
+{
+    ox = SimdMulAdd(z, m[2][0], SimdMulAdd(y, m[1][0], SimdMulAdd(x, m[0][0], tx)));
+    oy = SimdMulAdd(z, m[2][1], SimdMulAdd(y, m[1][1], SimdMulAdd(x, m[0][1], ty)));
+    oz = SimdMulAdd(z, m[2][2], SimdMulAdd(y, m[1][2], SimdMulAdd(x, m[0][2], tz)));
+}
+
+#endif // MATH_SIMD_SSE2
+
+//---------------------------------------------------------
+// Desc:   a common implementation for MatrixTransformPoints/Normals:
+//         transform the upper 3x3 part and add w*translation (w is 1 or 0)
+//---------------------------------------------------------
+inline void MatrixTransformVec3Stream(
+    const Vec3* in,
+    const size_t inStride,
+    const Matrix& mat,
+    Vec3* out,
+    const size_t outStride,
+    const size_t count,
+    const float w)
+{
+    assert((in != nullptr) || (count == 0));
+    assert((out != nullptr) || (count == 0));
+
+    const unsigned char* src = (const unsigned char*)in;
+    unsigned char*       dst = (unsigned char*)out;
+    size_t i = 0;
+
+#if defined(MATH_SIMD_AVX2)
+
+    // process 8 vectors per iteration
+    __m256 m8[3][3];
+
+    for (int r = 0; r < 3; ++r)
+        for (int c = 0; c < 3; ++c)
+            m8[r][c] = _mm256_set1_ps(mat.m[r][c]);
+
+    const __m256 tx8 = _mm256_set1_ps(mat.m30 * w);
+    const __m256 ty8 = _mm256_set1_ps(mat.m31 * w);
+    const __m256 tz8 = _mm256_set1_ps(mat.m32 * w);
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128 xl, yl, zl, xh, yh, zh;
+        LoadVec3x4Simd(src + inStride*i,     inStride, xl, yl, zl);
+        LoadVec3x4Simd(src + inStride*(i+4), inStride, xh, yh, zh);
+
+        const __m256 x = _mm256_insertf128_ps(_mm256_castps128_ps256(xl), xh, 1);
+        const __m256 y = _mm256_insertf128_ps(_mm256_castps128_ps256(yl), yh, 1);
+        const __m256 z = _mm256_insertf128_ps(_mm256_castps128_ps256(zl), zh, 1);
+
+        __m256 ox, oy, oz;
+        MatrixTransformSoASimd(x, y, z, m8, tx8, ty8, tz8, ox, oy, oz);
+
+        StoreVec3x4Simd(dst + outStride*i,
+                        outStride,
+                        _mm256_castps256_ps128(ox),
+                        _mm256_castps256_ps128(oy),
+                        _mm256_castps256_ps128(oz));
+
+        StoreVec3x4Simd(dst + outStride*(i+4),
+                        outStride,
+                        _mm256_extractf128_ps(ox, 1),
+                        _mm256_extractf128_ps(oy, 1),
+                        _mm256_extractf128_ps(oz, 1));
+    }
+
+#elif defined(MATH_SIMD_SSE2)
+
+    // process 4 vectors per iteration
+    __m128 m4[3][3];
+
+    for (int r = 0; r < 3; ++r)
+        for (int c = 0; c < 3; ++c)
+            m4[r][c] = _mm_set1_ps(mat.m[r][c]);
+
+    const __m128 tx4 = _mm_set1_ps(mat.m30 * w);
+    const __m128 ty4 = _mm_set1_ps(mat.m31 * w);
+    const __m128 tz4 = _mm_set1_ps(mat.m32 * w);
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 x, y, z;
+        __m128 ox, oy, oz;
+
+        LoadVec3x4Simd(src + inStride*i, inStride, x, y, z);
+        MatrixTransformSoASimd(x, y, z, m4, tx4, ty4, tz4, ox, oy, oz);
+        StoreVec3x4Simd(dst + outStride*i, outStride, ox, oy, oz);
+    }
+
+#endif
+
+    // the tail (or everything if there is no SIMD)
+    for (; i < count; ++i)
+    {
+        const Vec3& v = *(const Vec3*)(src + inStride*i);
+        Vec3&       o = *(Vec3*)(dst + outStride*i);
+
+        const float x = v.x;
+        const float y = v.y;
+        const float z = v.z;
+
+        o.x = x*mat.m00 + y*mat.m10 + z*mat.m20 + w*mat.m30;
+        o.y = x*mat.m01 + y*mat.m11 + z*mat.m21 + w*mat.m31;
+        o.z = x*mat.m02 + y*mat.m12 + z*mat.m22 + w*mat.m32;
+    }
+}
+
+//---------------------------------------------------------
+// Desc:   transform an array of 3D points by the matrix (w = 1, like MatrixMulVec3)
+// Args:   - in:        input points
+//         - inStride:  distance in bytes btw two input points (sizeof(Vec3) for packed arr)
+//         - mat:       transformation matrix
+//         - out:       output points (can be the same memory as input)
+//         - outStride: distance in bytes btw two output points
+//         - count:     number of points
+//---------------------------------------------------------
+inline void MatrixTransformPoints(
+    const Vec3* in,
+    const size_t inStride,
+    const Matrix& mat,
+    Vec3* out,
+    const size_t outStride,
+    const size_t count)
+{
+    MatrixTransformVec3Stream(in, inStride, mat, out, outStride, count, 1.0f);
+}
+
+//---------------------------------------------------------
+// Desc:   transform an array of 3D normals/directions by the matrix (w = 0,
+//         so translation is ignored); for non-uniform scaling pass an
+//         inverse transpose matrix
+// Args:   the same as for MatrixTransformPoints
+//---------------------------------------------------------
+inline void MatrixTransformNormals(
+    const Vec3* in,
+    const size_t inStride,
+    const Matrix& mat,
+    Vec3* out,
+    const size_t outStride,
+    const size_t count)
+{
+    MatrixTransformVec3Stream(in, inStride, mat, out, outStride, count, 0.0f);
+}
+
+//---------------------------------------------------------
+// Desc:   transform an array of 4D vectors by the matrix (like MatrixMulVec4)
+// Args:   - in:        input vectors
+//         - inStride:  distance in bytes btw two input vectors (sizeof(Vec4) for packed arr)
+//         - mat:       transformation matrix
+//         - out:       output vectors (can be the same memory as input)
+//         - outStride: distance in bytes btw two output vectors
+//         - count:     number of vectors
+//---------------------------------------------------------
+inline void MatrixTransformVec4Stream(
+    const Vec4* in,
+    const size_t inStride,
+    const Matrix& mat,
+    Vec4* out,
+    const size_t outStride,
+    const size_t count)
+{
+    assert((in != nullptr) || (count == 0));
+    assert((out != nullptr) || (count == 0));
+
+    const unsigned char* src = (const unsigned char*)in;
+    unsigned char*       dst = (unsigned char*)out;
+    size_t i = 0;
+
+    // a vector by matrix product is a linear combination of the matrix rows
+    // so each vector is processed as a single matrix row
+
+#if defined(MATH_SIMD_AVX2)
+
+    const __m256 b0 = _mm256_broadcast_ps((const __m128*)mat.m[0]);
+    const __m256 b1 = _mm256_broadcast_ps((const __m128*)mat.m[1]);
+    const __m256 b2 = _mm256_broadcast_ps((const __m128*)mat.m[2]);
+    const __m256 b3 = _mm256_broadcast_ps((const __m128*)mat.m[3]);
+
+    // process 8 vectors per iteration (2 vectors per register)
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256 v[4];
+
+        for (int k = 0; k < 4; ++k)
+        {
+            const float* lo = (const float*)(src + inStride*(i + 2*k));
+            const float* hi = (const float*)(src + inStride*(i + 2*k + 1));
+            v[k] = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(lo)), _mm_loadu_ps(hi), 1);
+        }
+
+        for (int k = 0; k < 4; ++k)
+        {
+            const __m256 r = MatrixMulRow2Simd(v[k], b0, b1, b2, b3);
+
+            _mm_storeu_ps((float*)(dst + outStride*(i + 2*k)),     _mm256_castps256_ps128(r));
+            _mm_storeu_ps((float*)(dst + outStride*(i + 2*k + 1)), _mm256_extractf128_ps(r, 1));
+        }
+    }
+
+#elif defined(MATH_SIMD_SSE2)
+
+    const __m128 b0 = _mm_load_ps(mat.m[0]);
+    const __m128 b1 = _mm_load_ps(mat.m[1]);
+    const __m128 b2 = _mm_load_ps(mat.m[2]);
+    const __m128 b3 = _mm_load_ps(mat.m[3]);
+
+    // process 4 vectors per iteration
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 v[4];
+
+        for (int k = 0; k < 4; ++k)
+            v[k] = _mm_loadu_ps((const float*)(src + inStride*(i + k)));
+
+        for (int k = 0; k < 4; ++k)
+            _mm_storeu_ps((float*)(dst + outStride*(i + k)), MatrixMulRowSimd(v[k], b0, b1, b2, b3));
+    }
+
+#endif
+
+    // the tail (or everything if there is no SIMD)
+    // (vectors inside of interleaved data may be not 16-byte aligned, so copy them)
+    for (; i < count; ++i)
+    {
+        Vec4 v;
+        memcpy(v.xyzw, src + inStride*i, sizeof(Vec4));
+        MatrixMulVec4(v, mat, v);
+        memcpy(dst + outStride*i, v.xyzw, sizeof(Vec4));
     }
 }
 
@@ -587,10 +1342,8 @@ inline Matrix MatrixProjectionLH(
 //---------------------------------------------------------
 inline Matrix& Matrix::operator *= (const Matrix& mat)
 {
-    Matrix tmp;
-    
-    MatrixMul(*this, mat, tmp);
-    MatrixCopy(tmp, *this);
+    // MatrixMul() handles the case when the output is one of the inputs
+    MatrixMul(*this, mat, *this);
 
     return *this;
 }
@@ -0,0 +1,381 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: matrix3x4.h
+    Desc:     compact affine transformation (48 bytes instead of 64 of Matrix)
+
+              the last column of an affine row-major Matrix is always (0,0,0,1)
+              so we store only its first 3 columns; each column is stored
+              as a row of 4 floats:
+
+                  Matrix (row-major)          Matrix3x4
+
+                  | m00 m01 m02 0 |           | m00 m10 m20 m30 |   <- r[0]
+                  | m10 m11 m12 0 |    =>     | m01 m11 m21 m31 |   <- r[1]
+                  | m20 m21 m22 0 |           | m02 m12 m22 m32 |   <- r[2]
+                  | m30 m31 m32 1 |
+
+              so a transformed point is: out[k] = dot(r[k].xyz, p) + r[k].w;
+              the multiplication order is the same as for Matrix:
+              (a * b) means "transform by a, then by b"
+
+    Created:  17.10.2026 by DimaSkup
+\**********************************************************************************/
+#pragma once
+
+#include <math/matrix.h>
+#include <math/vec3.h>
+#include <math/vec4.h>
+#include <math/simd.h>
+#include <assert.h>
+#include <memory.h>
+#include <math.h>
+
+
+//==================================================================================
+// Class:   Matrix3x4
+//==================================================================================
+class alignas(16) Matrix3x4
+{
+public:
+    Matrix3x4();
+    Matrix3x4(const Matrix3x4& src);
+    Matrix3x4(const Matrix& src);
+
+    Matrix3x4(const float m00, const float m10, const float m20, const float m30,
+              const float m01, const float m11, const float m21, const float m31,
+              const float m02, const float m12, const float m22, const float m32);
+
+    Matrix3x4& operator *= (const Matrix3x4& mat);
+    Matrix3x4& operator =  (const Matrix3x4& mat);
+
+    inline const Vec4& operator[](const int row) const { return r[row]; }
+    inline Vec4& operator[](const int row)             { return r[row]; }
+
+public:
+    union
+    {
+        float mat[12]{0};
+        float m[3][4];
+        Vec4  r[3];
+    };
+};
+
+
+//==================================================================================
+// constructors
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:   default constructor (zero matrix)
+//---------------------------------------------------------
+inline Matrix3x4::Matrix3x4()
+{
+    memset(mat, 0, sizeof(mat));
+}
+
+//---------------------------------------------------------
+// Desc:   copy constructor
+//---------------------------------------------------------
+inline Matrix3x4::Matrix3x4(const Matrix3x4& src)
+{
+    memcpy(mat, src.mat, sizeof(mat));
+}
+
+//---------------------------------------------------------
+// Desc:   init with 12 floats (NOTE: the order is column by column
+//         of the corresponding row-major Matrix)
+//---------------------------------------------------------
+inline Matrix3x4::Matrix3x4(
+    const float _m00, const float _m10, const float _m20, const float _m30,
+    const float _m01, const float _m11, const float _m21, const float _m31,
+    const float _m02, const float _m12, const float _m22, const float _m32)
+{
+    m[0][0] = _m00;  m[0][1] = _m10;  m[0][2] = _m20;  m[0][3] = _m30;
+    m[1][0] = _m01;  m[1][1] = _m11;  m[1][2] = _m21;  m[1][3] = _m31;
+    m[2][0] = _m02;  m[2][1] = _m12;  m[2][2] = _m22;  m[2][3] = _m32;
+}
+
+//---------------------------------------------------------
+// Desc:   init from an affine row-major 4x4 matrix
+//         (the last column of the input matrix is ignored)
+//---------------------------------------------------------
+inline Matrix3x4::Matrix3x4(const Matrix& src)
+{
+    for (int k = 0; k < 3; ++k)
+    {
+        m[k][0] = src.m[0][k];
+        m[k][1] = src.m[1][k];
+        m[k][2] = src.m[2][k];
+        m[k][3] = src.m[3][k];
+    }
+}
+
+
+//==================================================================================
+// functions
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:   setup input matrix as identity
+//---------------------------------------------------------
+inline void Matrix3x4Identity(Matrix3x4& m)
+{
+    memset(m.mat, 0, sizeof(m.mat));
+    m.m[0][0] = 1.0f;
+    m.m[1][1] = 1.0f;
+    m.m[2][2] = 1.0f;
+}
+
+//---------------------------------------------------------
+// Desc:   return an identity matrix
+//---------------------------------------------------------
+inline Matrix3x4 Matrix3x4Identity()
+{
+    Matrix3x4 m;
+    Matrix3x4Identity(m);
+    return m;
+}
+
+//---------------------------------------------------------
+// Desc:   compare two matrices and return true if they are equal
+//---------------------------------------------------------
+inline bool Matrix3x4Equal(const Matrix3x4& m1, const Matrix3x4& m2)
+{
+    bool isEqual = true;
+
+    for (int i = 0; i < 12; ++i)
+        isEqual &= (FloatEqual(m1.mat[i], m2.mat[i]));
+
+    return isEqual;
+}
+
+//---------------------------------------------------------
+// Desc:   convert an affine row-major 4x4 matrix into 3x4
+//---------------------------------------------------------
+inline void Matrix3x4FromMatrix(const Matrix& src, Matrix3x4& dst)
+{
+    dst = Matrix3x4(src);
+}
+
+//---------------------------------------------------------
+// Desc:   convert a 3x4 matrix into row-major 4x4 (last column is 0,0,0,1)
+//---------------------------------------------------------
+inline void Matrix3x4ToMatrix(const Matrix3x4& src, Matrix& dst)
+{
+    for (int k = 0; k < 3; ++k)
+    {
+        dst.m[0][k] = src.m[k][0];
+        dst.m[1][k] = src.m[k][1];
+        dst.m[2][k] = src.m[k][2];
+        dst.m[3][k] = src.m[k][3];
+    }
+
+    dst.m03 = 0.0f;
+    dst.m13 = 0.0f;
+    dst.m23 = 0.0f;
+    dst.m33 = 1.0f;
+}
+
+//---------------------------------------------------------
+// Desc:   convert a 3x4 matrix into row-major 4x4 and return it
+//---------------------------------------------------------
+inline Matrix Matrix3x4ToMatrix(const Matrix3x4& src)
+{
+    Matrix m;
+    Matrix3x4ToMatrix(src, m);
+    return m;
+}
+
+//---------------------------------------------------------
+// Desc:   combine two affine transformations: out = a * b
+//         ("transform by a, then by b" as for Matrix);
+//
+//         in the stored (transposed) form it is out` = b` * a`, so each
+//         row of the result is a linear combination of the rows of a:
+//
+//            out.r[i] = b[i][0]*a.r[0] + b[i][1]*a.r[1] + b[i][2]*a.r[2] + (0,0,0,b[i][3])
+//
+//         it costs 36 multiplies instead of 64 for a 4x4 matrix
+//
+// NOTE:   outMat CAN be the same object as a or b
+//---------------------------------------------------------
+inline void Matrix3x4Mul(const Matrix3x4& a, const Matrix3x4& b, Matrix3x4& outMat)
+{
+#if defined(MATH_SIMD_SSE2)
+
+    const __m128 a0 = _mm_load_ps(a.m[0]);
+    const __m128 a1 = _mm_load_ps(a.m[1]);
+    const __m128 a2 = _mm_load_ps(a.m[2]);
+
+    // (0,0,0,1) mask: keep only the translation component of b rows
+    const __m128 maskW = _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1));
+
+    const __m128 b0 = _mm_load_ps(b.m[0]);
+    const __m128 b1 = _mm_load_ps(b.m[1]);
+    const __m128 b2 = _mm_load_ps(b.m[2]);
+
+    __m128 r0 = _mm_and_ps(b0, maskW);
+    __m128 r1 = _mm_and_ps(b1, maskW);
+    __m128 r2 = _mm_and_ps(b2, maskW);
+
+    r0 = SimdMulAdd(SIMD_SPLAT(b0, 0), a0, r0);
+    r1 = SimdMulAdd(SIMD_SPLAT(b1, 0), a0, r1);
+    r2 = SimdMulAdd(SIMD_SPLAT(b2, 0), a0, r2);
+
+    r0 = SimdMulAdd(SIMD_SPLAT(b0, 1), a1, r0);
+    r1 = SimdMulAdd(SIMD_SPLAT(b1, 1), a1, r1);
+    r2 = SimdMulAdd(SIMD_SPLAT(b2, 1), a1, r2);
+
+    r0 = SimdMulAdd(SIMD_SPLAT(b0, 2), a2, r0);
+    r1 = SimdMulAdd(SIMD_SPLAT(b1, 2), a2, r1);
+    r2 = SimdMulAdd(SIMD_SPLAT(b2, 2), a2, r2);
+
+    _mm_store_ps(outMat.m[0], r0);
+    _mm_store_ps(outMat.m[1], r1);
+    _mm_store_ps(outMat.m[2], r2);
+
+#else
+
+    float res[3][4];
+
+    for (int i = 0; i < 3; ++i)
+    {
+        for (int j = 0; j < 4; ++j)
+        {
+            res[i][j] = b.m[i][0] * a.m[0][j] +
+                        b.m[i][1] * a.m[1][j] +
+                        b.m[i][2] * a.m[2][j];
+        }
+        res[i][3] += b.m[i][3];
+    }
+
+    memcpy(outMat.mat, res, sizeof(res));
+
+#endif
+}
+
+//---------------------------------------------------------
+// Desc:   transform a 3D point (w = 1) by the matrix
+//---------------------------------------------------------
+inline void Matrix3x4TransformPoint(const Vec3& p, const Matrix3x4& mat, Vec3& outPoint)
+{
+    const float x = p.x;
+    const float y = p.y;
+    const float z = p.z;
+
+    outPoint.x = mat.m[0][0]*x + mat.m[0][1]*y + mat.m[0][2]*z + mat.m[0][3];
+    outPoint.y = mat.m[1][0]*x + mat.m[1][1]*y + mat.m[1][2]*z + mat.m[1][3];
+    outPoint.z = mat.m[2][0]*x + mat.m[2][1]*y + mat.m[2][2]*z + mat.m[2][3];
+}
+
+//---------------------------------------------------------
+// Desc:   transform a 3D normal/direction (w = 0) by the matrix;
+//         for non-uniform scaling pass an inverse transpose matrix
+//---------------------------------------------------------
+inline void Matrix3x4TransformNormal(const Vec3& n, const Matrix3x4& mat, Vec3& outNormal)
+{
+    const float x = n.x;
+    const float y = n.y;
+    const float z = n.z;
+
+    outNormal.x = mat.m[0][0]*x + mat.m[0][1]*y + mat.m[0][2]*z;
+    outNormal.y = mat.m[1][0]*x + mat.m[1][1]*y + mat.m[1][2]*z;
+    outNormal.z = mat.m[2][0]*x + mat.m[2][1]*y + mat.m[2][2]*z;
+}
+
+//---------------------------------------------------------
+// Desc:   compute the inverse of the affine transformation:
+//         inverse of the 3x3 part by adjoint/det and the
+//         translation is -(R^-1 * t)
+// Args:   - invMat:      output inverse matrix (can be the same object as mat)
+//         - determinant: optional output determinant of the matrix
+//         - mat:         input matrix
+// Ret:    1 if the matrix is invertible, 0 otherwise
+//---------------------------------------------------------
+inline int Matrix3x4Inverse(Matrix3x4& invMat, float* determinant, const Matrix3x4& mat)
+{
+    const float (*m)[4] = mat.m;
+
+    // cofactors of the 1st column
+    const float c00 = m[1][1]*m[2][2] - m[1][2]*m[2][1];
+    const float c10 = m[1][2]*m[2][0] - m[1][0]*m[2][2];
+    const float c20 = m[1][0]*m[2][1] - m[1][1]*m[2][0];
+
+    const float det = m[0][0]*c00 + m[0][1]*c10 + m[0][2]*c20;
+
+    if (determinant != nullptr)
+        *determinant = det;
+
+    if (fabs(det) < EPSILON_E5)
+    {
+        return 0;
+    }
+
+    const float detInv = 1.0f / det;
+    float inv[3][4];
+
+    inv[0][0] = c00 * detInv;
+    inv[0][1] = (m[0][2]*m[2][1] - m[0][1]*m[2][2]) * detInv;
+    inv[0][2] = (m[0][1]*m[1][2] - m[0][2]*m[1][1]) * detInv;
+
+    inv[1][0] = c10 * detInv;
+    inv[1][1] = (m[0][0]*m[2][2] - m[0][2]*m[2][0]) * detInv;
+    inv[1][2] = (m[0][2]*m[1][0] - m[0][0]*m[1][2]) * detInv;
+
+    inv[2][0] = c20 * detInv;
+    inv[2][1] = (m[0][1]*m[2][0] - m[0][0]*m[2][1]) * detInv;
+    inv[2][2] = (m[0][0]*m[1][1] - m[0][1]*m[1][0]) * detInv;
+
+    // translation
+    for (int i = 0; i < 3; ++i)
+    {
+        inv[i][3] = -(inv[i][0]*m[0][3] + inv[i][1]*m[1][3] + inv[i][2]*m[2][3]);
+    }
+
+    memcpy(invMat.mat, inv, sizeof(inv));
+
+    return 1;
+}
+
+
+//==================================================================================
+// operators
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:   combine the current transformation with the input one
+//---------------------------------------------------------
+inline Matrix3x4& Matrix3x4::operator *= (const Matrix3x4& mat)
+{
+    Matrix3x4Mul(*this, mat, *this);
+    return *this;
+}
+
+//---------------------------------------------------------
+// Desc:   combine two transformations and return the result as a new matrix
+//---------------------------------------------------------
+inline Matrix3x4 operator * (const Matrix3x4& m1, const Matrix3x4& m2)
+{
+    Matrix3x4 result;
+    Matrix3x4Mul(m1, m2, result);
+    return result;
+}
+
+//---------------------------------------------------------
+// Desc:   matrix assignment
+//---------------------------------------------------------
+inline Matrix3x4& Matrix3x4::operator = (const Matrix3x4& src)
+{
+    if (this != &src)
+        memcpy(mat, src.mat, sizeof(mat));
+
+    return *this;
+}
@@ -0,0 +1,87 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: morton.h
+    Desc:     Morton codes (Z-order curve): bits of 3 coordinates are
+              interleaved, so points which are close in space mostly get
+              close codes; sorting by the codes gives a spatial order
+
+    Created:  17.10.2026 by DimaSkup
+\**********************************************************************************/
+#pragma once
+
+#include <math/vec3.h>
+#include <assert.h>
+#include <stdint.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+
+//---------------------------------------------------------
+// Desc:   number of leading zero bits of a 32-bit value
+// Ret:    32 if the value is 0
+//---------------------------------------------------------
+inline int CountLeadingZeros32(const uint32_t value)
+{
+    if (value == 0)
+        return 32;
+
+#if defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanReverse(&idx, value);
+    return 31 - (int)idx;
+#else
+    return __builtin_clz(value);
+#endif
+}
+
+//---------------------------------------------------------
+// Desc:   insert two zero bits after each of the lower 10 bits of a value
+//         (bit i moves into bit 3*i)
+//---------------------------------------------------------
+inline uint32_t MortonExpandBits10(uint32_t v)
+{
+    v &= 0x000003FF;
+    v = (v | (v << 16)) & 0x030000FF;
+    v = (v | (v <<  8)) & 0x0300F00F;
+    v = (v | (v <<  4)) & 0x030C30C3;
+    v = (v | (v <<  2)) & 0x09249249;
+    return v;
+}
+
+//---------------------------------------------------------
+// Desc:   30-bit Morton code of a point with 10-bit integer coords
+//---------------------------------------------------------
+inline uint32_t MortonEncode3d(const uint32_t x, const uint32_t y, const uint32_t z)
+{
+    assert(x < 1024 && y < 1024 && z < 1024);
+    return (MortonExpandBits10(x) << 2) | (MortonExpandBits10(y) << 1) | MortonExpandBits10(z);
+}
+
+//---------------------------------------------------------
+// Desc:   30-bit Morton code of a point inside of some box
+// Args:   - point:  the point to encode
+//         - minP:   min corner of the box
+//         - scale:  1024 / (size of the box) per axis (0 for flat axes)
+//---------------------------------------------------------
+inline uint32_t MortonEncodePoint(const Vec3& point, const Vec3& minP, const Vec3& scale)
+{
+    uint32_t coords[3];
+
+    for (int i = 0; i < 3; ++i)
+    {
+        const float c = (point.xyz[i] - minP.xyz[i]) * scale.xyz[i];
+        coords[i] = (c <= 0.0f) ? 0 : (c >= 1023.0f) ? 1023 : (uint32_t)c;
+    }
+
+    return MortonEncode3d(coords[0], coords[1], coords[2]);
+}
@@ -0,0 +1,474 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: quat.h
+    Desc:     quaternion (x,y,z - imaginary part, w - real part)
+
+              conventions are the same as for Matrix (and DirectXMath):
+              - QuatFromAxisAngle() gives the same rotation as MatrixRotationAxis()
+              - QuatMul(a, b) means "rotate by a, then by b", so
+                QuatToMatrix(QuatMul(a, b)) == QuatToMatrix(a) * QuatToMatrix(b)
+
+    Created:  17.10.2026 by DimaSkup
+\**********************************************************************************/
+#pragma once
+
+#include <math/matrix.h>
+#include <math/vec3.h>
+#include <math/math_helpers.h>
+#include <math/simd.h>
+#include <assert.h>
+#include <math.h>
+#include <stddef.h>
+
+
+//==================================================================================
+// Structure:  Quat
+//==================================================================================
+struct alignas(16) Quat
+{
+    //-----------------------------------------------------
+    // public data
+    //-----------------------------------------------------
+    union
+    {
+        float xyzw[4];
+
+        struct
+        {
+            float x, y, z, w;
+        };
+    };
+
+    //-----------------------------------------------------
+    // constructors
+    //-----------------------------------------------------
+
+    // identity quaternion (no rotation)
+    Quat() :
+        x{ 0 }, y{ 0 }, z{ 0 }, w{ 1 } {}
+
+    Quat(const float _x, const float _y, const float _z, const float _w) :
+        x{ _x }, y{ _y }, z{ _z }, w{ _w } {}
+
+    //-----------------------------------------------------
+    // operators
+    //-----------------------------------------------------
+    inline bool operator == (const Quat& q) const
+    {
+        return FloatEqual(x, q.x) && FloatEqual(y, q.y) && FloatEqual(z, q.z) && FloatEqual(w, q.w);
+    }
+
+    inline Quat operator - () const
+    {
+        return Quat(-x, -y, -z, -w);
+    }
+
+    inline float  operator[](const int n) const { return xyzw[n]; }
+    inline float& operator[](const int n)       { return xyzw[n]; }
+};
+
+
+//==================================================================================
+// basic functions
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:   return an identity quaternion
+//---------------------------------------------------------
+inline Quat QuatIdentity()
+{
+    return Quat(0, 0, 0, 1);
+}
+
+//---------------------------------------------------------
+// Desc:   check if two quaternions represent the same rotation
+//         (q and -q give the same rotation)
+//---------------------------------------------------------
+inline bool QuatEqualRotation(const Quat& q1, const Quat& q2)
+{
+    return (q1 == q2) || (q1 == -q2);
+}
+
+//---------------------------------------------------------
+
+inline float QuatDot(const Quat& q1, const Quat& q2)
+{
+    return q1.x*q2.x + q1.y*q2.y + q1.z*q2.z + q1.w*q2.w;
+}
+
+//---------------------------------------------------------
+
+inline float QuatLength(const Quat& q)
+{
+    return sqrtf(QuatDot(q, q));
+}
+
+//---------------------------------------------------------
+
+inline void QuatNormalize(Quat& q)
+{
+    const float invLen = 1.0f / QuatLength(q);
+    q.x *= invLen;
+    q.y *= invLen;
+    q.z *= invLen;
+    q.w *= invLen;
+}
+
+//---------------------------------------------------------
+// Desc:   return a conjugate (the inverse rotation for a unit quaternion)
+//---------------------------------------------------------
+inline Quat QuatConjugate(const Quat& q)
+{
+    return Quat(-q.x, -q.y, -q.z, q.w);
+}
+
+//---------------------------------------------------------
+// Desc:   return an inverse of any non-zero quaternion
+//---------------------------------------------------------
+inline Quat QuatInverse(const Quat& q)
+{
+    const float lenSqr = QuatDot(q, q);
+    assert(lenSqr > 0 && "divide by zero error");
+
+    const float invLenSqr = 1.0f / lenSqr;
+    return Quat(-q.x*invLenSqr, -q.y*invLenSqr, -q.z*invLenSqr, q.w*invLenSqr);
+}
+
+//---------------------------------------------------------
+// Desc:   combine two rotations: "rotate by a, then by b";
+//         it is the Hamilton product (b * a)
+//---------------------------------------------------------
+inline Quat QuatMul(const Quat& a, const Quat& b)
+{
+#if defined(MATH_SIMD_SSE2)
+
+    //   out = bw*a + bx*(aw,-az, ay,-ax) + by*(az, aw,-ax,-ay) + bz*(-ay, ax, aw,-az)
+    const __m128 q  = _mm_load_ps(a.xyzw);
+    const __m128 p  = _mm_load_ps(b.xyzw);
+
+    const __m128 signX = _mm_setr_ps( 0.0f, -0.0f,  0.0f, -0.0f);
+    const __m128 signY = _mm_setr_ps( 0.0f,  0.0f, -0.0f, -0.0f);
+    const __m128 signZ = _mm_setr_ps(-0.0f,  0.0f,  0.0f, -0.0f);
+
+    const __m128 qx = _mm_xor_ps(_mm_shuffle_ps(q, q, _MM_SHUFFLE(0,1,2,3)), signX);
+    const __m128 qy = _mm_xor_ps(_mm_shuffle_ps(q, q, _MM_SHUFFLE(1,0,3,2)), signY);
+    const __m128 qz = _mm_xor_ps(_mm_shuffle_ps(q, q, _MM_SHUFFLE(2,3,0,1)), signZ);
+
+    __m128 r = _mm_mul_ps(SIMD_SPLAT(p, 3), q);
+    r = SimdMulAdd(SIMD_SPLAT(p, 0), qx, r);
+    r = SimdMulAdd(SIMD_SPLAT(p, 1), qy, r);
+    r = SimdMulAdd(SIMD_SPLAT(p, 2), qz, r);
+
+    Quat out;
+    _mm_store_ps(out.xyzw, r);
+    return out;
+
+#else
+
+    return Quat(b.w*a.x + b.x*a.w + b.y*a.z - b.z*a.y,
+                b.w*a.y - b.x*a.z + b.y*a.w + b.z*a.x,
+                b.w*a.z + b.x*a.y - b.y*a.x + b.z*a.w,
+                b.w*a.w - b.x*a.x - b.y*a.y - b.z*a.z);
+
+#endif
+}
+
+//---------------------------------------------------------
+// Desc:   return a quaternion of rotation around an arbitrary axis
+// Args:   - axis:  vector describing the axis of rotation (doesn't have to be normalized)
+//         - angle: angle of rotation in radians (the same direction as for MatrixRotationAxis)
+//---------------------------------------------------------
+inline Quat QuatFromAxisAngle(const Vec3& axis, const float angle)
+{
+    const float len = sqrtf(SQR(axis.x) + SQR(axis.y) + SQR(axis.z));
+    assert(len > 0 && "zero length axis");
+
+    const float halfAngle = angle * 0.5f;
+    const float s         = sinf(halfAngle) / len;
+
+    return Quat(axis.x * s, axis.y * s, axis.z * s, cosf(halfAngle));
+}
+
+//---------------------------------------------------------
+// Desc:   rotate a vector by a unit quaternion:
+//         v' = v + w*t + cross(q.xyz, t),  where t = 2*cross(q.xyz, v)
+//         (the same result as MatrixMulVec3 with QuatToMatrix(q) without translation)
+//---------------------------------------------------------
+inline void QuatRotateVec3(const Vec3& v, const Quat& q, Vec3& outVec)
+{
+    const float tx = 2.0f * (q.y*v.z - q.z*v.y);
+    const float ty = 2.0f * (q.z*v.x - q.x*v.z);
+    const float tz = 2.0f * (q.x*v.y - q.y*v.x);
+
+    outVec.x = v.x + q.w*tx + (q.y*tz - q.z*ty);
+    outVec.y = v.y + q.w*ty + (q.z*tx - q.x*tz);
+    outVec.z = v.z + q.w*tz + (q.x*ty - q.y*tx);
+}
+
+
+//==================================================================================
+// conversions
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:   convert a unit quaternion into a row-major rotation matrix
+//---------------------------------------------------------
+inline void QuatToMatrix(const Quat& q, Matrix& m)
+{
+    const float xx = q.x*q.x,  yy = q.y*q.y,  zz = q.z*q.z;
+    const float xy = q.x*q.y,  xz = q.x*q.z,  yz = q.y*q.z;
+    const float wx = q.w*q.x,  wy = q.w*q.y,  wz = q.w*q.z;
+
+    m.m00 = 1.0f - 2.0f*(yy + zz);
+    m.m01 = 2.0f*(xy + wz);
+    m.m02 = 2.0f*(xz - wy);
+    m.m03 = 0.0f;
+
+    m.m10 = 2.0f*(xy - wz);
+    m.m11 = 1.0f - 2.0f*(xx + zz);
+    m.m12 = 2.0f*(yz + wx);
+    m.m13 = 0.0f;
+
+    m.m20 = 2.0f*(xz + wy);
+    m.m21 = 2.0f*(yz - wx);
+    m.m22 = 1.0f - 2.0f*(xx + yy);
+    m.m23 = 0.0f;
+
+    m.m30 = 0.0f;
+    m.m31 = 0.0f;
+    m.m32 = 0.0f;
+    m.m33 = 1.0f;
+}
+
+//---------------------------------------------------------
+
+inline Matrix QuatToMatrix(const Quat& q)
+{
+    Matrix m;
+    QuatToMatrix(q, m);
+    return m;
+}
+
+//---------------------------------------------------------
+// Desc:   extract a unit quaternion from the upper 3x3 part of the
+//         row-major matrix (which must be a pure rotation)
+//---------------------------------------------------------
+inline Quat QuatFromMatrix(const Matrix& m)
+{
+    const float trace = m.m00 + m.m11 + m.m22;
+    Quat q;
+
+    // choose the biggest component to avoid a division by a small number
+    if (trace > 0.0f)
+    {
+        const float s = 0.5f / sqrtf(trace + 1.0f);
+        q.w = 0.25f / s;
+        q.x = (m.m12 - m.m21) * s;
+        q.y = (m.m20 - m.m02) * s;
+        q.z = (m.m01 - m.m10) * s;
+    }
+    else if (m.m00 > m.m11 && m.m00 > m.m22)
+    {
+        const float s = 2.0f * sqrtf(1.0f + m.m00 - m.m11 - m.m22);
+        q.w = (m.m12 - m.m21) / s;
+        q.x = 0.25f * s;
+        q.y = (m.m10 + m.m01) / s;
+        q.z = (m.m20 + m.m02) / s;
+    }
+    else if (m.m11 > m.m22)
+    {
+        const float s = 2.0f * sqrtf(1.0f + m.m11 - m.m00 - m.m22);
+        q.w = (m.m20 - m.m02) / s;
+        q.x = (m.m10 + m.m01) / s;
+        q.y = 0.25f * s;
+        q.z = (m.m21 + m.m12) / s;
+    }
+    else
+    {
+        const float s = 2.0f * sqrtf(1.0f + m.m22 - m.m00 - m.m11);
+        q.w = (m.m01 - m.m10) / s;
+        q.x = (m.m20 + m.m02) / s;
+        q.y = (m.m21 + m.m12) / s;
+        q.z = 0.25f * s;
+    }
+
+    return q;
+}
+
+//---------------------------------------------------------
+// Desc:   convert a unit quaternion into Euler angles in 3-2-1 sequence
+// Ret:    roll (x-axis), pitch (y-axis), yaw (z-axis) packed into Vec3
+//---------------------------------------------------------
+inline Vec3 QuatToRollPitchYaw(const Quat& q)
+{
+    // x-axis rotation; (forward-backward axis)
+    const float sinrCosp = 2 * (q.w * q.x + q.y * q.z);
+    const float cosrCosp = 1 - 2 * (q.x * q.x + q.y * q.y);
+    const float roll     = atan2f(sinrCosp, cosrCosp);
+
+    // y-axis rotation; (left-right axis)
+    const float temp  = Clamp(2 * (q.w * q.y - q.x * q.z), -1.0f, 1.0f);
+    const float sinp  = sqrtf(1 + temp);
+    const float cosp  = sqrtf(1 - temp);
+    const float pitch = 2 * atan2f(sinp, cosp) - PIDIV2;
+
+    // z-axis rotation; (up-down axis)
+    const float sinyCosp = 2 * (q.w * q.z + q.x * q.y);
+    const float cosyCosp = 1 - 2 * (q.y * q.y + q.z * q.z);
+    const float yaw      = atan2f(sinyCosp, cosyCosp);
+
+    return Vec3(roll, pitch, yaw);
+}
+
+
+//==================================================================================
+// interpolation
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:   normalized linear interpolation btw two unit quaternions
+//         (by the shortest path); cheap and good enough for animation blending
+//---------------------------------------------------------
+inline Quat QuatNlerp(const Quat& a, const Quat& b, const float t)
+{
+    // if the quaternions are in different hemispheres - flip one of them
+    const float tb = (QuatDot(a, b) < 0.0f) ? -t : t;
+    const float ta = 1.0f - t;
+
+    Quat q(a.x*ta + b.x*tb,
+           a.y*ta + b.y*tb,
+           a.z*ta + b.z*tb,
+           a.w*ta + b.w*tb);
+
+    QuatNormalize(q);
+    return q;
+}
+
+//---------------------------------------------------------
+// Desc:   spherical linear interpolation btw two unit quaternions
+//         (by the shortest path, with a constant angular velocity)
+//---------------------------------------------------------
+inline Quat QuatSlerp(const Quat& a, const Quat& b, const float t)
+{
+    float cosOmega = QuatDot(a, b);
+    float sign     = 1.0f;
+
+    if (cosOmega < 0.0f)
+    {
+        cosOmega = -cosOmega;
+        sign     = -1.0f;
+    }
+
+    // if the quaternions are very close we use nlerp to avoid a division by ~0
+    if (cosOmega > 1.0f - EPSILON_E4)
+        return QuatNlerp(a, b, t);
+
+    const float omega       = acosf(cosOmega);
+    const float invSinOmega = 1.0f / sinf(omega);
+    const float ka          = sinf((1.0f - t) * omega) * invSinOmega;
+    const float kb          = sinf(t * omega) * invSinOmega * sign;
+
+    return Quat(a.x*ka + b.x*kb,
+                a.y*ka + b.y*kb,
+                a.z*ka + b.z*kb,
+                a.w*ka + b.w*kb);
+}
+
+//---------------------------------------------------------
+// Desc:   nlerp for arrays of quaternions: out[i] = nlerp(a[i], b[i], t)
+//         (blending of two animation poses with the same weight);
+//         4 quaternions are transposed into SoA registers per iteration
+// Args:   - a, b: arrays of n unit quaternions
+//         - t:    interpolation factor [0, 1]
+//         - out:  output array (can be the same as a or b)
+//         - n:    number of quaternions
+//---------------------------------------------------------
+inline void QuatNlerpBatch(const Quat* a, const Quat* b, const float t, Quat* out, const size_t n)
+{
+    assert((a != nullptr && b != nullptr && out != nullptr) || (n == 0));
+
+    size_t i = 0;
+
+#if defined(MATH_SIMD_SSE2)
+
+    const __m128 ta   = _mm_set1_ps(1.0f - t);
+    const __m128 tb   = _mm_set1_ps(t);
+    const __m128 sign = _mm_set1_ps(-0.0f);
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 ax = _mm_load_ps(a[i+0].xyzw);
+        __m128 ay = _mm_load_ps(a[i+1].xyzw);
+        __m128 az = _mm_load_ps(a[i+2].xyzw);
+        __m128 aw = _mm_load_ps(a[i+3].xyzw);
+
+        __m128 bx = _mm_load_ps(b[i+0].xyzw);
+        __m128 by = _mm_load_ps(b[i+1].xyzw);
+        __m128 bz = _mm_load_ps(b[i+2].xyzw);
+        __m128 bw = _mm_load_ps(b[i+3].xyzw);
+
+        _MM_TRANSPOSE4_PS(ax, ay, az, aw);
+        _MM_TRANSPOSE4_PS(bx, by, bz, bw);
+
+        // dot(a, b) for 4 pairs
+        __m128 dot = _mm_mul_ps(ax, bx);
+        dot = SimdMulAdd(ay, by, dot);
+        dot = SimdMulAdd(az, bz, dot);
+        dot = SimdMulAdd(aw, bw, dot);
+
+        // flip the sign of the weight of b if the dot is negative
+        const __m128 w = _mm_xor_ps(tb, _mm_and_ps(dot, sign));
+
+        __m128 qx = SimdMulAdd(bx, w, _mm_mul_ps(ax, ta));
+        __m128 qy = SimdMulAdd(by, w, _mm_mul_ps(ay, ta));
+        __m128 qz = SimdMulAdd(bz, w, _mm_mul_ps(az, ta));
+        __m128 qw = SimdMulAdd(bw, w, _mm_mul_ps(aw, ta));
+
+        // normalize
+        __m128 lenSqr = _mm_mul_ps(qx, qx);
+        lenSqr = SimdMulAdd(qy, qy, lenSqr);
+        lenSqr = SimdMulAdd(qz, qz, lenSqr);
+        lenSqr = SimdMulAdd(qw, qw, lenSqr);
+
+        const __m128 invLen = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(lenSqr));
+
+        qx = _mm_mul_ps(qx, invLen);
+        qy = _mm_mul_ps(qy, invLen);
+        qz = _mm_mul_ps(qz, invLen);
+        qw = _mm_mul_ps(qw, invLen);
+
+        _MM_TRANSPOSE4_PS(qx, qy, qz, qw);
+
+        _mm_store_ps(out[i+0].xyzw, qx);
+        _mm_store_ps(out[i+1].xyzw, qy);
+        _mm_store_ps(out[i+2].xyzw, qz);
+        _mm_store_ps(out[i+3].xyzw, qw);
+    }
+
+#endif
+
+    // the tail (or everything if there is no SIMD)
+    for (; i < n; ++i)
+        out[i] = QuatNlerp(a[i], b[i], t);
+}
+
+
+//==================================================================================
+// operators
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:   combine two rotations: "rotate by a, then by b" (the same as QuatMul)
+//---------------------------------------------------------
+inline Quat operator * (const Quat& a, const Quat& b)
+{
+    return QuatMul(a, b);
+}
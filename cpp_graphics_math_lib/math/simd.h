@@ -0,0 +1,292 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: simd.h
+    Desc:     compile-time selection of the SIMD instruction set and
+              a few small intrinsic helpers shared by the math/geometry code
+
+              the level is chosen from the compiler flags:
+                  SSE2      - always on x64 (or /arch:SSE2, -msse2)
+                  SSE4.1    - /arch:AVX or -msse4.1
+                  FMA       - /arch:AVX2 or -mfma
+                  AVX2      - /arch:AVX2 or -mavx2
+
+              define MATH_NO_SIMD before including any header of the library
+              to force the scalar code paths (useful for debugging/comparison)
+
+    Created:  17.10.2026 by DimaSkup
+\**********************************************************************************/
+#pragma once
+
+#include <stddef.h>
+
+//---------------------------------------------------------
+// detect available instruction sets
+//---------------------------------------------------------
+#if !defined(MATH_NO_SIMD)
+
+    #if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || \
+        (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+        #define MATH_SIMD_SSE2 1
+    #endif
+
+    #if defined(MATH_SIMD_SSE2) && (defined(__SSE4_1__) || defined(__AVX__))
+        #define MATH_SIMD_SSE4 1
+    #endif
+
+    // MSVC doesn't define __FMA__ but emits FMA instructions under /arch:AVX2
+    #if defined(MATH_SIMD_SSE2) && (defined(__FMA__) || (defined(_MSC_VER) && defined(__AVX2__)))
+        #define MATH_SIMD_FMA 1
+    #endif
+
+    #if defined(MATH_SIMD_SSE2) && defined(__AVX2__)
+        #define MATH_SIMD_AVX2 1
+    #endif
+
+#endif // !MATH_NO_SIMD
+
+
+//---------------------------------------------------------
+// intrinsic headers
+//---------------------------------------------------------
+#if defined(MATH_SIMD_AVX2) || defined(MATH_SIMD_FMA)
+    #include <immintrin.h>
+#elif defined(MATH_SIMD_SSE4)
+    #include <smmintrin.h>
+#elif defined(MATH_SIMD_SSE2)
+    #include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+    #include <malloc.h>
+#else
+    #include <stdlib.h>
+#endif
+
+
+//---------------------------------------------------------
+// Desc:   allocate/release memory aligned for SIMD loads and cache lines
+//         (std::align_val_t is C++17, and the project is built as C++14)
+// Args:   - bytes:     size of the memory block
+//         - alignment: a power of 2, at least sizeof(void*)
+// Ret:    the memory block or nullptr
+//---------------------------------------------------------
+inline void* AlignedAlloc(const size_t bytes, const size_t alignment)
+{
+#if defined(_MSC_VER)
+    return _aligned_malloc(bytes, alignment);
+#else
+    void* ptr = nullptr;
+    return (posix_memalign(&ptr, alignment, bytes) == 0) ? ptr : nullptr;
+#endif
+}
+
+inline void AlignedFree(void* ptr)
+{
+#if defined(_MSC_VER)
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
+
+
+#if defined(MATH_SIMD_SSE2)
+
+//---------------------------------------------------------
+// Desc:   broadcast a lane of the input register into all the 4 lanes
+//---------------------------------------------------------
+#define SIMD_SPLAT(v, lane) _mm_shuffle_ps((v), (v), _MM_SHUFFLE(lane, lane, lane, lane))
+
+//---------------------------------------------------------
+// Desc:   return a*b + c (fused if FMA is available)
+//---------------------------------------------------------
+inline __m128 SimdMulAdd(const __m128 a, const __m128 b, const __m128 c)
+{
+#if defined(MATH_SIMD_FMA)
+    return _mm_fmadd_ps(a, b, c);
+#else
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+}
+
+//---------------------------------------------------------
+// Desc:   overloaded wrappers of the basic arithmetic, so templated kernels
+//         can be written once for both __m128 and __m256
+//---------------------------------------------------------
+inline __m128 SimdAdd(const __m128 a, const __m128 b) { return _mm_add_ps(a, b); }
+inline __m128 SimdSub(const __m128 a, const __m128 b) { return _mm_sub_ps(a, b); }
+inline __m128 SimdMul(const __m128 a, const __m128 b) { return _mm_mul_ps(a, b); }
+inline __m128 SimdDiv(const __m128 a, const __m128 b) { return _mm_div_ps(a, b); }
+inline __m128 SimdSqrt(const __m128 a)                { return _mm_sqrt_ps(a); }
+inline __m128 SimdMin(const __m128 a, const __m128 b) { return _mm_min_ps(a, b); }
+inline __m128 SimdMax(const __m128 a, const __m128 b) { return _mm_max_ps(a, b); }
+inline __m128 SimdAnd(const __m128 a, const __m128 b) { return _mm_and_ps(a, b); }
+inline __m128 SimdOr (const __m128 a, const __m128 b) { return _mm_or_ps(a, b); }
+
+// comparisons return all-ones lanes for "true" (false for NaN)
+inline __m128 SimdCmpGe(const __m128 a, const __m128 b) { return _mm_cmpge_ps(a, b); }
+inline __m128 SimdCmpGt(const __m128 a, const __m128 b) { return _mm_cmpgt_ps(a, b); }
+inline __m128 SimdCmpLe(const __m128 a, const __m128 b) { return _mm_cmple_ps(a, b); }
+inline __m128 SimdCmpLt(const __m128 a, const __m128 b) { return _mm_cmplt_ps(a, b); }
+
+// one bit per lane (the sign bit of each lane)
+inline int SimdMoveMask(const __m128 a) { return _mm_movemask_ps(a); }
+
+// broadcast a float into all the lanes (output param to allow overloading)
+inline void SimdSet1(const float f, __m128& out) { out = _mm_set1_ps(f); }
+
+// aligned load/store of all the lanes
+inline void SimdLoad(const float* p, __m128& out) { out = _mm_load_ps(p); }
+inline void SimdStore(float* p, const __m128 a)   { _mm_store_ps(p, a); }
+inline void SimdStoreu(float* p, const __m128 a)  { _mm_storeu_ps(p, a); }
+
+// broadcast a raw 32-bit pattern (e.g. 0xFFFFFFFF mask) into all the lanes
+inline void SimdSet1Bits(const unsigned int bits, __m128& out) { out = _mm_castsi128_ps(_mm_set1_epi32((int)bits)); }
+
+// per lane: mask ? a : b  (mask lanes must be all ones or all zeros)
+inline __m128 SimdSelect(const __m128 mask, const __m128 a, const __m128 b)
+{
+#if defined(MATH_SIMD_SSE4)
+    return _mm_blendv_ps(b, a, mask);
+#else
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+#endif
+}
+
+//---------------------------------------------------------
+// Desc:   SIMD helper: load 4 vectors of 3 floats (Vec3) from the array with
+//         input stride (in bytes) and transpose them into SoA registers x, y, z
+//---------------------------------------------------------
+inline void LoadVec3x4Simd(
+    const unsigned char* p,
+    const size_t stride,
+    __m128& x,
+    __m128& y,
+    __m128& z)
+{
+    if (stride == 3*sizeof(float))
+    {
+        // v0 = x0 y0 z0 x1;  v1 = y1 z1 x2 y2;  v2 = z2 x3 y3 z3
+        const __m128 v0 = _mm_loadu_ps((const float*)p);
+        const __m128 v1 = _mm_loadu_ps((const float*)p + 4);
+        const __m128 v2 = _mm_loadu_ps((const float*)p + 8);
+
+        const __m128 tx = _mm_shuffle_ps(v1, v2, _MM_SHUFFLE(1,1,2,2));
+        x = _mm_shuffle_ps(v0, tx, _MM_SHUFFLE(2,0,3,0));
+
+        const __m128 ty0 = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(0,0,1,1));
+        const __m128 ty1 = _mm_shuffle_ps(v1, v2, _MM_SHUFFLE(2,2,3,3));
+        y = _mm_shuffle_ps(ty0, ty1, _MM_SHUFFLE(2,0,2,0));
+
+        const __m128 tz0 = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(1,1,2,2));
+        const __m128 tz1 = _mm_shuffle_ps(v2, v2, _MM_SHUFFLE(3,3,0,0));
+        z = _mm_shuffle_ps(tz0, tz1, _MM_SHUFFLE(2,0,2,0));
+    }
+    else
+    {
+        const float* p0 = (const float*)(p);
+        const float* p1 = (const float*)(p + stride);
+        const float* p2 = (const float*)(p + stride*2);
+        const float* p3 = (const float*)(p + stride*3);
+
+        x = _mm_setr_ps(p0[0], p1[0], p2[0], p3[0]);
+        y = _mm_setr_ps(p0[1], p1[1], p2[1], p3[1]);
+        z = _mm_setr_ps(p0[2], p1[2], p2[2], p3[2]);
+    }
+}
+
+//---------------------------------------------------------
+// Desc:   SIMD helper: transpose SoA registers x, y, z back into 4 Vec3 and
+//         store them into the array with output stride (in bytes)
+//---------------------------------------------------------
+inline void StoreVec3x4Simd(
+    unsigned char* p,
+    const size_t stride,
+    const __m128 x,
+    const __m128 y,
+    const __m128 z)
+{
+    if (stride == 3*sizeof(float))
+    {
+        const __m128 t0 = _mm_shuffle_ps(x, y, _MM_SHUFFLE(0,0,0,0));
+        const __m128 u0 = _mm_shuffle_ps(z, x, _MM_SHUFFLE(1,1,0,0));
+        const __m128 t1 = _mm_shuffle_ps(y, z, _MM_SHUFFLE(1,1,1,1));
+        const __m128 u1 = _mm_shuffle_ps(x, y, _MM_SHUFFLE(2,2,2,2));
+        const __m128 t2 = _mm_shuffle_ps(z, x, _MM_SHUFFLE(3,3,2,2));
+        const __m128 u2 = _mm_shuffle_ps(y, z, _MM_SHUFFLE(3,3,3,3));
+
+        _mm_storeu_ps((float*)p,     _mm_shuffle_ps(t0, u0, _MM_SHUFFLE(2,0,2,0)));
+        _mm_storeu_ps((float*)p + 4, _mm_shuffle_ps(t1, u1, _MM_SHUFFLE(2,0,2,0)));
+        _mm_storeu_ps((float*)p + 8, _mm_shuffle_ps(t2, u2, _MM_SHUFFLE(2,0,2,0)));
+    }
+    else
+    {
+        alignas(16) float fx[4];
+        alignas(16) float fy[4];
+        alignas(16) float fz[4];
+
+        _mm_store_ps(fx, x);
+        _mm_store_ps(fy, y);
+        _mm_store_ps(fz, z);
+
+        for (int i = 0; i < 4; ++i)
+        {
+            float* dst = (float*)(p + stride*i);
+            dst[0] = fx[i];
+            dst[1] = fy[i];
+            dst[2] = fz[i];
+        }
+    }
+}
+
+#endif // MATH_SIMD_SSE2
+
+
+#if defined(MATH_SIMD_AVX2)
+
+//---------------------------------------------------------
+// Desc:   return a*b + c for 8 lanes (fused if FMA is available)
+//---------------------------------------------------------
+inline __m256 SimdMulAdd(const __m256 a, const __m256 b, const __m256 c)
+{
+#if defined(MATH_SIMD_FMA)
+    return _mm256_fmadd_ps(a, b, c);
+#else
+    return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+}
+
+inline __m256 SimdAdd(const __m256 a, const __m256 b) { return _mm256_add_ps(a, b); }
+inline __m256 SimdSub(const __m256 a, const __m256 b) { return _mm256_sub_ps(a, b); }
+inline __m256 SimdMul(const __m256 a, const __m256 b) { return _mm256_mul_ps(a, b); }
+inline __m256 SimdDiv(const __m256 a, const __m256 b) { return _mm256_div_ps(a, b); }
+inline __m256 SimdSqrt(const __m256 a)                { return _mm256_sqrt_ps(a); }
+inline __m256 SimdMin(const __m256 a, const __m256 b) { return _mm256_min_ps(a, b); }
+inline __m256 SimdMax(const __m256 a, const __m256 b) { return _mm256_max_ps(a, b); }
+inline __m256 SimdAnd(const __m256 a, const __m256 b) { return _mm256_and_ps(a, b); }
+inline __m256 SimdOr (const __m256 a, const __m256 b) { return _mm256_or_ps(a, b); }
+
+inline __m256 SimdCmpGe(const __m256 a, const __m256 b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+inline __m256 SimdCmpGt(const __m256 a, const __m256 b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+inline __m256 SimdCmpLe(const __m256 a, const __m256 b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+inline __m256 SimdCmpLt(const __m256 a, const __m256 b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+
+inline int SimdMoveMask(const __m256 a) { return _mm256_movemask_ps(a); }
+
+inline void SimdSet1(const float f, __m256& out) { out = _mm256_set1_ps(f); }
+inline void SimdLoad(const float* p, __m256& out) { out = _mm256_load_ps(p); }
+inline void SimdStore(float* p, const __m256 a)   { _mm256_store_ps(p, a); }
+inline void SimdStoreu(float* p, const __m256 a)  { _mm256_storeu_ps(p, a); }
+inline void SimdSet1Bits(const unsigned int bits, __m256& out) { out = _mm256_castsi256_ps(_mm256_set1_epi32((int)bits)); }
+
+inline __m256 SimdSelect(const __m256 mask, const __m256 a, const __m256 b) { return _mm256_blendv_ps(b, a, mask); }
+
+#endif // MATH_SIMD_AVX2
@@ -0,0 +1,351 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: trs.h
+    Desc:     composition of (translation, rotation, scale) into a matrix,
+              for single elements and for SoA arrays (animation palettes)
+
+              the result is the same as for:
+                  MatrixScaling(s) * QuatToMatrix(q) * MatrixTranslation(t)
+              but without any sin/cos and matrix multiplications
+
+    Created:  17.10.2026 by DimaSkup
+\**********************************************************************************/
+#pragma once
+
+#include <math/matrix.h>
+#include <math/matrix3x4.h>
+#include <math/quat.h>
+#include <math/vec3.h>
+#include <math/simd.h>
+#include <assert.h>
+#include <stddef.h>
+
+
+//==================================================================================
+// Structure:  TRSArraysSoA
+// Desc:       pointers to the SoA arrays of (translation, rotation, scale),
+//             all the arrays must have the same number of elements;
+//             rotations must be unit quaternions
+//==================================================================================
+struct TRSArraysSoA
+{
+    const float* tx = nullptr;      // translation
+    const float* ty = nullptr;
+    const float* tz = nullptr;
+
+    const float* qx = nullptr;      // rotation
+    const float* qy = nullptr;
+    const float* qz = nullptr;
+    const float* qw = nullptr;
+
+    const float* sx = nullptr;      // scale
+    const float* sy = nullptr;
+    const float* sz = nullptr;
+};
+
+
+//==================================================================================
+// single element
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:   build a row-major matrix: scale, then rotate, then translate
+// Args:   - t:      translation
+//         - q:      rotation (unit quaternion)
+//         - s:      scale
+//         - outMat: output matrix
+//---------------------------------------------------------
+inline void ComposeTRS(const Vec3& t, const Quat& q, const Vec3& s, Matrix& outMat)
+{
+    QuatToMatrix(q, outMat);
+
+    outMat.m00 *= s.x;  outMat.m01 *= s.x;  outMat.m02 *= s.x;
+    outMat.m10 *= s.y;  outMat.m11 *= s.y;  outMat.m12 *= s.y;
+    outMat.m20 *= s.z;  outMat.m21 *= s.z;  outMat.m22 *= s.z;
+
+    outMat.m30 = t.x;
+    outMat.m31 = t.y;
+    outMat.m32 = t.z;
+}
+
+//---------------------------------------------------------
+// Desc:   the same as above but the output is a compact 3x4 matrix
+//---------------------------------------------------------
+inline void ComposeTRS(const Vec3& t, const Quat& q, const Vec3& s, Matrix3x4& outMat)
+{
+    Matrix m;
+    ComposeTRS(t, q, s, m);
+    Matrix3x4FromMatrix(m, outMat);
+}
+
+
+//==================================================================================
+// SIMD helpers
+//==================================================================================
+#if defined(MATH_SIMD_SSE2)
+
+//---------------------------------------------------------
+// Desc:   SIMD helper: compute the upper 3x3 part of TRS matrix for 4 (or 8)
+//         elements in SoA form: r[i][j] = scale[i] * rotation[i][j]
+//---------------------------------------------------------
+template <class T>
+inline void ComposeRotScaleSoASimd(
+    const T qx, const T qy, const T qz, const T qw,
+    const T sx, const T sy, const T sz,
+    const T one,
+    T r[3][3])
+{
+    const T x2 = SimdAdd(qx, qx);
+    const T y2 = SimdAdd(qy, qy);
+    const T z2 = SimdAdd(qz, qz);
+
+    const T xx = SimdMul(qx, x2);
+    const T yy = SimdMul(qy, y2);
+    const T zz = SimdMul(qz, z2);
+    const T xy = SimdMul(qx, y2);
+    const T xz = SimdMul(qx, z2);
+    const T yz = SimdMul(qy, z2);
+    const T wx = SimdMul(qw, x2);
+    const T wy = SimdMul(qw, y2);
+    const T wz = SimdMul(qw, z2);
+
+    r[0][0] = SimdMul(SimdSub(one, SimdAdd(yy, zz)), sx);
+    r[0][1] = SimdMul(SimdAdd(xy, wz), sx);
+    r[0][2] = SimdMul(SimdSub(xz, wy), sx);
+
+    r[1][0] = SimdMul(SimdSub(xy, wz), sy);
+    r[1][1] = SimdMul(SimdSub(one, SimdAdd(xx, zz)), sy);
+    r[1][2] = SimdMul(SimdAdd(yz, wx), sy);
+
+    r[2][0] = SimdMul(SimdAdd(xz, wy), sz);
+    r[2][1] = SimdMul(SimdSub(yz, wx), sz);
+    r[2][2] = SimdMul(SimdSub(one, SimdAdd(xx, yy)), sz);
+}
+
+//---------------------------------------------------------
+// Desc:   SIMD helper: transpose 4 SoA registers and store the result
+//         into the row (of index row) of 4 sequential matrices
+//---------------------------------------------------------
+template <class TMatrix>
+inline void StoreRowsTransposedSimd(__m128 a, __m128 b, __m128 c, __m128 d, const int row, TMatrix* out)
+{
+    _MM_TRANSPOSE4_PS(a, b, c, d);
+
+    _mm_store_ps(out[0].m[row], a);
+    _mm_store_ps(out[1].m[row], b);
+    _mm_store_ps(out[2].m[row], c);
+    _mm_store_ps(out[3].m[row], d);
+}
+
+//---------------------------------------------------------
+// Desc:   SIMD helper: store 4 elements of TRS in SoA form as 4x4 matrices
+//---------------------------------------------------------
+inline void StoreTRSSimd(
+    const __m128 r[3][3],
+    const __m128 tx, const __m128 ty, const __m128 tz,
+    Matrix* out)
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one  = _mm_set1_ps(1.0f);
+
+    StoreRowsTransposedSimd(r[0][0], r[0][1], r[0][2], zero, 0, out);
+    StoreRowsTransposedSimd(r[1][0], r[1][1], r[1][2], zero, 1, out);
+    StoreRowsTransposedSimd(r[2][0], r[2][1], r[2][2], zero, 2, out);
+    StoreRowsTransposedSimd(tx, ty, tz, one, 3, out);
+}
+
+//---------------------------------------------------------
+// Desc:   SIMD helper: store 4 elements of TRS in SoA form as 3x4 matrices
+//         (each row of Matrix3x4 is a column of 4x4 matrix)
+//---------------------------------------------------------
+inline void StoreTRSSimd(
+    const __m128 r[3][3],
+    const __m128 tx, const __m128 ty, const __m128 tz,
+    Matrix3x4* out)
+{
+    StoreRowsTransposedSimd(r[0][0], r[1][0], r[2][0], tx, 0, out);
+    StoreRowsTransposedSimd(r[0][1], r[1][1], r[2][1], ty, 1, out);
+    StoreRowsTransposedSimd(r[0][2], r[1][2], r[2][2], tz, 2, out);
+}
+
+//---------------------------------------------------------
+// Desc:   a common SIMD implementation of ComposeTRSBatch for Matrix/Matrix3x4:
+//         8 elements per iteration with AVX2 (4 with SSE)
+// Ret:    number of processed elements (the tail must be processed by the caller)
+//---------------------------------------------------------
+template <class TMatrix>
+inline size_t ComposeTRSBatchSimd(const TRSArraysSoA& trs, TMatrix* out, const size_t n)
+{
+    size_t i = 0;
+
+#if defined(MATH_SIMD_AVX2)
+
+    const __m256 one8 = _mm256_set1_ps(1.0f);
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256 r8[3][3];
+
+        ComposeRotScaleSoASimd(
+            _mm256_loadu_ps(trs.qx + i),
+            _mm256_loadu_ps(trs.qy + i),
+            _mm256_loadu_ps(trs.qz + i),
+            _mm256_loadu_ps(trs.qw + i),
+            _mm256_loadu_ps(trs.sx + i),
+            _mm256_loadu_ps(trs.sy + i),
+            _mm256_loadu_ps(trs.sz + i),
+            one8,
+            r8);
+
+        // split into two halves of 4 elements and transpose them into matrices
+        __m128 rl[3][3];
+        __m128 rh[3][3];
+
+        for (int r = 0; r < 3; ++r)
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                rl[r][c] = _mm256_castps256_ps128(r8[r][c]);
+                rh[r][c] = _mm256_extractf128_ps(r8[r][c], 1);
+            }
+        }
+
+        StoreTRSSimd(rl,
+                     _mm_loadu_ps(trs.tx + i),
+                     _mm_loadu_ps(trs.ty + i),
+                     _mm_loadu_ps(trs.tz + i),
+                     out + i);
+
+        StoreTRSSimd(rh,
+                     _mm_loadu_ps(trs.tx + i + 4),
+                     _mm_loadu_ps(trs.ty + i + 4),
+                     _mm_loadu_ps(trs.tz + i + 4),
+                     out + i + 4);
+    }
+
+#endif
+
+    const __m128 one = _mm_set1_ps(1.0f);
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 r[3][3];
+
+        ComposeRotScaleSoASimd(
+            _mm_loadu_ps(trs.qx + i),
+            _mm_loadu_ps(trs.qy + i),
+            _mm_loadu_ps(trs.qz + i),
+            _mm_loadu_ps(trs.qw + i),
+            _mm_loadu_ps(trs.sx + i),
+            _mm_loadu_ps(trs.sy + i),
+            _mm_loadu_ps(trs.sz + i),
+            one,
+            r);
+
+        StoreTRSSimd(r,
+                     _mm_loadu_ps(trs.tx + i),
+                     _mm_loadu_ps(trs.ty + i),
+                     _mm_loadu_ps(trs.tz + i),
+                     out + i);
+    }
+
+    return i;
+}
+
+#endif // MATH_SIMD_SSE2
+
+
+//==================================================================================
+// batch functions
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:   build n matrices from SoA arrays of (translation, rotation, scale);
+//         out[i] = MatrixScaling(s[i]) * QuatToMatrix(q[i]) * MatrixTranslation(t[i])
+// Args:   - trs: pointers to the input arrays
+//         - out: output array of n matrices
+//         - n:   number of elements
+//---------------------------------------------------------
+template <class TMatrix>
+inline void ComposeTRSBatchImpl(const TRSArraysSoA& trs, TMatrix* out, const size_t n)
+{
+    assert((out != nullptr) || (n == 0));
+    assert((trs.tx && trs.ty && trs.tz) || (n == 0));
+    assert((trs.qx && trs.qy && trs.qz && trs.qw) || (n == 0));
+    assert((trs.sx && trs.sy && trs.sz) || (n == 0));
+
+    size_t i = 0;
+
+#if defined(MATH_SIMD_SSE2)
+    i = ComposeTRSBatchSimd(trs, out, n);
+#endif
+
+    // the tail (or everything if there is no SIMD)
+    for (; i < n; ++i)
+    {
+        ComposeTRS(Vec3(trs.tx[i], trs.ty[i], trs.tz[i]),
+                   Quat(trs.qx[i], trs.qy[i], trs.qz[i], trs.qw[i]),
+                   Vec3(trs.sx[i], trs.sy[i], trs.sz[i]),
+                   out[i]);
+    }
+}
+
+//---------------------------------------------------------
+
+inline void ComposeTRSBatch(const TRSArraysSoA& trs, Matrix* out, const size_t n)
+{
+    ComposeTRSBatchImpl(trs, out, n);
+}
+
+//---------------------------------------------------------
+
+inline void ComposeTRSBatch(const TRSArraysSoA& trs, Matrix3x4* out, const size_t n)
+{
+    ComposeTRSBatchImpl(trs, out, n);
+}
+
+//---------------------------------------------------------
+// Desc:   convert an array of unit quaternions into rotation matrices
+// Args:   - quats: input array of n quaternions
+//         - out:   output array of n matrices
+//         - n:     number of elements
+//---------------------------------------------------------
+inline void QuatToMatrixBatch(const Quat* quats, Matrix* out, const size_t n)
+{
+    assert((quats != nullptr && out != nullptr) || (n == 0));
+
+    size_t i = 0;
+
+#if defined(MATH_SIMD_SSE2)
+
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one  = _mm_set1_ps(1.0f);
+
+    for (; i + 4 <= n; i += 4)
+    {
+        // AoS -> SoA
+        __m128 qx = _mm_load_ps(quats[i+0].xyzw);
+        __m128 qy = _mm_load_ps(quats[i+1].xyzw);
+        __m128 qz = _mm_load_ps(quats[i+2].xyzw);
+        __m128 qw = _mm_load_ps(quats[i+3].xyzw);
+
+        _MM_TRANSPOSE4_PS(qx, qy, qz, qw);
+
+        __m128 r[3][3];
+        ComposeRotScaleSoASimd(qx, qy, qz, qw, one, one, one, one, r);
+        StoreTRSSimd(r, zero, zero, zero, out + i);
+    }
+
+#endif
+
+    for (; i < n; ++i)
+        QuatToMatrix(quats[i], out[i]);
+}
@@ -0,0 +1,592 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: vec3_soa.h
+    Desc:     structure-of-arrays form of Vec3:
+              - Vec3x8  - 8 vectors in SoA form (one AVX register per component)
+              - Vec3SoA - a container of any number of vectors in SoA form,
+                          which is processed by Vec3x8 blocks
+
+    Created:  17.10.2026 by DimaSkup
+\**********************************************************************************/
+#pragma once
+
+#include <math/vec3.h>
+#include <math/simd.h>
+#include <assert.h>
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+
+
+//==================================================================================
+// Structure:  Vec3x8
+// Desc:       8 lanes of Vec3 in SoA form
+//==================================================================================
+struct alignas(32) Vec3x8
+{
+    //-----------------------------------------------------
+    // public data
+    //-----------------------------------------------------
+    float x[8]{ 0 };
+    float y[8]{ 0 };
+    float z[8]{ 0 };
+
+    //-----------------------------------------------------
+    // constructors
+    //-----------------------------------------------------
+    Vec3x8() {}
+
+    // broadcast the same vector into all the lanes
+    explicit Vec3x8(const Vec3& v)
+    {
+        for (int i = 0; i < 8; ++i)
+        {
+            x[i] = v.x;
+            y[i] = v.y;
+            z[i] = v.z;
+        }
+    }
+
+    //-----------------------------------------------------
+    // access to a single lane
+    //-----------------------------------------------------
+    inline Vec3 Get(const int lane) const
+    {
+        assert(lane >= 0 && lane < 8);
+        return Vec3(x[lane], y[lane], z[lane]);
+    }
+
+    inline void Set(const int lane, const Vec3& v)
+    {
+        assert(lane >= 0 && lane < 8);
+        x[lane] = v.x;
+        y[lane] = v.y;
+        z[lane] = v.z;
+    }
+};
+
+
+//==================================================================================
+// Vec3x8: arithmetic
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:   component-wise a + b for each lane
+//---------------------------------------------------------
+inline Vec3x8 Vec3x8Add(const Vec3x8& a, const Vec3x8& b)
+{
+    Vec3x8 out;
+
+#if defined(MATH_SIMD_AVX2)
+    _mm256_store_ps(out.x, _mm256_add_ps(_mm256_load_ps(a.x), _mm256_load_ps(b.x)));
+    _mm256_store_ps(out.y, _mm256_add_ps(_mm256_load_ps(a.y), _mm256_load_ps(b.y)));
+    _mm256_store_ps(out.z, _mm256_add_ps(_mm256_load_ps(a.z), _mm256_load_ps(b.z)));
+#else
+    for (int i = 0; i < 8; ++i)
+    {
+        out.x[i] = a.x[i] + b.x[i];
+        out.y[i] = a.y[i] + b.y[i];
+        out.z[i] = a.z[i] + b.z[i];
+    }
+#endif
+
+    return out;
+}
+
+//---------------------------------------------------------
+// Desc:   component-wise a - b for each lane
+//---------------------------------------------------------
+inline Vec3x8 Vec3x8Sub(const Vec3x8& a, const Vec3x8& b)
+{
+    Vec3x8 out;
+
+#if defined(MATH_SIMD_AVX2)
+    _mm256_store_ps(out.x, _mm256_sub_ps(_mm256_load_ps(a.x), _mm256_load_ps(b.x)));
+    _mm256_store_ps(out.y, _mm256_sub_ps(_mm256_load_ps(a.y), _mm256_load_ps(b.y)));
+    _mm256_store_ps(out.z, _mm256_sub_ps(_mm256_load_ps(a.z), _mm256_load_ps(b.z)));
+#else
+    for (int i = 0; i < 8; ++i)
+    {
+        out.x[i] = a.x[i] - b.x[i];
+        out.y[i] = a.y[i] - b.y[i];
+        out.z[i] = a.z[i] - b.z[i];
+    }
+#endif
+
+    return out;
+}
+
+//---------------------------------------------------------
+// Desc:   component-wise a * b for each lane
+//---------------------------------------------------------
+inline Vec3x8 Vec3x8Mul(const Vec3x8& a, const Vec3x8& b)
+{
+    Vec3x8 out;
+
+#if defined(MATH_SIMD_AVX2)
+    _mm256_store_ps(out.x, _mm256_mul_ps(_mm256_load_ps(a.x), _mm256_load_ps(b.x)));
+    _mm256_store_ps(out.y, _mm256_mul_ps(_mm256_load_ps(a.y), _mm256_load_ps(b.y)));
+    _mm256_store_ps(out.z, _mm256_mul_ps(_mm256_load_ps(a.z), _mm256_load_ps(b.z)));
+#else
+    for (int i = 0; i < 8; ++i)
+    {
+        out.x[i] = a.x[i] * b.x[i];
+        out.y[i] = a.y[i] * b.y[i];
+        out.z[i] = a.z[i] * b.z[i];
+    }
+#endif
+
+    return out;
+}
+
+//---------------------------------------------------------
+// Desc:   multiply each lane by a scalar
+//---------------------------------------------------------
+inline Vec3x8 Vec3x8Mul(const Vec3x8& a, const float s)
+{
+    Vec3x8 out;
+
+#if defined(MATH_SIMD_AVX2)
+    const __m256 s8 = _mm256_set1_ps(s);
+    _mm256_store_ps(out.x, _mm256_mul_ps(_mm256_load_ps(a.x), s8));
+    _mm256_store_ps(out.y, _mm256_mul_ps(_mm256_load_ps(a.y), s8));
+    _mm256_store_ps(out.z, _mm256_mul_ps(_mm256_load_ps(a.z), s8));
+#else
+    for (int i = 0; i < 8; ++i)
+    {
+        out.x[i] = a.x[i] * s;
+        out.y[i] = a.y[i] * s;
+        out.z[i] = a.z[i] * s;
+    }
+#endif
+
+    return out;
+}
+
+//---------------------------------------------------------
+// Desc:   component-wise a*b + c for each lane (fused if FMA is available)
+//---------------------------------------------------------
+inline Vec3x8 Vec3x8MulAdd(const Vec3x8& a, const Vec3x8& b, const Vec3x8& c)
+{
+    Vec3x8 out;
+
+#if defined(MATH_SIMD_AVX2)
+    _mm256_store_ps(out.x, SimdMulAdd(_mm256_load_ps(a.x), _mm256_load_ps(b.x), _mm256_load_ps(c.x)));
+    _mm256_store_ps(out.y, SimdMulAdd(_mm256_load_ps(a.y), _mm256_load_ps(b.y), _mm256_load_ps(c.y)));
+    _mm256_store_ps(out.z, SimdMulAdd(_mm256_load_ps(a.z), _mm256_load_ps(b.z), _mm256_load_ps(c.z)));
+#else
+    for (int i = 0; i < 8; ++i)
+    {
+        out.x[i] = a.x[i] * b.x[i] + c.x[i];
+        out.y[i] = a.y[i] * b.y[i] + c.y[i];
+        out.z[i] = a.z[i] * b.z[i] + c.z[i];
+    }
+#endif
+
+    return out;
+}
+
+
+//==================================================================================
+// Vec3x8: dot and cross product, length
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:   dot product for each pair of lanes
+// Args:   - outDot: array of 8 floats
+//---------------------------------------------------------
+inline void Vec3x8Dot(const Vec3x8& a, const Vec3x8& b, float* outDot)
+{
+    assert(outDot != nullptr);
+
+#if defined(MATH_SIMD_AVX2)
+    __m256 dot = _mm256_mul_ps(_mm256_load_ps(a.x), _mm256_load_ps(b.x));
+    dot = SimdMulAdd(_mm256_load_ps(a.y), _mm256_load_ps(b.y), dot);
+    dot = SimdMulAdd(_mm256_load_ps(a.z), _mm256_load_ps(b.z), dot);
+    _mm256_storeu_ps(outDot, dot);
+#else
+    for (int i = 0; i < 8; ++i)
+        outDot[i] = a.x[i]*b.x[i] + a.y[i]*b.y[i] + a.z[i]*b.z[i];
+#endif
+}
+
+//---------------------------------------------------------
+// Desc:   cross product for each pair of lanes
+//---------------------------------------------------------
+inline Vec3x8 Vec3x8Cross(const Vec3x8& a, const Vec3x8& b)
+{
+    Vec3x8 out;
+
+#if defined(MATH_SIMD_AVX2)
+    const __m256 ax = _mm256_load_ps(a.x);
+    const __m256 ay = _mm256_load_ps(a.y);
+    const __m256 az = _mm256_load_ps(a.z);
+    const __m256 bx = _mm256_load_ps(b.x);
+    const __m256 by = _mm256_load_ps(b.y);
+    const __m256 bz = _mm256_load_ps(b.z);
+
+    _mm256_store_ps(out.x, _mm256_sub_ps(_mm256_mul_ps(ay, bz), _mm256_mul_ps(az, by)));
+    _mm256_store_ps(out.y, _mm256_sub_ps(_mm256_mul_ps(az, bx), _mm256_mul_ps(ax, bz)));
+    _mm256_store_ps(out.z, _mm256_sub_ps(_mm256_mul_ps(ax, by), _mm256_mul_ps(ay, bx)));
+#else
+    for (int i = 0; i < 8; ++i)
+    {
+        out.x[i] = a.y[i]*b.z[i] - a.z[i]*b.y[i];
+        out.y[i] = a.z[i]*b.x[i] - a.x[i]*b.z[i];
+        out.z[i] = a.x[i]*b.y[i] - a.y[i]*b.x[i];
+    }
+#endif
+
+    return out;
+}
+
+//---------------------------------------------------------
+// Desc:   length of each lane
+// Args:   - outLength: array of 8 floats
+//---------------------------------------------------------
+inline void Vec3x8Length(const Vec3x8& v, float* outLength)
+{
+    assert(outLength != nullptr);
+
+#if defined(MATH_SIMD_AVX2)
+    const __m256 x = _mm256_load_ps(v.x);
+    const __m256 y = _mm256_load_ps(v.y);
+    const __m256 z = _mm256_load_ps(v.z);
+
+    __m256 lenSqr = _mm256_mul_ps(x, x);
+    lenSqr = SimdMulAdd(y, y, lenSqr);
+    lenSqr = SimdMulAdd(z, z, lenSqr);
+    _mm256_storeu_ps(outLength, _mm256_sqrt_ps(lenSqr));
+#else
+    for (int i = 0; i < 8; ++i)
+        outLength[i] = sqrtf(v.x[i]*v.x[i] + v.y[i]*v.y[i] + v.z[i]*v.z[i]);
+#endif
+}
+
+//---------------------------------------------------------
+// Desc:   normalize each lane (lanes must have non-zero length)
+//---------------------------------------------------------
+inline Vec3x8 Vec3x8Normalize(const Vec3x8& v)
+{
+    Vec3x8 out;
+
+#if defined(MATH_SIMD_AVX2)
+    const __m256 x = _mm256_load_ps(v.x);
+    const __m256 y = _mm256_load_ps(v.y);
+    const __m256 z = _mm256_load_ps(v.z);
+
+    __m256 lenSqr = _mm256_mul_ps(x, x);
+    lenSqr = SimdMulAdd(y, y, lenSqr);
+    lenSqr = SimdMulAdd(z, z, lenSqr);
+
+    const __m256 invLen = _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(lenSqr));
+
+    _mm256_store_ps(out.x, _mm256_mul_ps(x, invLen));
+    _mm256_store_ps(out.y, _mm256_mul_ps(y, invLen));
+    _mm256_store_ps(out.z, _mm256_mul_ps(z, invLen));
+#else
+    for (int i = 0; i < 8; ++i)
+    {
+        const float invLen = 1.0f / sqrtf(v.x[i]*v.x[i] + v.y[i]*v.y[i] + v.z[i]*v.z[i]);
+        out.x[i] = v.x[i] * invLen;
+        out.y[i] = v.y[i] * invLen;
+        out.z[i] = v.z[i] * invLen;
+    }
+#endif
+
+    return out;
+}
+
+
+//==================================================================================
+// Vec3x8: conversion from/to arrays of Vec3
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:   load 8 sequential Vec3 and transpose them into SoA form
+//---------------------------------------------------------
+inline Vec3x8 Vec3x8Load(const Vec3* src)
+{
+    assert(src != nullptr);
+    Vec3x8 out;
+
+#if defined(MATH_SIMD_SSE2)
+    const unsigned char* p = (const unsigned char*)src;
+
+    for (int half = 0; half < 8; half += 4)
+    {
+        __m128 x, y, z;
+        LoadVec3x4Simd(p + sizeof(Vec3)*half, sizeof(Vec3), x, y, z);
+
+        _mm_store_ps(out.x + half, x);
+        _mm_store_ps(out.y + half, y);
+        _mm_store_ps(out.z + half, z);
+    }
+#else
+    for (int i = 0; i < 8; ++i)
+        out.Set(i, src[i]);
+#endif
+
+    return out;
+}
+
+//---------------------------------------------------------
+// Desc:   transpose lanes back into AoS form and store them as 8 sequential Vec3
+//---------------------------------------------------------
+inline void Vec3x8Store(const Vec3x8& v, Vec3* dst)
+{
+    assert(dst != nullptr);
+
+#if defined(MATH_SIMD_SSE2)
+    unsigned char* p = (unsigned char*)dst;
+
+    for (int half = 0; half < 8; half += 4)
+    {
+        StoreVec3x4Simd(p + sizeof(Vec3)*half,
+                        sizeof(Vec3),
+                        _mm_load_ps(v.x + half),
+                        _mm_load_ps(v.y + half),
+                        _mm_load_ps(v.z + half));
+    }
+#else
+    for (int i = 0; i < 8; ++i)
+        dst[i] = v.Get(i);
+#endif
+}
+
+//---------------------------------------------------------
+// Desc:   gather 8 vectors by indices: lane[i] = src[indices[i]]
+//---------------------------------------------------------
+inline Vec3x8 Vec3x8Gather(const Vec3* src, const int* indices)
+{
+    assert(src != nullptr && indices != nullptr);
+    Vec3x8 out;
+
+#if defined(MATH_SIMD_AVX2)
+    static_assert(sizeof(Vec3) == 3*sizeof(float), "Vec3 must be tightly packed");
+
+    // Vec3 is 3 floats, so offset (in floats) of each vector is index*3
+    const __m256i idx    = _mm256_loadu_si256((const __m256i*)indices);
+    const __m256i offset = _mm256_add_epi32(idx, _mm256_add_epi32(idx, idx));
+    const float*  base   = src->xyz;
+
+    _mm256_store_ps(out.x, _mm256_i32gather_ps(base,     offset, 4));
+    _mm256_store_ps(out.y, _mm256_i32gather_ps(base + 1, offset, 4));
+    _mm256_store_ps(out.z, _mm256_i32gather_ps(base + 2, offset, 4));
+#else
+    for (int i = 0; i < 8; ++i)
+        out.Set(i, src[indices[i]]);
+#endif
+
+    return out;
+}
+
+//---------------------------------------------------------
+// Desc:   scatter 8 lanes by indices: dst[indices[i]] = lane[i]
+//         (if indices repeat - the last lane wins)
+//---------------------------------------------------------
+inline void Vec3x8Scatter(const Vec3x8& v, const int* indices, Vec3* dst)
+{
+    assert(dst != nullptr && indices != nullptr);
+
+    // there is no scatter instruction in AVX2
+    for (int i = 0; i < 8; ++i)
+        dst[indices[i]] = v.Get(i);
+}
+
+
+//==================================================================================
+// Structure:  Vec3SoA
+// Desc:       a container of vectors in SoA form; the capacity is always
+//             a multiple of 8 and arrays are 32-byte aligned, so the container
+//             can be processed by Vec3x8 blocks without a scalar tail
+//             (padding lanes are zeros after Resize())
+//==================================================================================
+struct Vec3SoA
+{
+    //-----------------------------------------------------
+    // public data
+    //-----------------------------------------------------
+    float* x        = nullptr;
+    float* y        = nullptr;
+    float* z        = nullptr;
+    size_t size     = 0;
+    size_t capacity = 0;
+
+    //-----------------------------------------------------
+    // constructors, destructor
+    //-----------------------------------------------------
+    Vec3SoA() {}
+
+    explicit Vec3SoA(const size_t n)
+    {
+        Resize(n);
+    }
+
+    ~Vec3SoA()
+    {
+        Release();
+    }
+
+    Vec3SoA(const Vec3SoA&) = delete;
+    Vec3SoA& operator = (const Vec3SoA&) = delete;
+
+    //-----------------------------------------------------
+    // methods
+    //-----------------------------------------------------
+
+    // change the number of vectors (new vectors are zeros)
+    void Resize(const size_t n)
+    {
+        if (n > capacity)
+            Reserve(n);
+
+        // clear removed/added elements so the padding lanes stay zeros
+        const size_t from = (n < size) ? n : size;
+        const size_t cnt  = capacity - from;
+
+        if (cnt > 0)
+        {
+            memset(x + from, 0, cnt * sizeof(float));
+            memset(y + from, 0, cnt * sizeof(float));
+            memset(z + from, 0, cnt * sizeof(float));
+        }
+
+        size = n;
+    }
+
+    // allocate memory for at least n vectors (keeps the current content)
+    void Reserve(const size_t n)
+    {
+        if (n <= capacity)
+            return;
+
+        const size_t newCapacity = (n + 7) & ~size_t(7);
+        float*       buf         = (float*)AlignedAlloc(newCapacity * 3 * sizeof(float), 32);
+
+        assert(buf != nullptr && "can't allocate memory for SoA vectors");
+        memset(buf, 0, newCapacity * 3 * sizeof(float));
+
+        const size_t oldSize = size;
+
+        if (oldSize > 0)
+        {
+            memcpy(buf,                 x, oldSize * sizeof(float));
+            memcpy(buf + newCapacity,   y, oldSize * sizeof(float));
+            memcpy(buf + newCapacity*2, z, oldSize * sizeof(float));
+        }
+
+        Release();
+
+        x        = buf;
+        y        = buf + newCapacity;
+        z        = buf + newCapacity*2;
+        size     = oldSize;
+        capacity = newCapacity;
+    }
+
+    void Release()
+    {
+        if (x)
+            AlignedFree(x);
+
+        x        = nullptr;
+        y        = nullptr;
+        z        = nullptr;
+        size     = 0;
+        capacity = 0;
+    }
+
+    inline Vec3 Get(const size_t i) const
+    {
+        assert(i < size);
+        return Vec3(x[i], y[i], z[i]);
+    }
+
+    inline void Set(const size_t i, const Vec3& v)
+    {
+        assert(i < size);
+        x[i] = v.x;
+        y[i] = v.y;
+        z[i] = v.z;
+    }
+};
+
+
+//==================================================================================
+// Vec3SoA: functions
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:   load a block of 8 vectors starting from index i (i must be a multiple of 8)
+//---------------------------------------------------------
+inline Vec3x8 Vec3x8Load(const Vec3SoA& soa, const size_t i)
+{
+    assert((i % 8 == 0) && (i < soa.capacity));
+    Vec3x8 out;
+
+    memcpy(out.x, soa.x + i, sizeof(out.x));
+    memcpy(out.y, soa.y + i, sizeof(out.y));
+    memcpy(out.z, soa.z + i, sizeof(out.z));
+
+    return out;
+}
+
+//---------------------------------------------------------
+// Desc:   store a block of 8 vectors starting from index i (i must be a multiple of 8)
+//---------------------------------------------------------
+inline void Vec3x8Store(const Vec3x8& v, Vec3SoA& soa, const size_t i)
+{
+    assert((i % 8 == 0) && (i < soa.capacity));
+
+    memcpy(soa.x + i, v.x, sizeof(v.x));
+    memcpy(soa.y + i, v.y, sizeof(v.y));
+    memcpy(soa.z + i, v.z, sizeof(v.z));
+}
+
+//---------------------------------------------------------
+// Desc:   convert an array of Vec3 into SoA form
+// Args:   - src: input array of n vectors
+//         - n:   number of vectors
+//         - dst: output container (it is resized to n)
+//---------------------------------------------------------
+inline void Vec3SoAFromArray(const Vec3* src, const size_t n, Vec3SoA& dst)
+{
+    assert((src != nullptr) || (n == 0));
+
+    dst.Resize(n);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+        Vec3x8Store(Vec3x8Load(src + i), dst, i);
+
+    for (; i < n; ++i)
+        dst.Set(i, src[i]);
+}
+
+//---------------------------------------------------------
+// Desc:   convert vectors from SoA form back into an array of Vec3
+// Args:   - src: input container
+//         - dst: output array of src.size vectors
+//---------------------------------------------------------
+inline void Vec3SoAToArray(const Vec3SoA& src, Vec3* dst)
+{
+    assert((dst != nullptr) || (src.size == 0));
+
+    const size_t n = src.size;
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+        Vec3x8Store(Vec3x8Load(src, i), dst + i);
+
+    for (; i < n; ++i)
+        dst[i] = src.Get(i);
+}
@@ -8,15 +8,17 @@
     **    **  **    **  **    **  **  ***   **    **
     ******    ********  ********  **    **  ********
 
-    Filename: vec3.h
-    Desc:     vector of 4 floats 
+    Filename: vec4.h
+    Desc:     vector of 4 floats (16-byte aligned, so it can be
+              processed as a single SSE register)
     Created:  13.09.2025 by DimaSkup
 \***************************************************************/
 #pragma once
 
 #include <math/math_helpers.h>
+#include <math/simd.h>
 
-struct Vec4
+struct alignas(16) Vec4
 {
     //-----------------------------------------------------
     // public data
@@ -31,6 +33,10 @@ struct Vec4
         {
             float x, y, z, w;
         };
+
+#if defined(MATH_SIMD_SSE2)
+        __m128 xmm;
+#endif
     };
 
     //-----------------------------------------------------
@@ -42,27 +48,219 @@ struct Vec4
     Vec4(const float _x, const float _y, const float _z, const float _w) :
         x{ _x }, y{ _y }, z{ _z }, w{ _w } {}
 
+#if defined(MATH_SIMD_SSE2)
+    explicit Vec4(const __m128 v) :
+        xmm{ v } {}
+#endif
+
 
     //-----------------------------------------------------
     // operators
     //-----------------------------------------------------
 
-    inline bool operator == (const Vec4& v) const
-    {
-        return FloatEqual(x, v.x) && FloatEqual(y, v.y) && FloatEqual(z, v.z) && FloatEqual(w, v.w);
-    }
+    inline bool operator == (const Vec4& v) const;
 
-    inline Vec4 operator+(const Vec4& v) const
-    {
-        return { x + v.x, y + v.y, z + v.z, w + v.w };
-    }
+    inline Vec4 operator + (const Vec4& v) const;
+    inline Vec4 operator - (const Vec4& v) const;
+    inline Vec4 operator * (const Vec4& v) const;
+    inline Vec4 operator * (const float s) const;
+    inline Vec4 operator - () const;
 
-    inline Vec4 operator-(const Vec4& v) const
-    {
-        return { x - v.x, y - v.y, z - v.z, w - v.w };
-    }
+    inline Vec4& operator += (const Vec4& v) { return *this = *this + v; }
+    inline Vec4& operator -= (const Vec4& v) { return *this = *this - v; }
+    inline Vec4& operator *= (const float s) { return *this = *this * s; }
 
     inline float  operator[](const int n) const { return xyzw[n]; }
     inline float& operator[](const int n)       { return xyzw[n]; }
 
 };
+
+static_assert(sizeof(Vec4) == 16, "Vec4 must be 16 bytes");
+
+
+//==================================================================================
+// arithmetic
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:   component-wise v1 + v2
+//---------------------------------------------------------
+inline Vec4 Vec4Add(const Vec4& v1, const Vec4& v2)
+{
+#if defined(MATH_SIMD_SSE2)
+    return Vec4(_mm_add_ps(v1.xmm, v2.xmm));
+#else
+    return Vec4(v1.x + v2.x, v1.y + v2.y, v1.z + v2.z, v1.w + v2.w);
+#endif
+}
+
+//---------------------------------------------------------
+// Desc:   component-wise v1 - v2
+//---------------------------------------------------------
+inline Vec4 Vec4Sub(const Vec4& v1, const Vec4& v2)
+{
+#if defined(MATH_SIMD_SSE2)
+    return Vec4(_mm_sub_ps(v1.xmm, v2.xmm));
+#else
+    return Vec4(v1.x - v2.x, v1.y - v2.y, v1.z - v2.z, v1.w - v2.w);
+#endif
+}
+
+//---------------------------------------------------------
+// Desc:   component-wise v1 * v2
+//---------------------------------------------------------
+inline Vec4 Vec4Mul(const Vec4& v1, const Vec4& v2)
+{
+#if defined(MATH_SIMD_SSE2)
+    return Vec4(_mm_mul_ps(v1.xmm, v2.xmm));
+#else
+    return Vec4(v1.x * v2.x, v1.y * v2.y, v1.z * v2.z, v1.w * v2.w);
+#endif
+}
+
+//---------------------------------------------------------
+// Desc:   multiply each component by a scalar
+//---------------------------------------------------------
+inline Vec4 Vec4Mul(const Vec4& v, const float s)
+{
+#if defined(MATH_SIMD_SSE2)
+    return Vec4(_mm_mul_ps(v.xmm, _mm_set1_ps(s)));
+#else
+    return Vec4(v.x * s, v.y * s, v.z * s, v.w * s);
+#endif
+}
+
+//---------------------------------------------------------
+// Desc:   component-wise v1*v2 + v3 (fused if FMA is available)
+//---------------------------------------------------------
+inline Vec4 Vec4MulAdd(const Vec4& v1, const Vec4& v2, const Vec4& v3)
+{
+#if defined(MATH_SIMD_SSE2)
+    return Vec4(SimdMulAdd(v1.xmm, v2.xmm, v3.xmm));
+#else
+    return Vec4(v1.x*v2.x + v3.x, v1.y*v2.y + v3.y, v1.z*v2.z + v3.z, v1.w*v2.w + v3.w);
+#endif
+}
+
+//---------------------------------------------------------
+
+inline float Vec4Dot(const Vec4& v1, const Vec4& v2)
+{
+#if defined(MATH_SIMD_SSE4)
+    return _mm_cvtss_f32(_mm_dp_ps(v1.xmm, v2.xmm, 0xF1));
+
+#elif defined(MATH_SIMD_SSE2)
+    // horizontal sum of the products
+    const __m128 prod = _mm_mul_ps(v1.xmm, v2.xmm);
+    const __m128 sum  = _mm_add_ps(prod, _mm_shuffle_ps(prod, prod, _MM_SHUFFLE(2,3,0,1)));
+    return _mm_cvtss_f32(_mm_add_ss(sum, _mm_movehl_ps(sum, sum)));
+
+#else
+    return v1.x*v2.x + v1.y*v2.y + v1.z*v2.z + v1.w*v2.w;
+#endif
+}
+
+
+//==================================================================================
+// min/max, abs
+//==================================================================================
+
+inline Vec4 Vec4Min(const Vec4& v1, const Vec4& v2)
+{
+#if defined(MATH_SIMD_SSE2)
+    return Vec4(_mm_min_ps(v1.xmm, v2.xmm));
+#else
+    return Vec4(Min(v1.x, v2.x), Min(v1.y, v2.y), Min(v1.z, v2.z), Min(v1.w, v2.w));
+#endif
+}
+
+//---------------------------------------------------------
+
+inline Vec4 Vec4Max(const Vec4& v1, const Vec4& v2)
+{
+#if defined(MATH_SIMD_SSE2)
+    return Vec4(_mm_max_ps(v1.xmm, v2.xmm));
+#else
+    return Vec4(Max(v1.x, v2.x), Max(v1.y, v2.y), Max(v1.z, v2.z), Max(v1.w, v2.w));
+#endif
+}
+
+//---------------------------------------------------------
+
+inline Vec4 Vec4Abs(const Vec4& v)
+{
+#if defined(MATH_SIMD_SSE2)
+    // clear the sign bits
+    return Vec4(_mm_andnot_ps(_mm_set1_ps(-0.0f), v.xmm));
+#else
+    return Vec4(fabsf(v.x), fabsf(v.y), fabsf(v.z), fabsf(v.w));
+#endif
+}
+
+
+//==================================================================================
+// comparison
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:   component-wise v1 < v2
+// Ret:    bitmask where bit i is set if v1[i] < v2[i]
+//---------------------------------------------------------
+inline int Vec4Less(const Vec4& v1, const Vec4& v2)
+{
+#if defined(MATH_SIMD_SSE2)
+    return _mm_movemask_ps(_mm_cmplt_ps(v1.xmm, v2.xmm));
+#else
+    return ((v1.x < v2.x) << 0) | ((v1.y < v2.y) << 1) | ((v1.z < v2.z) << 2) | ((v1.w < v2.w) << 3);
+#endif
+}
+
+//---------------------------------------------------------
+// Desc:   component-wise v1 <= v2
+// Ret:    bitmask where bit i is set if v1[i] <= v2[i]
+//---------------------------------------------------------
+inline int Vec4LessOrEqual(const Vec4& v1, const Vec4& v2)
+{
+#if defined(MATH_SIMD_SSE2)
+    return _mm_movemask_ps(_mm_cmple_ps(v1.xmm, v2.xmm));
+#else
+    return ((v1.x <= v2.x) << 0) | ((v1.y <= v2.y) << 1) | ((v1.z <= v2.z) << 2) | ((v1.w <= v2.w) << 3);
+#endif
+}
+
+//---------------------------------------------------------
+// Desc:   check if all the components of two vectors differ less than epsilon
+//---------------------------------------------------------
+inline bool Vec4NearEqual(const Vec4& v1, const Vec4& v2, const float epsilon = EPSILON_E5)
+{
+#if defined(MATH_SIMD_SSE2)
+    const __m128 diff = _mm_andnot_ps(_mm_set1_ps(-0.0f), _mm_sub_ps(v1.xmm, v2.xmm));
+    return _mm_movemask_ps(_mm_cmplt_ps(diff, _mm_set1_ps(epsilon))) == 0xF;
+#else
+    return (fabsf(v1.x - v2.x) < epsilon) &&
+           (fabsf(v1.y - v2.y) < epsilon) &&
+           (fabsf(v1.z - v2.z) < epsilon) &&
+           (fabsf(v1.w - v2.w) < epsilon);
+#endif
+}
+
+
+//==================================================================================
+// operators
+//==================================================================================
+
+inline bool Vec4::operator == (const Vec4& v) const { return Vec4NearEqual(*this, v); }
+
+inline Vec4 Vec4::operator + (const Vec4& v) const  { return Vec4Add(*this, v); }
+inline Vec4 Vec4::operator - (const Vec4& v) const  { return Vec4Sub(*this, v); }
+inline Vec4 Vec4::operator * (const Vec4& v) const  { return Vec4Mul(*this, v); }
+inline Vec4 Vec4::operator * (const float s) const  { return Vec4Mul(*this, s); }
+
+inline Vec4 Vec4::operator - () const
+{
+#if defined(MATH_SIMD_SSE2)
+    return Vec4(_mm_xor_ps(xmm, _mm_set1_ps(-0.0f)));
+#else
+    return Vec4(-x, -y, -z, -w);
+#endif
+}
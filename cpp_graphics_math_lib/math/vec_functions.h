@@ -69,7 +69,7 @@ inline Vec3 Vec3Cross(const Vec3& v1, const Vec3& v2)
 {
     return Vec3((v1.y * v2.z) - (v1.z * v2.y),
                 (v1.z * v2.x) - (v1.x * v2.z),
-                (v1.x - v2.y) - (v1.y * v2.x));
+                (v1.x * v2.y) - (v1.y * v2.x));
 }
 
 //==================================================================================
@@ -0,0 +1,533 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: tests_bvh.h
+    Desc:     tests for bounding volume hierarchy (BVH)
+
+    Created:  17.10.2026  by DimaSkup
+\**********************************************************************************/
+#pragma once
+#include <geometry/bvh.h>
+#include <geometry/bvh_parallel_build.h>
+#include <geometry/bvh_linear_build.h>
+#include <tests/tests_frustum.h>
+#include <math/random.h>
+#include <log.h>
+#include <stdio.h>
+#include <algorithm>
+#include <vector>
+
+
+//==================================================================================
+// forward declaration of the main test
+//==================================================================================
+void TestBvh();
+
+
+//==================================================================================
+// helpers
+//==================================================================================
+inline void TestBvh_GenerateRects(std::vector<Rect3d>& rects, const size_t n)
+{
+    rects.resize(n);
+
+    for (Rect3d& rect : rects)
+    {
+        const float x = RandF(-100, 100);
+        const float y = RandF(-100, 100);
+        const float z = RandF(-20, 120);
+
+        rect = Rect3d(x, x + RandF(0.1f, 10), y, y + RandF(0.1f, 10), z, z + RandF(0.1f, 10));
+    }
+}
+
+//---------------------------------------------------------
+// Desc:   check the structure of the tree: children bounds are inside
+//         of the parent, each primitive is referred once, leaves are small
+//---------------------------------------------------------
+inline bool TestBvh_Validate(const Bvh& bvh, const Rect3d* prims, const uint32_t maxLeafSize)
+{
+    std::vector<int> refs(bvh.numPrims, 0);
+
+    for (uint32_t i = 0; i < bvh.numNodes; ++i)
+    {
+        if (i == 1)
+            continue;
+
+        const BvhNode& node = bvh.nodes[i];
+
+        if (node.IsLeaf())
+        {
+            if (node.count > maxLeafSize)
+                return false;
+
+            for (uint32_t j = node.leftOrFirst; j < node.leftOrFirst + node.count; ++j)
+            {
+                const Rect3d& prim = prims[bvh.primIndices[j]];
+                Rect3d        tmp;
+
+                refs[bvh.primIndices[j]]++;
+
+                // bounds of primitives are copied in the leaf order
+                if (bvh.primBounds[j] != prim)
+                    return false;
+
+                // the primitive is inside of the leaf bounds
+                if (!IntersectRect3d(node.bounds, prim, tmp) || tmp != prim)
+                    return false;
+            }
+            continue;
+        }
+
+        // children pair is stored after the parent and starts on a cache line
+        if ((node.leftOrFirst <= i) || (node.leftOrFirst % 2) != 0 || ((size_t)&bvh.nodes[node.leftOrFirst] % 64) != 0)
+            return false;
+
+        for (uint32_t c = node.leftOrFirst; c < node.leftOrFirst + 2; ++c)
+        {
+            Rect3d tmp;
+            IntersectRect3d(node.bounds, bvh.nodes[c].bounds, tmp);
+
+            if (tmp != bvh.nodes[c].bounds)
+                return false;
+        }
+    }
+
+    for (const int count : refs)
+    {
+        if (count != 1)
+            return false;
+    }
+
+    return true;
+}
+
+//---------------------------------------------------------
+// Desc:   compare a query result with the expected (brute force) one
+//---------------------------------------------------------
+inline bool TestBvh_SameIndices(const uint32_t* found, const uint32_t numFound, std::vector<uint32_t> expect)
+{
+    std::vector<uint32_t> result(found, found + numFound);
+
+    std::sort(result.begin(), result.end());
+    std::sort(expect.begin(), expect.end());
+
+    return result == expect;
+}
+
+
+//==================================================================================
+// test functions
+//==================================================================================
+void TestBvhBuild()
+{
+    std::vector<Rect3d> rects;
+    Bvh                 bvh;
+
+    // empty tree
+    bvh.Build(nullptr, 0);
+    assert(bvh.IsEmpty());
+    assert(bvh.QueryPoint(Vec3(0, 0, 0), nullptr, 0) == 0);
+
+    // a single primitive
+    TestBvh_GenerateRects(rects, 1);
+    bvh.Build(rects.data(), 1);
+    assert(bvh.nodes[0].IsLeaf() && bvh.nodes[0].bounds == rects[0]);
+
+    // a lot of primitives (with different leaf sizes)
+    TestBvh_GenerateRects(rects, 1000);
+
+    bvh.Build(rects.data(), (uint32_t)rects.size());
+    assert(TestBvh_Validate(bvh, rects.data(), Bvh::MAX_LEAF_SIZE));
+
+    bvh.Build(rects.data(), (uint32_t)rects.size(), 1);
+    assert(TestBvh_Validate(bvh, rects.data(), 1));
+
+    // all the primitives are the same: centroids can't be split by bins
+    for (Rect3d& rect : rects)
+        rect = Rect3d(1, 2, 1, 2, 1, 2);
+
+    bvh.Build(rects.data(), (uint32_t)rects.size(), 2);
+    assert(TestBvh_Validate(bvh, rects.data(), 2));
+
+    LogMsg("%-50s test is passed", "Bvh::Build()");
+}
+
+//---------------------------------------------------------
+
+void TestBvhQueries()
+{
+    const size_t        n = 2000;
+    std::vector<Rect3d> rects;
+    std::vector<uint32_t> expect;
+    std::vector<uint32_t> found(n);
+
+    TestBvh_GenerateRects(rects, n);
+
+    Bvh bvh;
+    bvh.Build(rects.data(), (uint32_t)n);
+
+    for (int test = 0; test < 20; ++test)
+    {
+        // rect query
+        const float  x = RandF(-100, 100);
+        const float  y = RandF(-100, 100);
+        const float  z = RandF(-20, 120);
+        const Rect3d box(x, x + RandF(1, 40), y, y + RandF(1, 40), z, z + RandF(1, 40));
+
+        expect.clear();
+        for (uint32_t i = 0; i < n; ++i)
+            if (OverlapRect3d(rects[i], box))
+                expect.push_back(i);
+
+        uint32_t numFound = bvh.QueryRect(box, found.data(), (uint32_t)n);
+        assert(TestBvh_SameIndices(found.data(), numFound, expect));
+
+        // point query
+        const Vec3 point(x, y, z);
+
+        expect.clear();
+        for (uint32_t i = 0; i < n; ++i)
+            if (rects[i].PointInRect(point))
+                expect.push_back(i);
+
+        numFound = bvh.QueryPoint(point, found.data(), (uint32_t)n);
+        assert(TestBvh_SameIndices(found.data(), numFound, expect));
+
+        // ray query
+        const Vec3  dir(RandF(-1, 1), RandF(-1, 1), RandF(-1, 1));
+        const float tMax = RandF(50, 300);
+        const Ray   ray(point, dir, 0.0f, tMax);
+        float       tNear;
+
+        expect.clear();
+        for (uint32_t i = 0; i < n; ++i)
+            if (RayIntersectRect3d(ray, rects[i], tNear))
+                expect.push_back(i);
+
+        numFound = bvh.QueryRay(point, dir, tMax, found.data(), (uint32_t)n);
+        assert(TestBvh_SameIndices(found.data(), numFound, expect));
+    }
+
+    // axis-parallel rays which start exactly on a face of a primitive
+    // (0 * inf is NaN) find it, the same as a ray packet does
+    for (uint32_t i = 0; i < n; i += 97)
+    {
+        const Rect3d& rect = rects[i];
+        const Vec3    dirs[] = { Vec3(0, 0, 1), Vec3(-0.0f, 0, 1), Vec3(0, 1, -0.0f) };
+        const Vec3    origins[] = {
+            Vec3(rect.x0, 0.5f * (rect.y0 + rect.y1), rect.z0 - 1),
+            Vec3(rect.x1, rect.y1, rect.z0 - 1),
+            Vec3(rect.x1, rect.y0 - 1, rect.z0) };
+
+        for (int j = 0; j < 3; ++j)
+        {
+            const uint32_t numFound = bvh.QueryRay(origins[j], dirs[j], 1000.0f, found.data(), (uint32_t)n);
+            assert(std::find(found.data(), found.data() + numFound, i) != found.data() + numFound);
+
+            RayPacket4 packet;
+            Ray        ray(origins[j], dirs[j], 0.0f, 1000.0f);
+            packet.SetRays(&ray, 1);
+
+            std::vector<uint32_t> packetFound(n);
+            const uint32_t numPacketFound = bvh.QueryRayPacket(packet, 1, packetFound.data(), nullptr, (uint32_t)n);
+
+            expect.assign(packetFound.data(), packetFound.data() + numPacketFound);
+            assert(TestBvh_SameIndices(found.data(), numFound, expect));
+        }
+    }
+
+    // frustum query
+    Frustum frustum;
+    frustum.CreateFromProjMatrix(MatrixProjectionLH(1.30796f, 1600.0f / 900.0f, 0.1f, 100.0f), true);
+
+    const uint32_t numFound = bvh.QueryFrustum(frustum, found.data(), (uint32_t)n);
+    std::vector<uint32_t> result(found.data(), found.data() + numFound);
+
+    std::sort(result.begin(), result.end());
+
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        bool onBorder = false;
+        const int  type      = TestFrustum_ClassifyRect(frustum, rects[i], onBorder);
+        const bool isVisible = std::binary_search(result.begin(), result.end(), i);
+
+        if (!onBorder)
+            assert(isVisible == (type != Frustum::CULL_OUTSIDE));
+    }
+
+    assert(numFound > 0 && numFound < n);
+
+    // the output buffer is too small: the result is the total number,
+    // but only maxCount indices are written
+    const uint32_t maxCount = 5;
+    found[maxCount] = 0xFFFFFFFF;
+
+    assert(bvh.QueryFrustum(frustum, found.data(), maxCount) == numFound);
+    assert(found[maxCount] == 0xFFFFFFFF);
+
+    LogMsg("%-50s test is passed", "Bvh::QueryFrustum/Rect/Point/Ray()");
+}
+
+//---------------------------------------------------------
+
+void TestBvhParallelBuild()
+{
+    // enough primitives to split the root by parallel binning
+    const uint32_t      n = 100000;
+    std::vector<Rect3d> rects;
+
+    TestBvh_GenerateRects(rects, n);
+
+    Bvh expect;
+    expect.Build(rects.data(), n);
+
+    // the result must be the same for any number of threads
+    const int numWorkers[] = { 0, 1, 3, -1 };
+
+    for (const int count : numWorkers)
+    {
+        TaskPool pool(count);
+        Bvh      bvh;
+
+        BvhBuildParallel(pool, rects.data(), n, bvh);
+
+        assert(bvh.numNodes == expect.numNodes);
+        assert(memcmp(bvh.nodes, expect.nodes, bvh.numNodes * sizeof(BvhNode)) == 0);
+        assert(memcmp(bvh.primIndices, expect.primIndices, n * sizeof(uint32_t)) == 0);
+        assert(TestBvh_Validate(bvh, rects.data(), Bvh::MAX_LEAF_SIZE));
+    }
+
+    // small inputs
+    TaskPool pool;
+    Bvh      bvh;
+
+    BvhBuildParallel(pool, nullptr, 0, bvh);
+    assert(bvh.IsEmpty());
+
+    BvhBuildParallel(pool, rects.data(), 7, bvh, 2);
+    assert(TestBvh_Validate(bvh, rects.data(), 2));
+
+    LogMsg("%-50s test is passed", "BvhBuildParallel()");
+}
+
+//---------------------------------------------------------
+
+void TestParallelRadixSort()
+{
+    const uint32_t n = 50000;
+
+    std::vector<uint32_t> keys(n), values(n), tmpKeys(n), tmpValues(n);
+    std::vector<std::pair<uint32_t, uint32_t>> expect(n);
+
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        // a lot of equal keys to check the stability
+        keys[i]   = RandUint(0, 1 << 12) << 18;
+        values[i] = i;
+        expect[i] = { keys[i], i };
+    }
+
+    std::stable_sort(expect.begin(), expect.end(),
+        [](const std::pair<uint32_t, uint32_t>& a, const std::pair<uint32_t, uint32_t>& b) { return a.first < b.first; });
+
+    TaskPool pool(2);
+    ParallelRadixSort(pool, keys.data(), values.data(), tmpKeys.data(), tmpValues.data(), n, 30);
+
+    for (uint32_t i = 0; i < n; ++i)
+        assert(keys[i] == expect[i].first && values[i] == expect[i].second);
+
+    LogMsg("%-50s test is passed", "ParallelRadixSort()");
+}
+
+//---------------------------------------------------------
+
+void TestBvhLinearBuild()
+{
+    const uint32_t        n = 5000;
+    std::vector<Rect3d>   rects;
+    std::vector<uint32_t> expect;
+    std::vector<uint32_t> found(n);
+
+    TestBvh_GenerateRects(rects, n);
+
+    TaskPool         pool0(0);
+    TaskPool         pool3(3);
+    BvhLinearBuilder builder;
+    Bvh              bvh;
+    Bvh              bvh2;
+
+    builder.Build(pool0, rects.data(), n, bvh);
+    assert(TestBvh_Validate(bvh, rects.data(), 1));
+
+    // the same result for another number of threads (and a reused builder)
+    builder.Build(pool3, rects.data(), n, bvh2);
+    assert(bvh.numNodes == bvh2.numNodes);
+    assert(memcmp(bvh.nodes, bvh2.nodes, bvh.numNodes * sizeof(BvhNode)) == 0);
+
+    // primitives are sorted by Morton codes
+    for (uint32_t i = 1; i < n; ++i)
+        assert(builder.codes[i - 1] <= builder.codes[i]);
+
+    // queries work as with any other BVH
+    for (int test = 0; test < 10; ++test)
+    {
+        const float  x = RandF(-100, 100);
+        const float  y = RandF(-100, 100);
+        const float  z = RandF(-20, 120);
+        const Rect3d box(x, x + RandF(1, 40), y, y + RandF(1, 40), z, z + RandF(1, 40));
+
+        expect.clear();
+        for (uint32_t i = 0; i < n; ++i)
+            if (OverlapRect3d(rects[i], box))
+                expect.push_back(i);
+
+        const uint32_t numFound = bvh.QueryRect(box, found.data(), n);
+        assert(TestBvh_SameIndices(found.data(), numFound, expect));
+    }
+
+    // a rebuild after the primitives are moved reuses the memory
+    const BvhNode* nodes = bvh.nodes;
+
+    for (Rect3d& rect : rects)
+        rect += Vec3(RandF(-1, 1), RandF(-1, 1), RandF(-1, 1));
+
+    builder.Build(pool3, rects.data(), n, bvh);
+    assert(bvh.nodes == nodes);
+    assert(TestBvh_Validate(bvh, rects.data(), 1));
+
+    // duplicate codes, tiny inputs
+    for (Rect3d& rect : rects)
+        rect = Rect3d(1, 2, 1, 2, 1, 2);
+
+    BvhBuildLinear(pool3, rects.data(), n, bvh);
+    assert(TestBvh_Validate(bvh, rects.data(), 1));
+
+    BvhBuildLinear(pool3, rects.data(), 2, bvh);
+    assert(TestBvh_Validate(bvh, rects.data(), 1));
+
+    BvhBuildLinear(pool3, rects.data(), 1, bvh);
+    assert(bvh.nodes[0].IsLeaf() && (bvh.QueryPoint(Vec3(1.5f, 1.5f, 1.5f), found.data(), n) == 1));
+
+    BvhBuildLinear(pool3, nullptr, 0, bvh);
+    assert(bvh.IsEmpty());
+
+    LogMsg("%-50s test is passed", "BvhLinearBuilder::Build()");
+}
+
+//---------------------------------------------------------
+
+void TestBvhRefit()
+{
+    const uint32_t        n = 5000;
+    std::vector<Rect3d>   rects;
+    std::vector<uint32_t> expect;
+    std::vector<uint32_t> found(n);
+
+    TestBvh_GenerateRects(rects, n);
+
+    Bvh bvh;
+    bvh.Build(rects.data(), n);
+    assert(bvh.buildSahCost > 0.0f && bvh.sahCost == bvh.buildSahCost);
+
+    // refit with the same bounds doesn't change anything
+    std::vector<BvhNode> nodes(bvh.nodes, bvh.nodes + bvh.numNodes);
+
+    bvh.Refit(rects.data(), true);
+    assert(memcmp(bvh.nodes, nodes.data(), bvh.numNodes * sizeof(BvhNode)) == 0);
+    assert(fabsf(bvh.sahCost - bvh.buildSahCost) <= 1e-3f * bvh.buildSahCost);
+
+    // small motion: the tree is valid and still good enough
+    for (Rect3d& rect : rects)
+        rect += Vec3(RandF(-1, 1), RandF(-1, 1), RandF(-1, 1));
+
+    bvh.Refit(rects.data(), true);
+    assert(TestBvh_Validate(bvh, rects.data(), Bvh::MAX_LEAF_SIZE));
+    assert(!bvh.IsDegraded());
+
+    for (int test = 0; test < 10; ++test)
+    {
+        const float  x = RandF(-100, 100);
+        const float  y = RandF(-100, 100);
+        const float  z = RandF(-20, 120);
+        const Rect3d box(x, x + RandF(1, 40), y, y + RandF(1, 40), z, z + RandF(1, 40));
+
+        expect.clear();
+        for (uint32_t i = 0; i < n; ++i)
+            if (OverlapRect3d(rects[i], box))
+                expect.push_back(i);
+
+        const uint32_t numFound = bvh.QueryRect(box, found.data(), n);
+        assert(TestBvh_SameIndices(found.data(), numFound, expect));
+    }
+
+    // primitives are shuffled: the tree is still valid but it's time to rebuild it
+    for (uint32_t i = n - 1; i > 0; --i)
+        std::swap(rects[i], rects[RandUint(0, i + 1)]);
+
+    bvh.Refit(rects.data());
+    assert(TestBvh_Validate(bvh, rects.data(), Bvh::MAX_LEAF_SIZE));
+    assert(!bvh.IsDegraded());                   // the cost isn't updated
+
+    bvh.Refit(rects.data(), true);
+    assert(bvh.IsDegraded());
+    assert(fabsf(bvh.sahCost - bvh.ComputeSahCost()) <= 1e-3f * bvh.sahCost);
+
+    bvh.Build(rects.data(), n);
+    assert(!bvh.IsDegraded());
+
+    // refit of the LBVH
+    TaskPool pool(0);
+    BvhBuildLinear(pool, rects.data(), n, bvh);
+
+    for (Rect3d& rect : rects)
+        rect += Vec3(RandF(-1, 1), RandF(-1, 1), RandF(-1, 1));
+
+    bvh.Refit(rects.data(), true);
+    assert(TestBvh_Validate(bvh, rects.data(), 1));
+
+    // a single leaf, an empty tree
+    bvh.Build(rects.data(), 3);
+    rects[1] += Vec3(50, 0, 0);
+    bvh.Refit(rects.data(), true);
+    assert(TestBvh_Validate(bvh, rects.data(), Bvh::MAX_LEAF_SIZE));
+
+    bvh.Build(nullptr, 0);
+    bvh.Refit(nullptr, true);
+    assert(bvh.IsEmpty());
+
+    LogMsg("%-50s test is passed", "Bvh::Refit()");
+}
+
+
+//==================================================================================
+// main test
+//==================================================================================
+void TestBvh()
+{
+    SetConsoleColor(CYAN);
+
+    LogMsg("-----------------------------------------------");
+    LogMsg("Test BVH functional:");
+    LogMsg("-----------------------------------------------");
+
+    TestBvhBuild();
+    TestBvhQueries();
+    TestBvhParallelBuild();
+    TestParallelRadixSort();
+    TestBvhLinearBuild();
+    TestBvhRefit();
+
+    LogMsg("-----------------------------------------------");
+    LogMsg("all the BVH tests are passed!");
+    LogMsg("-----------------------------------------------\n");
+
+    SetConsoleColor(RESET);
+}
@@ -0,0 +1,397 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: tests_dynamic_aabb_tree.h
+    Desc:     tests for the dynamic AABB tree
+
+    Created:  17.10.2026  by DimaSkup
+\**********************************************************************************/
+#pragma once
+#include <geometry/dynamic_aabb_tree.h>
+#include <tests/tests_bvh.h>
+#include <math/random.h>
+#include <log.h>
+#include <stdio.h>
+#include <algorithm>
+#include <vector>
+
+
+//==================================================================================
+// forward declaration of the main test
+//==================================================================================
+void TestDynamicAabbTree();
+
+
+//==================================================================================
+// helpers
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:   check a subtree: links to parents, heights and balance,
+//         children bounds are inside of the parent
+// Ret:    number of leaves in the subtree (-1 if the subtree is broken)
+//---------------------------------------------------------
+inline int TestDynamicAabbTree_ValidateNode(const DynamicAabbTree& tree, const int32_t nodeIdx)
+{
+    const DynamicAabbNode& node = tree.nodes[nodeIdx];
+
+    if (node.IsLeaf())
+        return (node.height == 0) ? 1 : -1;
+
+    const DynamicAabbNode& child1 = tree.nodes[node.child1];
+    const DynamicAabbNode& child2 = tree.nodes[node.child2];
+
+    if (child1.parentOrNext != nodeIdx || child2.parentOrNext != nodeIdx)
+        return -1;
+
+    const int32_t maxHeight = (child1.height > child2.height) ? child1.height : child2.height;
+    const int32_t balance   = child1.height - child2.height;
+
+    if (node.height != maxHeight + 1 || balance < -1 || balance > 1)
+        return -1;
+
+    if (!ContainsRect3d(node.bounds, child1.bounds) || !ContainsRect3d(node.bounds, child2.bounds))
+        return -1;
+
+    const int numLeaves1 = TestDynamicAabbTree_ValidateNode(tree, node.child1);
+    const int numLeaves2 = TestDynamicAabbTree_ValidateNode(tree, node.child2);
+
+    if (numLeaves1 < 0 || numLeaves2 < 0)
+        return -1;
+
+    return numLeaves1 + numLeaves2;
+}
+
+//---------------------------------------------------------
+// Desc:   check the whole tree and the free list
+//---------------------------------------------------------
+inline bool TestDynamicAabbTree_Validate(const DynamicAabbTree& tree)
+{
+    if (tree.root == DynamicAabbTree::NULL_NODE)
+    {
+        if (tree.numProxies != 0 || tree.numNodes != 0)
+            return false;
+    }
+    else
+    {
+        if (tree.nodes[tree.root].parentOrNext != DynamicAabbTree::NULL_NODE)
+            return false;
+
+        if (TestDynamicAabbTree_ValidateNode(tree, tree.root) != tree.numProxies)
+            return false;
+
+        if (tree.numNodes != 2 * tree.numProxies - 1)
+            return false;
+    }
+
+    // all the other nodes are in the free list
+    int32_t numFree = 0;
+
+    for (int32_t i = tree.freeList; i != DynamicAabbTree::NULL_NODE; i = tree.nodes[i].parentOrNext)
+    {
+        if (tree.nodes[i].height != -1)
+            return false;
+        ++numFree;
+    }
+
+    return numFree == tree.maxNodes - tree.numNodes;
+}
+
+//---------------------------------------------------------
+// Desc:   check a query result: all the proxies which real bounds overlap
+//         the box are found, and fat bounds of each found one overlap it
+//---------------------------------------------------------
+inline bool TestDynamicAabbTree_CheckQuery(
+    const DynamicAabbTree& tree,
+    const std::vector<int32_t>& proxies,
+    const std::vector<Rect3d>& rects,
+    const Rect3d& box,
+    std::vector<int32_t>& found)
+{
+    const int32_t numFound = tree.QueryRect(box, found.data(), (int32_t)found.size());
+
+    std::sort(found.begin(), found.begin() + numFound);
+
+    for (int32_t i = 0; i < numFound; ++i)
+    {
+        if (!OverlapRect3d(tree.GetFatBounds(found[i]), box))
+            return false;
+    }
+
+    for (size_t i = 0; i < proxies.size(); ++i)
+    {
+        if (proxies[i] == DynamicAabbTree::NULL_NODE || !OverlapRect3d(rects[i], box))
+            continue;
+
+        if (!std::binary_search(found.begin(), found.begin() + numFound, proxies[i]))
+            return false;
+    }
+
+    return true;
+}
+
+
+//==================================================================================
+// test functions
+//==================================================================================
+void TestDynamicAabbTreeInsertRemove()
+{
+    const int32_t        n = 1000;
+    std::vector<Rect3d>  rects;
+    std::vector<int32_t> proxies(n);
+
+    TestBvh_GenerateRects(rects, n);
+
+    DynamicAabbTree tree(0.5f);
+    assert(tree.IsEmpty() && TestDynamicAabbTree_Validate(tree));
+
+    // a single proxy: it is the root, its fat bounds contain the real ones
+    proxies[0] = tree.Insert(rects[0], 100);
+    assert(tree.root == proxies[0] && tree.GetUserData(proxies[0]) == 100);
+    assert(ContainsRect3d(tree.GetFatBounds(proxies[0]), rects[0]));
+
+    for (int32_t i = 1; i < n; ++i)
+    {
+        proxies[i] = tree.Insert(rects[i], 100 + i);
+        assert(ContainsRect3d(tree.GetFatBounds(proxies[i]), rects[i]));
+    }
+
+    assert(TestDynamicAabbTree_Validate(tree));
+    assert(tree.numProxies == n);
+
+    // the tree is balanced: log2(1000) ~ 10
+    assert(tree.GetHeight() < 20);
+
+    for (int32_t i = 0; i < n; ++i)
+        assert(tree.GetUserData(proxies[i]) == (uint32_t)(100 + i));
+
+    // remove a half, then insert again: freed nodes are reused
+    for (int32_t i = 0; i < n; i += 2)
+    {
+        tree.Remove(proxies[i]);
+        proxies[i] = DynamicAabbTree::NULL_NODE;
+    }
+
+    assert(TestDynamicAabbTree_Validate(tree));
+    assert(tree.numProxies == n / 2);
+
+    const DynamicAabbNode* nodes = tree.nodes;
+
+    for (int32_t i = 0; i < n; i += 2)
+        proxies[i] = tree.Insert(rects[i], 100 + i);
+
+    assert(tree.nodes == nodes);
+    assert(TestDynamicAabbTree_Validate(tree));
+
+    // remove everything
+    for (int32_t i = 0; i < n; ++i)
+        tree.Remove(proxies[i]);
+
+    assert(tree.IsEmpty() && TestDynamicAabbTree_Validate(tree));
+
+    // a lot of proxies inserted in a sorted order don't make a degenerate tree
+    for (int32_t i = 0; i < n; ++i)
+        tree.Insert(Rect3d((float)i, (float)i + 1, 0, 1, 0, 1));
+
+    assert(TestDynamicAabbTree_Validate(tree));
+    assert(tree.GetHeight() < 20);
+
+    tree.Clear();
+    assert(tree.IsEmpty() && TestDynamicAabbTree_Validate(tree));
+
+    LogMsg("%-50s test is passed", "DynamicAabbTree::Insert/Remove()");
+}
+
+//---------------------------------------------------------
+
+void TestDynamicAabbTreeMove()
+{
+    const int32_t        n = 2000;
+    std::vector<Rect3d>  rects;
+    std::vector<int32_t> proxies(n);
+    std::vector<int32_t> found(n);
+
+    TestBvh_GenerateRects(rects, n);
+
+    DynamicAabbTree tree(0.2f);
+
+    for (int32_t i = 0; i < n; ++i)
+        proxies[i] = tree.Insert(rects[i], i);
+
+    // a motion within the margin doesn't change the tree
+    const Rect3d fatBounds = tree.GetFatBounds(proxies[0]);
+    rects[0] += Vec3(0.1f, -0.1f, 0.05f);
+
+    assert(!tree.Move(proxies[0], rects[0]));
+    assert(tree.GetFatBounds(proxies[0]) == fatBounds);
+
+    // a bigger one reinserts the leaf, its bounds are extended along the motion
+    const Vec3 displacement(5, 0, 0);
+    rects[0] += displacement;
+
+    assert(tree.Move(proxies[0], rects[0], displacement));
+    assert(ContainsRect3d(tree.GetFatBounds(proxies[0]), rects[0]));
+    assert(tree.GetFatBounds(proxies[0]).x1 >= rects[0].x1 + 4.0f * displacement.x);
+
+    // a small step in the same direction fits into the fat bounds
+    rects[0] += Vec3(0.1f, 0, 0);
+    assert(!tree.Move(proxies[0], rects[0], displacement));
+
+    // the object stopped: too big fat bounds are shrunk
+    assert(tree.Move(proxies[0], rects[0]));
+
+    // steady state: a lot of frames of random motion, spawning and despawning
+    const DynamicAabbNode* nodes = tree.nodes;
+    int numReinserted = 0;
+
+    for (int frame = 0; frame < 50; ++frame)
+    {
+        for (int32_t i = 0; i < n; ++i)
+        {
+            if (proxies[i] == DynamicAabbTree::NULL_NODE)
+            {
+                proxies[i] = tree.Insert(rects[i], i);
+                continue;
+            }
+
+            if (RandUint(0, 100) == 0)
+            {
+                tree.Remove(proxies[i]);
+                proxies[i] = DynamicAabbTree::NULL_NODE;
+                continue;
+            }
+
+            const Vec3 d(RandF(-0.3f, 0.3f), RandF(-0.3f, 0.3f), RandF(-0.3f, 0.3f));
+            rects[i] += d;
+            numReinserted += tree.Move(proxies[i], rects[i], d);
+        }
+
+        assert(TestDynamicAabbTree_Validate(tree));
+    }
+
+    // nothing is allocated, fat bounds save most of the reinsertions
+    assert(tree.nodes == nodes);
+    assert(numReinserted > 0 && numReinserted < 50 * n);
+
+    for (int32_t i = 0; i < n; ++i)
+    {
+        if (proxies[i] != DynamicAabbTree::NULL_NODE)
+            assert(ContainsRect3d(tree.GetFatBounds(proxies[i]), rects[i]));
+    }
+
+    // queries find all the overlapping objects
+    for (int test = 0; test < 20; ++test)
+    {
+        const float  x = RandF(-100, 100);
+        const float  y = RandF(-100, 100);
+        const float  z = RandF(-20, 120);
+        const Rect3d box(x, x + RandF(1, 40), y, y + RandF(1, 40), z, z + RandF(1, 40));
+
+        assert(TestDynamicAabbTree_CheckQuery(tree, proxies, rects, box, found));
+    }
+
+    LogMsg("%-50s test is passed", "DynamicAabbTree::Move()");
+}
+
+//---------------------------------------------------------
+
+void TestDynamicAabbTreeQueries()
+{
+    const int32_t        n = 2000;
+    std::vector<Rect3d>  rects;
+    std::vector<int32_t> proxies(n);
+    std::vector<int32_t> found(n);
+
+    TestBvh_GenerateRects(rects, n);
+
+    DynamicAabbTree tree(0.0f);
+    assert(tree.QueryRect(rects[0], found.data(), n) == 0);
+
+    for (int32_t i = 0; i < n; ++i)
+        proxies[i] = tree.Insert(rects[i], i);
+
+    // with zero margin the result is exact
+    for (int test = 0; test < 20; ++test)
+    {
+        const float  x = RandF(-100, 100);
+        const float  y = RandF(-100, 100);
+        const float  z = RandF(-20, 120);
+        const Rect3d box(x, x + RandF(1, 40), y, y + RandF(1, 40), z, z + RandF(1, 40));
+
+        std::vector<uint32_t> expect;
+        for (int32_t i = 0; i < n; ++i)
+            if (OverlapRect3d(rects[i], box))
+                expect.push_back(i);
+
+        const int32_t numFound = tree.QueryRect(box, found.data(), n);
+        std::vector<uint32_t> result;
+
+        for (int32_t i = 0; i < numFound; ++i)
+            result.push_back(tree.GetUserData(found[i]));
+
+        assert(TestBvh_SameIndices(result.data(), (uint32_t)result.size(), expect));
+    }
+
+    // frustum query
+    Frustum frustum;
+    frustum.CreateFromProjMatrix(MatrixProjectionLH(1.30796f, 1600.0f / 900.0f, 0.1f, 100.0f), true);
+
+    const int32_t numFound = tree.QueryFrustum(frustum, found.data(), n);
+    std::vector<uint32_t> result;
+
+    for (int32_t i = 0; i < numFound; ++i)
+        result.push_back(tree.GetUserData(found[i]));
+
+    std::sort(result.begin(), result.end());
+
+    for (int32_t i = 0; i < n; ++i)
+    {
+        bool onBorder = false;
+        const int  type      = TestFrustum_ClassifyRect(frustum, rects[i], onBorder);
+        const bool isVisible = std::binary_search(result.begin(), result.end(), (uint32_t)i);
+
+        if (!onBorder)
+            assert(isVisible == (type != Frustum::CULL_OUTSIDE));
+    }
+
+    assert(numFound > 0 && numFound < n);
+
+    // the output buffer is too small
+    const int32_t maxCount = 5;
+    found[maxCount] = -100;
+
+    assert(tree.QueryFrustum(frustum, found.data(), maxCount) == numFound);
+    assert(found[maxCount] == -100);
+
+    LogMsg("%-50s test is passed", "DynamicAabbTree::QueryRect/Frustum()");
+}
+
+
+//==================================================================================
+// main test
+//==================================================================================
+void TestDynamicAabbTree()
+{
+    SetConsoleColor(MAGENTA);
+
+    LogMsg("-----------------------------------------------");
+    LogMsg("Test dynamic AABB tree functional:");
+    LogMsg("-----------------------------------------------");
+
+    TestDynamicAabbTreeInsertRemove();
+    TestDynamicAabbTreeMove();
+    TestDynamicAabbTreeQueries();
+
+    LogMsg("-----------------------------------------------");
+    LogMsg("all the dynamic AABB tree tests are passed!");
+    LogMsg("-----------------------------------------------\n");
+
+    SetConsoleColor(RESET);
+}
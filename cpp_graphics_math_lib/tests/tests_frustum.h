@@ -8,8 +8,10 @@
 
 #include <geometry/frustum.h>
 #include <geometry/plane_3d_functions.h>
+#include <math/random.h>
 #include <log.h>
 #include <stdio.h>
+#include <string.h>
 
 
 //==================================================================================
@@ -138,6 +140,355 @@ void Test_FrustumTransform()
     LogMsg("%-50s test is passed", "Frustum::Transform(outFrustum, transformMat)");
 }
 
+//---------------------------------------------------------
+// Desc:   check if the sphere is too close to the border of the frustum
+//         (batch and single tests may give different results because of rounding)
+//---------------------------------------------------------
+bool TestFrustum_IsSphereOnBorder(const Frustum& frustum, const Sphere& sphere)
+{
+    const Plane3d* planes[6] =
+    {
+        &frustum.leftPlane, &frustum.rightPlane, &frustum.topPlane,
+        &frustum.bottomPlane, &frustum.nearPlane, &frustum.farPlane
+    };
+
+    for (const Plane3d* plane : planes)
+    {
+        if (fabsf(plane->SignedDistance(sphere.center) + sphere.radius) < EPSILON_E4)
+            return true;
+    }
+    return false;
+}
+
+//---------------------------------------------------------
+
+void Test_FrustumCullSpheres()
+{
+    const float fov    = 1.30796f;
+    const float aspect = 1600.0f / 900.0f;
+
+    Frustum frustum;
+    frustum.CreateFromProjMatrix(MatrixProjectionLH(fov, aspect, 0.1f, 100.0f), true);
+
+    // odd number to test the SIMD body, the tail and more than one output word
+    const size_t n     = 203;
+    const size_t words = (n + 63) / 64;
+
+    Sphere*   spheres = new Sphere[n];
+    float*    x       = new float[n];
+    float*    y       = new float[n];
+    float*    z       = new float[n];
+    float*    r       = new float[n];
+    uint64_t* bits    = new uint64_t[words];
+    uint64_t* bitsSoA = new uint64_t[words];
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        spheres[i] = Sphere(RandF(-120, 120), RandF(-120, 120), RandF(-20, 120), RandF(0, 10));
+        x[i] = spheres[i].center.x;
+        y[i] = spheres[i].center.y;
+        z[i] = spheres[i].center.z;
+        r[i] = spheres[i].radius;
+    }
+
+    memset(bits,    0xFF, words * sizeof(uint64_t));
+    memset(bitsSoA, 0xFF, words * sizeof(uint64_t));
+
+    frustum.CullSpheres(spheres, n, bits);
+    frustum.CullSpheres(x, y, z, r, n, bitsSoA);
+
+    int numVisible = 0;
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        const bool visible    = (bits[i / 64]    >> (i % 64)) & 1;
+        const bool visibleSoA = (bitsSoA[i / 64] >> (i % 64)) & 1;
+
+        assert(visible == visibleSoA);
+
+        if (!TestFrustum_IsSphereOnBorder(frustum, spheres[i]))
+            assert(visible == frustum.TestSphere(spheres[i]));
+
+        numVisible += visible;
+    }
+
+    // we must have both visible and not visible spheres
+    assert(numVisible > 0 && numVisible < (int)n);
+
+    // unused bits of the last word are cleared
+    assert((bits[words - 1] >> (n % 64)) == 0);
+    assert((bitsSoA[words - 1] >> (n % 64)) == 0);
+
+    delete[] spheres;
+    delete[] x;
+    delete[] y;
+    delete[] z;
+    delete[] r;
+    delete[] bits;
+    delete[] bitsSoA;
+
+    LogMsg("%-50s test is passed", "Frustum::CullSpheres(spheres, n, visibleBits)");
+}
+
+//---------------------------------------------------------
+// Desc:   classify the box using PlaneClassify() for each plane and
+//         check if any corner of the box is too close to any plane
+//---------------------------------------------------------
+int TestFrustum_ClassifyRect(const Frustum& frustum, const Rect3d& rect, bool& onBorder)
+{
+    const Plane3d* planes[6] =
+    {
+        &frustum.leftPlane, &frustum.rightPlane, &frustum.topPlane,
+        &frustum.bottomPlane, &frustum.nearPlane, &frustum.farPlane
+    };
+
+    int  numFront = 0;
+    bool outside  = false;
+
+    onBorder = false;
+
+    for (const Plane3d* plane : planes)
+    {
+        const int type = PlaneClassify(rect, *plane);
+
+        outside  |= (type == PLANE_BACK);
+        numFront += (type == PLANE_FRONT);
+
+        for (int i = 0; i < 8; ++i)
+        {
+            const Vec3 corner((i & 1) ? rect.x1 : rect.x0,
+                              (i & 2) ? rect.y1 : rect.y0,
+                              (i & 4) ? rect.z1 : rect.z0);
+
+            onBorder |= (fabsf(plane->SignedDistance(corner)) < EPSILON_E4);
+        }
+    }
+
+    if (outside)
+        return Frustum::CULL_OUTSIDE;
+
+    return (numFront == 6) ? Frustum::CULL_INSIDE : Frustum::CULL_INTERSECT;
+}
+
+//---------------------------------------------------------
+
+void Test_FrustumCullRects()
+{
+    const float fov    = 1.30796f;
+    const float aspect = 1600.0f / 900.0f;
+
+    Frustum frustum;
+    frustum.CreateFromProjMatrix(MatrixProjectionLH(fov, aspect, 0.1f, 100.0f), true);
+
+    const size_t n      = 203;
+    Rect3d*      rects  = new Rect3d[n];
+    uint8_t*     result = new uint8_t[n + 1];
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        const float x = RandF(-100, 100);
+        const float y = RandF(-100, 100);
+        const float z = RandF(-20, 120);
+
+        rects[i] = Rect3d(x, x + RandF(0.1f, 20), y, y + RandF(0.1f, 20), z, z + RandF(0.1f, 20));
+    }
+
+    result[n] = 0xAB;
+    frustum.CullRects(rects, n, result);
+
+    int count[3] = { 0 };
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        bool onBorder = false;
+        const int expect = TestFrustum_ClassifyRect(frustum, rects[i], onBorder);
+
+        if (!onBorder)
+        {
+            assert(result[i] == expect);
+            assert((result[i] != Frustum::CULL_OUTSIDE) == frustum.TestRect(rects[i]));
+        }
+
+        count[result[i]]++;
+    }
+
+    // we must have all the types of results
+    assert(count[Frustum::CULL_OUTSIDE] > 0);
+    assert(count[Frustum::CULL_INTERSECT] > 0);
+    assert(count[Frustum::CULL_INSIDE] > 0);
+
+    // nothing is written behind the end of the output
+    assert(result[n] == 0xAB);
+
+    delete[] rects;
+    delete[] result;
+
+    LogMsg("%-50s test is passed", "Frustum::CullRects(rects, n, result)");
+}
+
+//---------------------------------------------------------
+
+void Test_FrustumHierarchicalCulling()
+{
+    Frustum frustum;
+    frustum.CreateFromProjMatrix(MatrixProjectionLH(1.30796f, 1600.0f / 900.0f, 0.1f, 100.0f), true);
+
+    // a box behind the far plane is rejected by it, and the cache remembers this plane
+    const Rect3d farRect(-1, 1, -1, 1, 200, 210);
+    uint32_t     outMask   = 0;
+    int          lastPlane = -1;
+
+    assert(frustum.ClassifyRect(farRect, Frustum::ALL_PLANES_MASK, outMask, lastPlane) == Frustum::CULL_OUTSIDE);
+    assert(lastPlane == Frustum::PLANE_IDX_FAR);
+    assert(outMask == 0);
+
+    // next time the cached plane is tested first and rejects the box again
+    assert(frustum.ClassifyRect(farRect, Frustum::ALL_PLANES_MASK, outMask, lastPlane) == Frustum::CULL_OUTSIDE);
+    assert(lastPlane == Frustum::PLANE_IDX_FAR);
+
+    // a box which crosses only the near plane
+    const Rect3d nearRect(-0.01f, 0.01f, -0.01f, 0.01f, 0.05f, 0.5f);
+    lastPlane = -1;
+
+    assert(frustum.ClassifyRect(nearRect, Frustum::ALL_PLANES_MASK, outMask, lastPlane) == Frustum::CULL_INTERSECT);
+    assert(outMask == (1 << Frustum::PLANE_IDX_NEAR));
+    assert(lastPlane == -1);
+
+    // if the parent is completely inside, children are inside without any tests
+    assert(frustum.ClassifyRect(farRect, 0, outMask, lastPlane) == Frustum::CULL_INSIDE);
+
+    // children with the parent mask give the same result as the full test
+    for (int i = 0; i < 50; ++i)
+    {
+        const float x = RandF(-100, 100);
+        const float y = RandF(-100, 100);
+        const float z = RandF(-20, 120);
+        const float size = RandF(1, 40);
+
+        const Rect3d parent(x, x + size, y, y + size, z, z + size);
+        uint32_t     parentMask  = 0;
+        int          parentCache = -1;
+
+        const int parentRes = frustum.ClassifyRect(parent, Frustum::ALL_PLANES_MASK, parentMask, parentCache);
+
+        if (parentRes == Frustum::CULL_OUTSIDE)
+            continue;
+
+        // 8 octants of the parent box
+        for (int k = 0; k < 8; ++k)
+        {
+            const float half = size * 0.5f;
+            const float cx   = x + ((k & 1) ? half : 0);
+            const float cy   = y + ((k & 2) ? half : 0);
+            const float cz   = z + ((k & 4) ? half : 0);
+            const Rect3d child(cx, cx + half, cy, cy + half, cz, cz + half);
+
+            uint32_t maskFull = 0, maskHier = 0;
+            int      cacheFull = -1, cacheHier = -1;
+
+            const int full = frustum.ClassifyRect(child, Frustum::ALL_PLANES_MASK, maskFull, cacheFull);
+            const int hier = frustum.ClassifyRect(child, parentMask, maskHier, cacheHier);
+
+            assert(full == hier);
+            assert(maskFull == maskHier);
+
+            // the same for spheres inscribed into children
+            const Sphere sphere(cx + half*0.5f, cy + half*0.5f, cz + half*0.5f, half * 0.5f);
+
+            const int sphereFull = frustum.ClassifySphere(sphere, Frustum::ALL_PLANES_MASK, maskFull, cacheFull);
+            const int sphereHier = frustum.ClassifySphere(sphere, parentMask, maskHier, cacheHier);
+
+            assert(sphereFull == sphereHier);
+
+            if (full == Frustum::CULL_INSIDE)
+                assert(sphereFull == Frustum::CULL_INSIDE);
+        }
+    }
+
+    LogMsg("%-50s test is passed", "Frustum::ClassifyRect/ClassifySphere (hierarchical)");
+}
+
+//---------------------------------------------------------
+
+void Test_PackedFrustum()
+{
+    const Matrix proj = MatrixProjectionLH(1.30796f, 1600.0f / 900.0f, 0.1f, 100.0f);
+
+    PackedFrustum packed;
+    packed.CreateFromProjMatrix(proj, true);
+
+    assert(((size_t)&packed % 32) == 0);
+
+    // padding lanes are empty planes
+    for (int i = Frustum::NUM_PLANES; i < PackedFrustum::NUM_LANES; ++i)
+    {
+        assert(packed.nx[i] == 0 && packed.ny[i] == 0 && packed.nz[i] == 0 && packed.d[i] == 0);
+        assert(packed.signX[i] == 0 && packed.signY[i] == 0 && packed.signZ[i] == 0);
+    }
+
+    // the camera moves: rebuild planes from the view-projection matrix
+    const Matrix view = MatrixTranslation(-10, 5, -20) * MatrixRotationY(0.7f);
+
+    Frustum frustum;
+    frustum.CreateFromProjMatrix(view * proj, true);
+    packed.Build(frustum);
+
+    for (int i = 0; i < Frustum::NUM_PLANES; ++i)
+    {
+        const Plane3d& plane = frustum.GetPlane(i);
+
+        assert(packed.nx[i] == plane.normal.x && packed.absNx[i] == fabsf(plane.normal.x));
+        assert(packed.ny[i] == plane.normal.y && packed.absNy[i] == fabsf(plane.normal.y));
+        assert(packed.nz[i] == plane.normal.z && packed.absNz[i] == fabsf(plane.normal.z));
+        assert(packed.d[i]  == plane.distance);
+        assert((packed.signX[i] != 0) == (plane.normal.x > 0.0f));
+    }
+
+    // single volume tests against all the planes at once
+    const size_t n       = 150;
+    Rect3d*      rects   = new Rect3d[n];
+    uint8_t*     result  = new uint8_t[n];
+    uint8_t*     result2 = new uint8_t[n];
+    int          count[3] = { 0 };
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        const Sphere sphere(RandF(-120, 120), RandF(-120, 120), RandF(-120, 120), RandF(0, 10));
+
+        if (!TestFrustum_IsSphereOnBorder(frustum, sphere))
+            assert(packed.TestSphere(sphere) == frustum.TestSphere(sphere));
+
+        const float x = RandF(-100, 100);
+        const float y = RandF(-100, 100);
+        const float z = RandF(-100, 100);
+
+        rects[i] = Rect3d(x, x + RandF(0.1f, 20), y, y + RandF(0.1f, 20), z, z + RandF(0.1f, 20));
+
+        bool onBorder = false;
+        const int expect = TestFrustum_ClassifyRect(frustum, rects[i], onBorder);
+
+        if (!onBorder)
+            assert(packed.ClassifyRect(rects[i]) == expect);
+
+        count[expect]++;
+    }
+
+    assert(count[Frustum::CULL_OUTSIDE] > 0);
+    assert(count[Frustum::CULL_INTERSECT] + count[Frustum::CULL_INSIDE] > 0);
+
+    // batch culling with a prebuilt frustum gives the same results
+    packed.CullRects(rects, n, result);
+    frustum.CullRects(rects, n, result2);
+
+    assert(memcmp(result, result2, n) == 0);
+
+    delete[] rects;
+    delete[] result;
+    delete[] result2;
+
+    LogMsg("%-50s test is passed", "PackedFrustum");
+}
+
 //==================================================================================
 // main test
 //==================================================================================
@@ -155,6 +506,11 @@ void TestFrustum()
 
     Test_FrustumTransform();
 
+    Test_FrustumCullSpheres();
+    Test_FrustumCullRects();
+    Test_FrustumHierarchicalCulling();
+    Test_PackedFrustum();
+
     LogMsg("-----------------------------------------------");
     LogMsg("all the tests for Frustum are passed!");
     LogMsg("-----------------------------------------------\n");
@@ -0,0 +1,254 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: tests_loose_octree.h
+    Desc:     tests for the loose octree
+
+    Created:  17.10.2026  by DimaSkup
+\**********************************************************************************/
+#pragma once
+#include <geometry/loose_octree.h>
+#include <tests/tests_bvh.h>
+#include <math/random.h>
+#include <log.h>
+#include <stdio.h>
+#include <algorithm>
+#include <vector>
+
+
+//==================================================================================
+// forward declaration of the main test
+//==================================================================================
+void TestLooseOctree();
+
+
+//==================================================================================
+// helpers
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:   generate objects of very different sizes (props, houses, hills)
+//---------------------------------------------------------
+inline void TestLooseOctree_GenerateRects(std::vector<Rect3d>& rects, const size_t n)
+{
+    rects.resize(n);
+
+    for (Rect3d& rect : rects)
+    {
+        const float x    = RandF(-500, 500);
+        const float y    = RandF(0, 50);
+        const float z    = RandF(-500, 500);
+        const float size = (RandUint(0, 100) == 0) ? RandF(50, 300) : RandF(0.1f, 5);
+
+        rect = Rect3d(x, x + size, y, y + RandF(0.1f, size), z, z + RandF(0.1f, size));
+    }
+}
+
+//---------------------------------------------------------
+// Desc:   check a subtree: ranges of children follow the own objects of
+//         the node, bounds of the node contain everything under it
+//---------------------------------------------------------
+inline bool TestLooseOctree_ValidateNode(const LooseOctree& tree, const uint32_t nodeIdx, const int level)
+{
+    const LooseOctreeNode& node = tree.nodes[nodeIdx];
+
+    if (level > tree.maxDepth || node.numTotal == 0)
+        return false;
+
+    for (uint32_t i = node.first; i < node.first + node.numOwn; ++i)
+    {
+        if (tree.GetLevel(tree.objBounds[i]) != level)
+            return false;
+
+        if (!ContainsRect3d(node.bounds, tree.objBounds[i]))
+            return false;
+    }
+
+    uint32_t next = node.first + node.numOwn;
+
+    for (uint32_t c = node.firstChild; c < node.firstChild + node.numChildren; ++c)
+    {
+        const LooseOctreeNode& child = tree.nodes[c];
+
+        if (child.first != next || !ContainsRect3d(node.bounds, child.bounds))
+            return false;
+
+        if (!TestLooseOctree_ValidateNode(tree, c, level + 1))
+            return false;
+
+        next += child.numTotal;
+    }
+
+    return next == node.first + node.numTotal;
+}
+
+
+//==================================================================================
+// test functions
+//==================================================================================
+void TestLooseOctreeBuild()
+{
+    const uint32_t      n = 20000;
+    std::vector<Rect3d> rects;
+    LooseOctree         tree;
+
+    // empty tree
+    tree.Build(nullptr, 0);
+    assert(tree.IsEmpty());
+    assert(tree.QueryRect(Rect3d(0, 1, 0, 1, 0, 1), nullptr, 0) == 0);
+
+    // a single object is in the root
+    TestLooseOctree_GenerateRects(rects, 1);
+    tree.Build(rects.data(), 1);
+    assert(tree.nodes.size() == 1 && tree.nodes[0].numOwn == 1);
+
+    // a lot of objects
+    TestLooseOctree_GenerateRects(rects, n);
+    tree.Build(rects.data(), n);
+
+    assert(TestLooseOctree_ValidateNode(tree, 0, 0));
+    assert(tree.nodes[0].numTotal == n);
+
+    std::vector<int> refs(n, 0);
+
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        const Rect3d& rect  = rects[tree.objIndices[i]];
+        const int     level = tree.GetLevel(rect);
+
+        refs[tree.objIndices[i]]++;
+        assert(tree.objBounds[i] == rect);
+
+        // the object isn't bigger than a cell of its level,
+        // but it is bigger than a cell of the next level
+        const float numCells = (float)(1 << level);
+        const Vec3  cellSize(tree.worldSize.x / numCells, tree.worldSize.y / numCells, tree.worldSize.z / numCells);
+        const Vec3  size = rect.Size();
+
+        assert(size.x <= cellSize.x && size.y <= cellSize.y && size.z <= cellSize.z);
+
+        if (level < tree.maxDepth)
+            assert(size.x > 0.5f * cellSize.x || size.y > 0.5f * cellSize.y || size.z > 0.5f * cellSize.z);
+
+        // so it fits into the loose cell of its center
+        uint32_t cx, cy, cz;
+        tree.GetCell(rect.MidPoint(), level, cx, cy, cz);
+
+        Rect3d looseCell = tree.GetLooseCellBounds(level, cx, cy, cz);
+        looseCell.Expand(0.001f);
+        assert(ContainsRect3d(looseCell, rect));
+    }
+
+    for (const int count : refs)
+        assert(count == 1);
+
+    // a rebuild with another depth
+    tree.Build(rects.data(), n, 4);
+    assert(TestLooseOctree_ValidateNode(tree, 0, 0));
+
+    // all the objects are the same
+    for (Rect3d& rect : rects)
+        rect = Rect3d(1, 2, 1, 2, 1, 2);
+
+    tree.Build(rects.data(), n);
+    assert(tree.nodes.size() == 1 && tree.nodes[0].numOwn == n);
+
+    LogMsg("%-50s test is passed", "LooseOctree::Build()");
+}
+
+//---------------------------------------------------------
+
+void TestLooseOctreeQueries()
+{
+    const uint32_t        n = 20000;
+    std::vector<Rect3d>   rects;
+    std::vector<uint32_t> expect;
+    std::vector<uint32_t> found(n);
+
+    TestLooseOctree_GenerateRects(rects, n);
+
+    LooseOctree tree;
+    tree.Build(rects.data(), n);
+
+    // rect query (both small and big boxes, so some subtrees are completely inside)
+    for (int test = 0; test < 20; ++test)
+    {
+        const float  x    = RandF(-500, 500);
+        const float  z    = RandF(-500, 500);
+        const float  size = (test & 1) ? RandF(1, 20) : RandF(100, 600);
+        const Rect3d box(x, x + size, -10, 60, z, z + size);
+
+        expect.clear();
+        for (uint32_t i = 0; i < n; ++i)
+            if (OverlapRect3d(rects[i], box))
+                expect.push_back(i);
+
+        const uint32_t numFound = tree.QueryRect(box, found.data(), n);
+        assert(TestBvh_SameIndices(found.data(), numFound, expect));
+    }
+
+    // frustum query
+    Frustum frustum;
+    frustum.CreateFromProjMatrix(MatrixProjectionLH(1.30796f, 1600.0f / 900.0f, 0.1f, 400.0f), true);
+
+    const uint32_t numFound = tree.QueryFrustum(frustum, found.data(), n);
+    std::vector<uint32_t> result(found.data(), found.data() + numFound);
+
+    std::sort(result.begin(), result.end());
+
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        bool onBorder = false;
+        const int  type      = TestFrustum_ClassifyRect(frustum, rects[i], onBorder);
+        const bool isVisible = std::binary_search(result.begin(), result.end(), i);
+
+        if (!onBorder)
+            assert(isVisible == (type != Frustum::CULL_OUTSIDE));
+    }
+
+    // each object is found once
+    assert(std::adjacent_find(result.begin(), result.end()) == result.end());
+    assert(numFound > 0 && numFound < n);
+
+    // the output buffer is too small: the result is the total number,
+    // but only maxCount indices are written
+    const uint32_t maxCount = 5;
+    found[maxCount] = 0xFFFFFFFF;
+
+    assert(tree.QueryFrustum(frustum, found.data(), maxCount) == numFound);
+    assert(found[maxCount] == 0xFFFFFFFF);
+
+    assert(tree.QueryRect(tree.worldBounds, found.data(), maxCount) == n);
+    assert(found[maxCount] == 0xFFFFFFFF);
+
+    LogMsg("%-50s test is passed", "LooseOctree::QueryFrustum/Rect()");
+}
+
+
+//==================================================================================
+// main test
+//==================================================================================
+void TestLooseOctree()
+{
+    SetConsoleColor(GREEN);
+
+    LogMsg("-----------------------------------------------");
+    LogMsg("Test loose octree functional:");
+    LogMsg("-----------------------------------------------");
+
+    TestLooseOctreeBuild();
+    TestLooseOctreeQueries();
+
+    LogMsg("-----------------------------------------------");
+    LogMsg("all the loose octree tests are passed!");
+    LogMsg("-----------------------------------------------\n");
+
+    SetConsoleColor(RESET);
+}
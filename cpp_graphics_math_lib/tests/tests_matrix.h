@@ -16,8 +16,10 @@
 #pragma once
 #include <math/matrix.h>
 #include <math/math_helpers.h>
+#include <math/random.h>
 #include <log.h>
 #include <stdio.h>
+#include <algorithm>
 
 
 //==================================================================================
@@ -318,6 +320,97 @@ void TestMatrixGetInverse()
 
 //---------------------------------------------------------
 
+void TestMatrixGetInverseGeneral()
+{
+    const Matrix I = MatrixIdentity();
+
+    // projection matrix isn't affine so only the general inverse is correct for it
+    const Matrix proj = MatrixProjectionLH(DEG_TO_RAD(60), 1.5f, 0.1f, 100.0f);
+    Matrix invProj;
+    Matrix res;
+    float det = 0;
+
+    assert(MatrixInverse(invProj, &det, proj) == 1);
+    assert(FloatEqual(det, MatrixDeterminant4x4(proj)));
+
+    MatrixMul(proj, invProj, res);
+    assert(MatrixEqual(res, I) == true);
+
+    MatrixMul(invProj, proj, res);
+    assert(MatrixEqual(res, I) == true);
+
+    // SIMD and scalar versions must give the same result for random matrices
+    for (int n = 0; n < 100; ++n)
+    {
+        Matrix m;
+        Matrix inv0;
+        Matrix inv1;
+        float det0 = 0;
+        float det1 = 0;
+
+        for (int i = 0; i < 16; ++i)
+            m.mat[i] = RandF(-1, 1);
+
+        // make the matrix diagonally dominant so it is well-conditioned
+        for (int i = 0; i < 4; ++i)
+            m.m[i][i] += 5.0f;
+
+        assert(MatrixInverse(inv0, &det0, m) == 1);
+        assert(MatrixInverseScalar(inv1, &det1, m) == 1);
+
+        assert(fabsf(det0 - det1) < EPSILON_E4 * fabsf(det1));
+        assert(MatrixEqual(inv0, inv1) == true);
+
+        MatrixMul(m, inv0, res);
+        assert(MatrixEqual(res, I) == true);
+
+        // output can be the same object as input
+        MatrixInverse(m, nullptr, m);
+        assert(MatrixEqual(m, inv0) == true);
+    }
+
+    // a singular matrix has no inverse
+    const Matrix singular(1,2,3,4,  2,4,6,8,  0,1,0,1,  1,0,0,1);
+    assert(MatrixInverse(res, &det, singular) == 0);
+    assert(MatrixInverseScalar(res, &det, singular) == 0);
+
+    LogMsg("%-50s test is passed", "MatrixInverse() for a general 4x4 matrix");
+}
+
+//---------------------------------------------------------
+
+void TestMatrixGetInverseAffineOrthonormal()
+{
+    const Matrix I      = MatrixIdentity();
+    const Matrix rotTr  = MatrixRotationAxis(Vec3{ 1,2,3 }, 0.6f) * MatrixTranslation(4, -5, 6);
+    const Matrix affine = MatrixScaling(2, 3, 0.5f) * rotTr;
+
+    Matrix inv;
+    Matrix expect;
+    Matrix res;
+
+    // affine inverse
+    assert(MatrixInverseAffine(inv, nullptr, affine) == 1);
+    MatrixInverseScalar(expect, nullptr, affine);
+    assert(MatrixEqual(inv, expect) == true);
+
+    MatrixMul(affine, inv, res);
+    assert(MatrixEqual(res, I) == true);
+
+    // inverse of rotation+translation
+    MatrixInverseOrthonormal(inv, rotTr);
+    MatrixInverseScalar(expect, nullptr, rotTr);
+    assert(MatrixEqual(inv, expect) == true);
+
+    MatrixMul(rotTr, inv, res);
+    assert(MatrixEqual(res, I) == true);
+
+    LogMsg("%-50s test is passed", "MatrixInverseAffine(invMat, det, mat)");
+    LogMsg("%-50s test is passed", "MatrixInverseOrthonormal(invMat, mat)");
+}
+
+//---------------------------------------------------------
+
 void TestMatrixMultiplyMatrix()
 {
     const Matrix matA(4, 1, 8, 0, 9, 6, 2, 0, 1, 6, 2, 0, 10, 20, 30, 1);
@@ -338,6 +431,110 @@ void TestMatrixMultiplyMatrix()
 
 //---------------------------------------------------------
 
+void TestMatrixMultiplySimd()
+{
+    // SIMD version of MatrixMul must give the same result as the scalar one
+    for (int n = 0; n < 100; ++n)
+    {
+        Matrix ma;
+        Matrix mb;
+        Matrix expect;
+        Matrix res;
+
+        for (int i = 0; i < 16; ++i)
+        {
+            ma.mat[i] = RandF(-10, 10);
+            mb.mat[i] = RandF(-10, 10);
+        }
+
+        MatrixMulScalar(ma, mb, expect);
+        MatrixMul(ma, mb, res);
+
+        for (int i = 0; i < 16; ++i)
+            assert(fabsf(expect.mat[i] - res.mat[i]) < EPSILON_E4 * 100);   // abs values up to 400
+
+        // output can be the same object as input
+        Matrix mc(ma);
+        MatrixMul(mc, mb, mc);
+        assert(MatrixEqual(mc, res) == true);
+
+        Matrix md(mb);
+        MatrixMul(ma, md, md);
+        assert(MatrixEqual(md, res) == true);
+    }
+
+    LogMsg("%-50s test is passed", "MatrixMul() SIMD vs MatrixMulScalar()");
+}
+
+//---------------------------------------------------------
+
+void TestMatrixMulBatch_Helper(const size_t n)
+{
+    Matrix* a   = new Matrix[n];
+    Matrix* b   = new Matrix[n];
+    Matrix* out = new Matrix[n];
+    Matrix parent;
+    Matrix expect;
+
+    for (int i = 0; i < 16; ++i)
+        parent.mat[i] = RandF(-2, 2);
+
+    for (size_t idx = 0; idx < n; ++idx)
+    {
+        for (int i = 0; i < 16; ++i)
+        {
+            a[idx].mat[i] = RandF(-2, 2);
+            b[idx].mat[i] = RandF(-2, 2);
+        }
+    }
+
+    // out[i] = a[i] * parent
+    MatrixMulBatch(a, parent, out, n);
+
+    for (size_t idx = 0; idx < n; ++idx)
+    {
+        MatrixMulScalar(a[idx], parent, expect);
+        assert(MatrixEqual(expect, out[idx]) == true);
+    }
+
+    // out[i] = a[i] * b[i]
+    MatrixMulBatch(a, b, out, n);
+
+    for (size_t idx = 0; idx < n; ++idx)
+    {
+        MatrixMulScalar(a[idx], b[idx], expect);
+        assert(MatrixEqual(expect, out[idx]) == true);
+    }
+
+    // in-place: out[i] = out[i] * parent
+    std::copy(a, a + n, out);
+    MatrixMulBatch(out, parent, out, n);
+
+    for (size_t idx = 0; idx < n; ++idx)
+    {
+        MatrixMulScalar(a[idx], parent, expect);
+        assert(MatrixEqual(expect, out[idx]) == true);
+    }
+
+    delete[] a;
+    delete[] b;
+    delete[] out;
+}
+
+//---------------------------------------------------------
+
+void TestMatrixMulBatch()
+{
+    // small batches are stored as usual, big ones - with non-temporal stores
+    TestMatrixMulBatch_Helper(1);
+    TestMatrixMulBatch_Helper(37);
+    TestMatrixMulBatch_Helper(MATRIX_BATCH_STREAM_BYTES / sizeof(Matrix) + 3);
+
+    LogMsg("%-50s test is passed", "MatrixMulBatch(a, b, out, n)");
+}
+
+//---------------------------------------------------------
+
 void TestMatrixTranslation()
 {
     const Vec3   t    = { 1.5312312f, 2.55345345f, 3.54234234f };   // translation vec
@@ -556,6 +753,102 @@ void TestMatrixMultiplyVec4()
 
 //---------------------------------------------------------
 
+void TestMatrixTransformStream_Helper(const size_t count)
+{
+    // interleaved vertex: position, some data, normal
+    struct Vertex
+    {
+        Vec3  pos;
+        float data;
+        Vec3  normal;
+    };
+
+    const Matrix mat = MatrixRotationAxis(Vec3{ 1,2,3 }, 0.7f) * MatrixTranslation(1, -2, 3);
+
+    Vertex* verts   = new Vertex[count];
+    Vec3*   points  = new Vec3[count];
+    Vec3*   outVec3 = new Vec3[count];
+    Vec4*   vec4s   = new Vec4[count];
+    Vec4*   outVec4 = new Vec4[count];
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        verts[i].pos    = Vec3(RandF(-5, 5), RandF(-5, 5), RandF(-5, 5));
+        verts[i].normal = Vec3(RandF(-1, 1), RandF(-1, 1), RandF(-1, 1));
+        verts[i].data   = 100.0f;
+        points[i]       = verts[i].pos;
+        vec4s[i]        = Vec4(RandF(-5, 5), RandF(-5, 5), RandF(-5, 5), RandF(-1, 1));
+    }
+
+    // packed points
+    MatrixTransformPoints(points, sizeof(Vec3), mat, outVec3, sizeof(Vec3), count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        Vec3 expect;
+        MatrixMulVec3(points[i], mat, expect);
+        assert(outVec3[i] == expect);
+    }
+
+    // strided points -> packed output
+    MatrixTransformPoints(&verts[0].pos, sizeof(Vertex), mat, outVec3, sizeof(Vec3), count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        Vec3 expect;
+        MatrixMulVec3(verts[i].pos, mat, expect);
+        assert(outVec3[i] == expect);
+    }
+
+    // strided normals in-place (translation must be ignored)
+    for (size_t i = 0; i < count; ++i)
+        points[i] = verts[i].normal;
+
+    MatrixTransformNormals(&verts[0].normal, sizeof(Vertex), mat, &verts[0].normal, sizeof(Vertex), count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        Vec4 expect;
+        MatrixMulVec4(Vec4(points[i].x, points[i].y, points[i].z, 0), mat, expect);
+
+        assert(verts[i].normal == Vec3(expect.x, expect.y, expect.z));
+        assert(verts[i].data == 100.0f);    // data btw normals is untouched
+    }
+
+    // packed Vec4
+    MatrixTransformVec4Stream(vec4s, sizeof(Vec4), mat, outVec4, sizeof(Vec4), count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        Vec4 expect;
+        MatrixMulVec4(vec4s[i], mat, expect);
+        assert(outVec4[i] == expect);
+    }
+
+    delete[] verts;
+    delete[] points;
+    delete[] outVec3;
+    delete[] vec4s;
+    delete[] outVec4;
+}
+
+//---------------------------------------------------------
+
+void TestMatrixTransformStream()
+{
+    // check counts which aren't divisible by 4 or 8 (tails)
+    TestMatrixTransformStream_Helper(0);
+    TestMatrixTransformStream_Helper(3);
+    TestMatrixTransformStream_Helper(8);
+    TestMatrixTransformStream_Helper(29);
+
+    LogMsg("%-50s test is passed", "MatrixTransformPoints(in, inStride, mat, ...)");
+    LogMsg("%-50s test is passed", "MatrixTransformNormals(in, inStride, mat, ...)");
+    LogMsg("%-50s test is passed", "MatrixTransformVec4Stream(in, inStride, mat, ...)");
+}
+
+//---------------------------------------------------------
+
 void TestMatrixRotationAxis()
 {
     const Matrix mRot      = MatrixRotationAxis(Vec3{1,1,1}, DEG_TO_RAD(-90));
@@ -649,7 +942,11 @@ void TestMatrixFunctions()
 
     TestMatrixGetDeterminant();
     TestMatrixGetInverse();
+    TestMatrixGetInverseGeneral();
+    TestMatrixGetInverseAffineOrthonormal();
     TestMatrixMultiplyMatrix();
+    TestMatrixMultiplySimd();
+    TestMatrixMulBatch();
 
     TestMatrixTranslation();
 
@@ -659,6 +956,7 @@ void TestMatrixFunctions()
 
     TestMatrixMultiplyVec3();
     TestMatrixMultiplyVec4();
+    TestMatrixTransformStream();
     TestMatrixRotationAxis();
 }
 
@@ -0,0 +1,163 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: tests_matrix3x4.h
+    Desc:     tests for compact 3x4 affine matrix functional
+
+    Created:  17.10.2026  by DimaSkup
+\**********************************************************************************/
+#pragma once
+#include <math/matrix3x4.h>
+#include <math/math_helpers.h>
+#include <log.h>
+#include <stdio.h>
+
+
+//==================================================================================
+// forward declaration of the main test
+//==================================================================================
+void TestMatrix3x4();
+
+
+//==================================================================================
+// test constructors and functions
+//==================================================================================
+void TestMatrix3x4Size()
+{
+    static_assert(sizeof(Matrix3x4) == 48, "Matrix3x4 must be 48 bytes");
+
+    LogMsg("%-50s test is passed", "sizeof(Matrix3x4) == 48");
+}
+
+//---------------------------------------------------------
+
+void TestMatrix3x4ConvertToFromMatrix()
+{
+    const Matrix src = MatrixRotationAxis(Vec3{ 1,2,3 }, 0.7f) * MatrixTranslation(1, 2, 3);
+
+    const Matrix3x4 m(src);
+    Matrix dst;
+    Matrix3x4ToMatrix(m, dst);
+
+    assert(MatrixEqual(src, dst) == true);
+
+    // translation is stored in the last element of each row
+    assert(FloatEqual(m.m[0][3], 1.0f));
+    assert(FloatEqual(m.m[1][3], 2.0f));
+    assert(FloatEqual(m.m[2][3], 3.0f));
+
+    LogMsg("%-50s test is passed", "Matrix3x4(const Matrix&)");
+    LogMsg("%-50s test is passed", "Matrix3x4ToMatrix(const Matrix3x4&, Matrix&)");
+}
+
+//---------------------------------------------------------
+
+void TestMatrix3x4Mul()
+{
+    const Matrix ma = MatrixScaling(2, 3, 4) * MatrixRotationX(0.3f) * MatrixTranslation(-1, 5, 2);
+    const Matrix mb = MatrixRotationAxis(Vec3{ -1,2,1 }, 1.1f) * MatrixTranslation(7, 0, -3);
+
+    const Matrix3x4 a(ma);
+    const Matrix3x4 b(mb);
+
+    // the result must be the same as for 4x4 matrices
+    const Matrix3x4 expect(ma * mb);
+
+    Matrix3x4 res;
+    Matrix3x4Mul(a, b, res);
+    assert(Matrix3x4Equal(res, expect) == true);
+
+    assert(Matrix3x4Equal(a * b, expect) == true);
+
+    Matrix3x4 c(a);
+    c *= b;
+    assert(Matrix3x4Equal(c, expect) == true);
+
+    LogMsg("%-50s test is passed", "Matrix3x4Mul(a, b, outMat)");
+    LogMsg("%-50s test is passed", "Matrix3x4::operator *= (const Matrix3x4&)");
+}
+
+//---------------------------------------------------------
+
+void TestMatrix3x4Transform()
+{
+    const Matrix    mat = MatrixRotationY(0.4f) * MatrixTranslation(3, -2, 1);
+    const Matrix3x4 m(mat);
+    const Vec3      v(1, 2, 3);
+
+    Vec3 res;
+    Vec3 expect;
+
+    // point
+    Matrix3x4TransformPoint(v, m, res);
+    MatrixMulVec3(v, mat, expect);
+    assert(res == expect);
+
+    // normal: translation is ignored
+    Vec4 expect4;
+    Matrix3x4TransformNormal(v, m, res);
+    MatrixMulVec4(Vec4(v.x, v.y, v.z, 0), mat, expect4);
+    assert(res == Vec3(expect4.x, expect4.y, expect4.z));
+
+    LogMsg("%-50s test is passed", "Matrix3x4TransformPoint(p, mat, outPoint)");
+    LogMsg("%-50s test is passed", "Matrix3x4TransformNormal(n, mat, outNormal)");
+}
+
+//---------------------------------------------------------
+
+void TestMatrix3x4Inverse()
+{
+    const Matrix    mat = MatrixScaling(2, 0.5f, 3) * MatrixRotationZ(0.9f) * MatrixTranslation(3, -2, 1);
+    const Matrix3x4 m(mat);
+
+    Matrix3x4 inv;
+    float     det = 0;
+
+    assert(Matrix3x4Inverse(inv, &det, m) == 1);
+    assert(FloatEqual(det, MatrixDeterminant(mat)));
+
+    // m * inv(m) == identity
+    assert(Matrix3x4Equal(m * inv, Matrix3x4Identity()) == true);
+
+    // the same as the 4x4 inverse
+    const Matrix3x4 expect(MatrixInverse(nullptr, mat));
+    assert(Matrix3x4Equal(inv, expect) == true);
+
+    // singular matrix
+    const Matrix3x4 zero;
+    assert(Matrix3x4Inverse(inv, nullptr, zero) == 0);
+
+    LogMsg("%-50s test is passed", "Matrix3x4Inverse(invMat, det, mat)");
+}
+
+
+//==================================================================================
+// main test
+//==================================================================================
+void TestMatrix3x4()
+{
+    SetConsoleColor(CYAN);
+
+    LogMsg("-----------------------------------------------");
+    LogMsg("Test Matrix3x4 functional:");
+    LogMsg("-----------------------------------------------");
+
+    TestMatrix3x4Size();
+    TestMatrix3x4ConvertToFromMatrix();
+    TestMatrix3x4Mul();
+    TestMatrix3x4Transform();
+    TestMatrix3x4Inverse();
+
+    LogMsg("-----------------------------------------------");
+    LogMsg("all the Matrix3x4 tests are passed!");
+    LogMsg("-----------------------------------------------\n");
+
+    SetConsoleColor(RESET);
+}
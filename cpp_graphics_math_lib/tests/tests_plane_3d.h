@@ -90,7 +90,8 @@ void Test_Plane3dConstructor_Copy()
 
 void Test_Plane3dConstructor_With3Points()
 {
-    // setup with 3 points in a clockwise ordering
+    // setup with 3 points in a clockwise ordering (looking from -z along +z),
+    // so the normal points to -z
     const Vec3 p0( 0, 1, 1);
     const Vec3 p1( 1,-1, 1);
     const Vec3 p2(-1,-1, 1);
@@ -99,8 +100,8 @@ void Test_Plane3dConstructor_With3Points()
 
     assert(pl.normal.x < EPSILON_E5);
     assert(pl.normal.y < EPSILON_E5);
-    assert(pl.normal.z == 1);
-    assert(pl.distance == -1);
+    assert(pl.normal.z == -1);
+    assert(pl.distance == 1);
 
     LogMsg("%-50s test is passed", "Plane3d::Plane3d(point0, point1, point2)");
 }
@@ -276,7 +277,7 @@ void Test_Plane3d_ProjectPointToPlane()
 
 void Test_Plane3d_Set()
 {
-    // test Set(3 points)
+    // test Set(3 points): clockwise looking from -z, the normal points to -z
     const Vec3 p0(0, 1, 1);
     const Vec3 p1(1, -1, 1);
     const Vec3 p2(-1, -1, 1);
@@ -286,8 +287,8 @@ void Test_Plane3d_Set()
 
     assert(pl0.normal.x < EPSILON_E5);
     assert(pl0.normal.y < EPSILON_E5);
-    assert(pl0.normal.z == 1);
-    assert(pl0.distance == -1);
+    assert(pl0.normal.z == -1);
+    assert(pl0.distance == 1);
 
 
     // test Set(normalVec, distance)
@@ -0,0 +1,239 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: tests_quat.h
+    Desc:     tests for quaternion functional
+
+    Created:  17.10.2026  by DimaSkup
+\**********************************************************************************/
+#pragma once
+#include <math/quat.h>
+#include <math/math_helpers.h>
+#include <math/random.h>
+#include <log.h>
+#include <stdio.h>
+
+
+//==================================================================================
+// forward declaration of the main test
+//==================================================================================
+void TestQuat();
+
+
+//==================================================================================
+// helpers
+//==================================================================================
+inline Quat TestQuatRandom()
+{
+    const Vec3 axis(RandF(-1, 1), RandF(-1, 1), RandF(0.1f, 1));
+    return QuatFromAxisAngle(axis, RandF(-PI, PI));
+}
+
+
+//==================================================================================
+// test functions
+//==================================================================================
+void TestQuatFromAxisAngle()
+{
+    const Vec3  axis(1, 2, 3);
+    const float angle = 0.7f;
+
+    const Quat q = QuatFromAxisAngle(axis, angle);
+
+    // must be normalized and give the same rotation as the matrix
+    assert(FloatEqual(QuatLength(q), 1.0f));
+    assert(MatrixEqual(QuatToMatrix(q), MatrixRotationAxis(axis, angle)) == true);
+
+    // simple cases
+    assert(MatrixEqual(QuatToMatrix(QuatFromAxisAngle(Vec3(1, 0, 0), 0.3f)), MatrixRotationX(0.3f)) == true);
+    assert(MatrixEqual(QuatToMatrix(QuatFromAxisAngle(Vec3(0, 1, 0), 0.3f)), MatrixRotationY(0.3f)) == true);
+    assert(MatrixEqual(QuatToMatrix(QuatFromAxisAngle(Vec3(0, 0, 1), 0.3f)), MatrixRotationZ(0.3f)) == true);
+
+    LogMsg("%-50s test is passed", "QuatFromAxisAngle(axis, angle)");
+    LogMsg("%-50s test is passed", "QuatToMatrix(q, outMat)");
+}
+
+//---------------------------------------------------------
+
+void TestQuatFromMatrix()
+{
+    // check each branch of the conversion (big trace, big x, big y, big z)
+    const Quat quats[] =
+    {
+        QuatFromAxisAngle(Vec3(1, 2, 3), 0.5f),
+        QuatFromAxisAngle(Vec3(1, 0.1f, 0.1f), 3.0f),
+        QuatFromAxisAngle(Vec3(0.1f, 1, 0.1f), 3.0f),
+        QuatFromAxisAngle(Vec3(0.1f, 0.1f, 1), 3.0f),
+    };
+
+    for (const Quat& q : quats)
+    {
+        const Quat res = QuatFromMatrix(QuatToMatrix(q));
+        assert(QuatEqualRotation(res, q) == true);
+    }
+
+    LogMsg("%-50s test is passed", "QuatFromMatrix(mat)");
+}
+
+//---------------------------------------------------------
+
+void TestQuatMul()
+{
+    for (int i = 0; i < 16; ++i)
+    {
+        const Quat a = TestQuatRandom();
+        const Quat b = TestQuatRandom();
+
+        // "rotate by a, then by b" - the same order as for matrices
+        const Matrix expect = QuatToMatrix(a) * QuatToMatrix(b);
+
+        assert(MatrixEqual(QuatToMatrix(QuatMul(a, b)), expect) == true);
+        assert(MatrixEqual(QuatToMatrix(a * b), expect) == true);
+    }
+
+    // q * inverse(q) == identity
+    const Quat q(1, 2, 3, 4);
+    assert((q * QuatInverse(q)) == QuatIdentity());
+
+    // for a unit quaternion the inverse is the conjugate
+    const Quat u = TestQuatRandom();
+    assert(QuatInverse(u) == QuatConjugate(u));
+
+    LogMsg("%-50s test is passed", "QuatMul(a, b)");
+    LogMsg("%-50s test is passed", "QuatInverse(q)");
+}
+
+//---------------------------------------------------------
+
+void TestQuatRotateVec3()
+{
+    for (int i = 0; i < 16; ++i)
+    {
+        const Quat q = TestQuatRandom();
+        const Vec3 v(RandF(-10, 10), RandF(-10, 10), RandF(-10, 10));
+
+        Vec3 res;
+        Vec3 expect;
+
+        QuatRotateVec3(v, q, res);
+        MatrixMulVec3(v, QuatToMatrix(q), expect);
+
+        assert(FloatEqual(res.x, expect.x));
+        assert(FloatEqual(res.y, expect.y));
+        assert(FloatEqual(res.z, expect.z));
+    }
+
+    LogMsg("%-50s test is passed", "QuatRotateVec3(v, q, outVec)");
+}
+
+//---------------------------------------------------------
+
+void TestQuatToRollPitchYaw()
+{
+    const float roll  = 0.3f;
+    const float pitch = -0.5f;
+    const float yaw   = 1.1f;
+
+    // 3-2-1 sequence: rotate around x, then y, then z
+    const Quat q = QuatFromAxisAngle(Vec3(1, 0, 0), roll) *
+                   QuatFromAxisAngle(Vec3(0, 1, 0), pitch) *
+                   QuatFromAxisAngle(Vec3(0, 0, 1), yaw);
+
+    const Vec3 angles = QuatToRollPitchYaw(q);
+
+    assert(FloatEqual(angles.x, roll));
+    assert(FloatEqual(angles.y, pitch));
+    assert(FloatEqual(angles.z, yaw));
+
+    LogMsg("%-50s test is passed", "QuatToRollPitchYaw(q)");
+}
+
+//---------------------------------------------------------
+
+void TestQuatInterpolation()
+{
+    const Vec3 axis(1, -2, 3);
+    const Quat a = QuatFromAxisAngle(axis, 0.2f);
+    const Quat b = QuatFromAxisAngle(axis, 1.4f);
+
+    // slerp around the same axis gives a linear change of the angle
+    assert(QuatEqualRotation(QuatSlerp(a, b, 0.0f),  a));
+    assert(QuatEqualRotation(QuatSlerp(a, b, 1.0f),  b));
+    assert(QuatEqualRotation(QuatSlerp(a, b, 0.25f), QuatFromAxisAngle(axis, 0.5f)));
+
+    // nlerp in the middle gives the same result as slerp
+    assert(QuatEqualRotation(QuatNlerp(a, b, 0.5f), QuatFromAxisAngle(axis, 0.8f)));
+
+    // the shortest path: -b represents the same rotation as b
+    assert(QuatEqualRotation(QuatSlerp(a, -b, 0.25f), QuatFromAxisAngle(axis, 0.5f)));
+    assert(QuatEqualRotation(QuatNlerp(a, -b, 0.5f),  QuatFromAxisAngle(axis, 0.8f)));
+
+    LogMsg("%-50s test is passed", "QuatSlerp(a, b, t)");
+    LogMsg("%-50s test is passed", "QuatNlerp(a, b, t)");
+}
+
+//---------------------------------------------------------
+
+void TestQuatNlerpBatch()
+{
+    // odd count to test both the SIMD body and the tail
+    const size_t n = 23;
+    const float  t = 0.35f;
+
+    Quat a[n];
+    Quat b[n];
+    Quat out[n];
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        a[i] = TestQuatRandom();
+        b[i] = TestQuatRandom();
+    }
+
+    QuatNlerpBatch(a, b, t, out, n);
+
+    for (size_t i = 0; i < n; ++i)
+        assert(out[i] == QuatNlerp(a[i], b[i], t));
+
+    // in-place
+    QuatNlerpBatch(a, b, t, a, n);
+
+    for (size_t i = 0; i < n; ++i)
+        assert(a[i] == out[i]);
+
+    LogMsg("%-50s test is passed", "QuatNlerpBatch(a, b, t, out, n)");
+}
+
+
+//==================================================================================
+// main test
+//==================================================================================
+void TestQuat()
+{
+    SetConsoleColor(MAGENTA);
+
+    LogMsg("-----------------------------------------------");
+    LogMsg("Test Quat functional:");
+    LogMsg("-----------------------------------------------");
+
+    TestQuatFromAxisAngle();
+    TestQuatFromMatrix();
+    TestQuatMul();
+    TestQuatRotateVec3();
+    TestQuatToRollPitchYaw();
+    TestQuatInterpolation();
+    TestQuatNlerpBatch();
+
+    LogMsg("-----------------------------------------------");
+    LogMsg("all the Quat tests are passed!");
+    LogMsg("-----------------------------------------------\n");
+
+    SetConsoleColor(RESET);
+}
@@ -0,0 +1,247 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: tests_ray.h
+    Desc:     tests for the ray and ray-vs-rect slab tests
+
+    Created:  17.10.2026  by DimaSkup
+\**********************************************************************************/
+#pragma once
+#include <geometry/ray.h>
+#include <math/random.h>
+#include <log.h>
+#include <stdio.h>
+
+
+//==================================================================================
+// forward declaration of the main test
+//==================================================================================
+void TestRay();
+
+
+//==================================================================================
+// helpers
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:   a random ray, often axis-parallel (+0 or -0 components)
+//         and often starting exactly on a slab plane of the rect
+//---------------------------------------------------------
+inline Ray TestRay_GenerateRay(const Rect3d& rect)
+{
+    Vec3 origin(RandF(-2, 2), RandF(-2, 2), RandF(-2, 2));
+    Vec3 dir(RandF(-1, 1), RandF(-1, 1), RandF(-1, 1));
+
+    float* o = &origin.x;
+    float* d = &dir.x;
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const uint32_t type = RandUint(0, 6);
+
+        if (type == 0)
+            d[axis] = 0.0f;
+        else if (type == 1)
+            d[axis] = -0.0f;
+
+        if (RandUint(0, 4) == 0)
+            o[axis] = (&rect.x0)[2 * axis + RandUint(0, 2)];
+    }
+
+    // not all the components are zero
+    if (dir.x == 0 && dir.y == 0 && dir.z == 0)
+        dir.z = 1.0f;
+
+    return Ray(origin, dir, RandF(0, 1), RandF(1, 20));
+}
+
+//---------------------------------------------------------
+// Desc:   a reference slab test with explicit branches for axis-parallel
+//         rays: the origin must be within the slab (touching counts)
+//---------------------------------------------------------
+inline bool TestRay_IntersectRect3dRef(const Ray& ray, const Rect3d& rect, float& tNear)
+{
+    float tEnter = ray.tMin;
+    float tExit  = ray.tMax;
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const float o      = (&ray.origin.x)[axis];
+        const float d      = (&ray.dir.x)[axis];
+        const float invDir = (&ray.invDir.x)[axis];
+        const float slab0  = (&rect.x0)[2 * axis];
+        const float slab1  = (&rect.x0)[2 * axis + 1];
+
+        if (d == 0.0f)
+        {
+            if (o < slab0 || o > slab1)
+                return false;
+
+            continue;
+        }
+
+        float t0 = (slab0 - o) * invDir;
+        float t1 = (slab1 - o) * invDir;
+
+        if (t0 > t1)
+        {
+            const float tmp = t0;
+            t0 = t1;
+            t1 = tmp;
+        }
+
+        tEnter = (t0 > tEnter) ? t0 : tEnter;
+        tExit  = (t1 < tExit)  ? t1 : tExit;
+    }
+
+    tNear = tEnter;
+    return tEnter <= tExit;
+}
+
+
+//==================================================================================
+// test functions
+//==================================================================================
+void TestRayIntersectRect3d()
+{
+    const Rect3d rect(0, 1, 0, 1, 0, 1);
+    float        tNear = 0;
+
+    // a ray along z through the rect, the rect is behind, or beyond tMax
+    assert( RayIntersectRect3d(Ray(Vec3(0.5f, 0.5f, -1), Vec3(0, 0, 1)), rect, tNear) && tNear == 1.0f);
+    assert(!RayIntersectRect3d(Ray(Vec3(0.5f, 0.5f, -1), Vec3(0, 0, -1)), rect, tNear));
+    assert(!RayIntersectRect3d(Ray(Vec3(0.5f, 0.5f, -1), Vec3(0, 0, 1), 0.0f, 0.5f), rect, tNear));
+
+    // the ray starts inside: tNear is tMin
+    assert( RayIntersectRect3d(Ray(Vec3(0.5f, 0.5f, 0.5f), Vec3(1, 2, 3), 0.1f), rect, tNear) && tNear == 0.1f);
+
+    // parallel to the x and y slabs, outside of one of them
+    assert(!RayIntersectRect3d(Ray(Vec3(2, 0.5f, -1),  Vec3(0, 0, 1)), rect, tNear));
+    assert(!RayIntersectRect3d(Ray(Vec3(0.5f, -2, -1), Vec3(-0.0f, 0, 1)), rect, tNear));
+
+    // origins exactly on slab planes (0 * inf is NaN): touching counts
+    const float planes[] = { 0.0f, 1.0f };
+    const float zeros[]  = { 0.0f, -0.0f };
+
+    for (const float x : planes)
+    {
+        for (const float zero : zeros)
+        {
+            assert(RayIntersectRect3d(Ray(Vec3(x, 0.5f, -1), Vec3(zero, zero, 1)), rect, tNear) && tNear == 1.0f);
+            assert(RayIntersectRect3d(Ray(Vec3(x, x, 3), Vec3(zero, zero, -2)), rect, tNear) && tNear == 1.0f);
+            assert(RayIntersectRect3d(Ray(Vec3(x, 0.5f, 0.5f), Vec3(zero, 1, zero)), rect, tNear) && tNear == 0.0f);
+        }
+    }
+
+    // a flat rect and a ray in its plane
+    assert(RayIntersectRect3d(Ray(Vec3(-1, 0.5f, 0.5f), Vec3(1, 0, 0)), Rect3d(0, 1, 0.5f, 0.5f, 0, 1), tNear) && tNear == 1.0f);
+
+    // the same as the reference test for usual, axis-parallel
+    // and starting on slab planes rays
+    int numHits = 0;
+
+    for (int i = 0; i < 10000; ++i)
+    {
+        const float  x = RandF(-3, 3), y = RandF(-3, 3), z = RandF(-3, 3);
+        const Rect3d box(x, x + RandF(0, 2), y, y + RandF(0, 2), z, z + RandF(0, 2));
+        const Ray    ray = TestRay_GenerateRay(box);
+
+        float      tNearRef = 0;
+        const bool isHitRef = TestRay_IntersectRect3dRef(ray, box, tNearRef);
+
+        assert(RayIntersectRect3d(ray, box, tNear) == isHitRef);
+        assert(!isHitRef || tNear == tNearRef);
+        numHits += isHitRef;
+    }
+
+    // both hits and misses were tested
+    assert(numHits > 200 && numHits < 9800);
+
+    LogMsg("%-50s test is passed", "RayIntersectRect3d()");
+}
+
+//---------------------------------------------------------
+
+void TestRayIntersectRect3dBatch()
+{
+    alignas(32) float tNear[8];
+    Rect3dx8          rects;
+    Ray               rays[8];
+    int               numHits = 0;
+
+    for (int test = 0; test < 2000; ++test)
+    {
+        // a single ray vs 8 rects
+        Rect3d boxes[8];
+
+        for (int i = 0; i < 8; ++i)
+        {
+            const float x = RandF(-3, 3), y = RandF(-3, 3), z = RandF(-3, 3);
+            boxes[i] = Rect3d(x, x + RandF(0, 2), y, y + RandF(0, 2), z, z + RandF(0, 2));
+            rects.Set(i, boxes[i]);
+        }
+
+        const Ray ray  = TestRay_GenerateRay(boxes[RandUint(0, 8)]);
+        const int mask = RayIntersectRect3dx8(ray, rects, tNear);
+
+        for (int i = 0; i < 8; ++i)
+        {
+            float      t     = 0;
+            const bool isHit = RayIntersectRect3d(ray, boxes[i], t);
+
+            assert(isHit == ((mask >> i) & 1));
+            assert(!isHit || t == tNear[i]);
+            numHits += isHit;
+        }
+
+        // 8 rays vs a single rect
+        for (int i = 0; i < 8; ++i)
+            rays[i] = TestRay_GenerateRay(boxes[0]);
+
+        const int raysMask = Rayx8IntersectRect3d(rays, boxes[0], tNear);
+
+        for (int i = 0; i < 8; ++i)
+        {
+            float      t     = 0;
+            const bool isHit = RayIntersectRect3d(rays[i], boxes[0], t);
+
+            assert(isHit == ((raysMask >> i) & 1));
+            assert(!isHit || t == tNear[i]);
+            numHits += isHit;
+        }
+    }
+
+    // both hits and misses were tested
+    assert(numHits > 500 && numHits < 2000 * 16 - 500);
+
+    LogMsg("%-50s test is passed", "RayIntersectRect3dx8/Rayx8IntersectRect3d()");
+}
+
+
+//==================================================================================
+// main test
+//==================================================================================
+void TestRay()
+{
+    SetConsoleColor(CYAN);
+
+    LogMsg("-----------------------------------------------");
+    LogMsg("Test ray functional:");
+    LogMsg("-----------------------------------------------");
+
+    TestRayIntersectRect3d();
+    TestRayIntersectRect3dBatch();
+
+    LogMsg("-----------------------------------------------");
+    LogMsg("all the ray tests are passed!");
+    LogMsg("-----------------------------------------------\n");
+
+    SetConsoleColor(RESET);
+}
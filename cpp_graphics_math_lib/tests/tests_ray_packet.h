@@ -0,0 +1,312 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: tests_ray_packet.h
+    Desc:     tests for packets of rays
+
+    Created:  17.10.2026  by DimaSkup
+\**********************************************************************************/
+#pragma once
+#include <geometry/ray_packet.h>
+#include <geometry/bvh.h>
+#include <geometry/sphere_functions.h>
+#include <geometry/plane_3d_functions.h>
+#include <tests/tests_bvh.h>
+#include <math/random.h>
+#include <log.h>
+#include <stdio.h>
+#include <algorithm>
+#include <vector>
+
+
+//==================================================================================
+// forward declaration of the main test
+//==================================================================================
+void TestRayPacket();
+
+
+//==================================================================================
+// helpers
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:   N coherent rays: a shared origin and close directions around
+//         the target (some of them are axis-parallel)
+//---------------------------------------------------------
+template <int N>
+inline void TestRayPacket_Generate(RayPacket<N>& packet, Ray* rays, const Vec3& target, const float spread)
+{
+    const Vec3 origin(RandF(-5, 5), RandF(-5, 5), RandF(-5, 5));
+    const Vec3 dir = target - origin;
+
+    for (int i = 0; i < N; ++i)
+    {
+        Vec3 d = dir + Vec3(RandF(-spread, spread), RandF(-spread, spread), RandF(-spread, spread));
+
+        if (RandUint(0, 8) == 0)
+            d.x = 0.0f;
+
+        rays[i] = Ray(origin, d, RandF(0, 0.5f), RandF(0.5f, 2));
+    }
+
+    packet.SetRays(rays, N);
+}
+
+//---------------------------------------------------------
+// Desc:   results of a packet test and a scalar test may differ only because
+//         of rounding (FMA), so a different result must be the same for
+//         slightly grown and shrunk volumes/intervals; slab tests of
+//         rects are exactly the same
+//---------------------------------------------------------
+inline bool TestRayPacket_IsBorderline(Ray, const Rect3d&, const bool)
+{
+    return false;
+}
+
+inline bool TestRayPacket_IsBorderline(Ray ray, const Sphere& sphere, const bool isPacketHit)
+{
+    const float eps = 1e-3f;
+    Sphere      grown(sphere.center, sphere.radius + eps);
+    Sphere      shrunk(sphere.center, Max(sphere.radius - eps, 0.0f));
+    float       t;
+
+    Ray wide   = ray;
+    Ray narrow = ray;
+
+    wide.tMin   -= eps;  wide.tMax   += eps;
+    narrow.tMin += eps;  narrow.tMax -= eps;
+
+    return isPacketHit ? RayIntersectSphere(wide, grown, t) : !RayIntersectSphere(narrow, shrunk, t);
+}
+
+inline bool TestRayPacket_IsBorderline(Ray ray, const Plane3d& plane, const bool isPacketHit)
+{
+    const float eps = 1e-3f;
+    float       t;
+
+    Ray wide   = ray;
+    Ray narrow = ray;
+
+    wide.tMin   -= eps;  wide.tMax   += eps;
+    narrow.tMin += eps;  narrow.tMax -= eps;
+
+    return isPacketHit ? RayIntersectPlane3d(wide, plane, t) : !RayIntersectPlane3d(narrow, plane, t);
+}
+
+//---------------------------------------------------------
+// Desc:   compare a packet test with scalar tests of its rays
+//---------------------------------------------------------
+template <int N, class TVolume, class TPacketTest, class TScalarTest>
+inline int TestRayPacket_Compare(
+    const RayPacket<N>& packet,
+    const Ray* rays,
+    const TVolume& volume,
+    const uint32_t activeMask,
+    TPacketTest packetTest,
+    TScalarTest scalarTest)
+{
+    alignas(32) float t[N];
+    const uint32_t    mask    = packetTest(packet, volume, activeMask, t);
+    int               numHits = 0;
+
+    assert((mask & ~activeMask) == 0);
+
+    for (int i = 0; i < N; ++i)
+    {
+        if (!(activeMask & (1u << i)))
+            continue;
+
+        float      tRef;
+        const bool isHit       = scalarTest(rays[i], volume, tRef);
+        const bool isPacketHit = (mask >> i) & 1;
+
+        if (isHit != isPacketHit)
+        {
+            assert(TestRayPacket_IsBorderline(rays[i], volume, isPacketHit));
+            continue;
+        }
+
+        if (isHit)
+            assert(fabsf(t[i] - tRef) <= 1e-3f * Max(1.0f, fabsf(tRef)));
+
+        numHits += isHit;
+    }
+
+    return numHits;
+}
+
+
+//==================================================================================
+// test functions
+//==================================================================================
+template <int N>
+void TestRayPacketIntersect()
+{
+    alignas(32) float t[N];
+    RayPacket<N>      packet;
+    Ray               rays[N];
+    int               numHits[3] = { 0, 0, 0 };
+
+    // unused lanes never hit anything
+    rays[0] = Ray(Vec3(0, 0, -5), Vec3(0, 0, 1));
+    assert(packet.SetRays(rays, 1) == 1);
+    assert(RayPacketIntersectRect3d(packet, Rect3d(-1, 1, -1, 1, -1, 1), RayPacket<N>::ALL_LANES, t) == 1);
+    assert(RayPacketIntersectSphere(packet, Sphere(0, 0, 0, 1), RayPacket<N>::ALL_LANES, t) == 1 && t[0] == 4.0f);
+    assert(RayPacketIntersectPlane3d(packet, Plane3d(Vec3(0, 0, 1), 0.0f), RayPacket<N>::ALL_LANES, t) == 1 && t[0] == 5.0f);
+
+    // the output doesn't have to be aligned
+    alignas(32) float unaligned[N + 1];
+    assert(RayPacketIntersectSphere(packet, Sphere(0, 0, 0, 1), RayPacket<N>::ALL_LANES, unaligned + 1) == 1 && unaligned[1] == 4.0f);
+
+    for (int test = 0; test < 3000; ++test)
+    {
+        const float  x = RandF(-3, 3), y = RandF(-3, 3), z = RandF(-3, 3);
+        const Rect3d rect(x, x + RandF(0, 4), y, y + RandF(0, 4), z, z + RandF(0, 4));
+        const Sphere sphere(x, y, z, RandF(0.1f, 3));
+
+        Plane3d plane(Vec3(RandF(-1, 1), RandF(-1, 1), RandF(-1, 1)), RandF(-3, 3));
+        plane.Normalize();
+
+        TestRayPacket_Generate(packet, rays, Vec3(x, y, z), (test & 1) ? 0.5f : 5.0f);
+
+        // random active lanes (sometimes whole halves are inactive)
+        uint32_t activeMask = RandUint(0, 1u << N);
+        if (test % 7 == 0)
+            activeMask &= 0xF0;
+
+        numHits[0] += TestRayPacket_Compare(packet, rays, rect, activeMask,
+            [](const RayPacket<N>& p, const Rect3d& v, const uint32_t m, float* out) { return RayPacketIntersectRect3d(p, v, m, out); },
+            [](const Ray& r, const Rect3d& v, float& out) { return RayIntersectRect3d(r, v, out); });
+
+        numHits[1] += TestRayPacket_Compare(packet, rays, sphere, activeMask,
+            [](const RayPacket<N>& p, const Sphere& v, const uint32_t m, float* out) { return RayPacketIntersectSphere(p, v, m, out); },
+            [](const Ray& r, const Sphere& v, float& out) { return RayIntersectSphere(r, v, out); });
+
+        numHits[2] += TestRayPacket_Compare(packet, rays, plane, activeMask,
+            [](const RayPacket<N>& p, const Plane3d& v, const uint32_t m, float* out) { return RayPacketIntersectPlane3d(p, v, m, out); },
+            [](const Ray& r, const Plane3d& v, float& out) { return RayIntersectPlane3d(r, v, out); });
+    }
+
+    // both hits and misses were tested
+    for (int i = 0; i < 3; ++i)
+        assert(numHits[i] > 500 && numHits[i] < 3000 * N / 2 - 500);
+
+    // closest hit: only closer intersections are accepted after ShrinkTMax()
+    for (int i = 0; i < N; ++i)
+        rays[i] = Ray(Vec3(0.1f * i, 0, -10), Vec3(0, 0, 1));
+
+    packet.SetRays(rays, N);
+
+    uint32_t mask = RayPacketIntersectSphere(packet, Sphere(0, 0, 0, 2), RayPacket<N>::ALL_LANES, t);
+    assert(mask == RayPacket<N>::ALL_LANES);
+    packet.ShrinkTMax(mask, t);
+
+    mask = RayPacketIntersectSphere(packet, Sphere(0, 0, 5, 2), RayPacket<N>::ALL_LANES, t);
+    assert(mask == 0);
+
+    mask = RayPacketIntersectSphere(packet, Sphere(0, 0, -5, 2), RayPacket<N>::ALL_LANES, t);
+    assert(mask == RayPacket<N>::ALL_LANES);
+
+    if (N == 4)
+        LogMsg("%-50s test is passed", "RayPacket4 vs Rect3d/Sphere/Plane3d");
+    else
+        LogMsg("%-50s test is passed", "RayPacket8 vs Rect3d/Sphere/Plane3d");
+}
+
+//---------------------------------------------------------
+
+template <int N>
+void TestRayPacketBvh()
+{
+    const uint32_t        n = 5000;
+    std::vector<Rect3d>   rects;
+    std::vector<uint32_t> found(n);
+    std::vector<uint32_t> masks(n);
+    std::vector<uint32_t> expect(n);
+    RayPacket<N>          packet;
+    Ray                   rays[N];
+    Bvh                   bvh;
+
+    TestBvh_GenerateRects(rects, n);
+    bvh.Build(rects.data(), n);
+
+    uint32_t totalFound = 0;
+
+    for (int test = 0; test < 50; ++test)
+    {
+        // rays from a point inside of the scene, in a narrow cone
+        const Vec3 origin(RandF(-100, 100), RandF(-100, 100), RandF(-20, 120));
+        const Vec3 dir(RandF(-1, 1), RandF(-1, 1), RandF(-1, 1));
+
+        for (int i = 0; i < N; ++i)
+            rays[i] = Ray(origin, dir + Vec3(RandF(-0.1f, 0.1f), RandF(-0.1f, 0.1f), RandF(-0.1f, 0.1f)), 0.0f, 100.0f);
+
+        packet.SetRays(rays, N);
+
+        const uint32_t activeMask = (test % 5 == 0) ? 0x5u : RayPacket<N>::ALL_LANES;
+        const uint32_t numFound   = bvh.QueryRayPacket(packet, activeMask, found.data(), masks.data(), n);
+
+        // brute force: a mask of rays for each rect
+        std::fill(expect.begin(), expect.end(), 0);
+
+        for (uint32_t r = 0; r < n; ++r)
+        {
+            for (int i = 0; i < N; ++i)
+            {
+                float tNear;
+
+                if ((activeMask & (1u << i)) && RayIntersectRect3d(rays[i], rects[r], tNear))
+                    expect[r] |= (1u << i);
+            }
+        }
+
+        const uint32_t numExpected = (uint32_t)(n - std::count(expect.begin(), expect.end(), 0u));
+        assert(numFound == numExpected);
+
+        for (uint32_t i = 0; i < numFound; ++i)
+            assert(masks[i] == expect[found[i]]);
+
+        totalFound += numFound;
+    }
+
+    assert(totalFound > 0);
+
+    // inactive packet
+    assert(bvh.QueryRayPacket(packet, 0, found.data(), masks.data(), n) == 0);
+
+    if (N == 4)
+        LogMsg("%-50s test is passed", "Bvh::QueryRayPacket<4>()");
+    else
+        LogMsg("%-50s test is passed", "Bvh::QueryRayPacket<8>()");
+}
+
+
+//==================================================================================
+// main test
+//==================================================================================
+void TestRayPacket()
+{
+    SetConsoleColor(YELLOW);
+
+    LogMsg("-----------------------------------------------");
+    LogMsg("Test ray packet functional:");
+    LogMsg("-----------------------------------------------");
+
+    TestRayPacketIntersect<4>();
+    TestRayPacketIntersect<8>();
+    TestRayPacketBvh<4>();
+    TestRayPacketBvh<8>();
+
+    LogMsg("-----------------------------------------------");
+    LogMsg("all the ray packet tests are passed!");
+    LogMsg("-----------------------------------------------\n");
+
+    SetConsoleColor(RESET);
+}
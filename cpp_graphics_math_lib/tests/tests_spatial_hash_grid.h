@@ -0,0 +1,242 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: tests_spatial_hash_grid.h
+    Desc:     tests for the spatial hash grid
+
+    Created:  17.10.2026  by DimaSkup
+\**********************************************************************************/
+#pragma once
+#include <geometry/spatial_hash_grid.h>
+#include <tests/tests_bvh.h>
+#include <math/random.h>
+#include <log.h>
+#include <stdio.h>
+#include <algorithm>
+#include <vector>
+
+
+//==================================================================================
+// forward declaration of the main test
+//==================================================================================
+void TestSpatialHashGrid();
+
+
+//==================================================================================
+// test functions
+//==================================================================================
+void TestSpatialHashGridBuild()
+{
+    const uint32_t      n = 10000;
+    std::vector<Sphere> spheres(n);
+    SpatialHashGrid     grid(2.0f);
+
+    // empty grid
+    grid.Build((const Sphere*)nullptr, 0);
+    assert(grid.GetNumItems() == 0);
+    assert(grid.QueryRadius(Vec3(0, 0, 0), 10.0f, nullptr, 0) == 0);
+
+    for (Sphere& sphere : spheres)
+        sphere = Sphere(RandF(-100, 100), RandF(-100, 100), RandF(-100, 100), RandF(0, 1.5f));
+
+    grid.Build(spheres.data(), n);
+    assert(grid.GetNumItems() == n);
+    assert(grid.cellStart.size() >= 2 * n);
+
+    // buckets are contiguous ranges which cover all the items,
+    // each item is in the bucket of its cell
+    uint32_t         next = 0;
+    std::vector<int> refs(n, 0);
+
+    for (uint32_t h = 0; h < grid.cellStart.size(); ++h)
+    {
+        assert(grid.cellStart[h] == next);
+
+        for (uint32_t i = grid.cellStart[h]; i < grid.cellStart[h] + grid.cellCount[h]; ++i)
+        {
+            const Vec3& p = grid.positions[i];
+            assert(grid.Hash(grid.GetCellCoord(p.x), grid.GetCellCoord(p.y), grid.GetCellCoord(p.z)) == h);
+
+            const Sphere& sphere = spheres[grid.indices[i]];
+            assert(sphere.center == p && sphere.radius == grid.radii[i]);
+
+            refs[grid.indices[i]]++;
+        }
+
+        next += grid.cellCount[h];
+    }
+
+    assert(next == n);
+
+    for (const int count : refs)
+        assert(count == 1);
+
+    // a rebuild of the same size reuses the memory
+    const Vec3* positions = grid.positions.data();
+    const uint32_t* starts = grid.cellStart.data();
+
+    for (Sphere& sphere : spheres)
+        sphere.center = sphere.center + Vec3(RandF(-1, 1), RandF(-1, 1), RandF(-1, 1));
+
+    grid.Build(spheres.data(), n);
+    assert(grid.positions.data() == positions && grid.cellStart.data() == starts);
+
+    LogMsg("%-50s test is passed", "SpatialHashGrid::Build()");
+}
+
+//---------------------------------------------------------
+
+void TestSpatialHashGridQueries()
+{
+    const uint32_t        n = 5000;
+    std::vector<Vec3>     points(n);
+    std::vector<Sphere>   spheres(n);
+    std::vector<uint32_t> expect;
+    std::vector<uint32_t> found(n);
+    SpatialHashGrid       grid(3.0f);
+
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        points[i]  = Vec3(RandF(-50, 50), RandF(-50, 50), RandF(-50, 50));
+        spheres[i] = Sphere(points[i], RandF(0, 2));
+    }
+
+    // points within radius
+    grid.Build(points.data(), n);
+
+    const float radii[] = { 0.5f, 3.0f, 7.5f, 300.0f };
+
+    for (const float radius : radii)
+    {
+        for (int test = 0; test < 20; ++test)
+        {
+            const Vec3 p(RandF(-60, 60), RandF(-60, 60), RandF(-60, 60));
+
+            expect.clear();
+            for (uint32_t i = 0; i < n; ++i)
+                if (Vec3Dot(points[i] - p, points[i] - p) <= radius * radius)
+                    expect.push_back(i);
+
+            const uint32_t numFound = grid.QueryRadius(p, radius, found.data(), n);
+            assert(TestBvh_SameIndices(found.data(), numFound, expect));
+        }
+    }
+
+    // spheres which intersect the query sphere
+    grid.Build(spheres.data(), n);
+
+    for (int test = 0; test < 20; ++test)
+    {
+        const Vec3  p(RandF(-60, 60), RandF(-60, 60), RandF(-60, 60));
+        const float radius = RandF(0, 6);
+
+        expect.clear();
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            const float maxDist = radius + spheres[i].radius;
+
+            if (Vec3Dot(spheres[i].center - p, spheres[i].center - p) <= maxDist * maxDist)
+                expect.push_back(i);
+        }
+
+        const uint32_t numFound = grid.QueryRadius(p, radius, found.data(), n);
+        assert(TestBvh_SameIndices(found.data(), numFound, expect));
+    }
+
+    // the output buffer is too small
+    const uint32_t total = grid.QueryRadius(Vec3(0, 0, 0), 20.0f, found.data(), n);
+    found[5] = 0xFFFFFFFF;
+
+    assert(total > 5);
+    assert(grid.QueryRadius(Vec3(0, 0, 0), 20.0f, found.data(), 5) == total);
+    assert(found[5] == 0xFFFFFFFF);
+
+    LogMsg("%-50s test is passed", "SpatialHashGrid::QueryRadius()");
+}
+
+//---------------------------------------------------------
+
+void TestSpatialHashGridBatch()
+{
+    const uint32_t        n = 3000;
+    std::vector<Sphere>   spheres(n);
+    std::vector<uint32_t> starts(n);
+    std::vector<uint32_t> counts(n);
+    std::vector<uint32_t> found(n * 8);
+    std::vector<uint32_t> single(n);
+    SpatialHashGrid       grid(1.5f);
+
+    for (Sphere& sphere : spheres)
+        sphere = Sphere(RandF(-30, 30), RandF(-30, 30), RandF(-30, 30), 0.5f);
+
+    grid.Build(spheres.data(), n);
+
+    // neighbours of each item (queried in the grid order)
+    const float    radius = 1.0f;
+    const uint32_t total  = grid.QueryRadiusBatch(
+        grid.positions.data(), n, radius,
+        found.data(), (uint32_t)found.size(),
+        starts.data(), counts.data());
+
+    assert(total <= found.size());
+
+    uint32_t sum = 0;
+
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        assert(starts[i] == sum);
+
+        const uint32_t numSingle = grid.QueryRadius(grid.positions[i], radius, single.data(), n);
+        assert(counts[i] == numSingle);
+
+        // the item itself is always found
+        assert(counts[i] >= 1);
+        assert(std::equal(single.begin(), single.begin() + numSingle, found.begin() + starts[i]));
+
+        sum += counts[i];
+    }
+
+    assert(sum == total);
+
+    // the output buffer is too small: starts are clamped, counts are still full
+    const uint32_t maxCount = total / 2;
+    const uint32_t total2   = grid.QueryRadiusBatch(
+        grid.positions.data(), n, radius,
+        found.data(), maxCount,
+        starts.data(), counts.data());
+
+    assert(total2 == total);
+    assert(starts[n - 1] == maxCount);
+
+    LogMsg("%-50s test is passed", "SpatialHashGrid::QueryRadiusBatch()");
+}
+
+
+//==================================================================================
+// main test
+//==================================================================================
+void TestSpatialHashGrid()
+{
+    SetConsoleColor(CYAN);
+
+    LogMsg("-----------------------------------------------");
+    LogMsg("Test spatial hash grid functional:");
+    LogMsg("-----------------------------------------------");
+
+    TestSpatialHashGridBuild();
+    TestSpatialHashGridQueries();
+    TestSpatialHashGridBatch();
+
+    LogMsg("-----------------------------------------------");
+    LogMsg("all the spatial hash grid tests are passed!");
+    LogMsg("-----------------------------------------------\n");
+
+    SetConsoleColor(RESET);
+}
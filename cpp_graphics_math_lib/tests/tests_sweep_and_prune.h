@@ -0,0 +1,218 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: tests_sweep_and_prune.h
+    Desc:     tests for the sweep-and-prune broadphase
+
+    Created:  17.10.2026  by DimaSkup
+\**********************************************************************************/
+#pragma once
+#include <geometry/sweep_and_prune.h>
+#include <geometry/intersection_tests.h>
+#include <math/random.h>
+#include <log.h>
+#include <stdio.h>
+#include <algorithm>
+#include <vector>
+
+
+//==================================================================================
+// forward declaration of the main test
+//==================================================================================
+void TestSweepAndPrune();
+
+
+//==================================================================================
+// helpers
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:   compare found pairs with all the overlapping pairs (brute force)
+//---------------------------------------------------------
+inline bool TestSap_SamePairs(const SweepAndPrune& sap, const std::vector<Rect3d>& rects)
+{
+    std::vector<uint64_t> found;
+    std::vector<uint64_t> expect;
+
+    for (const SapPair& pair : sap.pairs)
+    {
+        if (pair.a >= pair.b)
+            return false;
+
+        found.push_back(((uint64_t)pair.a << 32) | pair.b);
+    }
+
+    for (uint32_t i = 0; i < (uint32_t)rects.size(); ++i)
+        for (uint32_t j = i + 1; j < (uint32_t)rects.size(); ++j)
+            if (OverlapRect3d(rects[i], rects[j]))
+                expect.push_back(((uint64_t)i << 32) | j);
+
+    std::sort(found.begin(), found.end());
+    return found == expect;
+}
+
+//---------------------------------------------------------
+
+inline bool TestSap_IsSorted(const SweepAndPrune& sap)
+{
+    for (int axis = 0; axis < sap.numSortedAxes; ++axis)
+    {
+        const std::vector<SapEndpoint>& endpoints = sap.endpoints[axis];
+
+        if (endpoints.size() != 2 * sap.bounds.size())
+            return false;
+
+        for (size_t i = 1; i < endpoints.size(); ++i)
+            if (endpoints[i] < endpoints[i - 1])
+                return false;
+    }
+
+    return true;
+}
+
+
+//==================================================================================
+// test functions
+//==================================================================================
+void TestSapOverlap()
+{
+    const Rect3d a(0, 1, 0, 1, 0, 1);
+
+    // touching boxes overlap, separated along any axis don't
+    assert( SapOverlap(a, Rect3d(1, 2, 0, 1, 0, 1)));
+    assert( SapOverlap(a, Rect3d(0.5f, 0.6f, 0.5f, 0.6f, 0.5f, 0.6f)));
+    assert(!SapOverlap(a, Rect3d(1.1f, 2, 0, 1, 0, 1)));
+    assert(!SapOverlap(a, Rect3d(0, 1, -2, -0.1f, 0, 1)));
+    assert(!SapOverlap(a, Rect3d(0, 1, 0, 1, 1.01f, 3)));
+
+    for (int i = 0; i < 10000; ++i)
+    {
+        const float  x = RandF(-3, 3), y = RandF(-3, 3), z = RandF(-3, 3);
+        const Rect3d b(x, x + RandF(0, 2), y, y + RandF(0, 2), z, z + RandF(0, 2));
+
+        assert(SapOverlap(a, b) == OverlapRect3d(a, b));
+        assert(SapOverlap(b, a) == OverlapRect3d(a, b));
+    }
+
+    LogMsg("%-50s test is passed", "SapOverlap()");
+}
+
+//---------------------------------------------------------
+
+void TestSweepAndPruneFrames(const int numSortedAxes)
+{
+    const uint32_t      n = 2000;
+    std::vector<Rect3d> rects(n);
+    std::vector<Vec3>   velocities(n);
+    SweepAndPrune       sap(numSortedAxes);
+
+    // empty
+    sap.Update(nullptr, 0);
+    assert(sap.FindPairs() == 0);
+
+    // objects are spread along z much more than along x and y
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        const float x = RandF(-20, 20);
+        const float y = RandF(-20, 20);
+        const float z = RandF(-500, 500);
+
+        rects[i]      = Rect3d(x, x + RandF(0.1f, 2), y, y + RandF(0.1f, 2), z, z + RandF(0.1f, 2));
+        velocities[i] = Vec3(RandF(-0.05f, 0.05f), RandF(-0.05f, 0.05f), RandF(-0.05f, 0.05f));
+    }
+
+    sap.Update(rects.data(), n);
+    assert(TestSap_IsSorted(sap));
+    assert(sap.sweepAxis == ((numSortedAxes == 3) ? 2 : 0));
+
+    sap.FindPairs();
+    assert(TestSap_SamePairs(sap, rects));
+
+    // a few frames of small motions: arrays are re-sorted by a few swaps,
+    // the pair buffer isn't reallocated
+    const size_t pairsCapacity = sap.pairs.capacity() + 64;
+    sap.pairs.reserve(pairsCapacity);
+    const SapPair* pairsData = sap.pairs.data();
+
+    for (int frame = 0; frame < 10; ++frame)
+    {
+        for (uint32_t i = 0; i < n; ++i)
+            rects[i] += velocities[i];
+
+        sap.Update(rects.data(), n);
+        assert(TestSap_IsSorted(sap));
+
+        // a few swaps per endpoint (a random order would take ~n^2)
+        assert(sap.numSwaps < 4 * 2 * n * numSortedAxes);
+
+        sap.FindPairs();
+        assert(TestSap_SamePairs(sap, rects));
+        assert(sap.pairs.size() <= pairsCapacity && sap.pairs.data() == pairsData);
+    }
+
+    // a big jump is still sorted correctly (just slower)
+    for (Rect3d& rect : rects)
+        rect += Vec3(0, 0, RandF(-300, 300));
+
+    sap.Update(rects.data(), n);
+    assert(TestSap_IsSorted(sap));
+    sap.FindPairs();
+    assert(TestSap_SamePairs(sap, rects));
+
+    // the number of objects changed: rebuild
+    rects.resize(n / 2);
+    sap.Update(rects.data(), n / 2);
+    assert(TestSap_IsSorted(sap));
+    sap.FindPairs();
+    assert(TestSap_SamePairs(sap, rects));
+
+    // all the boxes touch each other
+    for (Rect3d& rect : rects)
+        rect = Rect3d(0, 1, 0, 1, 0, 1);
+
+    rects.resize(50);
+    sap.Update(rects.data(), 50);
+    assert(sap.FindPairs() == 50 * 49 / 2);
+
+    for (uint32_t i = 0; i < 50; ++i)
+        rects[i] = Rect3d((float)i, (float)i + 1, 0, 1, 0, 1);
+
+    sap.Update(rects.data(), 50);
+    assert(sap.FindPairs() == 49);
+    assert(TestSap_SamePairs(sap, rects));
+
+    if (numSortedAxes == 1)
+        LogMsg("%-50s test is passed", "SweepAndPrune (1 axis)");
+    else
+        LogMsg("%-50s test is passed", "SweepAndPrune (3 axes)");
+}
+
+
+//==================================================================================
+// main test
+//==================================================================================
+void TestSweepAndPrune()
+{
+    SetConsoleColor(MAGENTA);
+
+    LogMsg("-----------------------------------------------");
+    LogMsg("Test sweep-and-prune functional:");
+    LogMsg("-----------------------------------------------");
+
+    TestSapOverlap();
+    TestSweepAndPruneFrames(1);
+    TestSweepAndPruneFrames(3);
+
+    LogMsg("-----------------------------------------------");
+    LogMsg("all the sweep-and-prune tests are passed!");
+    LogMsg("-----------------------------------------------\n");
+
+    SetConsoleColor(RESET);
+}
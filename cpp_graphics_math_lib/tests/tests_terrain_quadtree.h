@@ -0,0 +1,263 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: tests_terrain_quadtree.h
+    Desc:     tests for the terrain LOD quadtree
+
+    Created:  17.10.2026  by DimaSkup
+\**********************************************************************************/
+#pragma once
+#include <geometry/terrain_quadtree.h>
+#include <geometry/intersection_tests.h>
+#include <tests/tests_frustum.h>
+#include <math/random.h>
+#include <log.h>
+#include <stdio.h>
+#include <vector>
+
+
+//==================================================================================
+// forward declaration of the main test
+//==================================================================================
+void TestTerrainQuadtree();
+
+
+//==================================================================================
+// helpers
+//==================================================================================
+inline void TestTerrain_GenerateHeights(std::vector<float>& heights, const uint32_t numSamples)
+{
+    heights.resize(numSamples * numSamples);
+
+    for (uint32_t z = 0; z < numSamples; ++z)
+    {
+        for (uint32_t x = 0; x < numSamples; ++x)
+        {
+            heights[z * numSamples + x] =
+                10.0f * sinf(0.05f * x) * cosf(0.07f * z) +
+                RandF(-0.5f, 0.5f);
+        }
+    }
+}
+
+//---------------------------------------------------------
+// Desc:   check bounds and errors of the subtree
+//---------------------------------------------------------
+inline bool TestTerrain_ValidateNode(const TerrainQuadtree& tree, const std::vector<float>& heights, const uint32_t nodeIdx)
+{
+    const TerrainQuadtreeNode& node   = tree.nodes[nodeIdx];
+    const uint32_t             extent = tree.chunkSize << (tree.numLevels - 1 - node.level);
+
+    // all the samples of the chunk are inside of its bounds
+    for (uint32_t z = node.sampleZ; z <= node.sampleZ + extent; ++z)
+    {
+        for (uint32_t x = node.sampleX; x <= node.sampleX + extent; ++x)
+        {
+            const Vec3 p(tree.origin.x + tree.spacing * x,
+                         tree.origin.y + heights[z * tree.numSamples + x],
+                         tree.origin.z + tree.spacing * z);
+
+            if (!node.bounds.PointInRect(p))
+                return false;
+        }
+    }
+
+    if (node.IsLeaf())
+        return (node.level == tree.numLevels - 1) && (node.geometricError == 0.0f);
+
+    for (uint32_t c = node.firstChild; c < node.firstChild + 4; ++c)
+    {
+        const TerrainQuadtreeNode& child = tree.nodes[c];
+
+        if (child.level != node.level + 1 || child.geometricError > node.geometricError)
+            return false;
+
+        if (!ContainsRect3d(node.bounds, child.bounds))
+            return false;
+
+        if (!TestTerrain_ValidateNode(tree, heights, c))
+            return false;
+    }
+
+    return true;
+}
+
+
+//==================================================================================
+// test functions
+//==================================================================================
+void TestTerrainQuadtreeBuild()
+{
+    const uint32_t     chunkSize  = 8;
+    const uint32_t     numSamples = chunkSize * 16 + 1;
+    std::vector<float> heights;
+    TerrainQuadtree    tree;
+
+    TestTerrain_GenerateHeights(heights, numSamples);
+    tree.Build(heights.data(), numSamples, chunkSize, Vec3(-64, 0, 10), 1.0f);
+
+    assert(tree.numLevels == 5);
+    assert(tree.nodes.size() == 1 + 4 + 16 + 64 + 256);
+    assert(TestTerrain_ValidateNode(tree, heights, 0));
+
+    // the root covers the whole terrain, the rough surface has some error
+    assert(tree.nodes[0].bounds.x0 == -64 && tree.nodes[0].bounds.x1 == 64);
+    assert(tree.nodes[0].bounds.z0 == 10  && tree.nodes[0].bounds.z1 == 138);
+    assert(tree.nodes[0].geometricError > 1.0f);
+
+    // a plane is represented exactly by any level
+    for (uint32_t z = 0; z < numSamples; ++z)
+        for (uint32_t x = 0; x < numSamples; ++x)
+            heights[z * numSamples + x] = 0.1f * x + 0.2f * z;
+
+    tree.Build(heights.data(), numSamples, chunkSize, Vec3(0, 0, 0), 2.0f);
+    assert(TestTerrain_ValidateNode(tree, heights, 0));
+
+    for (const TerrainQuadtreeNode& node : tree.nodes)
+        assert(node.geometricError < 1e-4f);
+
+    // a single chunk
+    tree.Build(heights.data(), chunkSize + 1, chunkSize, Vec3(0, 0, 0), 1.0f);
+    assert(tree.numLevels == 1 && tree.nodes.size() == 1 && tree.nodes[0].IsLeaf());
+
+    LogMsg("%-50s test is passed", "TerrainQuadtree::Build()");
+}
+
+//---------------------------------------------------------
+
+void TestTerrainQuadtreeSelectLod()
+{
+    const uint32_t        chunkSize  = 8;
+    const uint32_t        numSamples = chunkSize * 32 + 1;
+    std::vector<float>    heights;
+    std::vector<uint32_t> selected(4096);
+    TerrainQuadtree       tree;
+
+    // the camera is at the origin and looks along +z, the terrain is in front of it
+    TestTerrain_GenerateHeights(heights, numSamples);
+    tree.Build(heights.data(), numSamples, chunkSize, Vec3(-128, -20, 1), 1.0f);
+
+    const Matrix proj      = MatrixProjectionLH(1.30796f, 1600.0f / 900.0f, 0.1f, 1000.0f);
+    const float  sseFactor = TerrainSseFactor(proj, 900.0f);
+    const Vec3   cameraPos(0, 0, 0);
+
+    assert(fabsf(sseFactor - 450.0f / tanf(0.5f * 1.30796f)) < 1e-2f);
+
+    Frustum frustum;
+    frustum.CreateFromProjMatrix(proj, true);
+
+    // parents of nodes
+    std::vector<uint32_t> parents(tree.nodes.size(), 0);
+
+    for (uint32_t i = 0; i < tree.nodes.size(); ++i)
+        if (!tree.nodes[i].IsLeaf())
+            for (uint32_t c = 0; c < 4; ++c)
+                parents[tree.nodes[i].firstChild + c] = i;
+
+    const float maxErrors[] = { 0.0f, 1.0f, 4.0f, 1e9f };
+    uint32_t    numSelected[4];
+
+    for (int e = 0; e < 4; ++e)
+    {
+        const float    maxError = maxErrors[e];
+        const uint32_t count    = tree.SelectLod(frustum, cameraPos, sseFactor, maxError, selected.data(), (uint32_t)selected.size());
+
+        assert(count > 0 && count <= selected.size());
+        numSelected[e] = count;
+
+        std::vector<int> covered(tree.nodes.size(), 0);
+
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const TerrainQuadtreeNode& node = tree.nodes[selected[i]];
+            const float dist = sqrtf(TerrainSqrDistToRect(cameraPos, node.bounds));
+
+            // the node is visible and detailed enough (or it is a leaf),
+            // but its parent isn't detailed enough
+            assert(frustum.TestRect(node.bounds));
+            assert(node.IsLeaf() || node.geometricError * sseFactor <= maxError * dist * 1.001f);
+
+            if (selected[i] != 0)
+            {
+                const TerrainQuadtreeNode& parent = tree.nodes[parents[selected[i]]];
+                const float parentDist = sqrtf(TerrainSqrDistToRect(cameraPos, parent.bounds));
+
+                assert(parent.geometricError * sseFactor >= maxError * parentDist * 0.999f);
+            }
+
+            // mark leaves under the node
+            std::vector<uint32_t> stack(1, selected[i]);
+
+            while (!stack.empty())
+            {
+                const uint32_t idx = stack.back();
+                stack.pop_back();
+
+                if (tree.nodes[idx].IsLeaf())
+                    covered[idx]++;
+                else
+                    for (uint32_t c = 0; c < 4; ++c)
+                        stack.push_back(tree.nodes[idx].firstChild + c);
+            }
+        }
+
+        // selected chunks don't overlap, and each visible leaf is covered
+        for (uint32_t i = 0; i < tree.nodes.size(); ++i)
+        {
+            if (!tree.nodes[i].IsLeaf())
+                continue;
+
+            assert(covered[i] <= 1);
+
+            bool onBorder = false;
+            const int type = TestFrustum_ClassifyRect(frustum, tree.nodes[i].bounds, onBorder);
+
+            if (!onBorder && type != Frustum::CULL_OUTSIDE)
+                assert(covered[i] == 1);
+        }
+    }
+
+    // a bigger allowed error gives fewer chunks; a huge one selects the root only
+    assert(numSelected[0] >= numSelected[1] && numSelected[1] >= numSelected[2]);
+    assert(numSelected[1] > numSelected[3]);
+    assert(numSelected[3] == 1);
+
+    // the output buffer is too small
+    const uint32_t total = tree.SelectLod(frustum, cameraPos, sseFactor, 0.0f, selected.data(), 3);
+    assert(total == numSelected[0]);
+
+    // the terrain is behind the camera
+    tree.Build(heights.data(), numSamples, chunkSize, Vec3(-128, -20, -300), 1.0f);
+    assert(tree.SelectLod(frustum, cameraPos, sseFactor, 1.0f, selected.data(), (uint32_t)selected.size()) == 0);
+
+    LogMsg("%-50s test is passed", "TerrainQuadtree::SelectLod()");
+}
+
+
+//==================================================================================
+// main test
+//==================================================================================
+void TestTerrainQuadtree()
+{
+    SetConsoleColor(YELLOW);
+
+    LogMsg("-----------------------------------------------");
+    LogMsg("Test terrain quadtree functional:");
+    LogMsg("-----------------------------------------------");
+
+    TestTerrainQuadtreeBuild();
+    TestTerrainQuadtreeSelectLod();
+
+    LogMsg("-----------------------------------------------");
+    LogMsg("all the terrain quadtree tests are passed!");
+    LogMsg("-----------------------------------------------\n");
+
+    SetConsoleColor(RESET);
+}
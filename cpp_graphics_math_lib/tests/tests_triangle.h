@@ -0,0 +1,374 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: tests_triangle.h
+    Desc:     tests for triangles and ray-triangle intersections
+
+    Created:  17.10.2026  by DimaSkup
+\**********************************************************************************/
+#pragma once
+#include <geometry/triangle.h>
+#include <geometry/plane_3d_functions.h>
+#include <math/random.h>
+#include <log.h>
+#include <stdio.h>
+#include <vector>
+
+
+//==================================================================================
+// forward declaration of the main test
+//==================================================================================
+void TestTriangle();
+
+
+//==================================================================================
+// helpers
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:   a random triangle around the point
+//---------------------------------------------------------
+inline Triangle TestTriangle_Generate(const Vec3& center, const float size)
+{
+    return Triangle(
+        center + Vec3(RandF(-size, size), RandF(-size, size), RandF(-size, size)),
+        center + Vec3(RandF(-size, size), RandF(-size, size), RandF(-size, size)),
+        center + Vec3(RandF(-size, size), RandF(-size, size), RandF(-size, size)));
+}
+
+//---------------------------------------------------------
+// Desc:   a ray through a random point of the triangle (sometimes a bit
+//         outside of it) from a random origin
+//---------------------------------------------------------
+inline Ray TestTriangle_GenerateRay(const Triangle& tri)
+{
+    const float u = RandF(-0.2f, 1.0f);
+    const float v = RandF(-0.2f, 1.0f - u);
+
+    const Vec3 origin(RandF(-5, 5), RandF(-5, 5), RandF(-5, 5));
+    return Ray(origin, tri.GetPoint(u, v) - origin, RandF(0, 0.5f), RandF(0.5f, 2));
+}
+
+//---------------------------------------------------------
+// Desc:   results of different tests may differ only because of rounding,
+//         so a different result must be the same for a slightly shrunk and
+//         grown triangle and interval
+//---------------------------------------------------------
+inline bool TestTriangle_IsHitWithMargin(const Ray& ray, const Triangle& tri, const float eps)
+{
+    const Vec3  e1  = tri.v1 - tri.v0;
+    const Vec3  e2  = tri.v2 - tri.v0;
+    const Vec3  p   = Vec3Cross(ray.dir, e2);
+    const float det = Vec3Dot(e1, p);
+
+    const Vec3  s = ray.origin - tri.v0;
+    const Vec3  q = Vec3Cross(s, e1);
+    const float u = Vec3Dot(s, p) / det;
+    const float v = Vec3Dot(ray.dir, q) / det;
+    const float t = Vec3Dot(e2, q) / det;
+
+    return (u >= eps) && (v >= eps) && (u + v <= 1.0f - eps) &&
+           (t >= ray.tMin + eps) && (t <= ray.tMax - eps);
+}
+
+inline bool TestTriangle_IsBorderline(const Ray& ray, const Triangle& tri)
+{
+    const float eps = 1e-3f;
+    return !TestTriangle_IsHitWithMargin(ray, tri, eps) && TestTriangle_IsHitWithMargin(ray, tri, -eps);
+}
+
+
+//==================================================================================
+// test functions
+//==================================================================================
+void TestTriangleBasics()
+{
+    const Triangle tri(Vec3(0, 0, 0), Vec3(1, 0, 2), Vec3(0, 3, 0));
+
+    // bounds, normal, and a point by barycentrics
+    const Rect3d bounds = tri.GetBounds();
+    assert(bounds.x0 == 0 && bounds.x1 == 1 && bounds.y0 == 0 && bounds.y1 == 3 && bounds.z0 == 0 && bounds.z1 == 2);
+
+    const Vec3 n = tri.GetNormal();
+    assert(n.x == -6 && n.y == 0 && n.z == 3);
+    assert(Vec3Dot(n, tri.v1 - tri.v0) == 0 && Vec3Dot(n, tri.v2 - tri.v0) == 0);
+
+    // the same winding as for a plane by 3 points
+    const Plane3d plane(tri.v0, tri.v1, tri.v2);
+    assert(Vec3Dot(plane.normal, n) > 0);
+
+    const Vec3 p = tri.GetPoint(0.5f, 0.25f);
+    assert(p.x == 0.5f && p.y == 0.75f && p.z == 1.0f);
+
+    // a block keeps triangles
+    Trianglex8 block;
+    block.Set(5, tri);
+
+    const Triangle copy = block.Get(5);
+    assert(copy.v0.x == 0 && copy.v0.y == 0 && copy.v0.z == 0);
+    assert(copy.v1.x == 1 && copy.v1.y == 0 && copy.v1.z == 2);
+    assert(copy.v2.x == 0 && copy.v2.y == 3 && copy.v2.z == 0);
+
+    LogMsg("%-50s test is passed", "Triangle basics");
+}
+
+//---------------------------------------------------------
+
+void TestRayIntersectTriangle()
+{
+    const Triangle tri(Vec3(0, 0, 0), Vec3(2, 0, 0), Vec3(0, 2, 0));
+    float          t, u, v;
+
+    // both sides, behind, beyond tMax, parallel
+    assert(RayIntersectTriangle(Ray(Vec3(0.5f, 0.5f, -1), Vec3(0, 0, 1)), tri, t, u, v));
+    assert(t == 1.0f && u == 0.25f && v == 0.25f);
+
+    assert(RayIntersectTriangle(Ray(Vec3(1, 0.5f, 4), Vec3(0, 0, -2)), tri, t, u, v));
+    assert(t == 2.0f && u == 0.5f && v == 0.25f);
+
+    assert(!RayIntersectTriangle(Ray(Vec3(0.5f, 0.5f, -1), Vec3(0, 0, -1)), tri, t, u, v));
+    assert(!RayIntersectTriangle(Ray(Vec3(0.5f, 0.5f, -1), Vec3(0, 0, 1), 0.0f, 0.5f), tri, t, u, v));
+    assert(!RayIntersectTriangle(Ray(Vec3(0.5f, 0.5f, 0), Vec3(1, 0, 0)), tri, t, u, v));
+    assert(!RayIntersectTriangle(Ray(Vec3(1.5f, 1.5f, -1), Vec3(0, 0, 1)), tri, t, u, v));
+
+    // the same for the watertight test
+    assert(RayIntersectTriangleWatertight(Ray(Vec3(0.5f, 0.5f, -1), Vec3(0, 0, 1)), tri, t, u, v));
+    assert(t == 1.0f && u == 0.25f && v == 0.25f);
+
+    assert(RayIntersectTriangleWatertight(Ray(Vec3(1, 0.5f, 4), Vec3(0, 0, -2)), tri, t, u, v));
+    assert(t == 2.0f && u == 0.5f && v == 0.25f);
+
+    assert(!RayIntersectTriangleWatertight(Ray(Vec3(0.5f, 0.5f, -1), Vec3(0, 0, -1)), tri, t, u, v));
+    assert(!RayIntersectTriangleWatertight(Ray(Vec3(0.5f, 0.5f, -1), Vec3(0, 0, 1), 0.0f, 0.5f), tri, t, u, v));
+    assert(!RayIntersectTriangleWatertight(Ray(Vec3(0.5f, 0.5f, 0), Vec3(1, 0, 0)), tri, t, u, v));
+    assert(!RayIntersectTriangleWatertight(Ray(Vec3(1.5f, 1.5f, -1), Vec3(0, 0, 1)), tri, t, u, v));
+
+    // random rays: both tests agree, barycentrics give the hit point
+    int numHits = 0;
+
+    for (int test = 0; test < 10000; ++test)
+    {
+        const Triangle rnd = TestTriangle_Generate(Vec3(0, 0, 0), 2.0f);
+        const Ray      ray = TestTriangle_GenerateRay(rnd);
+        float          tw, uw, vw;
+
+        const bool isHit   = RayIntersectTriangle(ray, rnd, t, u, v);
+        const bool isHitWt = RayIntersectTriangleWatertight(ray, rnd, tw, uw, vw);
+
+        if (isHit != isHitWt)
+        {
+            assert(TestTriangle_IsBorderline(ray, rnd));
+            continue;
+        }
+
+        if (!isHit)
+            continue;
+
+        const Vec3 p0 = ray.GetPoint(t);
+        const Vec3 p1 = rnd.GetPoint(u, v);
+
+        assert(fabsf(p0.x - p1.x) < 1e-3f && fabsf(p0.y - p1.y) < 1e-3f && fabsf(p0.z - p1.z) < 1e-3f);
+        assert(fabsf(t - tw) < 1e-3f && fabsf(u - uw) < 1e-3f && fabsf(v - vw) < 1e-3f);
+
+        ++numHits;
+    }
+
+    // both hits and misses were tested
+    assert(numHits > 1000 && numHits < 9000);
+
+    LogMsg("%-50s test is passed", "RayIntersectTriangle/Watertight()");
+}
+
+//---------------------------------------------------------
+
+void TestRayIntersectTrianglex8()
+{
+    Trianglex8  block;
+    Triangle    tris[8];
+    TriangleHit hit;
+    int         numHits = 0;
+
+    // an empty block is never hit
+    block.SetTriangles(tris, 0);
+    assert(RayIntersectTrianglex8(Ray(Vec3(0, 0, -1), Vec3(0, 0, 1)), block, hit) == -1);
+    assert(hit.index == -1);
+
+    // the nearest of overlapped triangles (and only closer after tMax is shrunk)
+    for (int i = 0; i < 8; ++i)
+    {
+        const float z = (float)((i * 5) % 8);
+        tris[i] = Triangle(Vec3(-1, -1, z), Vec3(3, -1, z), Vec3(-1, 3, z));
+    }
+
+    block.SetTriangles(tris, 8);
+
+    Ray ray(Vec3(0, 0, -1), Vec3(0, 0, 1), 0.0f, 100.0f);
+    assert(RayIntersectTrianglex8(ray, block, hit) == 0 && hit.t == 1.0f && hit.u == 0.25f && hit.v == 0.25f);
+
+    ray = Ray(Vec3(0, 0, 10), Vec3(0, 0, -1), 0.0f, 100.0f);
+    assert(RayIntersectTrianglex8(ray, block, hit) == 3 && hit.t == 3.0f);
+
+    ray.tMax = 2.0f;
+    assert(RayIntersectTrianglex8(ray, block, hit) == -1 && hit.index == 3);
+
+    // random blocks vs the nearest of scalar tests
+    for (int test = 0; test < 5000; ++test)
+    {
+        const int numTris = 1 + RandUint(0, 8);
+
+        for (int i = 0; i < numTris; ++i)
+            tris[i] = TestTriangle_Generate(Vec3(0, 0, 0), 2.0f);
+
+        block.SetTriangles(tris, numTris);
+
+        ray = TestTriangle_GenerateRay(tris[RandUint(0, numTris)]);
+        hit = TriangleHit();
+
+        const int index = RayIntersectTrianglex8(ray, block, hit);
+
+        int   nearest  = -1;
+        float nearestT = FLT_MAX;
+
+        for (int i = 0; i < numTris; ++i)
+        {
+            float t, u, v;
+
+            if (RayIntersectTriangle(ray, tris[i], t, u, v) && t < nearestT)
+            {
+                nearest  = i;
+                nearestT = t;
+            }
+        }
+
+        // results may differ only because of rounding (FMA)
+        if (index != nearest)
+        {
+            assert(index < 0 || TestTriangle_IsBorderline(ray, tris[index]) || fabsf(hit.t - nearestT) < 1e-3f);
+            assert(nearest < 0 || TestTriangle_IsBorderline(ray, tris[nearest]) || fabsf(hit.t - nearestT) < 1e-3f);
+            continue;
+        }
+
+        if (index < 0)
+            continue;
+
+        float t, u, v;
+        RayIntersectTriangle(ray, tris[index], t, u, v);
+
+        assert(hit.index == index);
+        assert(fabsf(hit.t - t) < 1e-3f && fabsf(hit.u - u) < 1e-3f && fabsf(hit.v - v) < 1e-3f);
+
+        ++numHits;
+    }
+
+    // both hits and misses were tested
+    assert(numHits > 500 && numHits < 4900);
+
+    LogMsg("%-50s test is passed", "RayIntersectTrianglex8()");
+}
+
+//---------------------------------------------------------
+
+void TestRayIntersectTriangleWatertightMesh()
+{
+    // a distorted grid of cells, each cell is split into two triangles
+    const int             size = 16;
+    std::vector<Vec3>     verts((size + 1) * (size + 1));
+    std::vector<Triangle> tris;
+
+    for (int y = 0; y <= size; ++y)
+    {
+        for (int x = 0; x <= size; ++x)
+        {
+            verts[y * (size + 1) + x] = Vec3(
+                x + RandF(-0.3f, 0.3f),
+                y + RandF(-0.3f, 0.3f),
+                RandF(-0.2f, 0.2f));
+        }
+    }
+
+    for (int y = 0; y < size; ++y)
+    {
+        for (int x = 0; x < size; ++x)
+        {
+            const Vec3& v00 = verts[(y + 0) * (size + 1) + x + 0];
+            const Vec3& v10 = verts[(y + 0) * (size + 1) + x + 1];
+            const Vec3& v01 = verts[(y + 1) * (size + 1) + x + 0];
+            const Vec3& v11 = verts[(y + 1) * (size + 1) + x + 1];
+
+            tris.push_back(Triangle(v00, v10, v11));
+            tris.push_back(Triangle(v00, v11, v01));
+        }
+    }
+
+    // rays through inner vertices and points of shared edges never slip
+    // between triangles
+    TriangleHit hit;
+    int         numLeaksMT = 0;
+
+    for (int test = 0; test < 20000; ++test)
+    {
+        const int x = 1 + RandUint(0, size - 1);
+        const int y = 1 + RandUint(0, size - 1);
+
+        const Vec3& a = verts[y * (size + 1) + x];
+        const Vec3& b = (test & 1) ? verts[(y + 1) * (size + 1) + x + 1] : verts[y * (size + 1) + x - 1];
+
+        const uint32_t type   = RandUint(0, 3);
+        const Vec3     target = (type == 0) ? a : a + (b - a) * ((type == 1) ? 0.5f : RandF(0, 1));
+
+        const Vec3 dir(RandF(-0.1f, 0.1f), RandF(-0.1f, 0.1f), -1.0f);
+        const Ray  ray(target - dir * 10.0f, dir);
+
+        assert(RayIntersectTrianglesWatertight(ray, tris.data(), (int)tris.size(), hit) >= 0);
+        assert(fabsf(hit.t - 10.0f) < 1.0f);
+
+        // the nearest hit is the same triangle with the same barycentrics
+        float t, u, v;
+        assert(RayIntersectTriangleWatertight(ray, tris[hit.index], t, u, v));
+        assert(t == hit.t && u == hit.u && v == hit.v);
+
+        // just for information: Moller-Trumbore may leak here
+        bool isHitMT = false;
+
+        for (const Triangle& tri : tris)
+            isHitMT |= RayIntersectTriangle(ray, tri, t, u, v);
+
+        numLeaksMT += !isHitMT;
+    }
+
+    // an empty mesh is never hit
+    assert(RayIntersectTrianglesWatertight(Ray(Vec3(0, 0, 1), Vec3(0, 0, -1)), nullptr, 0, hit) == -1);
+
+    LogMsg("%-50s test is passed (MT leaks: %d)", "RayIntersectTrianglesWatertight() on a mesh", numLeaksMT);
+}
+
+
+//==================================================================================
+// main test
+//==================================================================================
+void TestTriangle()
+{
+    SetConsoleColor(MAGENTA);
+
+    LogMsg("-----------------------------------------------");
+    LogMsg("Test triangle functional:");
+    LogMsg("-----------------------------------------------");
+
+    TestTriangleBasics();
+    TestRayIntersectTriangle();
+    TestRayIntersectTrianglex8();
+    TestRayIntersectTriangleWatertightMesh();
+
+    LogMsg("-----------------------------------------------");
+    LogMsg("all the triangle tests are passed!");
+    LogMsg("-----------------------------------------------\n");
+
+    SetConsoleColor(RESET);
+}
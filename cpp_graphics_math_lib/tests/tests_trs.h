@@ -0,0 +1,179 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: tests_trs.h
+    Desc:     tests for composition of (translation, rotation, scale) into matrices
+
+    Created:  17.10.2026  by DimaSkup
+\**********************************************************************************/
+#pragma once
+#include <math/trs.h>
+#include <math/math_helpers.h>
+#include <math/random.h>
+#include <log.h>
+#include <stdio.h>
+#include <vector>
+
+
+//==================================================================================
+// forward declaration of the main test
+//==================================================================================
+void TestTRS();
+
+
+//==================================================================================
+// test functions
+//==================================================================================
+void TestComposeTRS()
+{
+    const Vec3 t(3, -2, 5);
+    const Vec3 s(2, 0.5f, 3);
+    const Vec3 axis(1, 2, -1);
+    const float angle = 0.8f;
+
+    const Matrix expect =
+        MatrixScaling(s.x, s.y, s.z) *
+        MatrixRotationAxis(axis, angle) *
+        MatrixTranslation(t.x, t.y, t.z);
+
+    Matrix    m;
+    Matrix3x4 m34;
+
+    ComposeTRS(t, QuatFromAxisAngle(axis, angle), s, m);
+    ComposeTRS(t, QuatFromAxisAngle(axis, angle), s, m34);
+
+    assert(MatrixEqual(m, expect) == true);
+    assert(Matrix3x4Equal(m34, Matrix3x4(expect)) == true);
+
+    LogMsg("%-50s test is passed", "ComposeTRS(t, q, s, outMat)");
+}
+
+//---------------------------------------------------------
+
+void TestComposeTRSBatch_Helper(const size_t n)
+{
+    // SoA input data
+    std::vector<float> data[10];
+
+    for (std::vector<float>& arr : data)
+        arr.resize(n);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        const Quat q = QuatFromAxisAngle(Vec3(RandF(-1, 1), RandF(-1, 1), RandF(0.1f, 1)), RandF(-PI, PI));
+
+        data[0][i] = RandF(-100, 100);
+        data[1][i] = RandF(-100, 100);
+        data[2][i] = RandF(-100, 100);
+        data[3][i] = q.x;
+        data[4][i] = q.y;
+        data[5][i] = q.z;
+        data[6][i] = q.w;
+        data[7][i] = RandF(0.1f, 4);
+        data[8][i] = RandF(0.1f, 4);
+        data[9][i] = RandF(0.1f, 4);
+    }
+
+    TRSArraysSoA trs;
+    trs.tx = data[0].data();
+    trs.ty = data[1].data();
+    trs.tz = data[2].data();
+    trs.qx = data[3].data();
+    trs.qy = data[4].data();
+    trs.qz = data[5].data();
+    trs.qw = data[6].data();
+    trs.sx = data[7].data();
+    trs.sy = data[8].data();
+    trs.sz = data[9].data();
+
+    Matrix*    mats   = new Matrix[n + 1];
+    Matrix3x4* mats34 = new Matrix3x4[n + 1];
+
+    ComposeTRSBatch(trs, mats, n);
+    ComposeTRSBatch(trs, mats34, n);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        const Vec3 t(trs.tx[i], trs.ty[i], trs.tz[i]);
+        const Quat q(trs.qx[i], trs.qy[i], trs.qz[i], trs.qw[i]);
+        const Vec3 s(trs.sx[i], trs.sy[i], trs.sz[i]);
+
+        const Matrix expect =
+            MatrixScaling(s.x, s.y, s.z) *
+            QuatToMatrix(q) *
+            MatrixTranslation(t.x, t.y, t.z);
+
+        assert(MatrixEqual(mats[i], expect) == true);
+        assert(Matrix3x4Equal(mats34[i], Matrix3x4(expect)) == true);
+    }
+
+    // nothing is written behind the end of the output
+    assert(MatrixEqual(mats[n], Matrix()) == true);
+    assert(Matrix3x4Equal(mats34[n], Matrix3x4()) == true);
+
+    delete[] mats;
+    delete[] mats34;
+}
+
+//---------------------------------------------------------
+
+void TestComposeTRSBatch()
+{
+    // sizes to test the AVX body (8), the SSE body (4) and the scalar tail
+    TestComposeTRSBatch_Helper(0);
+    TestComposeTRSBatch_Helper(3);
+    TestComposeTRSBatch_Helper(8);
+    TestComposeTRSBatch_Helper(31);
+
+    LogMsg("%-50s test is passed", "ComposeTRSBatch(trs, outMatrices, n)");
+}
+
+//---------------------------------------------------------
+
+void TestQuatToMatrixBatch()
+{
+    const size_t n = 11;
+
+    Quat   quats[n];
+    Matrix mats[n];
+
+    for (size_t i = 0; i < n; ++i)
+        quats[i] = QuatFromAxisAngle(Vec3(RandF(-1, 1), RandF(0.1f, 1), RandF(-1, 1)), RandF(-PI, PI));
+
+    QuatToMatrixBatch(quats, mats, n);
+
+    for (size_t i = 0; i < n; ++i)
+        assert(MatrixEqual(mats[i], QuatToMatrix(quats[i])) == true);
+
+    LogMsg("%-50s test is passed", "QuatToMatrixBatch(quats, outMatrices, n)");
+}
+
+
+//==================================================================================
+// main test
+//==================================================================================
+void TestTRS()
+{
+    SetConsoleColor(CYAN);
+
+    LogMsg("-----------------------------------------------");
+    LogMsg("Test TRS functional:");
+    LogMsg("-----------------------------------------------");
+
+    TestComposeTRS();
+    TestComposeTRSBatch();
+    TestQuatToMatrixBatch();
+
+    LogMsg("-----------------------------------------------");
+    LogMsg("all the TRS tests are passed!");
+    LogMsg("-----------------------------------------------\n");
+
+    SetConsoleColor(RESET);
+}
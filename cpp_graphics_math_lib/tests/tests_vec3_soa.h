@@ -0,0 +1,254 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: tests_vec3_soa.h
+    Desc:     tests for SoA form of Vec3 (Vec3x8, Vec3SoA)
+
+    Created:  17.10.2026  by DimaSkup
+\**********************************************************************************/
+#pragma once
+#include <math/vec3_soa.h>
+#include <math/math_helpers.h>
+#include <math/random.h>
+#include <log.h>
+#include <stdio.h>
+
+
+//==================================================================================
+// forward declaration of the main test
+//==================================================================================
+void TestVec3SoA();
+
+
+//==================================================================================
+// helpers
+//==================================================================================
+inline Vec3 TestVec3SoARandomVec()
+{
+    return Vec3(RandF(-2, 2), RandF(-2, 2), RandF(-2, 2));
+}
+
+//---------------------------------------------------------
+
+inline Vec3x8 TestVec3SoARandomVec3x8(Vec3* outAoS)
+{
+    for (int i = 0; i < 8; ++i)
+        outAoS[i] = TestVec3SoARandomVec();
+
+    return Vec3x8Load(outAoS);
+}
+
+//---------------------------------------------------------
+
+inline bool TestVec3SoAEqual(const Vec3x8& v, const Vec3* expect)
+{
+    for (int i = 0; i < 8; ++i)
+    {
+        if (!(v.Get(i) == expect[i]))
+            return false;
+    }
+    return true;
+}
+
+
+//==================================================================================
+// test functions
+//==================================================================================
+void TestVec3x8Arithmetic()
+{
+    Vec3 a[8];
+    Vec3 b[8];
+    Vec3 c[8];
+    Vec3 expect[8];
+
+    const Vec3x8 va = TestVec3SoARandomVec3x8(a);
+    const Vec3x8 vb = TestVec3SoARandomVec3x8(b);
+    const Vec3x8 vc = TestVec3SoARandomVec3x8(c);
+
+    for (int i = 0; i < 8; ++i)
+        expect[i] = Vec3(a[i].x + b[i].x, a[i].y + b[i].y, a[i].z + b[i].z);
+    assert(TestVec3SoAEqual(Vec3x8Add(va, vb), expect));
+
+    for (int i = 0; i < 8; ++i)
+        expect[i] = Vec3(a[i].x - b[i].x, a[i].y - b[i].y, a[i].z - b[i].z);
+    assert(TestVec3SoAEqual(Vec3x8Sub(va, vb), expect));
+
+    for (int i = 0; i < 8; ++i)
+        expect[i] = Vec3(a[i].x * b[i].x, a[i].y * b[i].y, a[i].z * b[i].z);
+    assert(TestVec3SoAEqual(Vec3x8Mul(va, vb), expect));
+
+    for (int i = 0; i < 8; ++i)
+        expect[i] = Vec3(a[i].x * 3.0f, a[i].y * 3.0f, a[i].z * 3.0f);
+    assert(TestVec3SoAEqual(Vec3x8Mul(va, 3.0f), expect));
+
+    for (int i = 0; i < 8; ++i)
+        expect[i] = Vec3(a[i].x*b[i].x + c[i].x, a[i].y*b[i].y + c[i].y, a[i].z*b[i].z + c[i].z);
+    assert(TestVec3SoAEqual(Vec3x8MulAdd(va, vb, vc), expect));
+
+    LogMsg("%-50s test is passed", "Vec3x8Add/Sub/Mul/MulAdd");
+}
+
+//---------------------------------------------------------
+
+void TestVec3x8DotCross()
+{
+    Vec3 a[8];
+    Vec3 b[8];
+    Vec3 expect[8];
+    float res[8];
+
+    const Vec3x8 va = TestVec3SoARandomVec3x8(a);
+    const Vec3x8 vb = TestVec3SoARandomVec3x8(b);
+
+    // dot
+    Vec3x8Dot(va, vb, res);
+
+    for (int i = 0; i < 8; ++i)
+        assert(FloatEqual(res[i], a[i].x*b[i].x + a[i].y*b[i].y + a[i].z*b[i].z));
+
+    // cross
+    for (int i = 0; i < 8; ++i)
+    {
+        expect[i] = Vec3(a[i].y*b[i].z - a[i].z*b[i].y,
+                         a[i].z*b[i].x - a[i].x*b[i].z,
+                         a[i].x*b[i].y - a[i].y*b[i].x);
+    }
+    assert(TestVec3SoAEqual(Vec3x8Cross(va, vb), expect));
+
+    // length
+    Vec3x8Length(va, res);
+
+    for (int i = 0; i < 8; ++i)
+        assert(FloatEqual(res[i], sqrtf(SQR(a[i].x) + SQR(a[i].y) + SQR(a[i].z))));
+
+    // normalize
+    const Vec3x8 n = Vec3x8Normalize(va);
+    Vec3x8Length(n, res);
+
+    for (int i = 0; i < 8; ++i)
+    {
+        const float invLen = 1.0f / sqrtf(SQR(a[i].x) + SQR(a[i].y) + SQR(a[i].z));
+        expect[i] = Vec3(a[i].x * invLen, a[i].y * invLen, a[i].z * invLen);
+
+        assert(FloatEqual(res[i], 1.0f));
+    }
+    assert(TestVec3SoAEqual(n, expect));
+
+    LogMsg("%-50s test is passed", "Vec3x8Dot/Cross/Length/Normalize");
+}
+
+//---------------------------------------------------------
+
+void TestVec3x8GatherScatter()
+{
+    Vec3 src[20];
+    Vec3 dst[20];
+    Vec3 expect[8];
+
+    for (int i = 0; i < 20; ++i)
+        src[i] = TestVec3SoARandomVec();
+
+    // load/store of sequential vectors
+    const Vec3x8 seq = Vec3x8Load(src + 5);
+    assert(TestVec3SoAEqual(seq, src + 5));
+
+    Vec3x8Store(seq, dst + 1);
+
+    for (int i = 0; i < 8; ++i)
+        assert(dst[i + 1] == src[i + 5]);
+
+    // gather/scatter by indices
+    const int indices[8] = { 19, 0, 7, 3, 12, 1, 18, 4 };
+
+    for (int i = 0; i < 8; ++i)
+        expect[i] = src[indices[i]];
+
+    const Vec3x8 v = Vec3x8Gather(src, indices);
+    assert(TestVec3SoAEqual(v, expect));
+
+    Vec3x8Scatter(v, indices, dst);
+
+    for (int i = 0; i < 8; ++i)
+        assert(dst[indices[i]] == src[indices[i]]);
+
+    LogMsg("%-50s test is passed", "Vec3x8Load/Store/Gather/Scatter");
+}
+
+//---------------------------------------------------------
+
+void TestVec3SoAContainer()
+{
+    const size_t n = 27;
+    Vec3 src[n];
+    Vec3 dst[n];
+
+    for (size_t i = 0; i < n; ++i)
+        src[i] = TestVec3SoARandomVec();
+
+    Vec3SoA soa;
+    Vec3SoAFromArray(src, n, soa);
+
+    // capacity is padded up to 8 lanes, arrays are aligned
+    assert(soa.size == n);
+    assert(soa.capacity == 32);
+    assert(((size_t)soa.x % 32) == 0);
+    assert(((size_t)soa.y % 32) == 0);
+    assert(((size_t)soa.z % 32) == 0);
+
+    for (size_t i = 0; i < n; ++i)
+        assert(soa.Get(i) == src[i]);
+
+    // padding lanes are zeros
+    for (size_t i = n; i < soa.capacity; ++i)
+        assert(soa.x[i] == 0 && soa.y[i] == 0 && soa.z[i] == 0);
+
+    // process the container by blocks of 8 and convert back
+    for (size_t i = 0; i < soa.size; i += 8)
+        Vec3x8Store(Vec3x8Mul(Vec3x8Load(soa, i), 2.0f), soa, i);
+
+    Vec3SoAToArray(soa, dst);
+
+    for (size_t i = 0; i < n; ++i)
+        assert(dst[i] == Vec3(src[i].x * 2, src[i].y * 2, src[i].z * 2));
+
+    // shrink and grow: the content is kept, new elements are zeros
+    soa.Resize(3);
+    soa.Resize(40);
+
+    assert(soa.Get(2) == Vec3(src[2].x * 2, src[2].y * 2, src[2].z * 2));
+    assert(soa.Get(3) == Vec3(0, 0, 0));
+    assert(soa.Get(39) == Vec3(0, 0, 0));
+
+    LogMsg("%-50s test is passed", "Vec3SoA");
+}
+
+
+//==================================================================================
+// main test
+//==================================================================================
+void TestVec3SoA()
+{
+    SetConsoleColor(YELLOW);
+
+    LogMsg("-----------------------------------------------");
+    LogMsg("Test Vec3SoA/Vec3x8 functional:");
+    LogMsg("-----------------------------------------------");
+
+    TestVec3x8Arithmetic();
+    TestVec3x8DotCross();
+    TestVec3x8GatherScatter();
+    TestVec3SoAContainer();
+
+    LogMsg("-----------------------------------------------");
+    LogMsg("all the Vec3SoA tests are passed!");
+    LogMsg("-----------------------------------------------\n");
+
+    SetConsoleColor(RESET);
+}
@@ -0,0 +1,126 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: tests_vec4.h
+    Desc:     tests for Vec4 functional
+
+    Created:  17.10.2026  by DimaSkup
+\**********************************************************************************/
+#pragma once
+#include <math/vec4.h>
+#include <math/math_helpers.h>
+#include <log.h>
+#include <stdio.h>
+
+
+//==================================================================================
+// forward declaration of the main test
+//==================================================================================
+void TestVec4();
+
+
+//==================================================================================
+// test functions
+//==================================================================================
+void TestVec4Layout()
+{
+    static_assert(sizeof(Vec4) == 16,  "Vec4 must be 16 bytes");
+    static_assert(alignof(Vec4) == 16, "Vec4 must be 16-byte aligned");
+
+    Vec4 arr[3];
+    assert(((size_t)&arr[1] % 16) == 0);
+
+    LogMsg("%-50s test is passed", "sizeof/alignof(Vec4)");
+}
+
+//---------------------------------------------------------
+
+void TestVec4Arithmetic()
+{
+    const Vec4 a(1, -2, 3, 4);
+    const Vec4 b(0.5f, 2, -1, 8);
+
+    assert((a + b) == Vec4(1.5f, 0, 2, 12));
+    assert((a - b) == Vec4(0.5f, -4, 4, -4));
+    assert((a * b) == Vec4(0.5f, -4, -3, 32));
+    assert((a * 2) == Vec4(2, -4, 6, 8));
+    assert((-a)    == Vec4(-1, 2, -3, -4));
+
+    assert(Vec4MulAdd(a, b, Vec4(1, 1, 1, 1)) == Vec4(1.5f, -3, -2, 33));
+
+    Vec4 c = a;
+    c += b;
+    assert(c == Vec4(1.5f, 0, 2, 12));
+    c -= b;
+    assert(c == a);
+    c *= 3;
+    assert(c == Vec4(3, -6, 9, 12));
+
+    assert(FloatEqual(Vec4Dot(a, b), 0.5f - 4 - 3 + 32));
+
+    LogMsg("%-50s test is passed", "Vec4 arithmetic, Vec4Dot");
+}
+
+//---------------------------------------------------------
+
+void TestVec4MinMaxAbs()
+{
+    const Vec4 a(1, -2, 3, -4);
+    const Vec4 b(0, 2, 5, -8);
+
+    assert(Vec4Min(a, b) == Vec4(0, -2, 3, -8));
+    assert(Vec4Max(a, b) == Vec4(1, 2, 5, -4));
+    assert(Vec4Abs(a)    == Vec4(1, 2, 3, 4));
+
+    LogMsg("%-50s test is passed", "Vec4Min/Max/Abs");
+}
+
+//---------------------------------------------------------
+
+void TestVec4Compare()
+{
+    const Vec4 a(1, 2, 3, 4);
+    const Vec4 b(1, 5, 0, 4.5f);
+
+    assert(Vec4Less(a, b)        == 0b1010);
+    assert(Vec4LessOrEqual(a, b) == 0b1011);
+
+    // approximate equality
+    assert(Vec4NearEqual(a, Vec4(1, 2, 3, 4 + EPSILON_E5 * 0.5f)) == true);
+    assert(Vec4NearEqual(a, Vec4(1, 2, 3, 4.001f))                == false);
+    assert(Vec4NearEqual(a, Vec4(1, 2, 3, 4.001f), 0.01f)         == true);
+    assert((a == Vec4(1, 2.1f, 3, 4)) == false);
+
+    LogMsg("%-50s test is passed", "Vec4Less/LessOrEqual/NearEqual");
+}
+
+
+//==================================================================================
+// main test
+//==================================================================================
+void TestVec4()
+{
+    SetConsoleColor(GREEN);
+
+    LogMsg("-----------------------------------------------");
+    LogMsg("Test Vec4 functional:");
+    LogMsg("-----------------------------------------------");
+
+    TestVec4Layout();
+    TestVec4Arithmetic();
+    TestVec4MinMaxAbs();
+    TestVec4Compare();
+
+    LogMsg("-----------------------------------------------");
+    LogMsg("all the Vec4 tests are passed!");
+    LogMsg("-----------------------------------------------\n");
+
+    SetConsoleColor(RESET);
+}
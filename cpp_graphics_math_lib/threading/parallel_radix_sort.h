@@ -0,0 +1,124 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: parallel_radix_sort.h
+    Desc:     parallel LSD radix sort of (32-bit key, 32-bit value) pairs
+
+              each pass sorts by 8 bits of the key:
+              1. each chunk of the input counts its digits (in parallel);
+              2. the counts are scanned in (digit, chunk) order which gives
+                 each chunk its own output offset for each digit;
+              3. each chunk scatters its elements (in parallel)
+              the sort is stable and its result doesn't depend on the
+              number of threads
+
+    Created:  17.10.2026 by DimaSkup
+\**********************************************************************************/
+#pragma once
+
+#include <threading/task_pool.h>
+#include <assert.h>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+
+//---------------------------------------------------------
+// Desc:   sort keys (and values along with them) in ascending order
+// Args:   - pool:      a pool to execute tasks
+//         - keys:      keys to sort (the result is written here)
+//         - values:    values to reorder along with the keys
+//         - tmpKeys:   a temp buffer of n elements
+//         - tmpValues: a temp buffer of n elements
+//         - n:         number of elements
+//         - numBits:   number of lower bits of keys to sort by (the rest must be 0)
+//---------------------------------------------------------
+inline void ParallelRadixSort(
+    TaskPool& pool,
+    uint32_t* keys,
+    uint32_t* values,
+    uint32_t* tmpKeys,
+    uint32_t* tmpValues,
+    const uint32_t n,
+    const int numBits = 32)
+{
+    assert((keys && values && tmpKeys && tmpValues) || (n == 0));
+    assert(numBits > 0 && numBits <= 32);
+
+    constexpr int      DIGIT_BITS = 8;
+    constexpr uint32_t NUM_DIGITS = 1 << DIGIT_BITS;
+    constexpr uint32_t GRAIN_SIZE = 1 << 14;
+
+    const uint32_t        numChunks = (n + GRAIN_SIZE - 1) / GRAIN_SIZE;
+    std::vector<uint32_t> offsets(numChunks * NUM_DIGITS);
+
+    uint32_t* srcKeys   = keys;
+    uint32_t* srcValues = values;
+    uint32_t* dstKeys   = tmpKeys;
+    uint32_t* dstValues = tmpValues;
+
+    for (int shift = 0; shift < numBits; shift += DIGIT_BITS)
+    {
+        // count digits of each chunk
+        pool.ParallelFor(n, GRAIN_SIZE, [&](const uint32_t begin, const uint32_t end)
+        {
+            uint32_t* counts = offsets.data() + (begin / GRAIN_SIZE) * NUM_DIGITS;
+
+            for (uint32_t d = 0; d < NUM_DIGITS; ++d)
+                counts[d] = 0;
+
+            for (uint32_t i = begin; i < end; ++i)
+                counts[(srcKeys[i] >> shift) & (NUM_DIGITS - 1)]++;
+        });
+
+        // exclusive scan: all the smaller digits go first, then the same digit of previous chunks
+        uint32_t sum = 0;
+
+        for (uint32_t d = 0; d < NUM_DIGITS; ++d)
+        {
+            for (uint32_t c = 0; c < numChunks; ++c)
+            {
+                const uint32_t count = offsets[c * NUM_DIGITS + d];
+                offsets[c * NUM_DIGITS + d] = sum;
+                sum += count;
+            }
+        }
+
+        // scatter
+        pool.ParallelFor(n, GRAIN_SIZE, [&](const uint32_t begin, const uint32_t end)
+        {
+            uint32_t* chunkOffsets = offsets.data() + (begin / GRAIN_SIZE) * NUM_DIGITS;
+
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                const uint32_t dst = chunkOffsets[(srcKeys[i] >> shift) & (NUM_DIGITS - 1)]++;
+
+                dstKeys[dst]   = srcKeys[i];
+                dstValues[dst] = srcValues[i];
+            }
+        });
+
+        std::swap(srcKeys,   dstKeys);
+        std::swap(srcValues, dstValues);
+    }
+
+    // after an odd number of passes the result is in the temp buffers
+    if (srcKeys != keys)
+    {
+        pool.ParallelFor(n, GRAIN_SIZE, [&](const uint32_t begin, const uint32_t end)
+        {
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                keys[i]   = srcKeys[i];
+                values[i] = srcValues[i];
+            }
+        });
+    }
+}
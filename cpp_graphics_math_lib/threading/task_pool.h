@@ -0,0 +1,309 @@
+/**********************************************************************************\
+
+    ******     ******    ******   ******    ********
+    **    **  **    **  **    **  **    **  **    **
+    **    **  **    **  **    **  **    **  **
+    **    **  **    **  **    **  **    **  ********
+    **    **  **    **  **    **  ******          **
+    **    **  **    **  **    **  **  ***   **    **
+    ******     ******    ******   **    **  ********
+
+    Filename: task_pool.h
+    Desc:     a small work-stealing thread pool for fork-join jobs
+              (parallel builds of spatial structures, parallel sorting, etc.)
+
+              - each worker has its own queue: it pushes/pops its tasks
+                from the back (LIFO, good for caches), other workers steal
+                from the front (FIFO, they get bigger pieces of work);
+              - tasks submitted by non-worker threads go into a shared queue;
+              - Wait() doesn't block: the waiting thread executes queued
+                tasks until its counter is zero, so tasks may recursively
+                submit and wait for subtasks without deadlocks
+
+    Created:  17.10.2026 by DimaSkup
+\**********************************************************************************/
+#pragma once
+
+#include <math/simd.h>
+#include <assert.h>
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+
+//---------------------------------------------------------
+// Desc:   number of unfinished tasks of some job (one fork-join point)
+//---------------------------------------------------------
+struct TaskCounter
+{
+    std::atomic<int> pending{ 0 };
+};
+
+//---------------------------------------------------------
+
+class TaskPool
+{
+public:
+    using Task = std::function<void()>;
+
+    struct QueuedTask
+    {
+        Task         func;
+        TaskCounter* counter = nullptr;
+    };
+
+    struct alignas(64) Queue
+    {
+        std::mutex             mutex;
+        std::deque<QueuedTask> tasks;
+    };
+
+    //-----------------------------------------------------
+    // public data
+    //-----------------------------------------------------
+    std::vector<std::thread> threads;
+    Queue*                   queues    = nullptr;   // one per worker + a shared one for other threads
+    int                      numQueues = 0;
+
+    std::atomic<int>         numQueued{ 0 };
+    std::atomic<bool>        stop{ false };
+    std::mutex               sleepMutex;
+    std::condition_variable  wakeUp;
+
+    //-----------------------------------------------------
+    // constructors, destructor
+    //-----------------------------------------------------
+    explicit TaskPool(const int numWorkers = -1);
+    ~TaskPool();
+
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator = (const TaskPool&) = delete;
+
+    //-----------------------------------------------------
+    // methods
+    //-----------------------------------------------------
+    void Submit(TaskCounter& counter, Task task);
+    void Wait(TaskCounter& counter);
+
+    template <class TFunc>
+    void ParallelFor(const uint32_t count, const uint32_t grainSize, const TFunc& func);
+
+    inline int GetNumWorkers() const { return (int)threads.size(); }
+
+    //-----------------------------------------------------
+    // internal
+    //-----------------------------------------------------
+    int  GetQueueIdx() const;
+    bool TryRunTask(const int selfIdx);
+    void WorkerLoop(const int idx);
+};
+
+
+//==================================================================================
+// INLINE METHODS
+//==================================================================================
+
+//---------------------------------------------------------
+// Desc:   info about the pool which owns the current thread (if any)
+//---------------------------------------------------------
+struct TaskPoolThreadInfo
+{
+    const TaskPool* pool     = nullptr;
+    int             queueIdx = -1;
+};
+
+inline TaskPoolThreadInfo& TaskPoolGetThreadInfo()
+{
+    static thread_local TaskPoolThreadInfo info;
+    return info;
+}
+
+//---------------------------------------------------------
+// Desc:   create a pool and start workers
+// Args:   - numWorkers: number of worker threads; -1 means (number of cores - 1)
+//                       since a thread which waits for tasks executes them too;
+//                       0 means all the tasks are executed by waiting threads
+//---------------------------------------------------------
+inline TaskPool::TaskPool(const int numWorkers)
+{
+    int count = numWorkers;
+
+    if (count < 0)
+    {
+        const int numCores = (int)std::thread::hardware_concurrency();
+        count = (numCores > 1) ? numCores - 1 : 0;
+    }
+
+    numQueues = count + 1;
+
+    // aligned new is C++17, so queues are constructed in aligned memory by hand
+    // (each queue takes its own cache lines: no false sharing of mutexes)
+    queues = (Queue*)AlignedAlloc(numQueues * sizeof(Queue), alignof(Queue));
+    assert(queues != nullptr && "can't allocate memory for task queues");
+
+    for (int i = 0; i < numQueues; ++i)
+        new (queues + i) Queue();
+
+    threads.reserve(count);
+
+    for (int i = 0; i < count; ++i)
+        threads.emplace_back(&TaskPool::WorkerLoop, this, i);
+}
+
+//---------------------------------------------------------
+// Desc:   stop and join all the workers (queued tasks must be finished before)
+//---------------------------------------------------------
+inline TaskPool::~TaskPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stop = true;
+    }
+    wakeUp.notify_all();
+
+    for (std::thread& thread : threads)
+        thread.join();
+
+    assert(numQueued == 0 && "the pool is destroyed with unfinished tasks");
+
+    for (int i = 0; i < numQueues; ++i)
+        queues[i].~Queue();
+
+    AlignedFree(queues);
+}
+
+//---------------------------------------------------------
+// Desc:   a queue of the current thread: its own for workers of this pool,
+//         the shared one (the last) for all the other threads
+//---------------------------------------------------------
+inline int TaskPool::GetQueueIdx() const
+{
+    const TaskPoolThreadInfo& info = TaskPoolGetThreadInfo();
+    return (info.pool == this) ? info.queueIdx : numQueues - 1;
+}
+
+//---------------------------------------------------------
+// Desc:   queue a task; the counter is decremented when the task is finished
+//---------------------------------------------------------
+inline void TaskPool::Submit(TaskCounter& counter, Task task)
+{
+    counter.pending.fetch_add(1);
+
+    Queue& queue = queues[GetQueueIdx()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(QueuedTask{ std::move(task), &counter });
+    }
+
+    // increment under the mutex so a worker which is going to sleep can't miss it
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        numQueued.fetch_add(1);
+    }
+    wakeUp.notify_one();
+}
+
+//---------------------------------------------------------
+// Desc:   execute a single task: the latest one from the own queue or
+//         the oldest one stolen from another queue
+// Ret:    false if there are no tasks at all
+//---------------------------------------------------------
+inline bool TaskPool::TryRunTask(const int selfIdx)
+{
+    QueuedTask task;
+    bool       found = false;
+
+    for (int i = 0; (i < numQueues) && !found; ++i)
+    {
+        const int idx   = (selfIdx + i) % numQueues;
+        Queue&    queue = queues[idx];
+
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        if (queue.tasks.empty())
+            continue;
+
+        if (idx == selfIdx)
+        {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+        else
+        {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+
+        found = true;
+    }
+
+    if (!found)
+        return false;
+
+    numQueued.fetch_sub(1);
+
+    task.func();
+    task.counter->pending.fetch_sub(1);
+
+    return true;
+}
+
+//---------------------------------------------------------
+// Desc:   execute queued tasks until all the tasks of the counter are finished
+//---------------------------------------------------------
+inline void TaskPool::Wait(TaskCounter& counter)
+{
+    const int selfIdx = GetQueueIdx();
+
+    while (counter.pending.load() > 0)
+    {
+        if (!TryRunTask(selfIdx))
+            std::this_thread::yield();
+    }
+}
+
+//---------------------------------------------------------
+// Desc:   a main loop of a worker thread
+//---------------------------------------------------------
+inline void TaskPool::WorkerLoop(const int idx)
+{
+    TaskPoolThreadInfo& info = TaskPoolGetThreadInfo();
+    info.pool     = this;
+    info.queueIdx = idx;
+
+    while (!stop)
+    {
+        if (TryRunTask(idx))
+            continue;
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wakeUp.wait(lock, [this]() { return stop || (numQueued.load() > 0); });
+    }
+}
+
+//---------------------------------------------------------
+// Desc:   call func(begin, end) for ranges of [0, count) in parallel
+//         and wait until all of them are finished
+// Args:   - grainSize: max size of one range
+//---------------------------------------------------------
+template <class TFunc>
+inline void TaskPool::ParallelFor(const uint32_t count, const uint32_t grainSize, const TFunc& func)
+{
+    assert(grainSize > 0);
+
+    TaskCounter counter;
+
+    for (uint32_t begin = 0; begin < count; begin += grainSize)
+    {
+        const uint32_t end = (count - begin > grainSize) ? begin + grainSize : count;
+        Submit(counter, [&func, begin, end]() { func(begin, end); });
+    }
+
+    Wait(counter);
+}